@@ -1,4 +1,3 @@
-<<<<<<< HEAD
 #pragma once
 #include "widget.hpp"
 
@@ -13,6 +12,18 @@ namespace zketch {
         Font font_ ;
         std::function<void(Canvas*, const Button&)> drawing_logic_ ;
         std::function<void()> callback_ ;
+		uint64_t skin_ = 0 ;
+
+		static inline const uint64_t ___DEFAULT_SKIN___ = SurfaceCache::NewSkin() ;
+
+		uint32_t GetState() const noexcept { return is_pressed_ ? 2 : is_hovered_ ? 1 : 0 ; }
+
+		uint64_t GetContentHash() const noexcept {
+			uint64_t h = codec::Hash64(label_.data(), label_.size() * sizeof(wchar_t)) ;
+			h = codec::Hash64(font_.GetFontName().data(), font_.GetFontName().size(), h) ;
+			h = HashValue(font_.GetFontSize(), h) ;
+			return HashValue(font_.GetFontStyle(), h) ;
+		}
 
 		void UpdateImpl() noexcept {
             if (!drawing_logic_) {
@@ -23,7 +34,19 @@ namespace zketch {
 				return ;
 			}
 
+			if (skin_ == 0) {
+				drawing_logic_(canvas_.get(), *this) ;
+				return ;
+			}
+
+			// buttons with the same size, state, skin and label end up sharing one surface
+			SurfaceKey key {canvas_->GetSize(), GetState(), skin_, GetContentHash()} ;
+			if (SurfaceCache::Find(key, *canvas_)) {
+				return ;
+			}
+
             drawing_logic_(canvas_.get(), *this) ;
+			SurfaceCache::Store(key, *canvas_) ;
         }
 
     public:
@@ -33,6 +56,19 @@ namespace zketch {
             canvas_->Create(bound_.GetSize()) ;
 
             SetDrawingLogic([](Canvas* canvas, const Button& button) {
+				// the label-free skin is shared too, labeled buttons fork it when the text is drawn
+				SurfaceKey skin_key {canvas->GetSize(), button.GetState(), ___DEFAULT_SKIN___, 0} ;
+				if (SurfaceCache::Find(skin_key, *canvas)) {
+					if (!button.GetLabel().empty()) {
+						Renderer render ;
+						if (render.Begin(*canvas)) {
+							button.DrawLabel(render) ;
+							render.End() ;
+						}
+					}
+					return ;
+				}
+
                 Renderer render ;
                 if (!render.Begin(*canvas)) {
 					return ;
@@ -56,20 +92,25 @@ namespace zketch {
                 RectF rect = button.GetRelativeBound() ;
                 render.FillRectRounded(rect, button_color, 5.0f) ;
                 render.DrawRectRounded(rect, border_color, 5.0f, 2.0f) ;
-                
-                if (!button.GetLabel().empty()) {
-                    Color text_color = rgba(255, 255, 255, 1) ;
-                    render.DrawString(
-						button.GetLabel(), 
-						button.GetFont().GetStringBound(button.GetLabel(), {0, button.GetFont().GetAscent()}).AnchorTo(button.GetRelativeBound(), Pivot::Center), 
-						text_color, 
-						button.GetFont()) ;
-                }
 
-                render.End() ;
-            }) ;
+				render.End() ;
+				SurfaceCache::Store(skin_key, *canvas) ;
+
+				if (!button.GetLabel().empty() && render.Begin(*canvas)) {
+					button.DrawLabel(render) ;
+					render.End() ;
+				}
+            }, ___DEFAULT_SKIN___) ;
         }
 
+		void DrawLabel(Renderer& render) const noexcept {
+			render.DrawString(
+				label_, 
+				font_.GetStringBound(label_, {0, font_.GetAscent()}).AnchorTo(GetRelativeBound(), Pivot::Center), 
+				rgba(255, 255, 255, 1), 
+				font_) ;
+		}
+
         bool OnHover(const PointF& mouse_pos) noexcept {
             bool state = bound_.Contain(mouse_pos) ;
             if (state != is_hovered_) {
@@ -101,8 +142,11 @@ namespace zketch {
             return false ;
         }
 
-        void SetDrawingLogic(std::function<void(Canvas*, const Button&)> drawing_logic) noexcept {
+		// pass a skin from SurfaceCache::NewSkin() when the logic only depends on size, state, label
+		// and font, buttons that match then share their surface. 0 keeps the canvas private.
+        void SetDrawingLogic(std::function<void(Canvas*, const Button&)> drawing_logic, uint64_t skin = 0) noexcept {
             drawing_logic_ = std::move(drawing_logic) ;
+			skin_ = skin ;
             update_ = true ;
         }
         
@@ -130,149 +174,4 @@ namespace zketch {
         bool IsHovered() const noexcept { return is_hovered_ ; }
         bool IsPressed() const noexcept { return is_pressed_ ; }
     } ;
-=======
-#pragma once
-#include "widget.hpp"
-
-namespace zketch {
-	class Button : public Widget<Button> {
-		friend class Widget<Button> ;
-
-    private:
-        bool is_hovered_ = false ;
-        bool is_pressed_ = false ;
-        std::wstring label_ ;
-        Font font_ ;
-        std::function<void(Canvas*, const Button&)> drawer_ ;
-        std::function<void()> on_click_ ;
-
-		void UpdateImpl() noexcept {
-            if (!drawer_) {
-				return ;
-			}
-
-            if (!ValidateCanvas("Button::UpdateImpl()")) {
-				return ;
-			}
-
-            drawer_(canvas_.get(), *this) ;
-        }
-
-    public:
-        Button(const RectF& bound, const std::wstring& label = L"", const Font& font = Font()) noexcept : label_(label), font_(font) {
-            bound_ = bound ;
-            canvas_ = std::make_unique<Canvas>() ;
-            canvas_->Create(bound_.GetSize()) ;
-            canvas_->SetClearColor(rgba(0, 0, 0, 0)) ;
-
-            SetDrawer([](Canvas* canvas, const Button& button) {
-                Drawer drawer ;
-                if (!drawer.Begin(*canvas)) return ;
-
-                // No need to call Clear() - already done by Begin()
-
-                Color button_color ;
-                Color border_color ;
-                
-                if (button.IsPressed()) {
-                    button_color = rgba(70, 130, 180, 255) ;
-                    border_color = rgba(50, 100, 150, 255) ;
-                } else if (button.IsHovered()) {
-                    button_color = rgba(100, 149, 237, 255) ;
-                    border_color = rgba(70, 119, 207, 255) ;
-                } else {
-                    button_color = rgba(135, 206, 250, 255) ;
-                    border_color = rgba(100, 171, 220, 255) ;
-                }
-                
-                RectF rect = button.GetRelativeBound() ;
-                drawer.FillRectRounded(rect, button_color, 5.0f) ;
-                drawer.DrawRectRounded(rect, border_color, 5.0f, 2.0f) ;
-                
-                if (!button.GetLabel().empty()) {
-                    Color text_color = rgba(255, 255, 255, 255) ;
-                    Point text_pos = {
-                        static_cast<int32_t>(rect.w / 2 - 30),
-                        static_cast<int32_t>(rect.h / 2 - 10)
-                    } ;
-                    drawer.DrawString(button.GetLabel(), text_pos, text_color, button.GetFont()) ;
-                }
-
-                drawer.End() ;
-            }) ;
-        }
-
-        bool OnHover(const PointF& mouse_pos) noexcept {
-            bool state = bound_.Contain(mouse_pos) ;
-            if (state != is_hovered_) {
-                is_hovered_ = state ;
-                MarkDirty() ;
-            }
-            return state ;
-        }
-
-        bool OnPress(const PointF& mouse_pos) noexcept {
-            if (bound_.Contain(mouse_pos)) {
-                is_pressed_ = true ;
-                MarkDirty() ;
-                return true ;
-            }
-            return false ;
-        }
-
-        bool OnRelease(const PointF& mouse_pos) noexcept {
-            bool was_pressed = is_pressed_ ;
-            is_pressed_ = false ;
-            if (was_pressed) {
-                MarkDirty() ;
-                if (bound_.Contain(mouse_pos) && on_click_) {
-                    on_click_() ;
-                }
-                return bound_.Contain(mouse_pos) ;
-            }
-            return false ;
-        }
-
-        void PresentImpl(HWND hwnd) noexcept {
-            if (!ValidateCanvas("Button::PresentImpl()")) return ;
-            canvas_->Present(hwnd, {static_cast<int32_t>(bound_.x), static_cast<int32_t>(bound_.y)}) ;
-        }
-
-        void SetDrawer(std::function<void(Canvas*, const Button&)> drawer) noexcept {
-            drawer_ = std::move(drawer) ;
-            MarkDirty() ;
-        }
-        
-        void SetOnClick(std::function<void()> callback) noexcept {
-            on_click_ = std::move(callback) ;
-        }
-        
-        void SetLabel(const std::wstring& label) noexcept {
-            if (label_ != label) {
-                label_ = label ;
-                MarkDirty() ;
-            }
-        }
-
-        RectF GetRelativeBound() const noexcept {
-            return {0, 0, bound_.w, bound_.h} ;
-        }
-
-        const std::wstring& GetLabel() const noexcept { 
-			return label_ ; 
-		}
-
-        const Font& GetFont() const noexcept { 
-			return font_ ; 
-		}
-
-        bool IsHovered() const noexcept { 
-			return is_hovered_ ; 
-		}
-
-        bool IsPressed() const noexcept { 
-			return is_pressed_ ; 
-		}
-    } ;
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+}
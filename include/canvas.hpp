@@ -1,80 +1,143 @@
-<<<<<<< HEAD
 #pragma once
 #include "font.hpp"
+#include "pixel.hpp"
+#include "encoder.hpp"
 
 namespace zketch {
 
+	// pixel memory plus the GDI+ bitmap wrapping it, shared between Canvas copies.
+	struct CanvasStorage {
+		std::unique_ptr<uint8_t[]> pixels_ {} ;
+		std::unique_ptr<Gdiplus::Bitmap> bitmap_ {} ;
+		std::atomic<const void*> writer_ {nullptr} ;	// the Renderer drawing into it, if any
+		uint64_t version_ = NextVersion() ;				// renewed whenever the pixels may change
+
+		static inline std::atomic<uint64_t> g_versions_ {0} ;
+
+		// unique across all storages, a version seen once never comes back with other pixels.
+		static uint64_t NextVersion() noexcept { return g_versions_.fetch_add(1, std::memory_order_relaxed) + 1 ; }
+	} ;
+
+	// every row of a canvas opened for writing at once, see Canvas::GetRows().
+	struct CanvasRows {
+		uint8_t* pixels_ = nullptr ;
+		size_t stride_ = 0 ;
+		uint32_t height_ = 0 ;
+
+		explicit operator bool() const noexcept { return pixels_ != nullptr ; }
+		uint8_t* operator[](uint32_t y) const noexcept { return pixels_ + static_cast<size_t>(y) * stride_ ; }
+	} ;
+
+	// a Canvas object is used by one thread at a time. Copies are separate objects sharing pixels,
+	// they can be read on different threads at once. A canvas bound by a Renderer can't be bound or
+	// read by another one until End().
 	class Canvas {
 		friend class Renderer ;
 		friend class Window ;
 
 	private :
-		std::unique_ptr<Gdiplus::Bitmap> canvas_ {} ;
+		std::shared_ptr<CanvasStorage> storage_ {} ;
+		std::vector<uint8_t> packed_ {} ;
+		Size size_ {} ;
+		uint32_t stride_ = 0 ;
+		ColorFormat format_ = ColorFormat::ARGB ;
+		Point origin_ {} ;
+		bool wrap_ = false ;
 		bool invalidate_ = false ;
 
+		static std::shared_ptr<CanvasStorage> Allocate(const Size& size, uint32_t stride, ColorFormat format) noexcept {
+			try {
+				auto storage = std::make_shared<CanvasStorage>() ;
+				// zeroed storage is already transparent (ARGB / A8) or black (XRGB / RGB565)
+				storage->pixels_ = std::make_unique<uint8_t[]>(static_cast<size_t>(stride) * size.y) ;
+				if (format != ColorFormat::A8) {
+					storage->bitmap_ = std::make_unique<Gdiplus::Bitmap>(size.x, size.y, stride, ToGdiFormat(format), storage->pixels_.get()) ;
+				}
+				return storage ;
+			} catch (...) {
+				return nullptr ;
+			}
+		}
+
+		static constexpr int32_t ToGdiFormat(ColorFormat format) noexcept {
+			switch (format) {
+				case ColorFormat::ARGB : return PixelFormat32bppARGB ;
+				case ColorFormat::XRGB : return PixelFormat32bppRGB ;
+				case ColorFormat::RGB565 : return PixelFormat16bppRGB565 ;
+				case ColorFormat::A8 : return 0 ; // GDI+ can't target 8bpp coverage, Renderer draws it through a scratch bitmap
+			}
+			return PixelFormat32bppARGB ;
+		}
+
 	public :
-		Canvas(const Canvas&) = delete ;
-		Canvas& operator=(const Canvas&) = delete ;
+		// copies share the pixels until one of them is written, see Detach().
+		Canvas(const Canvas&) = default ;
+		Canvas& operator=(const Canvas&) = default ;
 		Canvas(Canvas&&) = default ;
 		Canvas& operator=(Canvas&&) = default ;
 		Canvas() = default ;
 		~Canvas() = default ;
 
-		bool Create(const Size& size) noexcept {
+		bool Create(const Size& size, ColorFormat format = ColorFormat::ARGB) noexcept {
 			Clear() ;
 
 			#ifdef CANVAS_DEBUG
-				logger::info("Canvas::Create - Creating GDI+ bitmap: ", size.x, " x ", size.y, '.') ;
+				logger::info("Canvas::Create - Creating bitmap: ", size.x, " x ", size.y, ", format : ", static_cast<int32_t>(format), '.') ;
 			#endif
 
-			try {
-				canvas_ = std::make_unique<Gdiplus::Bitmap>(size.x, size.y, PixelFormat32bppARGB) ;
-			} catch (...) {
-				canvas_.reset() ;
+			if (size.x == 0 || size.y == 0) {
 
 				#ifdef CANVAS_DEBUG
-					logger::error("Canvas::Create - Exception while creating bitmap.") ;
+					logger::error("Canvas::Create - Invalid size.") ;
 				#endif
 
 				return false ;
 			}
 
-			if (!canvas_) {
+			const uint32_t stride = StrideOf(format, size.x) ;
+
+			auto storage = Allocate(size, stride, format) ;
+			if (!storage) {
 
 				#ifdef CANVAS_DEBUG
-					logger::error("Canvas::Create - Failed to allocate bitmap.") ;
+					logger::error("Canvas::Create - Exception while creating bitmap.") ;
 				#endif
 
 				return false ;
 			}
 
-			Gdiplus::Status status = canvas_->GetLastStatus() ;
-
-			#ifdef CANVAS_DEBUG
-				logger::info("Canvas::Create - Buffer status: ", static_cast<int32_t>(status)) ;
-			#endif
-
-			if (status != Gdiplus::Ok) {
-				canvas_.reset() ;
+			if (storage->bitmap_) {
+				Gdiplus::Status status = storage->bitmap_->GetLastStatus() ;
 
 				#ifdef CANVAS_DEBUG
-					logger::error("Canvas::Create - Failed to create buffer, status: ", static_cast<int32_t>(status)) ;
+					logger::info("Canvas::Create - Buffer status: ", static_cast<int32_t>(status)) ;
 				#endif
 
-				return false ;
-			}
+				if (status != Gdiplus::Ok) {
+
+					#ifdef CANVAS_DEBUG
+						logger::error("Canvas::Create - Failed to create buffer, status: ", static_cast<int32_t>(status)) ;
+					#endif
 
-			{
-				Gdiplus::Graphics gfx_front(canvas_.get()) ;
-				gfx_front.Clear(Transparent) ;
+					return false ;
+				}
 			}
 
+			storage_ = std::move(storage) ;
+			size_ = size ;
+			stride_ = stride ;
+			format_ = format ;
+			origin_ = {} ;
 			invalidate_ = true ;
 			return true ;
 		}
 
 		void Clear() noexcept {
-			canvas_.reset() ;
+			storage_.reset() ;
+			packed_ = {} ;
+			origin_ = {} ;
+			size_ = {} ;
+			stride_ = 0 ;
 			invalidate_ = false ;
 
 			#ifdef CANVAS_DEBUG
@@ -82,193 +145,394 @@ namespace zketch {
 			#endif
 		}
 
-		bool IsValid() const noexcept { return canvas_ != nullptr ; }
-		bool Invalidate() const noexcept { return invalidate_ ; }
-		void MarkInvalidate() noexcept { invalidate_ = true ; }
-		void MarkValidate() noexcept { invalidate_ = false ; }
+		// converts the pixels into another format, the canvas keeps its size.
+		bool Convert(ColorFormat format) noexcept {
+			if (!IsValid() || format == format_) {
+				return IsValid() ;
+			}
 
-		Gdiplus::Bitmap* GetBitmap() const noexcept { return canvas_.get() ; }
-		uint32_t GetWidth() const noexcept { return canvas_->GetWidth() ; }
-		uint32_t GetHeight() const noexcept { return canvas_->GetHeight() ; }
-		Size GetSize() const noexcept { return {GetWidth(), GetHeight()} ; }
-	} ;
-=======
-#pragma once 
-#include "font.hpp"
+			Canvas converted ;
+			if (!converted.Create(size_, format)) {
+				return false ;
+			}
 
-namespace zketch {
-	class Canvas {
-		friend class Drawer ;
-
-	private:
-		std::unique_ptr<Gdiplus::Bitmap> front_{} ;
-		std::unique_ptr<Gdiplus::Bitmap> back_{} ;
-		Size size_{} ;
-		bool dirty_ = false ;
-		Color clear_color_ = rgba(0, 0, 0, 0); // Default transparent
-
-	public:
-		Canvas(const Canvas&) = delete ;
-		Canvas& operator=(const Canvas&) = delete ;
-		Canvas() = default ;
-		Canvas(Canvas&&) = default ;
-		Canvas& operator=(Canvas&&) = default ;
-		~Canvas() = default ;
+			pixel::ConvertRect(GetPixels(), stride_, format_, converted.GetPixels(), converted.stride_, format, size_.x, size_.y) ;
+			*this = std::move(converted) ;
+			return true ;
+		}
 
-		bool Create(const Size& size) noexcept {
-			Clear() ;
+		// gives this canvas its own copy of shared pixels, every writer goes through here first.
+		bool Detach() noexcept {
+			if (!storage_ || storage_.use_count() == 1) {
+				// the last other owner (a recorder or present thread) may have just let go, its
+				// reads have to be done before this thread writes
+				std::atomic_thread_fence(std::memory_order_acquire) ;
+				return true ;
+			}
+
+			auto storage = Allocate(size_, stride_, format_) ;
+			if (!storage) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::Detach - Failed to copy shared storage.") ;
+				#endif
 
-			logger::info("Creating GDI+ bitmap: ", size.x, " x ", size.y) ;
-			try {
-				front_ = std::make_unique<Gdiplus::Bitmap>(size.x, size.y, PixelFormat32bppARGB) ;
-				back_ = std::make_unique<Gdiplus::Bitmap>(size.x, size.y, PixelFormat32bppARGB) ;
-			} catch (...) {
-				front_.reset() ;
-				back_.reset() ;
-				logger::error("Exception while creating bitmap.") ;
 				return false ;
 			}
 
-			if (!front_ || !back_) {
-				logger::error("Failed to allocate bitmap.") ;
-				return false ;
+			memcpy(storage->pixels_.get(), storage_->pixels_.get(), GetByteSize()) ;
+			storage_ = std::move(storage) ;
+			return true ;
+		}
+
+		// ring buffer mode, the storage is addressed modulo its size from a movable origin so Scroll()
+		// moves the origin instead of the pixels. Renderer and DrawCanvas work in logical coordinates.
+		void SetWrap(bool wrap) noexcept {
+			if (!wrap) {
+				Unwrap() ;
 			}
+			wrap_ = wrap ;
+		}
 
-			Gdiplus::Status fst = front_->GetLastStatus() ;
-			Gdiplus::Status bst = back_->GetLastStatus() ;
-			logger::info("front buffer status: ", static_cast<int32_t>(fst)) ;
-			logger::info("back buffer status: ", static_cast<int32_t>(bst)) ;
-			if (fst != Gdiplus::Ok || bst != Gdiplus::Ok) {
-				front_.reset() ;
-				back_.reset() ;
-				logger::error("Failed to create front buffer, status: ", static_cast<int32_t>(fst)) ;
-				logger::error("Failed to create back buffer, status: ", static_cast<int32_t>(bst)) ;
-				return false ;
+		// moves the view by (dx, dy) and returns the exposed strips (logical coordinates) that have to
+		// be drawn again, everything else keeps its pixels.
+		std::array<Rect, 2> Scroll(int32_t dx, int32_t dy) noexcept {
+			std::array<Rect, 2> exposed {} ;
+			if (!IsValid() || !wrap_) {
+
+				#ifdef CANVAS_DEBUG
+					logger::warning("Canvas::Scroll - Canvas isn't in wrap mode.") ;
+				#endif
+
+				return exposed ;
 			}
 
-			// Clear both buffers initially
-			{
-				Gdiplus::Graphics gfx_front(front_.get()) ;
-				Gdiplus::Graphics gfx_back(back_.get()) ;
-				gfx_front.Clear(Gdiplus::Color(0, 0, 0, 0)) ;
-				gfx_back.Clear(Gdiplus::Color(0, 0, 0, 0)) ;
+			const int32_t w = static_cast<int32_t>(size_.x) ;
+			const int32_t h = static_cast<int32_t>(size_.y) ;
+			dx = std::clamp(dx, -w, w) ;
+			dy = std::clamp(dy, -h, h) ;
+			origin_.x = ((origin_.x + dx) % w + w) % w ;
+			origin_.y = ((origin_.y + dy) % h + h) % h ;
+
+			if (dx > 0) {
+				exposed[0] = {w - dx, 0, dx, h} ;
+			} else if (dx < 0) {
+				exposed[0] = {0, 0, -dx, h} ;
 			}
 
-			size_ = size ;
-			dirty_ = true ;
-			return true ;
-		}
+			if (dy > 0) {
+				exposed[1] = {0, h - dy, w, dy} ;
+			} else if (dy < 0) {
+				exposed[1] = {0, 0, w, -dy} ;
+			}
 
-		void Clear() noexcept {
-			front_.reset() ;
-			back_.reset() ;
-			size_ = {} ;
-			dirty_ = false ;
-			logger::info("Canvas cleared.") ;
+			invalidate_ = true ;
+			return exposed ;
 		}
 
-		void SetClearColor(const Color& color) noexcept {
-			clear_color_ = color;
-		}
+		// rotates the storage back so the origin is (0, 0), GetView() then sees logical order.
+		bool Unwrap() noexcept {
+			if (!IsValid() || (origin_.x == 0 && origin_.y == 0)) {
+				return IsValid() ;
+			}
+
+			auto storage = Allocate(size_, stride_, format_) ;
+			if (!storage) {
+				return false ;
+			}
 
-		const Color& GetClearColor() const noexcept {
-			return clear_color_;
+			const uint32_t bpp = BytesPerPixel(format_) ;
+			const size_t head = static_cast<size_t>(size_.x - origin_.x) * bpp ;
+			const size_t tail = static_cast<size_t>(origin_.x) * bpp ;
+			for (uint32_t y = 0 ; y < size_.y ; ++y) {
+				const uint8_t* src = storage_->pixels_.get() + static_cast<size_t>((y + origin_.y) % size_.y) * stride_ ;
+				uint8_t* dst = storage->pixels_.get() + static_cast<size_t>(y) * stride_ ;
+				memcpy(dst, src + tail, head) ;
+				memcpy(dst + head, src, tail) ;
+			}
+
+			storage_ = std::move(storage) ;
+			origin_ = {} ;
+			invalidate_ = true ;
+			return true ;
 		}
 
-		void Present(HWND hwnd) noexcept {
-			if (!front_) {
-				logger::warning("Canvas::Present - No bitmap.") ;
+		// splits a logical rect into the (up to four) storage rects it covers. fn(piece, offset) gets the
+		// piece in storage coordinates and the offset that takes logical coordinates into it.
+		template <typename F>
+		void ForEachWrapPiece(const Rect& logical, F&& fn) const noexcept {
+			const int32_t w = static_cast<int32_t>(size_.x) ;
+			const int32_t h = static_cast<int32_t>(size_.y) ;
+			const int32_t lx0 = std::max(logical.x, 0) ;
+			const int32_t ly0 = std::max(logical.y, 0) ;
+			const int32_t lx1 = std::min(logical.x + static_cast<int32_t>(logical.w), w) ;
+			const int32_t ly1 = std::min(logical.y + static_cast<int32_t>(logical.h), h) ;
+			if (lx0 >= lx1 || ly0 >= ly1) {
 				return ;
 			}
 
-			if (!hwnd) {
-				logger::warning("Canvas::Present - hwnd is null.") ;
-				return ;
+			// logical x below split_x lands at x + origin, the rest wraps around to x + origin - w
+			const int32_t split_x = wrap_ ? w - origin_.x : w ;
+			const int32_t split_y = wrap_ ? h - origin_.y : h ;
+			const int32_t ox = wrap_ ? origin_.x : 0 ;
+			const int32_t oy = wrap_ ? origin_.y : 0 ;
+
+			for (int32_t j = 0 ; j < 2 ; ++j) {
+				const int32_t y0 = std::max(ly0, j == 0 ? 0 : split_y) ;
+				const int32_t y1 = std::min(ly1, j == 0 ? split_y : h) ;
+				if (y0 >= y1) {
+					continue ;
+				}
+
+				for (int32_t i = 0 ; i < 2 ; ++i) {
+					const int32_t x0 = std::max(lx0, i == 0 ? 0 : split_x) ;
+					const int32_t x1 = std::min(lx1, i == 0 ? split_x : w) ;
+					if (x0 >= x1) {
+						continue ;
+					}
+
+					const Point offset {i == 0 ? ox : ox - w, j == 0 ? oy : oy - h} ;
+					fn(Rect{x0 + offset.x, y0 + offset.y, x1 - x0, y1 - y0}, offset) ;
+				}
 			}
+		}
 
-			HDC hdc = GetDC(hwnd) ;
-			if (!hdc) {
-				logger::warning("Canvas::Present - GetDC failed.") ;
-				return ;
+		bool IsWrapped() const noexcept { return wrap_ ; }
+		Point GetOrigin() const noexcept { return origin_ ; }
+
+		// drops the pixels but remembers size and format, Restore() brings back a blank canvas.
+		void Release() noexcept {
+			storage_.reset() ;
+			packed_ = {} ;
+		}
+
+		// keeps the pixels compressed in memory (QOI for 32bpp, RLE otherwise) and drops the bitmap.
+		bool Compress() noexcept {
+			if (!IsValid()) {
+				return false ;
 			}
 
-			Gdiplus::Graphics screen(hdc) ;
-			screen.SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
-			screen.SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
-			screen.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor) ;
-			screen.DrawImage(front_.get(), 0, 0) ;
+			const size_t bytes = GetByteSize() ;
+			const uint8_t* src = storage_->pixels_.get() ;
+
+			try {
+				std::vector<uint8_t> packed ;
+				if (BytesPerPixel(format_) == 4) {
+					packed.resize(bytes / 4 * 5 + 1) ;
+					codec::QoiState qoi ;
+					uint8_t* end = qoi.Encode(reinterpret_cast<const uint32_t*>(src), bytes / 4, packed.data()) ;
+					end = qoi.Finish(end) ;
+					packed.resize(static_cast<size_t>(end - packed.data())) ;
+				} else {
+					packed.resize(bytes + bytes / 128 + 1) ;
+					uint8_t* end = codec::RleEncode(src, bytes, packed.data()) ;
+					packed.resize(static_cast<size_t>(end - packed.data())) ;
+				}
+
+				packed.shrink_to_fit() ;
+				packed_ = std::move(packed) ;
+			} catch (...) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::Compress - Failed to allocate compression buffer.") ;
+				#endif
+
+				return false ;
+			}
 
-			ReleaseDC(hwnd, hdc) ;
+			storage_.reset() ;
+			return true ;
 		}
 
-		void Present(HWND hwnd, const Point& pos) const noexcept {
-			if (!front_) {
-				logger::warning("Canvas::Present - No bitmap.") ;
-				return ;
+		// brings pixels back after Compress() or Release(), released canvases come back blank.
+		bool Restore() noexcept {
+			if (IsValid()) {
+				return true ;
 			}
 
-			if (!hwnd) {
-				logger::warning("Canvas::Present - hwnd is null.") ;
-				return ;
+			if (size_.x == 0 || size_.y == 0) {
+				return false ;
 			}
 
-			HDC hdc = GetDC(hwnd) ;
-			if (!hdc) {
-				logger::warning("Canvas::Present - invalid HDC.") ;
-				return ;
+			auto storage = Allocate(size_, stride_, format_) ;
+			if (!storage) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::Restore - Failed to allocate storage.") ;
+				#endif
+
+				return false ;
 			}
 
-			Gdiplus::Graphics screen(hdc) ;
-			screen.SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
-			screen.SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
-			screen.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor) ;
-			screen.DrawImage(front_.get(), pos.x, pos.y) ;
+			if (!packed_.empty()) {
+				const size_t bytes = GetByteSize() ;
+				bool ok = false ;
+				if (BytesPerPixel(format_) == 4) {
+					codec::QoiState qoi ;
+					ok = qoi.Decode(packed_.data(), packed_.data() + packed_.size(), reinterpret_cast<uint32_t*>(storage->pixels_.get()), bytes / 4) != nullptr ;
+				} else {
+					ok = codec::RleDecode(packed_.data(), packed_.size(), storage->pixels_.get(), bytes) ;
+				}
 
-			ReleaseDC(hwnd, hdc) ;
-		}
+				if (!ok) {
 
-		Gdiplus::Bitmap* GetBitmap() const noexcept { 
-			return front_.get() ; 
-		}
+					#ifdef CANVAS_DEBUG
+						logger::error("Canvas::Restore - Compressed pixels are corrupt.") ;
+					#endif
 
-		Gdiplus::Bitmap* GetBackBuffer() const noexcept { 
-			return back_.get() ; 
-		}
+					return false ;
+				}
+
+				packed_ = {} ;
+			}
 
-		int32_t GetWidth() const noexcept { 
-			return size_.x ; 
+			storage_ = std::move(storage) ;
+			invalidate_ = true ;
+			return true ;
 		}
 
-		int32_t GetHeight() const noexcept { 
-			return size_.y ; 
+		bool IsCompressed() const noexcept { return !storage_ && !packed_.empty() ; }
+		bool IsReleased() const noexcept { return !storage_ && packed_.empty() && size_.x != 0 && size_.y != 0 ; }
+		size_t GetCompressedSize() const noexcept { return packed_.size() ; }
+
+		// true when both canvases read the same pixels.
+		bool IsSharedWith(const Canvas& o) const noexcept { return storage_ && storage_ == o.storage_ ; }
+		bool IsShared() const noexcept { return storage_ && storage_.use_count() > 1 ; }
+		long GetShareCount() const noexcept { return storage_.use_count() ; }
+
+		// changes whenever the pixels may have been written, equal versions mean equal pixels.
+		uint64_t GetVersion() const noexcept { return storage_ ? storage_->version_ : 0 ; }
+
+		bool IsValid() const noexcept { return storage_ != nullptr ; }
+		bool Invalidate() const noexcept { return invalidate_ ; }
+		void MarkInvalidate() noexcept { invalidate_ = true ; }
+		void MarkValidate() noexcept { invalidate_ = false ; }
+
+		// null for ColorFormat::A8, GDI+ has no 8bpp coverage format. The bitmap may be shared,
+		// Detach() before drawing into it.
+		Gdiplus::Bitmap* GetBitmap() const noexcept { return storage_ ? storage_->bitmap_.get() : nullptr ; }
+		uint8_t* GetPixels() noexcept {
+			if (!storage_ || !Detach()) {
+				return nullptr ;
+			}
+			storage_->version_ = CanvasStorage::NextVersion() ;
+			return storage_->pixels_.get() ;
 		}
 
-		const Size& GetSize() const noexcept { 
-			return size_ ; 
+		const uint8_t* GetPixels() const noexcept { return storage_ ? storage_->pixels_.get() : nullptr ; }
+
+		// a Detach() and a new version per call, loops over rows take GetRows() once instead.
+		uint8_t* GetRow(uint32_t y) noexcept { return GetPixels() + static_cast<size_t>(y) * stride_ ; }
+
+		// every row for one Detach() and one new version. The rows stay this canvas's own only until
+		// a copy of it is made, writes after that need GetRows() again. Empty when memory ran out.
+		CanvasRows GetRows() noexcept {
+			uint8_t* pixels = GetPixels() ;
+			return {pixels, stride_, pixels ? size_.y : 0} ;
 		}
 
-		bool IsValid() const noexcept { 
-			return front_ != nullptr && back_ != nullptr ; 
+		const uint8_t* GetRow(uint32_t y) const noexcept { return GetPixels() + static_cast<size_t>(y) * stride_ ; }
+		uint32_t GetStride() const noexcept { return stride_ ; }
+		ColorFormat GetFormat() const noexcept { return format_ ; }
+		size_t GetByteSize() const noexcept { return static_cast<size_t>(stride_) * size_.y ; }
+		uint32_t GetWidth() const noexcept { return size_.x ; }
+		uint32_t GetHeight() const noexcept { return size_.y ; }
+		Size GetSize() const noexcept { return size_ ; }
+
+		// the storage as it is, so empty for a wrapped canvas scrolled away from its origin: Snapshot()
+		// or Unwrap() first. Pixels are only settled outside Renderer::Begin / End.
+		ImageView GetView() const noexcept {
+			if (origin_.x != 0 || origin_.y != 0) {
+				return {} ;
+			}
+			return {GetPixels(), size_.x, size_.y, stride_, format_} ;
 		}
 
-		bool NeedRedraw() const noexcept { 
-			return dirty_ ; 
+		// an owning copy in logical order, invalid when the canvas is or memory ran out.
+		ImageBuffer Snapshot() const noexcept {
+			if (!IsValid()) {
+				return {} ;
+			}
+
+			if (origin_.x == 0 && origin_.y == 0) {
+				return ImageBuffer(GetView()) ;
+			}
+
+			ImageBuffer copy(size_.x, size_.y, stride_, format_) ;
+			if (!copy.IsValid()) {
+				return copy ;
+			}
+
+			const uint32_t bpp = BytesPerPixel(format_) ;
+			ForEachWrapPiece({0, 0, size_.x, size_.y}, [&](const Rect& piece, const Point& offset) {
+				for (uint32_t y = 0 ; y < piece.h ; ++y) {
+					const uint8_t* src = GetRow(static_cast<uint32_t>(piece.y) + y) + static_cast<size_t>(piece.x) * bpp ;
+					memcpy(copy.GetRow(static_cast<uint32_t>(piece.y - offset.y) + y) + static_cast<size_t>(piece.x - offset.x) * bpp, src, static_cast<size_t>(piece.w) * bpp) ;
+				}
+			}) ;
+			return copy ;
 		}
 
-		void SwapBuffers() noexcept {
-			if (front_ && back_) {
-				std::swap(front_, back_) ;
-				dirty_ = false ;
+		bool Encode(ImageWriter& out, ImageFormat format = ImageFormat::PNG) const noexcept {
+			if (!IsValid()) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::Encode - Canvas is invalid.") ;
+				#endif
+
+				return false ;
+			}
+
+			if (origin_.x != 0 || origin_.y != 0) {
+				const ImageBuffer logical = Snapshot() ;
+				return logical.IsValid() && EncodeImage(logical.GetView(), out, format) ;
 			}
+			return EncodeImage(GetView(), out, format) ;
 		}
 
-		void MarkDirty() noexcept { 
-			dirty_ = true ; 
+		bool Encode(const std::string& path, ImageFormat format = ImageFormat::PNG) const noexcept {
+			FileWriter file(path) ;
+			if (!file.IsOpen()) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::Encode - Failed to open ", path, '.') ;
+				#endif
+
+				return false ;
+			}
+
+			return Encode(file, format) ;
 		}
 
-		void MarkClean() noexcept {
-			dirty_ = false ;
+		// copies the pixels and encodes the copy on a worker thread, the canvas can be redrawn right away.
+		// done gets the result of the encode. False, done untouched, when the copy or the thread
+		// couldn't be made.
+		bool EncodeAsync(const std::string& path, std::future<bool>& done, ImageFormat format = ImageFormat::PNG) const noexcept {
+			ImageBuffer snapshot = Snapshot() ;
+			if (!snapshot.IsValid()) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::EncodeAsync - Failed to copy the canvas.") ;
+				#endif
+
+				return false ;
+			}
+
+			try {
+				done = std::async(std::launch::async, [snapshot = std::move(snapshot), path, format]() noexcept {
+					FileWriter file(path) ;
+					return file.IsOpen() && EncodeImage(snapshot.GetView(), file, format) ;
+				}) ;
+			} catch (...) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("Canvas::EncodeAsync - Failed to start encoder thread.") ;
+				#endif
+
+				return false ;
+			}
+			return true ;
 		}
 	} ;
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+
+}
@@ -0,0 +1,395 @@
+#pragma once
+#include "encoder.hpp"
+
+namespace zketch {
+
+	namespace codec {
+
+		// ------------------------------ word runs ------------------------------
+
+		inline uint8_t* PutVarint(uint8_t* out, uint64_t v) noexcept {
+			while (v >= 0x80) {
+				*out++ = static_cast<uint8_t>(v | 0x80) ;
+				v >>= 7 ;
+			}
+			*out++ = static_cast<uint8_t>(v) ;
+			return out ;
+		}
+
+		inline const uint8_t* GetVarint(const uint8_t* in, const uint8_t* end, uint64_t& v) noexcept {
+			v = 0 ;
+			for (uint32_t shift = 0 ; in < end && shift < 64 ; shift += 7) {
+				const uint8_t b = *in++ ;
+				v |= static_cast<uint64_t>(b & 0x7F) << shift ;
+				if (!(b & 0x80)) {
+					return in ;
+				}
+			}
+			return nullptr ;
+		}
+
+		// worst case output of WordRunEncode for count words.
+		constexpr size_t WordRunBound(size_t count) noexcept { return count * 4 + (count / 2 + 1) * 10 ; }
+
+		// a token is a varint n: even n repeats the following word n / 2 times, odd n is followed by
+		// n / 2 literal words. XORed frame deltas are mostly long runs of zero words.
+		inline uint8_t* WordRunEncode(const uint32_t* in, size_t count, uint8_t* out) noexcept {
+			size_t i = 0 ;
+			while (i < count) {
+				size_t run = 1 ;
+				while (i + run < count && in[i + run] == in[i]) {
+					++run ;
+				}
+
+				if (run >= 2) {
+					out = PutVarint(out, static_cast<uint64_t>(run) << 1) ;
+					memcpy(out, in + i, 4) ;
+					out += 4 ;
+					i += run ;
+					continue ;
+				}
+
+				const size_t start = i++ ;
+				while (i < count && !(i + 1 < count && in[i] == in[i + 1])) {
+					++i ;
+				}
+
+				out = PutVarint(out, (static_cast<uint64_t>(i - start) << 1) | 1) ;
+				memcpy(out, in + start, (i - start) * 4) ;
+				out += (i - start) * 4 ;
+			}
+			return out ;
+		}
+
+		inline bool WordRunDecode(const uint8_t* in, size_t size, uint32_t* out, size_t count) noexcept {
+			const uint8_t* end = in + size ;
+			size_t o = 0 ;
+			while (in < end) {
+				uint64_t token = 0 ;
+				in = GetVarint(in, end, token) ;
+				const uint64_t n = token >> 1 ;
+				if (!in || n > count - o) {
+					return false ;
+				}
+
+				if (token & 1) {
+					if (static_cast<uint64_t>(end - in) < n * 4) {
+						return false ;
+					}
+					memcpy(out + o, in, n * 4) ;
+					in += n * 4 ;
+				} else {
+					if (end - in < 4) {
+						return false ;
+					}
+					uint32_t word ;
+					memcpy(&word, in, 4) ;
+					in += 4 ;
+					std::fill_n(out + o, n, word) ;
+				}
+				o += n ;
+			}
+			return o == count ;
+		}
+
+		// dst ^= src, a word at a time.
+		inline void XorBytes(uint8_t* dst, const uint8_t* src, size_t size) noexcept {
+			size_t i = 0 ;
+			for (; i + 8 <= size ; i += 8) {
+				uint64_t a, b ;
+				memcpy(&a, dst + i, 8) ;
+				memcpy(&b, src + i, 8) ;
+				a ^= b ;
+				memcpy(dst + i, &a, 8) ;
+			}
+			for (; i < size ; ++i) {
+				dst[i] ^= src[i] ;
+			}
+		}
+
+		// out = cur ^ prev, then prev = cur. One pass over both frames for the recorder.
+		inline void XorDelta(uint8_t* out, uint8_t* prev, const uint8_t* cur, size_t size) noexcept {
+			size_t i = 0 ;
+			for (; i + 8 <= size ; i += 8) {
+				uint64_t a, b ;
+				memcpy(&a, cur + i, 8) ;
+				memcpy(&b, prev + i, 8) ;
+				memcpy(prev + i, &a, 8) ;
+				a ^= b ;
+				memcpy(out + i, &a, 8) ;
+			}
+			for (; i < size ; ++i) {
+				out[i] = cur[i] ^ prev[i] ;
+				prev[i] = cur[i] ;
+			}
+		}
+
+		inline void PutU32LE(uint8_t* out, uint32_t v) noexcept {
+			out[0] = static_cast<uint8_t>(v) ;
+			out[1] = static_cast<uint8_t>(v >> 8) ;
+			out[2] = static_cast<uint8_t>(v >> 16) ;
+			out[3] = static_cast<uint8_t>(v >> 24) ;
+		}
+
+		inline void PutU64LE(uint8_t* out, uint64_t v) noexcept {
+			PutU32LE(out, static_cast<uint32_t>(v)) ;
+			PutU32LE(out + 4, static_cast<uint32_t>(v >> 32)) ;
+		}
+
+		inline uint32_t GetU32LE(const uint8_t* in) noexcept {
+			return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 | static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24 ;
+		}
+
+		inline uint64_t GetU64LE(const uint8_t* in) noexcept {
+			return static_cast<uint64_t>(GetU32LE(in)) | static_cast<uint64_t>(GetU32LE(in + 4)) << 32 ;
+		}
+	}
+
+	// ------------------------------ capture file ------------------------------
+	//
+	// header		"ZKCAPTUR" u32 version, u32 frame count, u32 key frame interval, u32 reserved, u64 index offset
+	// frame		u32 width, u32 height, u8 format, u8 flags, u16 rect count, u32 payload size, u64 timestamp ns,
+	//				rect count * (i32 x, i32 y, u32 w, u32 h), payload
+	// index		frame count * (u64 offset, u64 timestamp ns, u32 flags, u32 reserved)
+	//
+	// all little endian. A frame stores its rects XORed with the previous frame, rows padded to 4 bytes
+	// and packed back to back, word run encoded. Key frames are XORed against black, decoding can
+	// start at any of them. A file that was never closed has no index, readers rebuild it by scanning.
+
+	struct CaptureRect {
+		int32_t x = 0 ;
+		int32_t y = 0 ;
+		uint32_t w = 0 ;
+		uint32_t h = 0 ;
+	} ;
+
+	struct CaptureFile {
+		static constexpr char ___MAGIC___[8] = {'Z', 'K', 'C', 'A', 'P', 'T', 'U', 'R'} ;
+		static constexpr uint32_t ___VERSION___ = 1 ;
+		static constexpr size_t ___HEADER_SIZE___ = 32 ;
+		static constexpr size_t ___FRAME_SIZE___ = 24 ;
+		static constexpr size_t ___RECT_SIZE___ = 16 ;
+		static constexpr size_t ___INDEX_SIZE___ = 24 ;
+		static constexpr uint8_t ___KEY_FRAME___ = 1 ;
+
+		struct Entry {
+			uint64_t offset_ = 0 ;
+			uint64_t timestamp_ = 0 ;	// ns since recording started
+			uint32_t flags_ = 0 ;
+
+			bool IsKeyFrame() const noexcept { return flags_ & ___KEY_FRAME___ ; }
+		} ;
+
+		// row bytes of a rect inside the payload.
+		static constexpr size_t PaddedRow(uint32_t width, ColorFormat format) noexcept { return (static_cast<size_t>(width) * BytesPerPixel(format) + 3) & ~static_cast<size_t>(3) ; }
+	} ;
+
+	// reads capture files, any frame can be reached through Seek, which decodes forward from the
+	// nearest key frame. Needs nothing but the file, a dumper builds on it without a window system.
+	class CaptureReader {
+	private :
+		std::ifstream file_ ;
+		std::vector<CaptureFile::Entry> index_ ;
+		std::vector<uint8_t> frame_ ;		// decoded pixels, rows padded to 4 bytes
+		std::vector<uint8_t> payload_ ;
+		std::vector<uint32_t> words_ ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		ColorFormat format_ = ColorFormat::ARGB ;
+		uint32_t key_interval_ = 0 ;
+		size_t position_ = 0 ;				// frame held in frame_, index_.size() when none
+		uint64_t end_ = 0 ;					// first byte past the last frame record
+
+		bool ReadAt(uint64_t offset, void* data, size_t size) noexcept {
+			file_.clear() ;
+			file_.seekg(static_cast<std::streamoff>(offset)) ;
+			file_.read(static_cast<char*>(data), static_cast<std::streamsize>(size)) ;
+			return static_cast<bool>(file_) ;
+		}
+
+		// a file without index (recorder never closed) is walked frame by frame.
+		bool ScanIndex(uint64_t offset) noexcept {
+			uint8_t head[CaptureFile::___FRAME_SIZE___] ;
+			while (ReadAt(offset, head, sizeof(head))) {
+				CaptureFile::Entry entry ;
+				entry.offset_ = offset ;
+				entry.flags_ = head[9] ;
+				entry.timestamp_ = codec::GetU64LE(head + 16) ;
+
+				const uint16_t rects = static_cast<uint16_t>(head[10] | head[11] << 8) ;
+				offset += sizeof(head) + static_cast<uint64_t>(rects) * CaptureFile::___RECT_SIZE___ + codec::GetU32LE(head + 12) ;
+
+				// a record cut short by a crash ends the recording
+				file_.clear() ;
+				file_.seekg(0, std::ios::end) ;
+				if (static_cast<uint64_t>(file_.tellg()) < offset) {
+					break ;
+				}
+
+				try {
+					index_.push_back(entry) ;
+				} catch (...) {
+					return false ;
+				}
+				end_ = offset ;
+			}
+			return true ;
+		}
+
+		bool Decode(size_t frame) noexcept {
+			uint8_t head[CaptureFile::___FRAME_SIZE___] ;
+			if (!ReadAt(index_[frame].offset_, head, sizeof(head))) {
+				return false ;
+			}
+
+			const uint32_t width = codec::GetU32LE(head) ;
+			const uint32_t height = codec::GetU32LE(head + 4) ;
+			const ColorFormat format = static_cast<ColorFormat>(head[8]) ;
+			const bool key = head[9] & CaptureFile::___KEY_FRAME___ ;
+			const uint16_t count = static_cast<uint16_t>(head[10] | head[11] << 8) ;
+			const uint32_t payload = codec::GetU32LE(head + 12) ;
+
+			try {
+				if (key) {
+					width_ = width ;
+					height_ = height ;
+					format_ = format ;
+					frame_.assign(CaptureFile::PaddedRow(width_, format_) * height_, 0) ;
+				} else if (width != width_ || height != height_ || format != format_) {
+					return false ;
+				}
+
+				std::vector<CaptureRect> rects(count) ;
+				std::vector<uint8_t> raw(static_cast<size_t>(count) * CaptureFile::___RECT_SIZE___) ;
+				payload_.resize(payload) ;
+				if (!file_.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size())) || !file_.read(reinterpret_cast<char*>(payload_.data()), payload)) {
+					return false ;
+				}
+
+				size_t words = 0 ;
+				for (size_t i = 0 ; i < count ; ++i) {
+					const uint8_t* r = raw.data() + i * CaptureFile::___RECT_SIZE___ ;
+					rects[i] = {static_cast<int32_t>(codec::GetU32LE(r)), static_cast<int32_t>(codec::GetU32LE(r + 4)), codec::GetU32LE(r + 8), codec::GetU32LE(r + 12)} ;
+					if (rects[i].x < 0 || rects[i].y < 0 || rects[i].x + static_cast<uint64_t>(rects[i].w) > width_ || rects[i].y + static_cast<uint64_t>(rects[i].h) > height_) {
+						return false ;
+					}
+					words += CaptureFile::PaddedRow(rects[i].w, format_) / 4 * rects[i].h ;
+				}
+
+				words_.resize(words) ;
+				if (!codec::WordRunDecode(payload_.data(), payload_.size(), words_.data(), words)) {
+					return false ;
+				}
+
+				const size_t stride = CaptureFile::PaddedRow(width_, format_) ;
+				const uint32_t bpp = BytesPerPixel(format_) ;
+				const uint8_t* delta = reinterpret_cast<const uint8_t*>(words_.data()) ;
+				for (const CaptureRect& r : rects) {
+					const size_t bytes = static_cast<size_t>(r.w) * bpp ;
+					for (uint32_t y = 0 ; y < r.h ; ++y) {
+						codec::XorBytes(frame_.data() + (r.y + y) * stride + r.x * bpp, delta, bytes) ;
+						delta += CaptureFile::PaddedRow(r.w, format_) ;
+					}
+				}
+			} catch (...) {
+				return false ;
+			}
+
+			position_ = frame ;
+			return true ;
+		}
+
+	public :
+		CaptureReader() noexcept = default ;
+
+		bool Open(const std::string& path) noexcept {
+			file_ = std::ifstream(path, std::ios::binary) ;
+			index_.clear() ;
+			frame_.clear() ;
+			position_ = 0 ;
+
+			uint8_t head[CaptureFile::___HEADER_SIZE___] ;
+			if (!file_ || !ReadAt(0, head, sizeof(head)) || memcmp(head, CaptureFile::___MAGIC___, 8) != 0 || codec::GetU32LE(head + 8) != CaptureFile::___VERSION___) {
+
+				#ifdef CAPTURE_DEBUG
+					logger::error("CaptureReader::Open - ", path, " isn't a capture file.") ;
+				#endif
+
+				return false ;
+			}
+
+			const uint32_t frames = codec::GetU32LE(head + 12) ;
+			const uint64_t index = codec::GetU64LE(head + 24) ;
+			key_interval_ = codec::GetU32LE(head + 16) ;
+
+			end_ = index ;
+			if (index == 0) {
+				if (!ScanIndex(CaptureFile::___HEADER_SIZE___)) {
+					return false ;
+				}
+			} else {
+				try {
+					std::vector<uint8_t> raw(static_cast<size_t>(frames) * CaptureFile::___INDEX_SIZE___) ;
+					if (!ReadAt(index, raw.data(), raw.size())) {
+						return false ;
+					}
+
+					index_.resize(frames) ;
+					for (size_t i = 0 ; i < frames ; ++i) {
+						const uint8_t* e = raw.data() + i * CaptureFile::___INDEX_SIZE___ ;
+						index_[i] = {codec::GetU64LE(e), codec::GetU64LE(e + 8), codec::GetU32LE(e + 16)} ;
+					}
+				} catch (...) {
+					return false ;
+				}
+			}
+
+			position_ = index_.size() ;
+			return true ;
+		}
+
+		// decodes frame, from the nearest key frame at or before it or on from the current frame
+		// when that lies in between.
+		bool Seek(size_t frame) noexcept {
+			if (frame >= index_.size()) {
+				return false ;
+			}
+
+			if (frame == position_) {
+				return true ;
+			}
+
+			size_t key = frame ;
+			while (!index_[key].IsKeyFrame()) {
+				if (key == 0) {
+					return false ;
+				}
+				--key ;
+			}
+
+			const size_t start = position_ < index_.size() && position_ >= key && position_ < frame ? position_ + 1 : key ;
+			for (size_t f = start ; f <= frame ; ++f) {
+				if (!Decode(f)) {
+					position_ = index_.size() ;
+					return false ;
+				}
+			}
+			return true ;
+		}
+
+		bool Next() noexcept { return Seek(position_ < index_.size() ? position_ + 1 : 0) ; }
+
+		// last frame shown at or before t (ns since recording started).
+		size_t FindFrame(uint64_t timestamp) const noexcept {
+			auto it = std::upper_bound(index_.begin(), index_.end(), timestamp, [](uint64_t t, const CaptureFile::Entry& e) { return t < e.timestamp_ ; }) ;
+			return it == index_.begin() ? 0 : static_cast<size_t>(it - index_.begin()) - 1 ;
+		}
+
+		ImageView GetFrame() const noexcept { return {frame_.data(), width_, height_, static_cast<uint32_t>(CaptureFile::PaddedRow(width_, format_)), format_} ; }
+		const std::vector<CaptureFile::Entry>& GetIndex() const noexcept { return index_ ; }
+		size_t GetFrameCount() const noexcept { return index_.size() ; }
+		uint64_t GetFrameBytes(size_t frame) const noexcept { return frame < index_.size() ? (frame + 1 < index_.size() ? index_[frame + 1].offset_ : end_) - index_[frame].offset_ : 0 ; }
+		size_t GetPosition() const noexcept { return position_ ; }
+		uint32_t GetKeyFrameInterval() const noexcept { return key_interval_ ; }
+	} ;
+}
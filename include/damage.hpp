@@ -0,0 +1,136 @@
+#pragma once
+#include "unit.hpp"
+
+namespace zketch {
+
+	// the parts of a frame that changed. Overlapping rects are merged as they come in and a list
+	// that grows past ___MAX_RECTS___ collapses into its bounding box, so pushing it stays cheap.
+	class DamageList {
+	public :
+		static constexpr size_t ___MAX_RECTS___ = 16 ;
+
+	private :
+		std::vector<Rect> rects_ ;
+
+		static bool Overlaps(const Rect& a, const Rect& b) noexcept {
+			return a.x < b.x + static_cast<int32_t>(b.w) && b.x < a.x + static_cast<int32_t>(a.w) && a.y < b.y + static_cast<int32_t>(b.h) && b.y < a.y + static_cast<int32_t>(a.h) ;
+		}
+
+		static Rect Union(const Rect& a, const Rect& b) noexcept {
+			const int32_t x0 = std::min(a.x, b.x) ;
+			const int32_t y0 = std::min(a.y, b.y) ;
+			const int32_t x1 = std::max(a.x + static_cast<int32_t>(a.w), b.x + static_cast<int32_t>(b.w)) ;
+			const int32_t y1 = std::max(a.y + static_cast<int32_t>(a.h), b.y + static_cast<int32_t>(b.h)) ;
+			return {x0, y0, x1 - x0, y1 - y0} ;
+		}
+
+	public :
+		// rect is clamped to bound first, empty rects are ignored.
+		void Add(const Rect& rect, const Size& bound) noexcept {
+			const int32_t x0 = std::max(rect.x, 0) ;
+			const int32_t y0 = std::max(rect.y, 0) ;
+			const int32_t x1 = std::min(rect.x + static_cast<int32_t>(rect.w), static_cast<int32_t>(bound.x)) ;
+			const int32_t y1 = std::min(rect.y + static_cast<int32_t>(rect.h), static_cast<int32_t>(bound.y)) ;
+			if (x0 >= x1 || y0 >= y1) {
+				return ;
+			}
+
+			Rect merged {x0, y0, x1 - x0, y1 - y0} ;
+			for (size_t i = 0 ; i < rects_.size() ;) {
+				if (Overlaps(rects_[i], merged)) {
+					merged = Union(rects_[i], merged) ;
+					rects_[i] = rects_.back() ;
+					rects_.pop_back() ;
+					i = 0 ;
+				} else {
+					++i ;
+				}
+			}
+
+			if (rects_.size() >= ___MAX_RECTS___) {
+				for (const Rect& r : rects_) {
+					merged = Union(r, merged) ;
+				}
+				rects_.clear() ;
+			}
+
+			try {
+				rects_.push_back(merged) ;
+			} catch (...) {
+				rects_.clear() ;
+				rects_.push_back(merged) ;
+			}
+		}
+
+		void Add(const DamageList& other, const Size& bound) noexcept {
+			for (const Rect& r : other.rects_) {
+				Add(r, bound) ;
+			}
+		}
+
+		void SetAll(const Size& bound) noexcept {
+			rects_.clear() ;
+			Add({0, 0, static_cast<int32_t>(bound.x), static_cast<int32_t>(bound.y)}, bound) ;
+		}
+
+		void Clear() noexcept { rects_.clear() ; }
+		void Swap(DamageList& other) noexcept { rects_.swap(other.rects_) ; }
+
+		uint64_t GetArea() const noexcept {
+			uint64_t area = 0 ;
+			for (const Rect& r : rects_) {
+				area += static_cast<uint64_t>(r.w) * r.h ;
+			}
+			return area ;
+		}
+
+		bool IsEmpty() const noexcept { return rects_.empty() ; }
+		size_t GetCount() const noexcept { return rects_.size() ; }
+		const std::vector<Rect>& GetRects() const noexcept { return rects_ ; }
+		std::vector<Rect>::const_iterator begin() const noexcept { return rects_.begin() ; }
+		std::vector<Rect>::const_iterator end() const noexcept { return rects_.end() ; }
+	} ;
+
+	struct PresentStats {
+		uint64_t presents_ = 0 ;				// frames pushed to the output
+		uint64_t skipped_ = 0 ;					// presents skipped because nothing changed
+		uint64_t pixels_ = 0 ;					// pixels pushed
+		std::chrono::nanoseconds elapsed_ {} ;	// since the counters were reset
+
+		double GetPixelsPerSecond() const noexcept { return elapsed_.count() > 0 ? static_cast<double>(pixels_) * 1e9 / static_cast<double>(elapsed_.count()) : 0.0 ; }
+		double GetPresentsPerSecond() const noexcept { return elapsed_.count() > 0 ? static_cast<double>(presents_) * 1e9 / static_cast<double>(elapsed_.count()) : 0.0 ; }
+	} ;
+
+	// written by whichever thread presents, read from anywhere.
+	class PresentCounters {
+	private :
+		std::atomic<uint64_t> presents_ {0} ;
+		std::atomic<uint64_t> skipped_ {0} ;
+		std::atomic<uint64_t> pixels_ {0} ;
+		std::atomic<int64_t> since_ {std::chrono::steady_clock::now().time_since_epoch().count()} ;
+
+	public :
+		void Record(uint64_t pixels) noexcept {
+			presents_.fetch_add(1, std::memory_order_relaxed) ;
+			pixels_.fetch_add(pixels, std::memory_order_relaxed) ;
+		}
+
+		void Skip() noexcept { skipped_.fetch_add(1, std::memory_order_relaxed) ; }
+
+		void Reset() noexcept {
+			presents_.store(0, std::memory_order_relaxed) ;
+			skipped_.store(0, std::memory_order_relaxed) ;
+			pixels_.store(0, std::memory_order_relaxed) ;
+			since_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed) ;
+		}
+
+		PresentStats Get() const noexcept {
+			PresentStats stats ;
+			stats.presents_ = presents_.load(std::memory_order_relaxed) ;
+			stats.skipped_ = skipped_.load(std::memory_order_relaxed) ;
+			stats.pixels_ = pixels_.load(std::memory_order_relaxed) ;
+			stats.elapsed_ = std::chrono::steady_clock::now().time_since_epoch() - std::chrono::steady_clock::duration(since_.load(std::memory_order_relaxed)) ;
+			return stats ;
+		}
+	} ;
+}
@@ -0,0 +1,313 @@
+#pragma once
+#include "event.hpp"
+
+namespace zketch {
+
+	// names a listener of an EventDispatcher until it is unsubscribed, however many others come and
+	// go. A default one names nothing.
+	struct ListenerHandle {
+		uint32_t slot_ = 0 ;
+		uint32_t generation_ = 0 ;	// 0 never names a listener
+
+		constexpr explicit operator bool() const noexcept { return generation_ != 0 ; }
+		constexpr bool operator==(const ListenerHandle&) const noexcept = default ;
+	} ;
+
+	// hands events to the listeners subscribed to their type, and to their window when one is given,
+	// instead of every handler seeing every event. Listeners are a function pointer and a user pointer
+	// kept in dense arrays, a dispatch is a loop over one or two of them. The array of a window is found
+	// by the WindowRegistry slot of the event's id, not by a search. Unsubscribing swaps the last
+	// listener of the array into the hole, the order listeners are called in isn't kept.
+	//
+	// a listener may subscribe and unsubscribe, itself included, while it is called: new ones wait for
+	// the next event, removed ones aren't called again. Use it from one thread.
+	//
+	//	EventDispatcher dispatcher ;
+	//	dispatcher.Subscribe<&Button::OnEvent>(EventType::Mouse, &button, window.GetHandle()) ;
+	//	while (Application) {
+	//		dispatcher.DispatchAll() ;
+	//		...
+	//	}
+	class EventDispatcher {
+	public :
+		using Callback = void (*)(const Event&, void*) ;
+
+	private :
+		static constexpr size_t ___TYPES___ = static_cast<size_t>(EventType::Timer) + 1 ;
+		static constexpr uint32_t ___PENDING___ = UINT32_MAX ;
+
+		struct Listener {
+			Callback callback_ ;	// null once unsubscribed during a dispatch
+			void* user_ ;
+			uint32_t slot_ ;
+		} ;
+
+		// the listeners of one type, for one window or for every window (id 0).
+		struct Channel {
+			WindowId window_ ;
+			std::vector<Listener> listeners_ ;
+		} ;
+
+		struct Slot {
+			uint32_t generation_ ;
+			uint8_t type_ ;
+			uint32_t channel_ ;
+			uint32_t index_ ;	// in the channel, ___PENDING___ until a deferred subscribe lands
+		} ;
+
+		struct Deferred {
+			Listener listener_ ;
+			uint8_t type_ ;
+			WindowId window_ ;
+		} ;
+
+		// channel 0 of every type is the one for every window, channels are never erased. by_slot_
+		// holds one more than the channel of the window in each WindowRegistry slot, 0 for none.
+		std::array<std::vector<Channel>, ___TYPES___> channels_ ;
+		std::array<std::vector<uint32_t>, ___TYPES___> by_slot_ ;
+		std::vector<Slot> slots_ ;
+		std::vector<uint32_t> free_ ;
+		std::vector<Deferred> added_ ;		// subscribed during a dispatch
+		std::vector<uint32_t> removed_ ;	// slots unsubscribed during a dispatch
+		uint32_t dispatching_ = 0 ;
+		size_t count_ = 0 ;
+
+		static constexpr uint32_t NextGeneration(uint32_t generation) noexcept {
+			return generation + 1 != 0 ? generation + 1 : 1 ;
+		}
+
+		// the channel of window, null when it has no listeners of type. A window destroyed since it
+		// subscribed leaves its slot to the next one, its channel isn't found anymore.
+		Channel* FindChannel(uint8_t type, WindowId window) noexcept {
+			const auto& by_slot = by_slot_[type] ;
+			const uint32_t index = WindowRegistry::IndexOf(window) ;
+			if (index >= by_slot.size() || by_slot[index] == 0) {
+				return nullptr ;
+			}
+			Channel& channel = channels_[type][by_slot[index] - 1] ;
+			return channel.window_ == window ? &channel : nullptr ;
+		}
+
+		bool Insert(const Deferred& d) noexcept {
+			try {
+				auto& channels = channels_[d.type_] ;
+				if (channels.empty()) {
+					channels.push_back({0, {}}) ;
+				}
+
+				uint32_t channel = 0 ;
+				if (d.window_) {
+					auto& by_slot = by_slot_[d.type_] ;
+					const uint32_t index = WindowRegistry::IndexOf(d.window_) ;
+					if (index >= by_slot.size()) {
+						by_slot.resize(index + 1, 0) ;
+					}
+					if (by_slot[index] == 0 || channels[by_slot[index] - 1].window_ != d.window_) {
+						channels.push_back({d.window_, {}}) ;
+						by_slot[index] = static_cast<uint32_t>(channels.size()) ;
+					}
+					channel = by_slot[index] - 1 ;
+				}
+
+				auto& listeners = channels[channel].listeners_ ;
+				listeners.push_back(d.listener_) ;
+
+				Slot& slot = slots_[d.listener_.slot_] ;
+				slot.type_ = d.type_ ;
+				slot.channel_ = channel ;
+				slot.index_ = static_cast<uint32_t>(listeners.size() - 1) ;
+			} catch (...) {
+				return false ;
+			}
+			return true ;
+		}
+
+		void Erase(uint32_t s) noexcept {
+			const Slot& slot = slots_[s] ;
+			auto& listeners = channels_[slot.type_][slot.channel_].listeners_ ;
+			if (slot.index_ != listeners.size() - 1) {
+				listeners[slot.index_] = listeners.back() ;
+				slots_[listeners[slot.index_].slot_].index_ = slot.index_ ;
+			}
+			listeners.pop_back() ;
+		}
+
+		void Release(uint32_t s) noexcept {
+			try {
+				free_.push_back(s) ;
+			} catch (...) {}	// the slot is lost, the handle is dead either way
+		}
+
+		// applies what listeners changed while the dispatch ran.
+		void Settle() noexcept {
+			for (uint32_t s : removed_) {
+				Erase(s) ;
+				Release(s) ;
+			}
+			removed_.clear() ;
+
+			for (const auto& d : added_) {
+				if (d.listener_.callback_ && Insert(d)) {
+					continue ;
+				}
+
+				if (d.listener_.callback_) {
+					// out of memory, the handle dies
+					Slot& slot = slots_[d.listener_.slot_] ;
+					slot.generation_ = NextGeneration(slot.generation_) ;
+					--count_ ;
+				}
+				Release(d.listener_.slot_) ;
+			}
+			added_.clear() ;
+		}
+
+		// counts the listeners it called, not the ones unsubscribed before their turn.
+		static size_t Call(const std::vector<Listener>& listeners, const Event& e) noexcept {
+			// listeners only change in Settle, the array stays where it is
+			const Listener* l = listeners.data() ;
+			const size_t n = listeners.size() ;
+			size_t called = 0 ;
+			for (size_t i = 0 ; i < n ; ++i) {
+				if (l[i].callback_) {
+					l[i].callback_(e, l[i].user_) ;
+					++called ;
+				}
+			}
+			return called ;
+		}
+
+	public :
+		EventDispatcher() noexcept = default ;
+		EventDispatcher(const EventDispatcher&) = delete ;
+		EventDispatcher& operator=(const EventDispatcher&) = delete ;
+
+		// callback gets every event of type, only the ones of that window when handle isn't null.
+		// Returns an empty handle when memory or window ids ran out.
+		ListenerHandle Subscribe(EventType type, Callback callback, void* user = nullptr, HWND handle = nullptr) noexcept {
+			const uint8_t t = static_cast<uint8_t>(type) ;
+			const WindowId window = handle ? WindowRegistry::Acquire(handle) : 0 ;
+			if (t >= ___TYPES___ || !callback || (handle && !window)) {
+				return {} ;
+			}
+
+			uint32_t s ;
+			try {
+				if (free_.empty()) {
+					slots_.push_back({0, 0, 0, ___PENDING___}) ;
+					s = static_cast<uint32_t>(slots_.size() - 1) ;
+				} else {
+					s = free_.back() ;
+					free_.pop_back() ;
+				}
+			} catch (...) {
+				return {} ;
+			}
+
+			Slot& slot = slots_[s] ;
+			slot.generation_ = NextGeneration(slot.generation_) ;
+			slot.index_ = ___PENDING___ ;
+
+			const Deferred d = {{callback, user, s}, t, window} ;
+			bool added ;
+			if (dispatching_) {
+				try {
+					added_.push_back(d) ;
+					added = true ;
+				} catch (...) {
+					added = false ;
+				}
+			} else {
+				added = Insert(d) ;
+			}
+
+			if (!added) {
+				slot.generation_ = NextGeneration(slot.generation_) ;
+				Release(s) ;
+				return {} ;
+			}
+
+			++count_ ;
+			return {s, slot.generation_} ;
+		}
+
+		// binds a member function, void T::Method(const Event&).
+		template <auto Method, typename T>
+		ListenerHandle Subscribe(EventType type, T* object, HWND handle = nullptr) noexcept {
+			return Subscribe(type, [](const Event& e, void* self) { (static_cast<T*>(self)->*Method)(e) ; }, object, handle) ;
+		}
+
+		// false when handle was already unsubscribed.
+		bool Unsubscribe(ListenerHandle handle) noexcept {
+			if (!IsSubscribed(handle)) {
+				return false ;
+			}
+
+			Slot& slot = slots_[handle.slot_] ;
+			slot.generation_ = NextGeneration(slot.generation_) ;
+			--count_ ;
+
+			if (slot.index_ == ___PENDING___) {
+				// subscribed in this dispatch, Settle frees it
+				for (auto& d : added_) {
+					if (d.listener_.slot_ == handle.slot_) {
+						d.listener_.callback_ = nullptr ;
+					}
+				}
+				return true ;
+			}
+
+			if (dispatching_) {
+				channels_[slot.type_][slot.channel_].listeners_[slot.index_].callback_ = nullptr ;
+				try {
+					removed_.push_back(handle.slot_) ;
+				} catch (...) {}	// stays as a dead entry, it's never called
+				return true ;
+			}
+
+			Erase(handle.slot_) ;
+			Release(handle.slot_) ;
+			return true ;
+		}
+
+		bool IsSubscribed(ListenerHandle handle) const noexcept {
+			return handle && handle.slot_ < slots_.size() && slots_[handle.slot_].generation_ == handle.generation_ ;
+		}
+
+		// calls the listeners of e's type for every window, then those for e's window. Returns how
+		// many were called.
+		size_t Dispatch(const Event& e) noexcept {
+			const uint8_t t = static_cast<uint8_t>(e.GetEventType()) ;
+			if (t >= ___TYPES___ || channels_[t].empty()) {
+				return 0 ;
+			}
+
+			++dispatching_ ;
+			size_t called = Call(channels_[t][0].listeners_, e) ;
+			// a destroyed window's events still carry its id, its listeners aren't called for them
+			if (WindowRegistry::IsAlive(e.GetWindowId())) {
+				if (const Channel* channel = FindChannel(t, e.GetWindowId())) {
+					called += Call(channel->listeners_, e) ;
+				}
+			}
+
+			if (--dispatching_ == 0) {
+				Settle() ;
+			}
+			return called ;
+		}
+
+		// polls and dispatches until the queue is empty, returns how many events went out.
+		size_t DispatchAll() noexcept {
+			size_t events = 0 ;
+			Event e ;
+			while (PollEvent(e)) {
+				Dispatch(e) ;
+				++events ;
+			}
+			return events ;
+		}
+
+		size_t GetListenerCount() const noexcept { return count_ ; }
+	} ;
+}
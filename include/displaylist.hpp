@@ -0,0 +1,473 @@
+#pragma once
+#include "canvas.hpp"
+#include "capture.hpp"
+
+namespace zketch {
+
+	// ------------------------------ display list ------------------------------
+	//
+	// message		u8 type (1 = frame), u8[3] reserved, u32 body size, body
+	// frame		u32 width, u32 height, commands
+	// command		u8 op, 0x80 set when it reuses the color of the previous command, operands
+	//
+	// operands are i (zigzag varint), f (varint v, v & 1 is followed by a raw f32, otherwise zigzag
+	// v >> 1 in 1/16 pixel), c (u32 color, left out under 0x80) and slot (varint). Strings, fonts and
+	// canvases are sent once by a Define* command into a slot (hash % slots) and drawn by slot from
+	// then on, both ends keep the same slot tables so a hit costs a varint.
+	//
+	// define string	slot, i count, count * varint utf-16 code unit
+	// define font		slot, i name size, name, f size, u8 style
+	// define canvas	slot, i width, i height, u8 format, i stride, i size, payload (QOI for 32bpp, RLE
+	//					otherwise, over stride * height bytes like Canvas::Compress)
+
+	enum class DisplayOp : uint8_t {
+		Clear = 1,
+		ClearRect,			// i x, i y, i w, i h, c
+		DrawRect,			// f x, f y, f w, f h, c, f thickness
+		FillRect,			// i x, i y, i w, i h, c
+		DrawRectRounded,	// f x, f y, f w, f h, c, f radius, f thickness
+		FillRectRounded,	// f x, f y, f w, f h, c, f radius
+		DrawEllipse,		// f x, f y, f w, f h, c, f thickness
+		FillEllipse,		// f x, f y, f w, f h, c
+		DrawString,			// slot text, i x, i y, c, slot font
+		DrawPolygon,		// i count, count * (f x, f y), c, f thickness
+		FillPolygon,		// i count, count * (f x, f y), c
+		DrawLine,			// i x0, i y0, i x1, i y1, c, f thickness
+		DrawCanvas,			// slot, i region x, i region y, i region w, i region h, i x, i y
+		DrawMask,			// slot, i x, i y, c
+		DefineString = 32,
+		DefineFont,
+		DefineCanvas
+	} ;
+
+	struct DisplayList {
+		static constexpr uint8_t ___FRAME___ = 1 ;
+		static constexpr size_t ___MESSAGE_SIZE___ = 8 ;
+		static constexpr size_t ___FRAME_SIZE___ = 8 ;
+		static constexpr uint8_t ___SAME_COLOR___ = 0x80 ;
+		static constexpr uint32_t ___STRING_SLOTS___ = 1024 ;
+		static constexpr uint32_t ___FONT_SLOTS___ = 64 ;
+		static constexpr uint32_t ___CANVAS_SLOTS___ = 256 ;
+
+		static constexpr uint64_t ZigZag(int64_t v) noexcept { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63) ; }
+		static constexpr int64_t UnZigZag(uint64_t v) noexcept { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1) ; }
+	} ;
+
+	struct DisplayListStats {
+		uint64_t frames_ = 0 ;
+		uint64_t commands_ = 0 ;
+		uint64_t bytes_ = 0 ;			// written, definitions included
+		uint64_t define_bytes_ = 0 ;	// of that, spent on strings, fonts and canvases
+		uint64_t strings_ = 0 ;			// definitions sent
+		uint64_t fonts_ = 0 ;
+		uint64_t canvases_ = 0 ;
+		uint64_t reused_ = 0 ;			// references to something the receiver already had
+		uint64_t failed_ = 0 ;			// frames the output refused
+
+		double GetBytesPerFrame() const noexcept { return frames_ ? static_cast<double>(bytes_) / static_cast<double>(frames_) : 0.0 ; }
+	} ;
+
+	// serializes what a Renderer draws. Attach it with Renderer::SetDisplayList, every frame between
+	// Begin and End is written to out as one message. A DisplayListPlayer on the other end replays it
+	// into its own canvas. One writer feeds one receiver, Reset() when that receiver starts over.
+	class DisplayListWriter {
+	private :
+		ImageWriter* out_ = nullptr ;
+		std::vector<uint8_t> frame_ ;
+		std::vector<uint8_t> scratch_ ;
+		std::vector<uint64_t> strings_ ;	// content hash per slot the receiver holds, 0 empty
+		std::vector<uint64_t> fonts_ ;
+		std::vector<uint64_t> canvases_ ;
+		std::array<std::pair<uint64_t, uint64_t>, 256> hashed_ {} ;	// canvas version -> content hash
+		std::array<std::tuple<std::vector<uint64_t>*, uint32_t, uint64_t>, 3> claimed_ {} ;	// slots taken by the command in flight
+		size_t claimed_count_ = 0 ;
+		DisplayListStats stats_ ;
+		uint32_t color_ = 0 ;
+		bool has_color_ = false ;
+		bool open_ = false ;
+
+		void PutByte(uint8_t v) { frame_.push_back(v) ; }
+
+		void PutVarint(uint64_t v) {
+			uint8_t buffer[10] ;
+			frame_.insert(frame_.end(), buffer, codec::PutVarint(buffer, v)) ;
+		}
+
+		void PutInt(int64_t v) { PutVarint(DisplayList::ZigZag(v)) ; }
+
+		void PutFloat(float v) {
+			const float q = v * 16.0f ;
+			if (q == std::floor(q) && std::fabs(q) < 1073741824.0f) {
+				PutVarint(DisplayList::ZigZag(static_cast<int64_t>(q)) << 1) ;
+				return ;
+			}
+
+			PutVarint(1) ;
+			uint32_t bits ;
+			memcpy(&bits, &v, 4) ;
+			uint8_t buffer[4] ;
+			codec::PutU32LE(buffer, bits) ;
+			frame_.insert(frame_.end(), buffer, buffer + 4) ;
+		}
+
+		void PutRectF(const RectF& r) {
+			PutFloat(r.x) ;
+			PutFloat(r.y) ;
+			PutFloat(r.w) ;
+			PutFloat(r.h) ;
+		}
+
+		void PutRect(const Rect& r) {
+			PutInt(r.x) ;
+			PutInt(r.y) ;
+			PutInt(r.w) ;
+			PutInt(r.h) ;
+		}
+
+		// op byte now, color after whatever operands come first.
+		size_t PutOp(DisplayOp op, const Color& color) {
+			const size_t at = frame_.size() ;
+			const bool same = has_color_ && color.ABGR == color_ ;
+			PutByte(static_cast<uint8_t>(op) | (same ? DisplayList::___SAME_COLOR___ : 0)) ;
+			++stats_.commands_ ;
+			return at ;
+		}
+
+		void PutColor(size_t op, const Color& color) {
+			if (frame_[op] & DisplayList::___SAME_COLOR___) {
+				return ;
+			}
+
+			uint8_t buffer[4] ;
+			codec::PutU32LE(buffer, color.ABGR) ;
+			frame_.insert(frame_.end(), buffer, buffer + 4) ;
+			color_ = color.ABGR ;
+			has_color_ = true ;
+		}
+
+		// slot holding hash, define() writes it there first when the receiver doesn't have it.
+		template <typename F>
+		uint32_t Resolve(std::vector<uint64_t>& slots, uint64_t hash, uint64_t& defined, F&& define) {
+			hash = hash ? hash : 1 ;
+			const uint32_t slot = static_cast<uint32_t>(hash % slots.size()) ;
+			if (slots[slot] == hash) {
+				++stats_.reused_ ;
+				return slot ;
+			}
+
+			const size_t at = frame_.size() ;
+			claimed_[claimed_count_++] = {&slots, slot, slots[slot]} ;
+			slots[slot] = hash ;
+			define(slot) ;
+			stats_.define_bytes_ += frame_.size() - at ;
+			++defined ;
+			return slot ;
+		}
+
+		uint32_t ResolveString(const std::wstring& text) {
+			return Resolve(strings_, codec::Hash64(text.data(), text.size() * sizeof(wchar_t)), stats_.strings_, [&](uint32_t slot) {
+				PutByte(static_cast<uint8_t>(DisplayOp::DefineString)) ;
+				PutVarint(slot) ;
+				PutInt(static_cast<int64_t>(text.size())) ;
+				for (wchar_t c : text) {
+					PutVarint(static_cast<uint16_t>(c)) ;
+				}
+			}) ;
+		}
+
+		uint32_t ResolveFont(const Font& font) {
+			const std::string_view name = font.GetFontName() ;
+			const float size = font.GetFontSize() ;
+			uint64_t hash = codec::Hash64(name.data(), name.size()) ;
+			hash = codec::Hash64(&size, sizeof(size), hash) ;
+			hash ^= static_cast<uint64_t>(font.GetFontStyle()) * 0x9E3779B97F4A7C15ull ;
+
+			return Resolve(fonts_, hash, stats_.fonts_, [&](uint32_t slot) {
+				PutByte(static_cast<uint8_t>(DisplayOp::DefineFont)) ;
+				PutVarint(slot) ;
+				PutInt(static_cast<int64_t>(name.size())) ;
+				frame_.insert(frame_.end(), name.begin(), name.end()) ;
+				PutFloat(size) ;
+				PutByte(static_cast<uint8_t>(font.GetFontStyle())) ;
+			}) ;
+		}
+
+		uint32_t ResolveCanvas(const Canvas& canvas) {
+			const uint64_t version = canvas.GetVersion() ;
+			auto& memo = hashed_[version % hashed_.size()] ;
+			uint64_t hash = memo.first == version ? memo.second : 0 ;
+			if (hash == 0) {
+				hash = codec::Hash64(canvas.GetPixels(), canvas.GetByteSize(), static_cast<uint64_t>(canvas.GetWidth()) << 40 ^ static_cast<uint64_t>(canvas.GetHeight()) << 8 ^ static_cast<uint64_t>(canvas.GetFormat())) ;
+				memo = {version, hash} ;
+			}
+
+			return Resolve(canvases_, hash, stats_.canvases_, [&](uint32_t slot) {
+				const size_t bytes = canvas.GetByteSize() ;
+				if (BytesPerPixel(canvas.GetFormat()) == 4) {
+					scratch_.resize(bytes / 4 * 5 + 1) ;
+					codec::QoiState qoi ;
+					uint8_t* end = qoi.Finish(qoi.Encode(reinterpret_cast<const uint32_t*>(canvas.GetPixels()), bytes / 4, scratch_.data())) ;
+					scratch_.resize(static_cast<size_t>(end - scratch_.data())) ;
+				} else {
+					scratch_.resize(bytes + bytes / 128 + 1) ;
+					uint8_t* end = codec::RleEncode(canvas.GetPixels(), bytes, scratch_.data()) ;
+					scratch_.resize(static_cast<size_t>(end - scratch_.data())) ;
+				}
+
+				PutByte(static_cast<uint8_t>(DisplayOp::DefineCanvas)) ;
+				PutVarint(slot) ;
+				PutInt(canvas.GetWidth()) ;
+				PutInt(canvas.GetHeight()) ;
+				PutByte(static_cast<uint8_t>(canvas.GetFormat())) ;
+				PutInt(canvas.GetStride()) ;
+				PutInt(static_cast<int64_t>(scratch_.size())) ;
+				frame_.insert(frame_.end(), scratch_.begin(), scratch_.end()) ;
+			}) ;
+		}
+
+		// a failed append loses the command, the frame itself stays well formed.
+		template <typename F>
+		void Record(F&& fn) noexcept {
+			if (!open_) {
+				return ;
+			}
+
+			const size_t at = frame_.size() ;
+			const DisplayListStats stats = stats_ ;
+			claimed_count_ = 0 ;
+			try {
+				fn() ;
+			} catch (...) {
+				while (claimed_count_ > 0) {
+					const auto& [slots, slot, previous] = claimed_[--claimed_count_] ;
+					(*slots)[slot] = previous ;
+				}
+				frame_.resize(at) ;
+				stats_ = stats ;
+				has_color_ = false ;
+			}
+		}
+
+	public :
+		DisplayListWriter(const DisplayListWriter&) = delete ;
+		DisplayListWriter& operator=(const DisplayListWriter&) = delete ;
+
+		explicit DisplayListWriter(ImageWriter& out) noexcept : out_(&out) {
+			Reset() ;
+		}
+
+		// forgets what the receiver holds, everything is defined again.
+		void Reset() noexcept {
+			try {
+				strings_.assign(DisplayList::___STRING_SLOTS___, 0) ;
+				fonts_.assign(DisplayList::___FONT_SLOTS___, 0) ;
+				canvases_.assign(DisplayList::___CANVAS_SLOTS___, 0) ;
+			} catch (...) {}
+		}
+
+		// ------------------------------ called by Renderer ------------------------------
+
+		void BeginFrame(const Size& size) noexcept {
+			try {
+				frame_.resize(DisplayList::___MESSAGE_SIZE___ + DisplayList::___FRAME_SIZE___) ;
+			} catch (...) {
+				open_ = false ;
+				return ;
+			}
+
+			codec::PutU32LE(frame_.data() + DisplayList::___MESSAGE_SIZE___, size.x) ;
+			codec::PutU32LE(frame_.data() + DisplayList::___MESSAGE_SIZE___ + 4, size.y) ;
+			has_color_ = false ;
+			open_ = true ;
+		}
+
+		void EndFrame() noexcept {
+			if (!open_) {
+				return ;
+			}
+
+			open_ = false ;
+			frame_[0] = DisplayList::___FRAME___ ;
+			frame_[1] = frame_[2] = frame_[3] = 0 ;
+			codec::PutU32LE(frame_.data() + 4, static_cast<uint32_t>(frame_.size() - DisplayList::___MESSAGE_SIZE___)) ;
+
+			if (!out_->Write(frame_.data(), frame_.size())) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("DisplayListWriter::EndFrame - Output refused the frame, receiver caches are rebuilt.") ;
+				#endif
+
+				++stats_.failed_ ;
+				Reset() ;
+				return ;
+			}
+
+			++stats_.frames_ ;
+			stats_.bytes_ += frame_.size() ;
+		}
+
+		void Clear(const Color& color) noexcept {
+			Record([&] {
+				PutColor(PutOp(DisplayOp::Clear, color), color) ;
+			}) ;
+		}
+
+		void ClearRect(const Rect& rect, const Color& color) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::ClearRect, color) ;
+				PutRect(rect) ;
+				PutColor(op, color) ;
+			}) ;
+		}
+
+		void DrawRect(const RectF& rect, const Color& color, float thickness) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::DrawRect, color) ;
+				PutRectF(rect) ;
+				PutColor(op, color) ;
+				PutFloat(thickness) ;
+			}) ;
+		}
+
+		void FillRect(const Rect& rect, const Color& color) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::FillRect, color) ;
+				PutRect(rect) ;
+				PutColor(op, color) ;
+			}) ;
+		}
+
+		void DrawRectRounded(const RectF& rect, const Color& color, float radius, float thickness) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::DrawRectRounded, color) ;
+				PutRectF(rect) ;
+				PutColor(op, color) ;
+				PutFloat(radius) ;
+				PutFloat(thickness) ;
+			}) ;
+		}
+
+		void FillRectRounded(const RectF& rect, const Color& color, float radius) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::FillRectRounded, color) ;
+				PutRectF(rect) ;
+				PutColor(op, color) ;
+				PutFloat(radius) ;
+			}) ;
+		}
+
+		void DrawEllipse(const RectF& rect, const Color& color, float thickness) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::DrawEllipse, color) ;
+				PutRectF(rect) ;
+				PutColor(op, color) ;
+				PutFloat(thickness) ;
+			}) ;
+		}
+
+		void FillEllipse(const RectF& rect, const Color& color) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::FillEllipse, color) ;
+				PutRectF(rect) ;
+				PutColor(op, color) ;
+			}) ;
+		}
+
+		void DrawString(const std::wstring& text, const Point& pos, const Color& color, const Font& font) noexcept {
+			Record([&] {
+				const uint32_t text_slot = ResolveString(text) ;
+				const uint32_t font_slot = ResolveFont(font) ;
+				const size_t op = PutOp(DisplayOp::DrawString, color) ;
+				PutVarint(text_slot) ;
+				PutInt(pos.x) ;
+				PutInt(pos.y) ;
+				PutColor(op, color) ;
+				PutVarint(font_slot) ;
+			}) ;
+		}
+
+		void DrawPolygon(const Vertex& vertices, const Color& color, float thickness) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::DrawPolygon, color) ;
+				PutInt(static_cast<int64_t>(vertices.size())) ;
+				for (const auto& v : vertices) {
+					PutFloat(v.x) ;
+					PutFloat(v.y) ;
+				}
+				PutColor(op, color) ;
+				PutFloat(thickness) ;
+			}) ;
+		}
+
+		void FillPolygon(const Vertex& vertices, const Color& color) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::FillPolygon, color) ;
+				PutInt(static_cast<int64_t>(vertices.size())) ;
+				for (const auto& v : vertices) {
+					PutFloat(v.x) ;
+					PutFloat(v.y) ;
+				}
+				PutColor(op, color) ;
+			}) ;
+		}
+
+		void DrawLine(const Point& start, const Point& end, const Color& color, float thickness) noexcept {
+			Record([&] {
+				const size_t op = PutOp(DisplayOp::DrawLine, color) ;
+				PutInt(start.x) ;
+				PutInt(start.y) ;
+				PutInt(end.x) ;
+				PutInt(end.y) ;
+				PutColor(op, color) ;
+				PutFloat(thickness) ;
+			}) ;
+		}
+
+		// region is in logical coordinates, wrapped sources are sent unwrapped.
+		void DrawCanvas(const Canvas& src, const Rect& region, const Point& pos) noexcept {
+			Record([&] {
+				uint32_t slot ;
+				if (src.IsWrapped() && (src.GetOrigin().x != 0 || src.GetOrigin().y != 0)) {
+					Canvas logical = src ;
+					if (!logical.Unwrap()) {
+						return ;
+					}
+					slot = ResolveCanvas(logical) ;
+				} else {
+					slot = ResolveCanvas(src) ;
+				}
+
+				PutByte(static_cast<uint8_t>(DisplayOp::DrawCanvas)) ;
+				++stats_.commands_ ;
+				PutVarint(slot) ;
+				PutRect(region) ;
+				PutInt(pos.x) ;
+				PutInt(pos.y) ;
+			}) ;
+		}
+
+		void DrawMask(const Canvas& mask, const Point& pos, const Color& color) noexcept {
+			Record([&] {
+				uint32_t slot ;
+				if (mask.IsWrapped() && (mask.GetOrigin().x != 0 || mask.GetOrigin().y != 0)) {
+					Canvas logical = mask ;
+					if (!logical.Unwrap()) {
+						return ;
+					}
+					slot = ResolveCanvas(logical) ;
+				} else {
+					slot = ResolveCanvas(mask) ;
+				}
+
+				const size_t op = PutOp(DisplayOp::DrawMask, color) ;
+				PutVarint(slot) ;
+				PutInt(pos.x) ;
+				PutInt(pos.y) ;
+				PutColor(op, color) ;
+			}) ;
+		}
+
+		DisplayListStats GetStats() const noexcept { return stats_ ; }
+		void ResetStats() noexcept { stats_ = {} ; }
+	} ;
+}
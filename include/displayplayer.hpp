@@ -0,0 +1,488 @@
+#pragma once
+#include "renderer.hpp"
+
+namespace zketch {
+
+	// replays what a DisplayListWriter sent into a canvas of its own, drawing through a Renderer so
+	// the result is whatever this side's rasterizer makes of the commands. Slot tables mirror the
+	// writer's, a frame that fails to parse leaves them out of step until the writer is Reset().
+	class DisplayListPlayer {
+	private :
+		struct FontSlot {
+			std::string name_ ;	// Font keeps a view of it
+			std::optional<Font> font_ ;
+		} ;
+
+		// reads operands, any overrun clears ok_ and yields zeros from then on.
+		struct Cursor {
+			const uint8_t* in_ ;
+			const uint8_t* end_ ;
+			bool ok_ = true ;
+
+			uint8_t Byte() noexcept {
+				if (in_ >= end_) {
+					ok_ = false ;
+					return 0 ;
+				}
+				return *in_++ ;
+			}
+
+			uint64_t Varint() noexcept {
+				uint64_t v = 0 ;
+				const uint8_t* next = ok_ ? codec::GetVarint(in_, end_, v) : nullptr ;
+				if (!next) {
+					ok_ = false ;
+					return 0 ;
+				}
+				in_ = next ;
+				return v ;
+			}
+
+			int32_t Int() noexcept { return static_cast<int32_t>(DisplayList::UnZigZag(Varint())) ; }
+
+			float Float() noexcept {
+				const uint64_t v = Varint() ;
+				if (!(v & 1)) {
+					return static_cast<float>(DisplayList::UnZigZag(v >> 1)) / 16.0f ;
+				}
+
+				if (end_ - in_ < 4) {
+					ok_ = false ;
+					return 0.0f ;
+				}
+
+				const uint32_t bits = codec::GetU32LE(in_) ;
+				in_ += 4 ;
+				float f ;
+				memcpy(&f, &bits, 4) ;
+				return f ;
+			}
+
+			uint32_t U32() noexcept {
+				if (end_ - in_ < 4) {
+					ok_ = false ;
+					return 0 ;
+				}
+
+				const uint32_t v = codec::GetU32LE(in_) ;
+				in_ += 4 ;
+				return v ;
+			}
+
+			RectF GetRectF() noexcept {
+				const float x = Float() ;
+				const float y = Float() ;
+				const float w = Float() ;
+				const float h = Float() ;
+				return {x, y, w, h} ;
+			}
+
+			Rect GetRect() noexcept {
+				const int32_t x = Int() ;
+				const int32_t y = Int() ;
+				const int32_t w = Int() ;
+				const int32_t h = Int() ;
+				return {x, y, std::max(w, 0), std::max(h, 0)} ;
+			}
+
+			Point GetPoint() noexcept {
+				const int32_t x = Int() ;
+				const int32_t y = Int() ;
+				return {x, y} ;
+			}
+		} ;
+
+		std::vector<std::wstring> strings_ ;
+		std::vector<FontSlot> fonts_ ;
+		std::vector<Canvas> canvases_ ;
+		std::vector<uint8_t> pending_ ;	// partial message carried between Feed() calls
+		Renderer renderer_ ;
+		DisplayListStats stats_ ;
+
+		bool DefineString(Cursor& in) noexcept {
+			const uint64_t slot = in.Varint() ;
+			const int32_t count = in.Int() ;
+			if (!in.ok_ || slot >= strings_.size() || count < 0 || count > in.end_ - in.in_) {
+				return false ;
+			}
+
+			try {
+				std::wstring text(static_cast<size_t>(count), L'\0') ;
+				for (auto& c : text) {
+					c = static_cast<wchar_t>(in.Varint()) ;
+				}
+				strings_[slot] = std::move(text) ;
+			} catch (...) {
+				return false ;
+			}
+
+			++stats_.strings_ ;
+			return in.ok_ ;
+		}
+
+		bool DefineFont(Cursor& in) noexcept {
+			const uint64_t slot = in.Varint() ;
+			const int32_t length = in.Int() ;
+			if (!in.ok_ || slot >= fonts_.size() || length < 0 || length > in.end_ - in.in_) {
+				return false ;
+			}
+
+			FontSlot& font = fonts_[slot] ;
+			font.font_.reset() ;
+			try {
+				font.name_.assign(reinterpret_cast<const char*>(in.in_), static_cast<size_t>(length)) ;
+			} catch (...) {
+				return false ;
+			}
+			in.in_ += length ;
+
+			const float size = in.Float() ;
+			const FontStyle style = static_cast<FontStyle>(in.Byte()) ;
+			if (!in.ok_) {
+				return false ;
+			}
+
+			// a nameless font is the writer's default one, a font this side doesn't have leaves the slot
+			// empty and its strings are skipped
+			try {
+				if (font.name_.empty()) {
+					font.font_.emplace() ;
+				} else {
+					font.font_.emplace(font.name_, size, style) ;
+				}
+			} catch (...) {
+
+				#ifdef RENDERER_DEBUG
+					logger::warning("DisplayListPlayer::DefineFont - Font not found : ", font.name_, ", its strings are skipped.") ;
+				#endif
+
+			}
+
+			++stats_.fonts_ ;
+			return true ;
+		}
+
+		bool DefineCanvas(Cursor& in) noexcept {
+			const uint64_t slot = in.Varint() ;
+			const int32_t width = in.Int() ;
+			const int32_t height = in.Int() ;
+			const uint8_t format = in.Byte() ;
+			const int32_t stride = in.Int() ;
+			const int32_t size = in.Int() ;
+			if (!in.ok_ || slot >= canvases_.size() || width <= 0 || height <= 0 || format > static_cast<uint8_t>(ColorFormat::A8) || size < 0 || size > in.end_ - in.in_) {
+				return false ;
+			}
+
+			Canvas& canvas = canvases_[slot] ;
+			if (!canvas.Create({static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, static_cast<ColorFormat>(format)) || canvas.GetStride() != static_cast<uint32_t>(stride)) {
+				canvas.Clear() ;
+				return false ;
+			}
+
+			const size_t bytes = canvas.GetByteSize() ;
+			bool ok = false ;
+			if (BytesPerPixel(canvas.GetFormat()) == 4) {
+				codec::QoiState qoi ;
+				ok = qoi.Decode(in.in_, in.in_ + size, reinterpret_cast<uint32_t*>(canvas.GetPixels()), bytes / 4) != nullptr ;
+			} else {
+				ok = codec::RleDecode(in.in_, static_cast<size_t>(size), canvas.GetPixels(), bytes) ;
+			}
+			in.in_ += size ;
+
+			if (!ok) {
+				canvas.Clear() ;
+				return false ;
+			}
+
+			canvas.MarkInvalidate() ;
+			++stats_.canvases_ ;
+			return true ;
+		}
+
+		// one command, false when the frame can't be trusted past it.
+		bool Step(Cursor& in, Color& color) noexcept {
+			const uint8_t byte = in.Byte() ;
+			const bool same = byte & DisplayList::___SAME_COLOR___ ;
+			const auto op = static_cast<DisplayOp>(byte & ~DisplayList::___SAME_COLOR___) ;
+			const uint8_t* at = in.in_ ;
+
+			auto TakeColor = [&]() {
+				if (!same) {
+					color = in.U32() ;
+				}
+				return color ;
+			} ;
+
+			switch (op) {
+				case DisplayOp::Clear : {
+					const Color c = TakeColor() ;
+					if (in.ok_) {
+						renderer_.Clear(c) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::ClearRect : {
+					const Rect r = in.GetRect() ;
+					const Color c = TakeColor() ;
+					if (in.ok_) {
+						renderer_.ClearRect(r, c) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawRect : {
+					const RectF r = in.GetRectF() ;
+					const Color c = TakeColor() ;
+					const float thickness = in.Float() ;
+					if (in.ok_) {
+						renderer_.DrawRect(r, c, thickness) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::FillRect : {
+					const Rect r = in.GetRect() ;
+					const Color c = TakeColor() ;
+					if (in.ok_) {
+						renderer_.FillRect(r, c) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawRectRounded : {
+					const RectF r = in.GetRectF() ;
+					const Color c = TakeColor() ;
+					const float radius = in.Float() ;
+					const float thickness = in.Float() ;
+					if (in.ok_) {
+						renderer_.DrawRectRounded(r, c, radius, thickness) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::FillRectRounded : {
+					const RectF r = in.GetRectF() ;
+					const Color c = TakeColor() ;
+					const float radius = in.Float() ;
+					if (in.ok_) {
+						renderer_.FillRectRounded(r, c, radius) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawEllipse : {
+					const RectF r = in.GetRectF() ;
+					const Color c = TakeColor() ;
+					const float thickness = in.Float() ;
+					if (in.ok_) {
+						renderer_.DrawEllipse(r, c, thickness) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::FillEllipse : {
+					const RectF r = in.GetRectF() ;
+					const Color c = TakeColor() ;
+					if (in.ok_) {
+						renderer_.FillEllipse(r, c) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawString : {
+					const uint64_t text = in.Varint() ;
+					const Point pos = in.GetPoint() ;
+					const Color c = TakeColor() ;
+					const uint64_t font = in.Varint() ;
+					if (!in.ok_ || text >= strings_.size() || font >= fonts_.size()) {
+						return false ;
+					}
+
+					if (fonts_[font].font_) {
+						renderer_.DrawString(strings_[text], pos, c, *fonts_[font].font_) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawPolygon :
+				case DisplayOp::FillPolygon : {
+					const int32_t count = in.Int() ;
+					if (!in.ok_ || count <= 0 || count > in.end_ - in.in_) {
+						return false ;
+					}
+
+					Vertex vertices ;
+					try {
+						vertices.resize(static_cast<size_t>(count)) ;
+					} catch (...) {
+						return false ;
+					}
+
+					for (auto& v : vertices) {
+						v.x = in.Float() ;
+						v.y = in.Float() ;
+					}
+
+					const Color c = TakeColor() ;
+					if (op == DisplayOp::DrawPolygon) {
+						const float thickness = in.Float() ;
+						if (in.ok_) {
+							renderer_.DrawPolygon(vertices, c, thickness) ;
+						}
+					} else if (in.ok_) {
+						renderer_.FillPolygon(vertices, c) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawLine : {
+					const Point start = in.GetPoint() ;
+					const Point end = in.GetPoint() ;
+					const Color c = TakeColor() ;
+					const float thickness = in.Float() ;
+					if (in.ok_) {
+						renderer_.DrawLine(start, end, c, thickness) ;
+					}
+					break ;
+				}
+
+				case DisplayOp::DrawCanvas : {
+					const uint64_t slot = in.Varint() ;
+					const Rect region = in.GetRect() ;
+					const Point pos = in.GetPoint() ;
+					if (!in.ok_ || slot >= canvases_.size()) {
+						return false ;
+					}
+
+					renderer_.DrawCanvas(&canvases_[slot], region, pos) ;
+					break ;
+				}
+
+				case DisplayOp::DrawMask : {
+					const uint64_t slot = in.Varint() ;
+					const Point pos = in.GetPoint() ;
+					const Color c = TakeColor() ;
+					if (!in.ok_ || slot >= canvases_.size()) {
+						return false ;
+					}
+
+					renderer_.DrawMask(&canvases_[slot], pos, c) ;
+					break ;
+				}
+
+				case DisplayOp::DefineString :
+				case DisplayOp::DefineFont :
+				case DisplayOp::DefineCanvas : {
+					const bool ok = op == DisplayOp::DefineString ? DefineString(in) : op == DisplayOp::DefineFont ? DefineFont(in) : DefineCanvas(in) ;
+					stats_.define_bytes_ += static_cast<uint64_t>(in.in_ - at) + 1 ;
+					return ok ;
+				}
+
+				default :
+					return false ;
+			}
+
+			++stats_.commands_ ;
+			return in.ok_ ;
+		}
+
+	public :
+		DisplayListPlayer(const DisplayListPlayer&) = delete ;
+		DisplayListPlayer& operator=(const DisplayListPlayer&) = delete ;
+
+		DisplayListPlayer() noexcept {
+			Reset() ;
+		}
+
+		// drops every slot and any partial message, pairs with DisplayListWriter::Reset().
+		void Reset() noexcept {
+			try {
+				strings_.assign(DisplayList::___STRING_SLOTS___, {}) ;
+				fonts_ = std::vector<FontSlot>(DisplayList::___FONT_SLOTS___) ;
+				canvases_.assign(DisplayList::___CANVAS_SLOTS___, {}) ;
+			} catch (...) {}
+			pending_.clear() ;
+		}
+
+		// draws one message into target, sized to the frame first. Untouched pixels keep the
+		// previous frame, like a window's back buffer.
+		bool Replay(const uint8_t* message, size_t size, Canvas& target) noexcept {
+			if (size < DisplayList::___MESSAGE_SIZE___ + DisplayList::___FRAME_SIZE___ || message[0] != DisplayList::___FRAME___ || codec::GetU32LE(message + 4) != size - DisplayList::___MESSAGE_SIZE___) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("DisplayListPlayer::Replay - Not a display list frame.") ;
+				#endif
+
+				++stats_.failed_ ;
+				return false ;
+			}
+
+			const Size frame {codec::GetU32LE(message + 8), codec::GetU32LE(message + 12)} ;
+			if ((!target.IsValid() || target.GetSize() != frame) && !target.Create(frame)) {
+				++stats_.failed_ ;
+				return false ;
+			}
+
+			if (!renderer_.Begin(target)) {
+				++stats_.failed_ ;
+				return false ;
+			}
+
+			Cursor in {message + DisplayList::___MESSAGE_SIZE___ + DisplayList::___FRAME_SIZE___, message + size} ;
+			Color color ;
+			bool ok = true ;
+			while (ok && in.in_ < in.end_) {
+				ok = Step(in, color) ;
+			}
+			renderer_.End() ;
+
+			if (!ok) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("DisplayListPlayer::Replay - Corrupt command at byte ", in.in_ - message, ", slots are out of step.") ;
+				#endif
+
+				++stats_.failed_ ;
+				return false ;
+			}
+
+			++stats_.frames_ ;
+			stats_.bytes_ += size ;
+			return true ;
+		}
+
+		// takes bytes as they come off a stream, replaying every message completed. Returns false on a
+		// corrupt message and drops what was buffered, both ends Reset() before going on.
+		bool Feed(const uint8_t* data, size_t size, Canvas& target) noexcept {
+			try {
+				pending_.insert(pending_.end(), data, data + size) ;
+			} catch (...) {
+				return false ;
+			}
+
+			size_t at = 0 ;
+			bool ok = true ;
+			while (ok && pending_.size() - at >= DisplayList::___MESSAGE_SIZE___) {
+				const size_t message = DisplayList::___MESSAGE_SIZE___ + codec::GetU32LE(pending_.data() + at + 4) ;
+				if (pending_.size() - at < message) {
+					break ;
+				}
+
+				ok = Replay(pending_.data() + at, message, target) ;
+				at += message ;
+			}
+
+			if (!ok) {
+				pending_.clear() ;
+				return false ;
+			}
+
+			pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(at)) ;
+			return true ;
+		}
+
+		DisplayListStats GetStats() const noexcept { return stats_ ; }
+		void ResetStats() noexcept { stats_ = {} ; }
+	} ;
+}
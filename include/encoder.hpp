@@ -0,0 +1,1028 @@
+#pragma once
+#include "pixel.hpp"
+
+// carry-less multiply for the CRC, picked at run time since it isn't part of the baseline x86-64
+#if defined(ZKETCH_SSE2) && !defined(ZKETCH_NO_PCLMUL) && (defined(__GNUC__) || defined(_MSC_VER))
+	#define ZKETCH_PCLMUL
+	#include <wmmintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define ZKETCH_TARGET_PCLMUL
+	#else
+		#define ZKETCH_TARGET_PCLMUL __attribute__((target("pclmul")))
+	#endif
+#endif
+
+namespace zketch {
+
+	enum class ImageFormat : uint8_t {
+		QOI,
+		PNG,	// stored (uncompressed) deflate, valid for any PNG reader
+		PPM		// binary P6, P5 for A8 sources
+	} ;
+
+	// ------------------------------ writers ------------------------------
+
+	// byte sink the encoders stream into, implement it to send snapshots anywhere.
+	class ImageWriter {
+	public :
+		virtual ~ImageWriter() noexcept = default ;
+		virtual bool Write(const void* data, size_t size) noexcept = 0 ;
+	} ;
+
+	class FileWriter : public ImageWriter {
+	private :
+		std::ofstream file_ ;
+
+	public :
+		FileWriter(const std::string& path) noexcept : file_(path, std::ios::binary | std::ios::trunc) {}
+
+		bool Write(const void* data, size_t size) noexcept override {
+			file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)) ;
+			return static_cast<bool>(file_) ;
+		}
+
+		bool IsOpen() const noexcept { return file_.is_open() ; }
+	} ;
+
+	class MemoryWriter : public ImageWriter {
+	private :
+		std::vector<uint8_t> buffer_ ;
+
+	public :
+		MemoryWriter() noexcept = default ;
+
+		bool Write(const void* data, size_t size) noexcept override {
+			const uint8_t* bytes = static_cast<const uint8_t*>(data) ;
+			try {
+				buffer_.insert(buffer_.end(), bytes, bytes + size) ;
+			} catch (...) {
+				return false ;
+			}
+			return true ;
+		}
+
+		void Clear() noexcept { buffer_.clear() ; }
+		std::vector<uint8_t>& GetBuffer() noexcept { return buffer_ ; }
+		const std::vector<uint8_t>& GetBuffer() const noexcept { return buffer_ ; }
+	} ;
+
+	// ------------------------------ pixel sources ------------------------------
+
+	// non owning view over rows of pixels, what every encoder consumes.
+	struct ImageView {
+		const uint8_t* pixels_ = nullptr ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		uint32_t stride_ = 0 ;
+		ColorFormat format_ = ColorFormat::ARGB ;
+
+		const uint8_t* GetRow(uint32_t y) const noexcept { return pixels_ + static_cast<size_t>(y) * stride_ ; }
+		bool IsValid() const noexcept { return pixels_ && width_ && height_ ; }
+	} ;
+
+	// owning copy of a canvas, safe to hand to a worker thread while the canvas keeps drawing. Invalid
+	// when memory ran out.
+	class ImageBuffer {
+	private :
+		std::vector<uint8_t> pixels_ ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		uint32_t stride_ = 0 ;
+		ColorFormat format_ = ColorFormat::ARGB ;
+
+	public :
+		ImageBuffer() noexcept = default ;
+
+		ImageBuffer(const ImageView& view) noexcept {
+			if (!view.IsValid()) {
+				return ;
+			}
+
+			try {
+				pixels_.assign(view.pixels_, view.pixels_ + static_cast<size_t>(view.stride_) * view.height_) ;
+			} catch (...) {
+				return ;
+			}
+
+			width_ = view.width_ ;
+			height_ = view.height_ ;
+			stride_ = view.stride_ ;
+			format_ = view.format_ ;
+		}
+
+		// a blank image to fill through GetRow.
+		ImageBuffer(uint32_t width, uint32_t height, uint32_t stride, ColorFormat format) noexcept {
+			try {
+				pixels_.assign(static_cast<size_t>(stride) * height, 0) ;
+			} catch (...) {
+				return ;
+			}
+
+			width_ = width ;
+			height_ = height ;
+			stride_ = stride ;
+			format_ = format ;
+		}
+
+		uint8_t* GetRow(uint32_t y) noexcept { return pixels_.data() + static_cast<size_t>(y) * stride_ ; }
+
+		ImageView GetView() const noexcept { return {pixels_.data(), width_, height_, stride_, format_} ; }
+		bool IsValid() const noexcept { return !pixels_.empty() ; }
+	} ;
+
+	namespace codec {
+
+		// ------------------------------ checksums ------------------------------
+
+		struct ___crc_table___ {
+			uint32_t table_[8][256] {} ;
+
+			constexpr ___crc_table___() noexcept {
+				for (uint32_t i = 0 ; i < 256 ; ++i) {
+					uint32_t c = i ;
+					for (int32_t k = 0 ; k < 8 ; ++k) {
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1 ;
+					}
+					table_[0][i] = c ;
+				}
+
+				for (uint32_t i = 0 ; i < 256 ; ++i) {
+					for (int32_t t = 1 ; t < 8 ; ++t) {
+						table_[t][i] = (table_[t - 1][i] >> 8) ^ table_[0][table_[t - 1][i] & 0xFF] ;
+					}
+				}
+			}
+		} ;
+
+		static constexpr ___crc_table___ ___CRC___ {} ;
+
+		// slicing-by-8 over the inverted CRC Crc32() keeps while it runs.
+		inline uint32_t Crc32Slice8(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+			const auto& t = ___CRC___.table_ ;
+
+			while (size >= 8) {
+				uint32_t lo ;
+				uint32_t hi ;
+				memcpy(&lo, data, 4) ;
+				memcpy(&hi, data + 4, 4) ;
+				lo ^= crc ;
+				crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+					  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24] ;
+				data += 8 ;
+				size -= 8 ;
+			}
+
+			while (size--) {
+				crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8) ;
+			}
+
+			return crc ;
+		}
+
+		#ifdef ZKETCH_PCLMUL
+			inline bool HasPclmul() noexcept {
+				#ifdef _MSC_VER
+					int32_t info[4] {} ;
+					__cpuid(info, 1) ;
+					return (info[2] & 2) != 0 ;
+				#else
+					__builtin_cpu_init() ;
+					return __builtin_cpu_supports("pclmul") ;
+				#endif
+			}
+
+			static inline const bool g_pclmul_ = HasPclmul() ;
+
+			ZKETCH_TARGET_PCLMUL inline __m128i Crc32Fold16(__m128i x, __m128i next, __m128i k) noexcept {
+				return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00)), next) ;
+			}
+
+			// folds four 16 byte lanes per 64 bytes with carry-less multiplies, then folds them into
+			// one and Barrett reduces it (Gopal et al., "Fast CRC Computation for Generic Polynomials
+			// Using PCLMULQDQ", constants for the reflected PNG polynomial as zlib's crc32_simd has
+			// them). size is at least 64 and a multiple of 16, crc inverted like Crc32Slice8's.
+			ZKETCH_TARGET_PCLMUL inline uint32_t Crc32Fold(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+				const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4) ;
+				const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0) ;
+				const __m128i k5k0 = _mm_set_epi64x(0, 0x0163CD6124) ;
+				const __m128i poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641) ;
+				const __m128i low32 = _mm_setr_epi32(-1, 0, -1, 0) ;
+
+				__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)) ;
+				__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)) ;
+				__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)) ;
+				__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)) ;
+				x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int32_t>(crc))) ;
+				data += 64 ;
+				size -= 64 ;
+
+				for ( ; size >= 64 ; data += 64, size -= 64) {
+					const __m128i f1 = _mm_clmulepi64_si128(x1, k1k2, 0x00) ;
+					const __m128i f2 = _mm_clmulepi64_si128(x2, k1k2, 0x00) ;
+					const __m128i f3 = _mm_clmulepi64_si128(x3, k1k2, 0x00) ;
+					const __m128i f4 = _mm_clmulepi64_si128(x4, k1k2, 0x00) ;
+					x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k1k2, 0x11), f1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))) ;
+					x2 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x2, k1k2, 0x11), f2), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16))) ;
+					x3 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x3, k1k2, 0x11), f3), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32))) ;
+					x4 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x4, k1k2, 0x11), f4), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48))) ;
+				}
+
+				// the four lanes into one, then the 16 byte blocks left
+				x1 = Crc32Fold16(Crc32Fold16(Crc32Fold16(x1, x2, k3k4), x3, k3k4), x4, k3k4) ;
+				for ( ; size >= 16 ; data += 16, size -= 16) {
+					x1 = Crc32Fold16(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), k3k4) ;
+				}
+
+				// 128 bits to 64, then Barrett reduced to 32
+				x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10)) ;
+				x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), k5k0, 0x00), _mm_srli_si128(x1, 4)) ;
+
+				__m128i x = _mm_clmulepi64_si128(_mm_and_si128(x1, low32), poly, 0x10) ;
+				x = _mm_clmulepi64_si128(_mm_and_si128(x, low32), poly, 0x00) ;
+				x1 = _mm_xor_si128(x1, x) ;
+				return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4))) ;
+			}
+		#endif
+
+		// CRC-32 (PNG / zlib polynomial), folded with PCLMULQDQ where the cpu has it and the tail
+		// short of 16 bytes through slicing-by-8.
+		inline uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+			crc = ~crc ;
+
+			#ifdef ZKETCH_PCLMUL
+				if (size >= 64 && g_pclmul_) {
+					const size_t folded = size & ~static_cast<size_t>(15) ;
+					crc = Crc32Fold(crc, data, folded) ;
+					data += folded ;
+					size -= folded ;
+				}
+			#endif
+
+			return ~Crc32Slice8(crc, data, size) ;
+		}
+
+		inline uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size) noexcept {
+			static constexpr uint32_t ___MOD___ = 65521 ;
+			static constexpr size_t ___NMAX___ = 5552 ;
+
+			uint32_t s1 = adler & 0xFFFF ;
+			uint32_t s2 = adler >> 16 ;
+
+			while (size > 0) {
+				size_t n = std::min(size, ___NMAX___) ;
+				size -= n ;
+
+				#ifdef ZKETCH_SSE2
+					size_t blocks = n / 16 ;
+					if (blocks > 0) {
+						const __m128i zero = _mm_setzero_si128() ;
+						const __m128i w_lo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9) ;
+						const __m128i w_hi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1) ;
+						__m128i v_s1 = zero ;
+						__m128i v_prefix = zero ;
+						__m128i v_s2 = zero ;
+
+						for (size_t b = 0 ; b < blocks ; ++b) {
+							__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)) ;
+							v_prefix = _mm_add_epi32(v_prefix, v_s1) ;
+							v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(v, zero)) ;
+							v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), w_lo)) ;
+							v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), w_hi)) ;
+							data += 16 ;
+						}
+
+						alignas(16) uint32_t a1[4] ;
+						alignas(16) uint32_t ap[4] ;
+						alignas(16) uint32_t a2[4] ;
+						_mm_store_si128(reinterpret_cast<__m128i*>(a1), v_s1) ;
+						_mm_store_si128(reinterpret_cast<__m128i*>(ap), v_prefix) ;
+						_mm_store_si128(reinterpret_cast<__m128i*>(a2), v_s2) ;
+
+						// sad leaves its sums in lanes 0 and 2
+						uint64_t sum1 = static_cast<uint64_t>(a1[0]) + a1[2] ;
+						uint64_t prefix = static_cast<uint64_t>(ap[0]) + ap[2] ;
+						uint64_t sum2 = static_cast<uint64_t>(a2[0]) + a2[1] + a2[2] + a2[3] ;
+
+						s2 = static_cast<uint32_t>((s2 + 16 * (blocks * static_cast<uint64_t>(s1) + prefix) + sum2) % ___MOD___) ;
+						s1 = static_cast<uint32_t>((s1 + sum1) % ___MOD___) ;
+						n -= blocks * 16 ;
+					}
+				#endif
+
+				while (n--) {
+					s1 += *data++ ;
+					s2 += s1 ;
+				}
+
+				s1 %= ___MOD___ ;
+				s2 %= ___MOD___ ;
+			}
+
+			return (s2 << 16) | s1 ;
+		}
+
+		// fast 64 bit content hash for caches keyed by pixels or text, not meant to resist attacks.
+		inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0) noexcept {
+			const uint8_t* p = static_cast<const uint8_t*>(data) ;
+			uint64_t hash = seed ^ (size * 0x9E3779B97F4A7C15ull) ;
+			while (size >= 8) {
+				uint64_t word ;
+				memcpy(&word, p, 8) ;
+				hash = (hash ^ word) * 0xFF51AFD7ED558CCDull ;
+				hash ^= hash >> 32 ;
+				p += 8 ;
+				size -= 8 ;
+			}
+
+			uint64_t tail = 0 ;
+			memcpy(&tail, p, size) ;
+			hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ull ;
+			return hash ^ (hash >> 29) ;
+		}
+
+		// ------------------------------ row conversion ------------------------------
+
+		inline void ToArgbRow(const uint8_t* src, ColorFormat format, uint32_t* dst, size_t count) noexcept {
+			if (format == ColorFormat::A8) {
+				// coverage is exported as gray
+				for (size_t i = 0 ; i < count ; ++i) {
+					dst[i] = 0xFF000000u | (src[i] * 0x010101u) ;
+				}
+				return ;
+			}
+
+			pixel::ToArgb(src, format, dst, count, 0xFF000000u) ;
+		}
+
+		inline void ArgbToRgba(const uint32_t* src, uint8_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i keep = _mm_set1_epi32(static_cast<int32_t>(0xFF00FF00u)) ;
+				const __m128i low = _mm_set1_epi32(0xFF) ;
+				for ( ; i + 4 <= count ; i += 4) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) ;
+					__m128i r = _mm_and_si128(_mm_srli_epi32(v, 16), low) ;
+					__m128i b = _mm_slli_epi32(_mm_and_si128(v, low), 16) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_and_si128(v, keep), _mm_or_si128(r, b))) ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				uint32_t p = src[i] ;
+				dst[i * 4 + 0] = static_cast<uint8_t>(p >> 16) ;
+				dst[i * 4 + 1] = static_cast<uint8_t>(p >> 8) ;
+				dst[i * 4 + 2] = static_cast<uint8_t>(p) ;
+				dst[i * 4 + 3] = static_cast<uint8_t>(p >> 24) ;
+			}
+		}
+
+		inline void ArgbToRgb(const uint32_t* src, uint8_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				// swap to R G B A like ArgbToRgba, close the gap left by A in each half, then the gap
+				// between the halves. 16 bytes are stored for 12, the loop stops while that still fits
+				const __m128i keep = _mm_set1_epi32(static_cast<int32_t>(0x0000FF00u)) ;
+				const __m128i low = _mm_set1_epi32(0xFF) ;
+				const __m128i even = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF) ;
+				const __m128i first = _mm_set_epi32(0, 0, 0xFFFF, -1) ;
+				const __m128i second = _mm_set_epi32(0, -1, static_cast<int32_t>(0xFFFF0000u), 0) ;
+				for ( ; i + 6 <= count ; i += 4) {
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) ;
+					const __m128i rgb = _mm_or_si128(_mm_and_si128(v, keep), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), low), _mm_slli_epi32(_mm_and_si128(v, low), 16))) ;
+					const __m128i packed = _mm_or_si128(_mm_and_si128(rgb, even), _mm_srli_epi64(_mm_andnot_si128(even, rgb), 8)) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(_mm_and_si128(packed, first), _mm_and_si128(_mm_srli_si128(packed, 2), second))) ;
+					dst += 12 ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				uint32_t p = src[i] ;
+				dst[0] = static_cast<uint8_t>(p >> 16) ;
+				dst[1] = static_cast<uint8_t>(p >> 8) ;
+				dst[2] = static_cast<uint8_t>(p) ;
+				dst += 3 ;
+			}
+		}
+
+		// ------------------------------ QOI ------------------------------
+
+		static constexpr uint8_t ___QOI_OP_INDEX___ = 0x00 ;
+		static constexpr uint8_t ___QOI_OP_DIFF___ = 0x40 ;
+		static constexpr uint8_t ___QOI_OP_LUMA___ = 0x80 ;
+		static constexpr uint8_t ___QOI_OP_RUN___ = 0xC0 ;
+		static constexpr uint8_t ___QOI_OP_RGB___ = 0xFE ;
+		static constexpr uint8_t ___QOI_OP_RGBA___ = 0xFF ;
+		static constexpr uint8_t ___QOI_MASK___ = 0xC0 ;
+
+		inline constexpr uint32_t QoiHash(uint32_t p) noexcept {
+			return (((p >> 16) & 0xFF) * 3 + ((p >> 8) & 0xFF) * 5 + (p & 0xFF) * 7 + (p >> 24) * 11) & 63 ;
+		}
+
+		// the DIFF or LUMA op that takes prev to p as bytes in the low 16 bits, their count above.
+		// 0 when neither fits and the pixel goes out whole.
+		inline constexpr uint32_t QoiDelta(uint32_t p, uint32_t prev) noexcept {
+			if ((p >> 24) != (prev >> 24)) {
+				return 0 ;
+			}
+
+			const int8_t vr = static_cast<int8_t>(((p >> 16) & 0xFF) - ((prev >> 16) & 0xFF)) ;
+			const int8_t vg = static_cast<int8_t>(((p >> 8) & 0xFF) - ((prev >> 8) & 0xFF)) ;
+			const int8_t vb = static_cast<int8_t>((p & 0xFF) - (prev & 0xFF)) ;
+			const int8_t vg_r = static_cast<int8_t>(vr - vg) ;
+			const int8_t vg_b = static_cast<int8_t>(vb - vg) ;
+
+			if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+				return 0x10000u | static_cast<uint32_t>(___QOI_OP_DIFF___ | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2)) ;
+			}
+			if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+				return 0x20000u | static_cast<uint32_t>(___QOI_OP_LUMA___ | (vg + 32)) | static_cast<uint32_t>(((vg_r + 8) << 4) | (vg_b + 8)) << 8 ;
+			}
+			return 0 ;
+		}
+
+		// QOI state over 0xAARRGGBB words, shared by the image encoder and in-memory canvas compression.
+		class QoiState {
+		private :
+			static constexpr size_t ___CHUNK___ = 64 ;
+
+			uint32_t index_[64] {} ;
+			uint32_t prev_ = 0xFF000000u ;
+			uint32_t run_ = 0 ;
+
+			// hash and delta op of every pixel against the one before it, prev_ before the first. Only
+			// depends on the pixels, so it is worked out ahead for a chunk at a time.
+			void Prepare(const uint32_t* px, size_t count, uint8_t* hash, uint32_t* delta) const noexcept {
+				size_t i = 0 ;
+
+				#ifdef ZKETCH_SSE2
+					const __m128i zero = _mm_setzero_si128() ;
+					const __m128i weights = _mm_setr_epi16(7, 5, 3, 11, 7, 5, 3, 11) ;
+					const __m128i two = _mm_set1_epi8(2) ;
+					const __m128i eight = _mm_set1_epi8(8) ;
+					const __m128i thirty_two = _mm_set1_epi32(32 << 8) ;
+					const __m128i low = _mm_set1_epi32(0xFF) ;
+					const __m128i rgb = _mm_set1_epi32(0x00FFFFFF) ;
+					const __m128i diff_bits = _mm_set1_epi32(0x00FCFCFC) ;
+					const __m128i luma_bits = _mm_set1_epi32(0x00F000F0) ;
+					const __m128i luma_g_bits = _mm_set1_epi32(0xC0 << 8) ;
+					__m128i last = _mm_set1_epi32(static_cast<int32_t>(prev_)) ;
+
+					for ( ; i + 4 <= count ; i += 4) {
+						const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px + i)) ;
+						const __m128i prev = _mm_or_si128(_mm_slli_si128(v, 4), _mm_srli_si128(last, 12)) ;
+						last = v ;
+
+						// b * 7 + g * 5 + r * 3 + a * 11, two halves per pixel summed across
+						const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights) ;
+						const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights) ;
+						const __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)) ;
+						const __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)) ;
+						const __m128i h = _mm_and_si128(_mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd)), _mm_set1_epi32(63)) ;
+						const __m128i h16 = _mm_packs_epi32(h, zero) ;
+						const int32_t h8 = _mm_cvtsi128_si32(_mm_packus_epi16(h16, zero)) ;
+						memcpy(hash + i, &h8, 4) ;
+
+						// per byte deltas, vb vg vr va. DIFF wants vr, vg, vb + 2 in 0..3
+						const __m128i d = _mm_sub_epi8(v, prev) ;
+						const __m128i d2 = _mm_add_epi8(d, two) ;
+						const __m128i same_alpha = _mm_cmpeq_epi32(_mm_andnot_si128(rgb, d), zero) ;
+						const __m128i is_diff = _mm_and_si128(same_alpha, _mm_cmpeq_epi32(_mm_and_si128(d2, diff_bits), zero)) ;
+						const __m128i diff = _mm_or_si128(_mm_set1_epi32(0x10000 | ___QOI_OP_DIFF___), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(d2, 12), _mm_set1_epi32(0x30)), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(d2, 6), _mm_set1_epi32(0x0C)), _mm_and_si128(d2, _mm_set1_epi32(0x03))))) ;
+
+						// LUMA wants vg + 32 in 0..63, vr - vg and vb - vg + 8 in 0..15
+						const __m128i vg = _mm_and_si128(_mm_srli_epi32(d, 8), low) ;
+						const __m128i t = _mm_add_epi8(_mm_sub_epi8(d, _mm_or_si128(vg, _mm_slli_epi32(vg, 16))), eight) ;
+						const __m128i g32 = _mm_add_epi8(d, thirty_two) ;
+						const __m128i is_luma = _mm_and_si128(same_alpha, _mm_cmpeq_epi32(_mm_or_si128(_mm_and_si128(t, luma_bits), _mm_and_si128(g32, luma_g_bits)), zero)) ;
+						const __m128i luma = _mm_or_si128(_mm_set1_epi32(0x20000 | ___QOI_OP_LUMA___), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(g32, 8), _mm_set1_epi32(0x3F)), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(t, 4), _mm_set1_epi32(0xF000)), _mm_and_si128(_mm_slli_epi32(t, 8), _mm_set1_epi32(0x0F00))))) ;
+
+						const __m128i op = _mm_or_si128(_mm_and_si128(is_diff, diff), _mm_andnot_si128(is_diff, _mm_and_si128(is_luma, luma))) ;
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(delta + i), op) ;
+					}
+				#endif
+
+				for ( ; i < count ; ++i) {
+					hash[i] = static_cast<uint8_t>(QoiHash(px[i])) ;
+					delta[i] = QoiDelta(px[i], i ? px[i - 1] : prev_) ;
+				}
+			}
+
+			// how many pixels from px on repeat prev_
+			size_t RunLength(const uint32_t* px, size_t count) const noexcept {
+				size_t n = 0 ;
+
+				#ifdef ZKETCH_SSE2
+					const __m128i prev = _mm_set1_epi32(static_cast<int32_t>(prev_)) ;
+					for ( ; n + 4 <= count ; n += 4) {
+						const uint32_t same = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(px + n)), prev))) ;
+						if (same != 0xFFFF) {
+							return n + static_cast<size_t>(std::countr_one(same)) / 4 ;
+						}
+					}
+				#endif
+
+				while (n < count && px[n] == prev_) {
+					++n ;
+				}
+				return n ;
+			}
+
+			void AddRun(size_t n, uint8_t*& out) noexcept {
+				run_ += static_cast<uint32_t>(n) ;
+				while (run_ >= 62) {
+					*out++ = static_cast<uint8_t>(___QOI_OP_RUN___ | 61) ;
+					run_ -= 62 ;
+				}
+			}
+
+		public :
+			// worst case is 5 bytes per pixel, callers reserve count * 5 + 1.
+			uint8_t* Encode(const uint32_t* px, size_t count, uint8_t* out) noexcept {
+				uint8_t hash[___CHUNK___] ;
+				uint32_t delta[___CHUNK___] ;
+
+				// the chunk worked out ahead starts small after a run and grows while none interrupts it, so
+				// little is spent on pixels a run or an index hit would take anyway
+				size_t chunk = 4 ;
+				size_t i = 0 ;
+				while (i < count) {
+					// flat areas are skipped a vector at a time
+					const size_t run = RunLength(px + i, count - i) ;
+					if (run > 0) {
+						AddRun(run, out) ;
+						i += run ;
+						chunk = 4 ;
+						continue ;
+					}
+
+					const size_t n = std::min(chunk, count - i) ;
+					Prepare(px + i, n, hash, delta) ;
+					size_t k = 0 ;
+					for ( ; k < n ; ++k) {
+						const uint32_t p = px[i + k] ;
+						if (p == prev_) {
+							break ;
+						}
+
+						if (run_ > 0) {
+							*out++ = static_cast<uint8_t>(___QOI_OP_RUN___ | (run_ - 1)) ;
+							run_ = 0 ;
+						}
+
+						const uint32_t h = hash[k] ;
+						const uint32_t before = prev_ ;
+						prev_ = p ;
+						if (index_[h] == p) {
+							*out++ = static_cast<uint8_t>(___QOI_OP_INDEX___ | h) ;
+							continue ;
+						}
+						index_[h] = p ;
+
+						// the output has room for 5 bytes, both op bytes go out and the count moves on
+						if (const uint32_t op = delta[k]) {
+							out[0] = static_cast<uint8_t>(op) ;
+							out[1] = static_cast<uint8_t>(op >> 8) ;
+							out += op >> 16 ;
+						} else if ((p >> 24) == (before >> 24)) {
+							*out++ = ___QOI_OP_RGB___ ;
+							*out++ = static_cast<uint8_t>(p >> 16) ;
+							*out++ = static_cast<uint8_t>(p >> 8) ;
+							*out++ = static_cast<uint8_t>(p) ;
+						} else {
+							*out++ = ___QOI_OP_RGBA___ ;
+							*out++ = static_cast<uint8_t>(p >> 16) ;
+							*out++ = static_cast<uint8_t>(p >> 8) ;
+							*out++ = static_cast<uint8_t>(p) ;
+							*out++ = static_cast<uint8_t>(p >> 24) ;
+						}
+					}
+
+					i += k ;
+					chunk = k == n ? std::min(chunk * 2, ___CHUNK___) : 4 ;
+				}
+
+				return out ;
+			}
+
+			uint8_t* Finish(uint8_t* out) noexcept {
+				if (run_ > 0) {
+					*out++ = static_cast<uint8_t>(___QOI_OP_RUN___ | (run_ - 1)) ;
+					run_ = 0 ;
+				}
+				return out ;
+			}
+
+			// decodes exactly count pixels, returns the end of the consumed input or nullptr when it runs out.
+			const uint8_t* Decode(const uint8_t* in, const uint8_t* end, uint32_t* px, size_t count) noexcept {
+				for (size_t i = 0 ; i < count ; ++i) {
+					if (run_ > 0) {
+						--run_ ;
+						px[i] = prev_ ;
+						continue ;
+					}
+
+					if (in >= end) {
+						return nullptr ;
+					}
+
+					uint8_t op = *in++ ;
+					uint32_t p = prev_ ;
+
+					if (op == ___QOI_OP_RGB___) {
+						if (end - in < 3) {
+							return nullptr ;
+						}
+						p = (p & 0xFF000000u) | (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2] ;
+						in += 3 ;
+					} else if (op == ___QOI_OP_RGBA___) {
+						if (end - in < 4) {
+							return nullptr ;
+						}
+						p = (static_cast<uint32_t>(in[3]) << 24) | (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2] ;
+						in += 4 ;
+					} else if ((op & ___QOI_MASK___) == ___QOI_OP_INDEX___) {
+						p = index_[op] ;
+					} else if ((op & ___QOI_MASK___) == ___QOI_OP_DIFF___) {
+						uint32_t r = (((p >> 16) & 0xFF) + ((op >> 4) & 3) - 2) & 0xFF ;
+						uint32_t g = (((p >> 8) & 0xFF) + ((op >> 2) & 3) - 2) & 0xFF ;
+						uint32_t b = ((p & 0xFF) + (op & 3) - 2) & 0xFF ;
+						p = (p & 0xFF000000u) | (r << 16) | (g << 8) | b ;
+					} else if ((op & ___QOI_MASK___) == ___QOI_OP_LUMA___) {
+						if (in >= end) {
+							return nullptr ;
+						}
+						uint8_t next = *in++ ;
+						int32_t vg = (op & 0x3F) - 32 ;
+						uint32_t r = (((p >> 16) & 0xFF) + vg - 8 + ((next >> 4) & 0x0F)) & 0xFF ;
+						uint32_t g = (((p >> 8) & 0xFF) + vg) & 0xFF ;
+						uint32_t b = ((p & 0xFF) + vg - 8 + (next & 0x0F)) & 0xFF ;
+						p = (p & 0xFF000000u) | (r << 16) | (g << 8) | b ;
+					} else {
+						run_ = op & 0x3F ;
+					}
+
+					index_[QoiHash(p)] = p ;
+					prev_ = p ;
+					px[i] = p ;
+				}
+
+				return in ;
+			}
+		} ;
+
+		// ------------------------------ RLE ------------------------------
+
+		// PackBits style byte runs: n < 128 copies n + 1 literals, n >= 128 repeats the next byte n - 125 times.
+		// worst case is size + size / 128 + 1 bytes.
+		inline uint8_t* RleEncode(const uint8_t* in, size_t size, uint8_t* out) noexcept {
+			size_t i = 0 ;
+			while (i < size) {
+				size_t run = 1 ;
+				while (i + run < size && run < 130 && in[i + run] == in[i]) {
+					++run ;
+				}
+
+				if (run >= 3) {
+					*out++ = static_cast<uint8_t>(run + 125) ;
+					*out++ = in[i] ;
+					i += run ;
+					continue ;
+				}
+
+				size_t start = i ;
+				size_t count = 0 ;
+				while (i < size && count < 128) {
+					if (i + 2 < size && in[i] == in[i + 1] && in[i] == in[i + 2]) {
+						break ;
+					}
+					++i ;
+					++count ;
+				}
+
+				*out++ = static_cast<uint8_t>(count - 1) ;
+				memcpy(out, in + start, count) ;
+				out += count ;
+			}
+
+			return out ;
+		}
+
+		inline bool RleDecode(const uint8_t* in, size_t size, uint8_t* out, size_t out_size) noexcept {
+			const uint8_t* end = in + size ;
+			uint8_t* out_end = out + out_size ;
+
+			while (in < end) {
+				uint8_t n = *in++ ;
+				if (n < 128) {
+					size_t count = static_cast<size_t>(n) + 1 ;
+					if (static_cast<size_t>(end - in) < count || static_cast<size_t>(out_end - out) < count) {
+						return false ;
+					}
+					memcpy(out, in, count) ;
+					in += count ;
+					out += count ;
+				} else {
+					size_t count = static_cast<size_t>(n) - 125 ;
+					if (in >= end || static_cast<size_t>(out_end - out) < count) {
+						return false ;
+					}
+					memset(out, *in++, count) ;
+					out += count ;
+				}
+			}
+
+			return out == out_end ;
+		}
+	}
+
+	// ------------------------------ encoder ------------------------------
+
+	// streaming encoder, feed it rows top to bottom. Output is flushed to the writer in blocks so
+	// the whole image is never held in memory.
+	class ImageEncoder {
+	private :
+		static constexpr size_t ___FLUSH_SIZE___ = 1 << 18 ;
+		static constexpr size_t ___STORED_BLOCK___ = 65535 ;
+
+		ImageWriter* out_ = nullptr ;
+		ImageFormat format_ = ImageFormat::QOI ;
+		ColorFormat source_ = ColorFormat::ARGB ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		uint32_t rows_ = 0 ;
+		uint32_t channels_ = 4 ;
+		bool ok_ = false ;
+
+		std::vector<uint32_t> argb_ ;
+		std::vector<uint8_t> buffer_ ;	// sized once for a flush and a row, rows are encoded straight into it
+		size_t used_ = 0 ;
+		codec::QoiState qoi_ ;
+
+		// png / zlib stream state, the open IDAT chunk is framed in place
+		size_t idat_ = 0 ;
+		bool in_idat_ = false ;
+		uint32_t adler_ = 1 ;
+
+		bool Flush() noexcept {
+			if (used_ > 0) {
+				ok_ = ok_ && out_->Write(buffer_.data(), used_) ;
+				used_ = 0 ;
+			}
+			return ok_ ;
+		}
+
+		uint8_t* Tail() noexcept { return buffer_.data() + used_ ; }
+
+		void Put(const void* data, size_t size) noexcept {
+			if (size > 0) {
+				memcpy(Tail(), data, size) ;
+				used_ += size ;
+			}
+		}
+
+		void PutU32BE(uint32_t v) noexcept {
+			const uint8_t bytes[4] = {static_cast<uint8_t>(v >> 24), static_cast<uint8_t>(v >> 16), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v)} ;
+			Put(bytes, 4) ;
+		}
+
+		void PutChunk(const char* type, const uint8_t* data, size_t size) noexcept {
+			PutU32BE(static_cast<uint32_t>(size)) ;
+			const size_t start = used_ ;
+			Put(type, 4) ;
+			Put(data, size) ;
+			PutU32BE(codec::Crc32(0, buffer_.data() + start, size + 4)) ;
+		}
+
+		// IDAT payload is written where it ends up, the length is filled in and the CRC taken when the
+		// chunk closes before a flush
+		void OpenIdat() noexcept {
+			if (!in_idat_) {
+				idat_ = used_ ;
+				PutU32BE(0) ;
+				Put("IDAT", 4) ;
+				in_idat_ = true ;
+			}
+		}
+
+		void CloseIdat() noexcept {
+			if (!in_idat_) {
+				return ;
+			}
+
+			const size_t size = used_ - idat_ - 8 ;
+			uint8_t* chunk = buffer_.data() + idat_ ;
+			chunk[0] = static_cast<uint8_t>(size >> 24) ;
+			chunk[1] = static_cast<uint8_t>(size >> 16) ;
+			chunk[2] = static_cast<uint8_t>(size >> 8) ;
+			chunk[3] = static_cast<uint8_t>(size) ;
+			PutU32BE(codec::Crc32(0, chunk + 4, size + 4)) ;
+			in_idat_ = false ;
+		}
+
+		const uint32_t* ToArgb(const uint8_t* row) noexcept {
+			if (source_ == ColorFormat::ARGB) {
+				return reinterpret_cast<const uint32_t*>(row) ;
+			}
+			codec::ToArgbRow(row, source_, argb_.data(), width_) ;
+			return argb_.data() ;
+		}
+
+		// packs count pixels from first in the byte layout of PNG / PPM (RGBA, RGB or gray) at the tail
+		void PutPixels(const uint8_t* row, const uint32_t* argb, size_t first, size_t count) noexcept {
+			if (channels_ == 1) {
+				Put(row + first, count) ;
+				return ;
+			}
+
+			if (channels_ == 4) {
+				codec::ArgbToRgba(argb + first, Tail(), count) ;
+			} else {
+				codec::ArgbToRgb(argb + first, Tail(), count) ;
+			}
+			used_ += count * channels_ ;
+		}
+
+		// a stored block per row, split between pixels when the row is wider than a block holds
+		void PutStoredRow(const uint8_t* row) noexcept {
+			OpenIdat() ;
+			const uint32_t* argb = channels_ == 1 ? nullptr : ToArgb(row) ;
+
+			size_t x = 0 ;
+			size_t filter = 1 ;
+			while (filter || x < width_) {
+				const size_t n = std::min<size_t>(width_ - x, (___STORED_BLOCK___ - filter) / channels_) ;
+				const uint32_t len = static_cast<uint32_t>(filter + n * channels_) ;
+				const uint8_t header[5] = {static_cast<uint8_t>(rows_ + 1 == height_ && x + n == width_ ? 1 : 0), static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(~len), static_cast<uint8_t>(~len >> 8)} ;
+				Put(header, 5) ;
+
+				const size_t start = used_ ;
+				if (filter) {
+					buffer_[used_++] = 0 ;	// filter type none
+				}
+				PutPixels(row, argb, x, n) ;
+				adler_ = codec::Adler32(adler_, buffer_.data() + start, used_ - start) ;
+
+				x += n ;
+				filter = 0 ;
+			}
+		}
+
+	public :
+		ImageEncoder() noexcept = default ;
+
+		bool Begin(ImageWriter& out, ImageFormat format, uint32_t width, uint32_t height, ColorFormat source) noexcept {
+			if (width == 0 || height == 0) {
+				return false ;
+			}
+
+			if (source == ColorFormat::A8 && format != ImageFormat::QOI) {
+				channels_ = 1 ;
+			} else if (format == ImageFormat::PPM) {
+				channels_ = 3 ;		// P6 has no alpha
+			} else {
+				channels_ = HasAlpha(source) && source != ColorFormat::A8 ? 4 : 3 ;
+			}
+
+			// a row takes at most 5 bytes a pixel (QOI), stored blocks add 5 bytes per 64 KiB
+			try {
+				buffer_.resize(___FLUSH_SIZE___ + static_cast<size_t>(width) * 5 + 256) ;
+				argb_.assign(source == ColorFormat::ARGB ? 0 : width, 0) ;
+			} catch (...) {
+				return false ;
+			}
+
+			out_ = &out ;
+			format_ = format ;
+			source_ = source ;
+			width_ = width ;
+			height_ = height ;
+			rows_ = 0 ;
+			ok_ = true ;
+			used_ = 0 ;
+			in_idat_ = false ;
+			qoi_ = {} ;
+
+			switch (format) {
+				case ImageFormat::QOI : {
+					Put("qoif", 4) ;
+					PutU32BE(width) ;
+					PutU32BE(height) ;
+					const uint8_t tail[2] = {static_cast<uint8_t>(channels_), 0} ;
+					Put(tail, 2) ;
+					break ;
+				}
+
+				case ImageFormat::PNG : {
+					const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'} ;
+					Put(signature, 8) ;
+
+					const uint8_t ihdr[13] = {
+						static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+						static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+						8, static_cast<uint8_t>(channels_ == 4 ? 6 : channels_ == 3 ? 2 : 0), 0, 0, 0
+					} ;
+					PutChunk("IHDR", ihdr, sizeof(ihdr)) ;
+
+					adler_ = 1 ;
+					OpenIdat() ;
+					const uint8_t zlib[2] = {0x78, 0x01} ;
+					Put(zlib, 2) ;
+					break ;
+				}
+
+				case ImageFormat::PPM : {
+					std::string header ;
+					try {
+						header = (channels_ == 1 ? "P5\n" : "P6\n") + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n" ;
+					} catch (...) {
+						return false ;
+					}
+					Put(header.data(), header.size()) ;
+					break ;
+				}
+			}
+
+			return true ;
+		}
+
+		bool WriteRow(const uint8_t* row) noexcept {
+			if (!ok_ || rows_ >= height_) {
+				return false ;
+			}
+
+			switch (format_) {
+				case ImageFormat::QOI :
+					used_ = static_cast<size_t>(qoi_.Encode(ToArgb(row), width_, Tail()) - buffer_.data()) ;
+					break ;
+
+				case ImageFormat::PNG :
+					PutStoredRow(row) ;
+					break ;
+
+				case ImageFormat::PPM :
+					PutPixels(row, channels_ == 1 ? nullptr : ToArgb(row), 0, width_) ;
+					break ;
+			}
+
+			++rows_ ;
+			if (used_ >= ___FLUSH_SIZE___) {
+				CloseIdat() ;
+				Flush() ;
+			}
+			return ok_ ;
+		}
+
+		bool End() noexcept {
+			if (!ok_ || rows_ != height_) {
+				ok_ = false ;
+				return false ;
+			}
+
+			switch (format_) {
+				case ImageFormat::QOI : {
+					used_ = static_cast<size_t>(qoi_.Finish(Tail()) - buffer_.data()) ;
+					const uint8_t padding[8] = {0, 0, 0, 0, 0, 0, 0, 1} ;
+					Put(padding, 8) ;
+					break ;
+				}
+
+				case ImageFormat::PNG : {
+					OpenIdat() ;
+					PutU32BE(adler_) ;
+					CloseIdat() ;
+					PutChunk("IEND", nullptr, 0) ;
+					break ;
+				}
+
+				case ImageFormat::PPM :
+					break ;
+			}
+
+			Flush() ;
+			out_ = nullptr ;
+			return ok_ ;
+		}
+	} ;
+
+	inline bool EncodeImage(const ImageView& image, ImageWriter& out, ImageFormat format) noexcept {
+		if (!image.IsValid()) {
+			return false ;
+		}
+
+		ImageEncoder encoder ;
+		if (!encoder.Begin(out, format, image.width_, image.height_, image.format_)) {
+			return false ;
+		}
+
+		for (uint32_t y = 0 ; y < image.height_ ; ++y) {
+			if (!encoder.WriteRow(image.GetRow(y))) {
+				return false ;
+			}
+		}
+
+		return encoder.End() ;
+	}
+}
@@ -1,10 +1,22 @@
-<<<<<<< HEAD
 #pragma once
 
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <cerrno>
+#include <cmath>
 #include <limits>
 #include <type_traits>
 #include <utility>
+#include <array>
+#include <vector>
+#include <span>
+#include <bit>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <optional>
 #include <any>
@@ -17,9 +29,11 @@
 #include <string>
 #include <algorithm>
 #include <queue>
+#include <deque>
 #include <set>
 #include <unordered_set>
 #include <unordered_map>
+#include <list>
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -34,32 +48,4 @@ namespace zketch {
 	class Slider ;
 	class Button ;
 	class TextBox ;
-=======
-#pragma once
-
-#include <cstdint>
-#include <limits>
-#include <type_traits>
-#include <utility>
-#include <optional>
-#include <any>
-#include <bitset>
-#include <memory>
-#include <functional>
-#include <algorithm>
-#include <charconv>
-#include <string>
-#include <algorithm>
-#include <queue>
-#include <unordered_map>
-#include <iostream>
-
-namespace zketch {
-	class Window ;
-	class Renderer ;
-	class Drawer ;
-	class Slider ;
-	class Button ;
-	class TextBox ;
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+}
@@ -1,6 +1,9 @@
-<<<<<<< HEAD
 #pragma once
 #include "unit.hpp"
+#include "waitable.hpp"
+#include "mpscring.hpp"
+#include "registry.hpp"
+#include "timerwheel.hpp"
 
 namespace zketch {
 
@@ -12,27 +15,49 @@ namespace zketch {
 		} ;
 	}
 
+	// nanoseconds on the steady clock, what Event timestamps are measured in.
+	inline uint64_t MonotonicTime() noexcept {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) ;
+	}
+
+	// 24 bytes: the type, the state and button of the input, the window as a WindowId, the time and
+	// 8 bytes of payload. Windows and widgets are named by generational ids instead of pointers, an
+	// event outliving its window or widget resolves to null instead of dangling.
 	class Event {
 		friend inline bool PollEvent(Event&) ;
+		friend inline bool PumpEvents(Event&) ;
+		friend class EventSystem ;
 
 	private :
 		EventType type_ = EventType::None ;
-		HWND hwnd_ = nullptr ;
-		uint64_t timestamp_ = 0 ;
+		uint8_t state_ = 0 ;	// KeyState, MouseState, SliderState or ButtonState by type_
+		MouseButton button_ = MouseButton::None ;
+		WindowId window_ = 0 ;
+		uint64_t timestamp_ = 0 ;	// MonotonicTime when the input happened, 0 for an empty event
+
+		static constexpr uint64_t Stamp() noexcept {
+			return std::is_constant_evaluated() ? 0 : MonotonicTime() ;
+		}
+
+		static constexpr WindowId WindowOf(HWND src) noexcept {
+			return std::is_constant_evaluated() ? 0 : WindowRegistry::Acquire(src) ;
+		}
+
+		// window coordinates fit in 16 bits, they come that way in a Win32 lParam
+		static constexpr int16_t Coordinate(int32_t v) noexcept {
+			return static_cast<int16_t>(std::clamp<int32_t>(v, INT16_MIN, INT16_MAX)) ;
+		}
 
 		union data_ {
 			struct empty__ {} empty_ ;
 
 			struct Key__ {
-				KeyState state_ ;
 				uint32_t key_code_ ;
 			} key_ ;
 
 			struct Mouse__ {
-				MouseState state_ ;
-				MouseButton button_ ;
-				int32_t x_ ;
-				int32_t y_ ;
+				int16_t x_ ;
+				int16_t y_ ;
 				int32_t value_ ;
 			} mouse_ ;
 
@@ -42,32 +67,37 @@ namespace zketch {
 			} resize_ ;
 
 			struct Slider__ {
-				SliderState state_ ;
 				float value_ ;
-				Slider* slider_ptr_ ;
+				WidgetId widget_ ;
 			} slider_ ;
 
 			struct Button__ {
-				ButtonState state_ ;
-				Button* button_ptr_ ;
+				WidgetId widget_ ;
 			} button_ ;
+
+			struct Timer__ {
+				uint32_t slot_ ;
+				uint32_t generation_ ;
+			} timer_ ;
 		} data_ ;
 
 		// -------------- Construtor  --------------
 
 		constexpr Event(HWND src_, EventType type_) {
 			this->type_ = type_ ;
-			if ((IsMouseEvent() || IsKeyEvent() || IsResizeEvent() || IsSliderEvent())) {
+			if ((IsMouseEvent() || IsKeyEvent() || IsResizeEvent() || IsSliderEvent() || IsTimerEvent())) {
 				throw error_handler::invalid_event_type() ;
 			}
 			data_.empty_ = {} ;
-			hwnd_ = src_ ;
+			window_ = WindowOf(src_) ;
+			timestamp_ = Stamp() ;
 		}
 
 		constexpr Event(HWND src, const Size& size) noexcept {
 			type_ = EventType::Resize ;
 			data_.resize_ = {size.x, size.y} ;
-			hwnd_ = src ;
+			window_ = WindowOf(src) ;
+			timestamp_ = Stamp() ;
 		}
 
 		constexpr Event(HWND src, KeyState state, uint32_t key_code) {
@@ -76,9 +106,10 @@ namespace zketch {
 				throw error_handler::invalid_event_type() ;
 			}
 
-			data_.key_.state_ = state ;
+			state_ = static_cast<uint8_t>(state) ;
 			data_.key_.key_code_ = key_code ;
-			hwnd_ = src ;
+			window_ = WindowOf(src) ;
+			timestamp_ = Stamp() ;
 		}
 
 		constexpr Event(HWND src, MouseButton button, MouseState state, const Point& pos, int32_t value = 0) {
@@ -86,85 +117,100 @@ namespace zketch {
 			if (!IsMouseEvent()) {
 				throw error_handler::invalid_event_type() ;
 			}
-		
-			if (state == MouseState::None) {
-				data_.mouse_ = {
-					state, 
-					MouseButton::None,
-					pos.x, 
-					pos.y, 
-					0
-				} ;
-			} else if (state == MouseState::Wheel) {
-				data_.mouse_ = {
-					state, 
-					MouseButton::None,
-					pos.x, 
-					pos.y, 
-					value
-				} ;
-			} else {
-				data_.mouse_ = {
-					state, 
-					button, 
-					pos.x, 
-					pos.y,
-					value
-				} ;
-			}
-			hwnd_ = src ;
+
+			state_ = static_cast<uint8_t>(state) ;
+			button_ = state == MouseState::None || state == MouseState::Wheel ? MouseButton::None : button ;
+			data_.mouse_ = {
+				Coordinate(pos.x),
+				Coordinate(pos.y),
+				state == MouseState::None ? 0 : value
+			} ;
+			window_ = WindowOf(src) ;
+			timestamp_ = Stamp() ;
 		}
 
-		constexpr Event(SliderState state, float value, Slider* slider_ptr = nullptr) noexcept {
+		constexpr Event(SliderState state, float value, WidgetId slider) noexcept {
 			type_ = EventType::Slider ;
+			state_ = static_cast<uint8_t>(state) ;
 			data_.slider_ = {
-				state, 
 				value, 
-				slider_ptr
+				slider
 			} ;
-			hwnd_ = nullptr ;
+			timestamp_ = Stamp() ;
 		}
 
-		constexpr Event(ButtonState state, Button* button_ptr = nullptr) noexcept {
+		constexpr Event(ButtonState state, WidgetId button) noexcept {
 			type_ = EventType::Button ;
+			state_ = static_cast<uint8_t>(state) ;
 			data_.button_ = {
-				state,
-				button_ptr
+				button
 			} ;
+			timestamp_ = Stamp() ;
 		}
 
+		constexpr Event(HWND src, TimerHandle timer) noexcept {
+			type_ = EventType::Timer ;
+			data_.timer_ = {
+				timer.slot_,
+				timer.generation_
+			} ;
+			window_ = WindowOf(src) ;
+			timestamp_ = Stamp() ;
+		}
+
+		#ifdef ZKETCH_WIN32
 		static constexpr Event CreateEventFromMSG(const MSG& msg) noexcept {
+			Event e = Event::CreateCommonEvent(msg.hwnd, EventType::None) ;
 			switch (msg.message) {
 				case WM_KEYDOWN : 
-					return Event::CreateKeyEvent(msg.hwnd, KeyState::Down, msg.wParam) ; 
+					e = Event::CreateKeyEvent(msg.hwnd, KeyState::Down, msg.wParam) ;
+					break ;
 				case WM_KEYUP : 
-					return Event::CreateKeyEvent(msg.hwnd, KeyState::Up, msg.wParam) ; 
+					e = Event::CreateKeyEvent(msg.hwnd, KeyState::Up, msg.wParam) ;
+					break ;
 				case WM_MOUSEWHEEL :
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::None, MouseState::Wheel, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}, GET_WHEEL_DELTA_WPARAM(msg.wParam)) ;
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::None, MouseState::Wheel, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}, GET_WHEEL_DELTA_WPARAM(msg.wParam)) ;
+					break ;
 				case WM_MOUSEMOVE : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::None, MouseState::None, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::None, MouseState::None, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_LBUTTONDOWN : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Left, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::Left, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_RBUTTONDOWN : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Right, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::Right, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_MBUTTONDOWN :
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Middle, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::Middle, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_LBUTTONUP : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Left, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::Left, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_RBUTTONUP : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Right, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::Right, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_MBUTTONUP :
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Middle, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
+					e = Event::CreateMouseEvent(msg.hwnd, MouseButton::Middle, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ;
+					break ;
 				case WM_QUIT : 
-					return Event::CreateCommonEvent(nullptr, EventType::Quit) ;
+					e = Event::CreateCommonEvent(nullptr, EventType::Quit) ;
+					break ;
 				case WM_CLOSE : 
-					return Event::CreateCommonEvent(msg.hwnd, EventType::Close) ;
+					e = Event::CreateCommonEvent(msg.hwnd, EventType::Close) ;
+					break ;
+			}
+
+			// msg.time is GetTickCount when the message was posted, the event is as old as the message
+			if (!std::is_constant_evaluated() && e.timestamp_ != 0) {
+				const uint64_t age = static_cast<DWORD>(GetTickCount() - msg.time) ;
+				e.timestamp_ -= age < 10000 ? age * 1000000 : 0 ;
 			}
-			return Event::CreateCommonEvent(msg.hwnd, EventType::None) ;
+			return e ;
 		}
+		#endif
 
 	public :
-		constexpr Event() noexcept : type_(EventType::None), hwnd_(nullptr) {
+		constexpr Event() noexcept : type_(EventType::None), window_(0) {
 			data_.empty_ = {} ;
 		}
 
@@ -188,12 +234,17 @@ namespace zketch {
 			return Event(src, size) ;
 		}
 
-		static constexpr Event CreateSliderEvent(SliderState state, float value, Slider* slider_ptr = nullptr) {
-			return Event(state, value, slider_ptr) ;
+		// widget is the WidgetId of the sender, see Widget::GetWidgetId.
+		static constexpr Event CreateSliderEvent(SliderState state, float value, WidgetId slider = 0) {
+			return Event(state, value, slider) ;
 		}
 
-		static constexpr Event CreateButtonEvent(ButtonState state, Button* button_ptr = nullptr) {
-			return Event(state, button_ptr) ;
+		static constexpr Event CreateButtonEvent(ButtonState state, WidgetId button = 0) {
+			return Event(state, button) ;
+		}
+
+		static constexpr Event CreateTimerEvent(HWND src, TimerHandle timer) noexcept {
+			return Event(src, timer) ;
 		}
 
 		// --------------------------- Getter ---------------------------
@@ -203,15 +254,15 @@ namespace zketch {
 		}
 
 		constexpr KeyState GetKeyState() const noexcept {
-			return data_.key_.state_ ;
+			return static_cast<KeyState>(state_) ;
 		}
 
 		constexpr MouseState GetMouseState() const noexcept {
-			return data_.mouse_.state_ ;
+			return static_cast<MouseState>(state_) ;
 		}
 
 		constexpr MouseButton GetMouseButton() const noexcept {
-			return data_.mouse_.button_ ;
+			return button_ ;
 		}
 
 		constexpr int32_t GetMouseWheelValue() const noexcept {
@@ -227,23 +278,35 @@ namespace zketch {
 		}
 
 		constexpr SliderState GetSliderState() const noexcept {
-			return data_.slider_.state_ ;
+			return static_cast<SliderState>(state_) ;
 		}
 
 		constexpr float GetSliderValue() const noexcept {
 			return data_.slider_.value_ ;
 		}
 
-		constexpr Slider* GetSliderAddress() const noexcept {
-			return data_.slider_.slider_ptr_ ;
+		// null once the slider is destroyed.
+		Slider* GetSliderAddress() const noexcept {
+			return static_cast<Slider*>(WidgetRegistry::Resolve(data_.slider_.widget_)) ;
 		}
 
 		constexpr ButtonState GetButtonState() const noexcept {
-			return data_.button_.state_ ;
+			return static_cast<ButtonState>(state_) ;
 		}
 
-		constexpr Button* GetButtonAddress() const noexcept {
-			return data_.button_.button_ptr_ ;
+		// null once the button is destroyed.
+		Button* GetButtonAddress() const noexcept {
+			return static_cast<Button*>(WidgetRegistry::Resolve(data_.button_.widget_)) ;
+		}
+
+		// the timer that fired, see EventSystem::AddTimerEvent.
+		constexpr TimerHandle GetTimer() const noexcept {
+			return {data_.timer_.slot_, data_.timer_.generation_} ;
+		}
+
+		// the sender of a Slider or Button event, 0 for the others.
+		constexpr WidgetId GetWidgetId() const noexcept {
+			return IsSliderEvent() ? data_.slider_.widget_ : IsButtonEvent() ? data_.button_.widget_ : 0 ;
 		}
 
 		constexpr operator EventType() const noexcept {
@@ -254,12 +317,18 @@ namespace zketch {
 			return type_ ;
 		}
 
+		// MonotonicTime of the input. A coalesced event keeps the time of the oldest one it replaced.
 		uint64_t GetTimeStamp() const noexcept {
 			return timestamp_ ;
 		}
 
+		// null once the window is destroyed.
 		HWND GetHandle() const noexcept {
-			return hwnd_ ;
+			return WindowRegistry::Resolve(window_) ;
+		}
+
+		constexpr WindowId GetWindowId() const noexcept {
+			return window_ ;
 		}
 
 		// --------------------------- State queries ---------------------------
@@ -283,535 +352,839 @@ namespace zketch {
 		constexpr bool IsButtonEvent() const noexcept {
 			return (type_ == EventType::Button) ;
 		}
+
+		constexpr bool IsTimerEvent() const noexcept {
+			return (type_ == EventType::Timer) ;
+		}
+	} ;
+
+	static_assert(sizeof(Event) == 24, "Event grew past 24 bytes") ;
+
+	// a set of event types, for draining only some of them.
+	enum class EventMask : uint32_t {
+		None	= 0,
+		Quit	= 1 << static_cast<uint8_t>(EventType::Quit),
+		Close	= 1 << static_cast<uint8_t>(EventType::Close),
+		Key		= 1 << static_cast<uint8_t>(EventType::Key),
+		Mouse	= 1 << static_cast<uint8_t>(EventType::Mouse),
+		Resize	= 1 << static_cast<uint8_t>(EventType::Resize),
+		Slider	= 1 << static_cast<uint8_t>(EventType::Slider),
+		Button	= 1 << static_cast<uint8_t>(EventType::Button),
+		Timer	= 1 << static_cast<uint8_t>(EventType::Timer),
+		All		= 0xFFFFFFFF
 	} ;
 
+	constexpr EventMask operator|(EventMask a, EventMask b) noexcept { return static_cast<EventMask>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b)) ; }
+	constexpr bool operator&(EventMask mask, EventType type) noexcept { return (static_cast<uint32_t>(mask) >> static_cast<uint8_t>(type)) & 1 ; }
+
+	// what PushEvent does with a full queue.
+	enum class EventOverflow : uint8_t {
+		DropNewest,	// the event pushed is dropped and counted, the default
+		Block		// the pusher waits for the loop to make room, the loop's own thread still drops
+	} ;
+
+	// events can be pushed from any thread. Polling, peeking, clearing and the pumps belong to the
+	// thread running the event loop, the first one to call Init or poll, other threads get nothing.
+	//
+	// the queue is a bounded lock-free ring, pushing never takes a lock. Coalesced events sit in a
+	// small table of latest values, the ring only holds their place in line.
+	//
+	// DrainEvents and ForEachEvent take everything pending in one pass. Events their mask leaves out
+	// wait in order on the loop thread's side and come out first the next time.
+	//
+	// with motion coalescing on, a mouse move pushed right behind a queued move of the same window
+	// replaces it, wheel steps add up the same way. Anything queued in between starts a new one, so
+	// a click never moves relative to the moves around it.
+	//
+	// timers live on a TimerWheel of the loop thread, Pump fires the due ones. A loop asleep in
+	// WaitEvent or an idle FrameScheduler only wakes for the next one, however many are pending.
 	class EventSystem {
 	private :
-		static inline std::queue<Event> g_events_ ;
+		static constexpr size_t ___QUEUE_SIZE___ = 4096 ;
+		static constexpr size_t ___LATEST_SLOTS___ = 32 ;
+		static constexpr uint8_t ___NO_SLOT___ = 0xFF ;
+		static constexpr size_t ___MAX_SAMPLES___ = 1024 ;	// per merged event, a longer run starts a new one
+
+		struct Queued {
+			Event event_ ;
+			uint8_t latest_ ;	// ___NO_SLOT___, or the event is the one in g_latest_[latest_] when popped
+		} ;
+
+		// a coalesced event waiting in the ring, guarded by its own spin flag: producers hold it for a copy.
+		struct Latest {
+			std::atomic_flag lock_ ;
+			bool used_ ;	// zero initialized with the table
+			bool motion_ ;	// merged by motion coalescing, keeps samples_
+			size_t position_ ;	// of its marker in the ring
+			Event event_ ;
+			std::vector<Event> samples_ ;	// every event merged into event_, oldest first
+
+			void Lock() noexcept {
+				while (lock_.test_and_set(std::memory_order_acquire)) {
+					std::this_thread::yield() ;
+				}
+			}
+
+			void Unlock() noexcept { lock_.clear(std::memory_order_release) ; }
+		} ;
+
+		static inline MpscRing<Queued, ___QUEUE_SIZE___> g_events_ ;
+		static inline std::array<Latest, ___LATEST_SLOTS___> g_latest_ {} ;
+		static inline std::atomic<EventOverflow> g_overflow_ {EventOverflow::DropNewest} ;
+		static inline std::atomic<uint64_t> g_dropped_ {0} ;
+		static inline std::atomic<bool> g_coalesce_motion_ {false} ;
+		static inline std::atomic<uint8_t> g_last_motion_ {___NO_SLOT___} ;
+		static inline std::vector<Event> g_samples_ ;	// loop thread only, behind the last polled event
+		static inline std::vector<Event> g_held_ ;		// loop thread only, left out by a mask, from g_held_head_ on
+		static inline size_t g_held_head_ = 0 ;
+		static inline std::atomic<std::thread::id> g_owner_ {} ;
 		static inline bool event_was_initialized_ = false ;
+		static inline std::vector<void(*)()> g_pumps_ ;
+		static inline std::vector<std::pair<void(*)(const Event&, void*), void*>> g_poll_hooks_ ;
+		static inline TimerWheel g_timers_ ;	// loop thread only
+
+		struct Source {
+			WaitSource source_ ;
+			std::function<void(WaitSource, SourceEvent)> callback_ ;
+			bool removed_ = false ;	// removed while dispatching, erased once that is over
+		} ;
 
-	public :
-		EventSystem() = delete ;
-		EventSystem(const EventSystem&) = delete ;
-		EventSystem& operator=(const EventSystem&) = delete ;
-		EventSystem(EventSystem&&) = delete ;
-		EventSystem& operator=(EventSystem&&) = delete ;
+		static inline std::vector<std::unique_ptr<Source>> g_sources_ ;
+		static inline bool g_dispatching_ = false ;
 
-		static void Init() noexcept {
-			if (!event_was_initialized_) {
-				event_was_initialized_ = true ;
+		static bool Enqueue(const Queued& q, size_t* position = nullptr) noexcept {
+			while (!g_events_.TryPush(q, position)) {
+				// the loop's thread waiting on itself would never wake
+				if (g_overflow_.load(std::memory_order_relaxed) == EventOverflow::Block && g_owner_.load() != std::this_thread::get_id()) {
+					GetMainWakeSignal().Notify() ;
+					std::this_thread::yield() ;
+					continue ;
+				}
+
+				g_dropped_.fetch_add(1, std::memory_order_relaxed) ;
 
 				#ifdef EVENTSYSTEM_DEBUG
-					logger::info("EventSystem::Initialize - Initialized!.") ;
+					logger::warning("EventSystem::PushEvent - Queue is full, event dropped.") ;
 				#endif
 
-				return ;
+				return false ;
 			}
-			logger::info("EventSystem::Initialize - Event system was initialized.") ;
-		}
 
-		static void PushEvent(const Event& e) noexcept {
-			g_events_.push(e) ;
+			GetMainWakeSignal().Notify() ;
+			return true ;
 		}
 
-		static bool PollEvent(Event& e) noexcept {
-			if (g_events_.empty()) { 
+		// the event q stands for, a coalesced one's slot is freed when take is set.
+		static Event Resolve(const Queued& q, bool take) noexcept {
+			if (q.latest_ == ___NO_SLOT___) {
+				return q.event_ ;
+			}
 
-				#ifdef EVENTSYSTEM_DEBUG
-					logger::info("EventSystem::PollEvent - Event is empty.") ;
-				#endif
+			Latest& latest = g_latest_[q.latest_] ;
+			latest.Lock() ;
+			const Event e = latest.event_ ;
+			if (take && latest.used_ && latest.motion_) {
+				// hands the samples over and gets the last batch's storage back
+				g_samples_.swap(latest.samples_) ;
+			}
+			latest.used_ = latest.used_ && !take ;
+			latest.Unlock() ;
+			return e ;
+		}
+
+		static bool IsMotion(const Event& e) noexcept {
+			return e.IsMouseEvent() && (e.GetMouseState() == MouseState::None || e.GetMouseState() == MouseState::Wheel) ;
+		}
+
+		// takes a free slot of the latest table for e and queues its marker. ___NO_SLOT___ when every
+		// slot is waiting, queued tells whether the overflow policy let the marker in.
+		static uint8_t ClaimLatest(const Event& e, bool motion, bool& queued) noexcept {
+			for (size_t i = 0 ; i < g_latest_.size() ; ++i) {
+				Latest& latest = g_latest_[i] ;
+				latest.Lock() ;
+				const bool claimed = !latest.used_ ;
+				if (claimed) {
+					latest.used_ = true ;
+					latest.motion_ = motion ;
+					latest.position_ = SIZE_MAX ;
+					latest.event_ = e ;
+					latest.samples_.clear() ;
+				}
+				latest.Unlock() ;
+
+				if (!claimed) {
+					continue ;
+				}
+
+				size_t position = 0 ;
+				queued = Enqueue({e, static_cast<uint8_t>(i)}, &position) ;
+
+				latest.Lock() ;
+				if (!queued) {
+					latest.used_ = false ;
+				} else if (latest.used_) {
+					latest.position_ = position ;
+				}
+				latest.Unlock() ;
+				return static_cast<uint8_t>(i) ;
+			}
+
+			return ___NO_SLOT___ ;
+		}
+
+		// merges e into the last queued move or wheel step when nothing was queued after it.
+		static bool CoalesceMotion(const Event& e) noexcept {
+			const uint8_t last = g_last_motion_.load(std::memory_order_relaxed) ;
+			if (last != ___NO_SLOT___) {
+				Latest& latest = g_latest_[last] ;
+				latest.Lock() ;
+				const bool merge = latest.used_ && latest.motion_ && latest.samples_.size() < ___MAX_SAMPLES___ &&
+					latest.event_.window_ == e.window_ && latest.event_.GetMouseState() == e.GetMouseState() &&
+					latest.position_ + 1 == g_events_.GetTail() ;
+
+				if (merge) {
+					try {
+						if (latest.samples_.empty()) {
+							latest.samples_.push_back(latest.event_) ;
+						}
+						latest.samples_.push_back(e) ;
+					} catch (...) {}	// the merged event still goes out, only the samples are short
+
+					const Event merged = latest.event_ ;
+					latest.event_ = e ;
+					latest.event_.timestamp_ = merged.timestamp_ ;
+					if (e.GetMouseState() == MouseState::Wheel) {
+						latest.event_.data_.mouse_.value_ += merged.data_.mouse_.value_ ;
+					}
+				}
+				latest.Unlock() ;
+
+				if (merge) {
+					return true ;
+				}
+			}
 
-				return false ; 
+			bool queued = false ;
+			const uint8_t slot = ClaimLatest(e, true, queued) ;
+			if (slot == ___NO_SLOT___) {
+				return Enqueue({e, ___NO_SLOT___}) ;
 			}
 
-            e = g_events_.front() ;
-            g_events_.pop() ;
-            return true ;
+			if (queued) {
+				g_last_motion_.store(slot, std::memory_order_relaxed) ;
+			}
+			return queued ;
 		}
 
-		static bool PeekEvent(Event& e) noexcept {
-			if (g_events_.empty()) {
-				return false ;
+		static void Deliver(const Event& e) noexcept {
+			for (size_t i = 0 ; i < g_poll_hooks_.size() ; ++i) {
+				g_poll_hooks_[i].first(e, g_poll_hooks_[i].second) ;
 			}
+		}
 
-			e = g_events_.front() ;
-			return true ;
+		// hands up to limit events in mask to take, oldest first, and holds the others back. Only what
+		// was queued when it started is looked at, events take pushes meanwhile wait for the next sweep.
+		template <typename Fn>
+		static size_t Sweep(EventMask mask, size_t limit, Fn&& take) noexcept {
+			size_t taken = 0 ;
+			g_samples_.clear() ;
+
+			if (g_held_head_ < g_held_.size()) {
+				if (mask == EventMask::All) {
+					while (taken < limit && g_held_head_ < g_held_.size()) {
+						const Event& e = g_held_[g_held_head_++] ;
+						Deliver(e) ;
+						take(e) ;
+						++taken ;
+					}
+				} else {
+					// stable compaction, what stays keeps its order
+					size_t kept = g_held_head_ ;
+					for (size_t i = g_held_head_ ; i < g_held_.size() ; ++i) {
+						if (taken < limit && (mask & g_held_[i].GetEventType())) {
+							Deliver(g_held_[i]) ;
+							take(g_held_[i]) ;
+							++taken ;
+						} else {
+							g_held_[kept++] = g_held_[i] ;
+						}
+					}
+					g_held_.resize(kept) ;
+				}
+
+				if (g_held_head_ == g_held_.size()) {
+					g_held_.clear() ;
+					g_held_head_ = 0 ;
+				}
+			}
+
+			Queued q ;
+			for (size_t n = g_events_.GetSize() ; taken < limit && n != 0 && g_events_.TryPop(q) ; --n) {
+				g_samples_.clear() ;
+				const Event e = Resolve(q, true) ;
+				if (mask & e.GetEventType()) {
+					Deliver(e) ;
+					take(e) ;
+					++taken ;
+					continue ;
+				}
+
+				try {
+					g_held_.push_back(e) ;
+				} catch (...) {
+					g_dropped_.fetch_add(1, std::memory_order_relaxed) ;
+				}
+			}
+
+			return taken ;
 		}
 
-		static void Clear() noexcept {
-			while (!g_events_.empty()) {
-				g_events_.pop() ;
+		static bool CheckOwner(const char* caller) noexcept {
+			if (IsOwnerThread()) {
+				return true ;
 			}
 
 			#ifdef EVENTSYSTEM_DEBUG
-				logger::info("EventSystem::Clear - Event cleared!") ;
+				logger::error(caller, " - Called from a thread that doesn't own the event loop.") ;
+			#else
+				(void)caller ;
 			#endif
 
+			return false ;
 		}
-	} ;
 
-	constexpr std::string DescribeKeyState(KeyState state) noexcept {
-		switch (state) {
-			case KeyState::None : return "None" ;
-			case KeyState::Up : return "Up" ;
-			case KeyState::Down : return "Down" ;
-			default : return "Undefined" ;
-		}
-		return "Undefined" ;
-	}
+	public :
+		EventSystem() = delete ;
+		EventSystem(const EventSystem&) = delete ;
+		EventSystem& operator=(const EventSystem&) = delete ;
+		EventSystem(EventSystem&&) = delete ;
+		EventSystem& operator=(EventSystem&&) = delete ;
 
-	constexpr std::string DescribeMouseState(MouseState state) noexcept {
-		switch (state) {
-			case MouseState::None : return "None" ;
-			case MouseState::Up : return "Up" ;
-			case MouseState::Down : return "Down" ;
-			case MouseState::Wheel : return "Wheel" ;
-			default : return "Undefined" ;
+		// claims the event loop for the calling thread if no thread owns it yet.
+		static bool IsOwnerThread() noexcept {
+			std::thread::id none {} ;
+			const std::thread::id self = std::this_thread::get_id() ;
+			return g_owner_.compare_exchange_strong(none, self) || none == self ;
 		}
-		return "Undefined" ;
-	}
 
-	constexpr std::string DescribeMouseButton(MouseButton button) noexcept {
-		switch (button) {
-			case MouseButton::None : return "None" ;
-			case MouseButton::Left : return "Left" ;
-			case MouseButton::Right : return "Right" ;
-			case MouseButton::Middle : return "Middle" ;
-			default : return "Undefined" ;
-		}
-		return "Undefined" ;
-	}
+		static void Init() noexcept {
+			if (!CheckOwner("EventSystem::Init")) {
+				return ;
+			}
 
-	constexpr std::string DescribeSliderState(SliderState state) noexcept {
-		switch (state) {
-			case SliderState::None : return "None" ;
-			case SliderState::Start : return "Start" ;
-			case SliderState::End : return "End" ;
-			case SliderState::Changed : return "Changed" ;
-			case SliderState::Hover : return "Hover" ;
-			default : return "Undefined" ;
-		}
-		return "Undefined" ;
-	}
+			if (!event_was_initialized_) {
+				event_was_initialized_ = true ;
 
-	constexpr std::string DescribeButtonState(ButtonState state) noexcept {
-		switch (state) {
-			case ButtonState::None : return "None" ;
-			case ButtonState::Press : return "Press" ;
-			case ButtonState::Release : return "Release" ;
-			case ButtonState::Hover : return "Hover" ;
-			default : return "Undefined" ;
-		}
-		return "Undefined" ;
-	}
+				#ifdef EVENTSYSTEM_DEBUG
+					logger::info("EventSystem::Initialize - Initialized!.") ;
+				#endif
 
-	inline bool PollEvent(Event& e) {
-		if (EventSystem::PollEvent(e)) {
-			return true ;
+				return ;
+			}
+			logger::info("EventSystem::Initialize - Event system was initialized.") ;
 		}
 
-		MSG msg{};
-		while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
-			if (msg.message == WM_QUIT) {
-				
-				#ifdef POLLEVENT_DEBUG
-					logger::info("PollEvent - WM_QUIT received via PeekMessage.") ;
-				#endif
-
-				e = Event::CreateCommonEvent(nullptr, EventType::Quit) ;
-				return true ;
+		// any thread, false when the queue was full and the overflow policy dropped e.
+		static bool PushEvent(const Event& e) noexcept {
+			if (IsMotion(e) && g_coalesce_motion_.load(std::memory_order_relaxed)) {
+				return CoalesceMotion(e) ;
 			}
 
-			Event ecvt = Event::CreateEventFromMSG(msg) ;
+			return Enqueue({e, ___NO_SLOT___}) ;
+		}
+
+		// for events where only the latest value matters (Resize): overwrites the one still queued
+		// for the same window and type, which keeps its place in line, pushes e otherwise.
+		static bool CoalesceEvent(const Event& e) noexcept {
+			for (auto& latest : g_latest_) {
+				latest.Lock() ;
+				const bool same = latest.used_ && !latest.motion_ && latest.event_.GetEventType() == e.GetEventType() && latest.event_.window_ == e.window_ ;
+				if (same) {
+					const uint64_t since = latest.event_.timestamp_ ;
+					latest.event_ = e ;
+					latest.event_.timestamp_ = since ;
+				}
+				latest.Unlock() ;
+
+				if (same) {
+					return true ;
+				}
+			}
 
-			if (ecvt != EventType::None) {
-				EventSystem::PushEvent(ecvt) ;
+			bool queued = false ;
+			if (ClaimLatest(e, false, queued) != ___NO_SLOT___) {
+				return queued ;
 			}
 
-			TranslateMessage(&msg) ;
-			DispatchMessage(&msg) ;
+			// every slot is waiting, e just queues
+			return Enqueue({e, ___NO_SLOT___}) ;
 		}
 
-		return EventSystem::PollEvent(e) ;
-	}
-
-=======
-#pragma once
-
-#include "unit.hpp"
-
-namespace zketch {
-
-	namespace error_handler {
-		struct invalid_event_type {
-			const char* what() const noexcept {
-				return "invalid event type" ;
+		static bool PollEvent(Event& e) noexcept {
+			if (!CheckOwner("EventSystem::PollEvent")) {
+				return false ;
 			}
-		} ;
-	}
 
-	class Event {
-	private :
-		EventType type_ = EventType::None ;
-		HWND hwnd_ = nullptr ;
-		uint64_t timestamp_ = 0 ;
+			if (Sweep(EventMask::All, 1, [&](const Event& taken) { e = taken ; }) == 0) {
 
-		union data_ {
-			struct empty__ {} empty_ ;
-			struct Key__ {
-				KeyState state_ ;
-				uint32_t key_code_ ;
-			} key_ ;
-			struct Mouse__ {
-				MouseState state_ ;
-				MouseButton button_ ;
-				int32_t x_ ;
-				int32_t y_ ;
-				int32_t value_ ;
-			} mouse_ ;
-			struct Resize__ {
-				uint32_t width_ ;
-				uint32_t height_ ;
-			} resize_ ;
-			struct Slider__ {
-				SliderState state_ ;
-				float value_ ;
-				Slider* slider_ptr_ ;
-			} slider_ ;
-			struct Button__ {
-				ButtonState state_ ;
-				Button* button_ptr_ ;
-			} button_ ;
-		} data_ ;
+				#ifdef EVENTSYSTEM_DEBUG
+					logger::info("EventSystem::PollEvent - Event is empty.") ;
+				#endif
 
-		// -------------- Construtor  --------------
+				return false ;
+			}
+			return true ;
+		}
 
-		constexpr Event(HWND src, KeyState state, uint32_t key_code) {
-			type_ = EventType::Key ;
-			if (!IsKeyEvent()) {
-				throw error_handler::invalid_event_type() ;
+		// copies up to out.size() pending events in mask into out and returns how many, one owner
+		// check and one pass for the lot. Coalesced events come out merged, without samples: use
+		// ForEachEvent for those.
+		static size_t DrainEvents(std::span<Event> out, EventMask mask = EventMask::All) noexcept {
+			if (out.empty() || !CheckOwner("EventSystem::DrainEvents")) {
+				return 0 ;
 			}
 
-			data_.key_.state_ = state ;
-			data_.key_.key_code_ = key_code ;
-			hwnd_ = src ;
+			Event* next = out.data() ;
+			const size_t taken = Sweep(mask, out.size(), [&](const Event& e) { *next++ = e ; }) ;
+			g_samples_.clear() ;
+			return taken ;
 		}
 
-		constexpr Event(HWND src, const Size& size) noexcept {
-			type_ = EventType::Resize ;
-			data_.resize_ = {size.x, size.y} ;
-			hwnd_ = src ;
+		// calls visitor(const Event&) for every pending event in mask and returns how many. Coalesced
+		// samples of the event being visited are in GetCoalescedSamples.
+		template <typename Fn>
+		static size_t ForEachEvent(Fn&& visitor, EventMask mask = EventMask::All) noexcept {
+			if (!CheckOwner("EventSystem::ForEachEvent")) {
+				return 0 ;
+			}
+
+			return Sweep(mask, SIZE_MAX, visitor) ;
 		}
 
-		constexpr Event(HWND src, MouseButton button, MouseState state, const Point& pos, int32_t value = 0) {
-			type_ = EventType::Mouse ;
-			if (!IsMouseEvent()) {
-				throw error_handler::invalid_event_type() ;
+		// hook sees every event PollEvent hands out, before the caller does. For tracing, not for
+		// handling events: it can't consume them and must not poll.
+		static bool AddPollHook(void (*hook)(const Event&, void*), void* user) noexcept {
+			if (!CheckOwner("EventSystem::AddPollHook")) {
+				return false ;
 			}
-		
-			if (state == MouseState::None) {
-				data_.mouse_ = {
-					state, 
-					MouseButton::None, // ignore to MouseButton::None
-					pos.x, 
-					pos.y, 
-					0
-				} ;
-			} else if (state == MouseState::Wheel) {
-				data_.mouse_ = {
-					state, 
-					MouseButton::None, // ignore to MouseButton::None
-					pos.x, 
-					pos.y, 
-					value
-				} ;
-			} else {
-				data_.mouse_ = {
-					state, 
-					button, 
-					pos.x, 
-					pos.y,
-					value
-				} ;
+
+			try {
+				g_poll_hooks_.emplace_back(hook, user) ;
+			} catch (...) {
+				return false ;
 			}
-			hwnd_ = src ;
+			return true ;
 		}
 
-		constexpr Event(SliderState state, float value, Slider* slider_ptr = nullptr) noexcept {
-			type_ = EventType::Slider ;
-			data_.slider_ = {
-				state, 
-				value, 
-				slider_ptr
-			} ;
-			hwnd_ = nullptr ;
-		}
+		static void RemovePollHook(void (*hook)(const Event&, void*), void* user) noexcept {
+			if (!CheckOwner("EventSystem::RemovePollHook")) {
+				return ;
+			}
 
-		Event(ButtonState state, Button* button_ptr = nullptr) noexcept {
-			type_ = EventType::Button ;
-			data_.button_ = {
-				state,
-				button_ptr
-			} ;
+			g_poll_hooks_.erase(std::remove(g_poll_hooks_.begin(), g_poll_hooks_.end(), std::make_pair(hook, user)), g_poll_hooks_.end()) ;
 		}
 
-		constexpr Event(HWND src_, EventType type_) {
-			this->type_ = type_ ;
-			if ((IsMouseEvent() || IsKeyEvent() || IsResizeEvent() || IsSliderEvent())) {
-				throw error_handler::invalid_event_type() ;
+		// off by default. Turning it off leaves what was merged so far in place.
+		static void SetMotionCoalescing(bool enable) noexcept { g_coalesce_motion_.store(enable, std::memory_order_relaxed) ; }
+		static bool GetMotionCoalescing() noexcept { return g_coalesce_motion_.load(std::memory_order_relaxed) ; }
+
+		// the raw moves or wheel steps merged into the event PollEvent returned last or ForEachEvent is
+		// visiting, oldest first, for code that wants the full resolution. Empty when it merged nothing,
+		// after DrainEvents, and for an event a mask held back. Valid until the next poll.
+		static std::span<const Event> GetCoalescedSamples() noexcept {
+			if (!CheckOwner("EventSystem::GetCoalescedSamples")) {
+				return {} ;
 			}
-			data_.empty_ = {} ;
-			hwnd_ = src_ ;
-		}
 
-	public :
-		constexpr Event() noexcept : type_(EventType::None), hwnd_(nullptr) {
-			data_.empty_ = {} ;
+			return g_samples_ ;
 		}
 
-		constexpr bool IsKeyEvent() const noexcept {
-			return (type_ == EventType::Key) ;
-		}
+		// native sources without a Win32 message queue (X11) register a pump, PollEvent runs them
+		// once the queue is empty.
+		static void AddPump(void (*pump)()) noexcept {
+			if (!CheckOwner("EventSystem::AddPump")) {
+				return ;
+			}
 
-		constexpr bool IsMouseEvent() const noexcept {
-			return (type_ == EventType::Mouse) ;
+			try {
+				g_pumps_.push_back(pump) ;
+			} catch (...) {}
 		}
 
-		constexpr bool IsResizeEvent() const noexcept {
-			return (type_ == EventType::Resize) ;
-		}
+		static void RemovePump(void (*pump)()) noexcept {
+			if (!CheckOwner("EventSystem::RemovePump")) {
+				return ;
+			}
 
-		constexpr bool IsSliderEvent() const noexcept {
-			return (type_ == EventType::Slider) ;
+			g_pumps_.erase(std::remove(g_pumps_.begin(), g_pumps_.end(), pump), g_pumps_.end()) ;
 		}
 
-		constexpr bool IsButtonEvent() const noexcept {
-			return (type_ == EventType::Button) ;
-		}
+		static void Pump() noexcept {
+			if (!CheckOwner("EventSystem::Pump")) {
+				return ;
+			}
 
-		static Event CreateNormalEvent() noexcept {
-			return Event(nullptr, EventType::None) ;
+			DispatchSources() ;
+			g_timers_.Advance(MonotonicTime()) ;
+			for (auto pump : g_pumps_) {
+				pump() ;
+			}
 		}
 
-		static Event CreateNormalEvent(HWND src, EventType type) noexcept {
-			return Event(src, type) ;
-		}
+		// fds on Linux, waitable handles on Win32. The main WakeSignal watches source, so a loop asleep
+		// in FrameScheduler wakes when it is ready, and PollEvent calls callback on the loop thread. Level
+		// triggered: a callback that leaves data unread is called again.
+		static bool AddSource(WaitSource source, std::function<void(WaitSource, SourceEvent)> callback, SourceEvent events = SourceEvent::Readable) noexcept {
+			if (!CheckOwner("EventSystem::AddSource")) {
+				return false ;
+			}
 
-		static Event CreateKeyEvent(HWND src, KeyState state, uint32_t key_code) noexcept {
-			return Event(src, state, key_code) ;
-		}
+			for (const auto& s : g_sources_) {
+				if (!s->removed_ && s->source_ == source) {
 
-		static Event CreateMouseEvent(HWND src, MouseButton button, MouseState state, const Point& pos, int32_t value = 0) noexcept {
-			return Event(src, button, state, pos, value) ;
-		}
+					#ifdef EVENTSYSTEM_DEBUG
+						logger::error("EventSystem::AddSource - Source is already registered.") ;
+					#endif
 
-		static Event CreateResizeEvent(HWND src, const Point& size) noexcept {
-			return Event(src, size) ;
-		}
+					return false ;
+				}
+			}
 
-		static Event CreateSliderEvent(SliderState state, float value, Slider* slider_ptr = nullptr) {
-			return Event(state, value, slider_ptr) ;
-		}
+			try {
+				g_sources_.push_back(std::make_unique<Source>(Source{source, std::move(callback)})) ;
+			} catch (...) {
+				return false ;
+			}
 
-		static Event CreateButtonEvent(ButtonState state, Button* button_ptr = nullptr) {
-			return Event(state, button_ptr) ;
-		}
+			if (!GetMainWakeSignal().AddWatch(source, events)) {
 
-		static Event FromMSG(const MSG& msg) noexcept {
-			switch (msg.message) {
-				case WM_KEYDOWN : 
-					return Event::CreateKeyEvent(msg.hwnd, KeyState::Down, msg.wParam) ; 
-				case WM_KEYUP : 
-					return Event::CreateKeyEvent(msg.hwnd, KeyState::Up, msg.wParam) ; 
-				case WM_MOUSEWHEEL :
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::None, MouseState::Wheel, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}, GET_WHEEL_DELTA_WPARAM(msg.wParam)) ;
-				case WM_MOUSEMOVE : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::None, MouseState::None, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_LBUTTONDOWN : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Left, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_RBUTTONDOWN : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Right, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_MBUTTONDOWN :
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Middle, MouseState::Down, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_LBUTTONUP : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Left, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_RBUTTONUP : 
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Right, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_MBUTTONUP :
-					return Event::CreateMouseEvent(msg.hwnd, MouseButton::Middle, MouseState::Up, {GET_X_LPARAM(msg.lParam), GET_Y_LPARAM(msg.lParam)}) ; 
-				case WM_QUIT : 
-					return Event::CreateNormalEvent(nullptr, EventType::Quit) ;
-				case WM_CLOSE : 
-					return Event::CreateNormalEvent(msg.hwnd, EventType::Close) ;
+				#ifdef EVENTSYSTEM_DEBUG
+					logger::error("EventSystem::AddSource - Failed to watch source.") ;
+				#endif
+
+				g_sources_.pop_back() ;
+				return false ;
 			}
-			return Event::CreateNormalEvent(msg.hwnd, EventType::None) ;
-		}
 
-		constexpr uint32_t GetKeyCode() const noexcept { 
-			return data_.key_.key_code_ ; 
+			return true ;
 		}
 
-		constexpr KeyState GetKeyState() const noexcept {
-			return data_.key_.state_ ;
-		}
+		// safe from inside a callback, the source's own included.
+		static void RemoveSource(WaitSource source) noexcept {
+			if (!CheckOwner("EventSystem::RemoveSource")) {
+				return ;
+			}
 
-		constexpr MouseState GetMouseState() const noexcept {
-			return data_.mouse_.state_ ;
+			for (auto it = g_sources_.begin() ; it != g_sources_.end() ; ++it) {
+				if (!(*it)->removed_ && (*it)->source_ == source) {
+					GetMainWakeSignal().RemoveWatch(source) ;
+					if (g_dispatching_) {
+						(*it)->removed_ = true ;
+					} else {
+						g_sources_.erase(it) ;
+					}
+					return ;
+				}
+			}
 		}
 
-		constexpr MouseButton GetMouseButton() const noexcept {
-			return data_.mouse_.button_ ;
-		}
+		// runs the callbacks of ready sources, Pump() does it before the pumps.
+		static void DispatchSources() noexcept {
+			if (g_sources_.empty() || g_dispatching_ || !CheckOwner("EventSystem::DispatchSources")) {
+				return ;
+			}
 
-		constexpr int32_t GetMouseWheelValue() const noexcept {
-			return data_.mouse_.value_ ;
-		}
+			g_dispatching_ = true ;
+			GetMainWakeSignal().ForEachReady([](WaitSource source, SourceEvent events) {
+				// by index, callbacks may add sources
+				for (size_t i = 0 ; i < g_sources_.size() ; ++i) {
+					Source& s = *g_sources_[i] ;
+					if (!s.removed_ && s.source_ == source) {
+						s.callback_(source, events) ;
+						return ;
+					}
+				}
+			}) ;
+			g_dispatching_ = false ;
+
+			g_sources_.erase(std::remove_if(g_sources_.begin(), g_sources_.end(), [](const auto& s) { return s->removed_ ; }), g_sources_.end()) ;
+		}
+
+		// calls callback from Pump delay from now, then every interval when it isn't zero. Loop thread,
+		// other threads post to a FrameScheduler instead.
+		static TimerHandle AddTimer(std::chrono::nanoseconds delay, TimerWheel::Callback callback, void* user = nullptr, std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero()) noexcept {
+			if (!CheckOwner("EventSystem::AddTimer")) {
+				return {} ;
+			}
 
-		constexpr Point GetMousePosition() const noexcept {
-			return {data_.mouse_.x_, data_.mouse_.y_} ;
+			return g_timers_.Add(delay, callback, user, interval) ;
 		}
 
-		constexpr Point_<uint32_t> GetResizedSize() const noexcept { 
-			return {data_.resize_.width_, data_.resize_.height_} ; 
+		// the same, delivered as a Timer event of window instead of a call.
+		static TimerHandle AddTimerEvent(HWND window, std::chrono::nanoseconds delay, std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero()) noexcept {
+			return AddTimer(delay, [](TimerHandle timer, void* window) {
+				PushEvent(Event::CreateTimerEvent(static_cast<HWND>(window), timer)) ;
+			}, window, interval) ;
 		}
 
-		constexpr SliderState GetSliderState() const noexcept {
-			return data_.slider_.state_ ;
-		}
+		// false when timer already fired or was removed. A Timer event already queued still comes out.
+		static bool RemoveTimer(TimerHandle timer) noexcept {
+			if (!CheckOwner("EventSystem::RemoveTimer")) {
+				return false ;
+			}
 
-		constexpr float GetSliderValue() const noexcept {
-			return data_.slider_.value_ ;
+			return g_timers_.Remove(timer) ;
 		}
 
-		constexpr Slider* GetSliderAddress() const noexcept {
-			return data_.slider_.slider_ptr_ ;
+		static bool IsTimerActive(TimerHandle timer) noexcept {
+			return CheckOwner("EventSystem::IsTimerActive") && g_timers_.IsActive(timer) ;
 		}
 
-		constexpr ButtonState GetButtonState() const noexcept {
-			return data_.button_.state_ ;
+		static size_t GetTimerCount() noexcept {
+			return CheckOwner("EventSystem::GetTimerCount") ? g_timers_.GetCount() : 0 ;
 		}
 
-		constexpr Button* GetButtonAddress() const noexcept {
-			return data_.button_.button_ptr_ ;
-		}
+		// the MonotonicTime the loop has to be awake by for the next timer, nullopt without timers or
+		// on another thread. Never claims the loop for the caller.
+		static std::optional<uint64_t> GetNextTimerDeadline() noexcept {
+			if (g_owner_.load() != std::this_thread::get_id()) {
+				return std::nullopt ;
+			}
 
-		constexpr operator EventType() const noexcept {
-			return type_ ;
+			return g_timers_.GetNextDeadline() ;
 		}
 
-		constexpr EventType GetEventType() const noexcept {
-			return type_ ;
-		}
+		// queues e behind everything pending, on the loop thread's side where no overflow policy drops
+		// it. For an event the loop already holds and couldn't hand out, the native Quit.
+		static void Defer(const Event& e) noexcept {
+			if (!CheckOwner("EventSystem::Defer")) {
+				return ;
+			}
 
-		uint64_t GetTimeStamp() const noexcept {
-			return timestamp_ ;
+			try {
+				// what is in the ring was queued first
+				Queued q ;
+				for (size_t n = g_events_.GetSize() ; n != 0 && g_events_.TryPop(q) ; --n) {
+					g_held_.push_back(Resolve(q, true)) ;
+				}
+				g_held_.push_back(e) ;
+			} catch (...) {
+				g_dropped_.fetch_add(1, std::memory_order_relaxed) ;
+			}
+			g_samples_.clear() ;
 		}
 
-		HWND GetHandle() const noexcept {
-			return hwnd_ ;
-		}
-	} ;
+		static bool PeekEvent(Event& e) noexcept {
+			if (!CheckOwner("EventSystem::PeekEvent")) {
+				return false ;
+			}
 
-	class EventSystem {
-	private :
-		static inline std::queue<Event> g_events_ ;
-		static inline bool event_was_initialized_ = false ;
+			if (g_held_head_ < g_held_.size()) {
+				e = g_held_[g_held_head_] ;
+				return true ;
+			}
 
-	public :
-		static void Initialize() noexcept {
-			if (!event_was_initialized_) {
-				event_was_initialized_ = true ;
-				logger::info("EventSystem initialized!.") ;
-				return ;
+			const Queued* q = g_events_.Peek() ;
+			if (!q) {
+				return false ;
 			}
-			logger::info("EventSystem was initialized.") ;
-		}
 
-		static void PushEvent(const Event& e) noexcept {
-			g_events_.push(e) ;
+			e = Resolve(*q, false) ;
+			return true ;
 		}
 
-		static bool PoolEvent(Event& e) noexcept {
-			if (g_events_.empty()) { 
-				return false ; 
-			}
+		static void SetOverflowPolicy(EventOverflow policy) noexcept { g_overflow_.store(policy, std::memory_order_relaxed) ; }
+		static EventOverflow GetOverflowPolicy() noexcept { return g_overflow_.load(std::memory_order_relaxed) ; }
 
-            e = g_events_.front() ;
-            g_events_.pop() ;
-            return true ;
-		}
+		// events the overflow policy dropped since the start.
+		static uint64_t GetDroppedCount() noexcept { return g_dropped_.load(std::memory_order_relaxed) ; }
 
-		static bool PeekEvent(Event& e) noexcept {
-			if (g_events_.empty()) {
+		// a snapshot of how many events are waiting in the queue, what a mask held back isn't counted.
+		static size_t GetQueuedCount() noexcept { return g_events_.GetSize() ; }
+
+		// on the loop thread, whether an event is waiting to be taken: one in the queue or one a mask or
+		// a bounded drain left behind. Those were announced once, a wait that starts after them doesn't
+		// see them. False on another thread, never claims the loop for the caller.
+		static bool HasPendingEvents() noexcept {
+			if (g_owner_.load() != std::this_thread::get_id()) {
 				return false ;
 			}
 
-			e = g_events_.front() ;
-			return true ;
+			return g_held_head_ < g_held_.size() || g_events_.GetSize() != 0 ;
 		}
+		static constexpr size_t GetQueueCapacity() noexcept { return ___QUEUE_SIZE___ ; }
 
 		static void Clear() noexcept {
-			while (!g_events_.empty()) {
-				g_events_.pop() ;
+			if (!CheckOwner("EventSystem::Clear")) {
+				return ;
+			}
+
+			Queued q ;
+			while (g_events_.TryPop(q)) {
+				Resolve(q, true) ;
 			}
+			g_samples_.clear() ;
+			g_held_.clear() ;
+			g_held_head_ = 0 ;
+
+			#ifdef EVENTSYSTEM_DEBUG
+				logger::info("EventSystem::Clear - Event cleared!") ;
+			#endif
+
 		}
 	} ;
 
-	static constexpr std::string DescMouseState(MouseState state) noexcept {
+	constexpr std::string DescribeKeyState(KeyState state) noexcept {
+		switch (state) {
+			case KeyState::None : return "None" ;
+			case KeyState::Up : return "Up" ;
+			case KeyState::Down : return "Down" ;
+			default : return "Undefined" ;
+		}
+		return "Undefined" ;
+	}
+
+	constexpr std::string DescribeMouseState(MouseState state) noexcept {
 		switch (state) {
-			case MouseState::Up : return "UP" ;
-			case MouseState::Down : return "DOWN" ;
-			case MouseState::Wheel : return "WHEEL" ;
-			case MouseState::None : return "NONE" ;
+			case MouseState::None : return "None" ;
+			case MouseState::Up : return "Up" ;
+			case MouseState::Down : return "Down" ;
+			case MouseState::Wheel : return "Wheel" ;
 			default : return "Undefined" ;
 		}
 		return "Undefined" ;
 	}
 
-	static constexpr std::string DescMouseButton(MouseButton button) noexcept {
+	constexpr std::string DescribeMouseButton(MouseButton button) noexcept {
 		switch (button) {
-			case MouseButton::Left : return "LEFT" ;
+			case MouseButton::None : return "None" ;
+			case MouseButton::Left : return "Left" ;
 			case MouseButton::Right : return "Right" ;
-			case MouseButton::Middle : return "MIDDLE" ;
-			case MouseButton::None : return "NONE" ;
+			case MouseButton::Middle : return "Middle" ;
 			default : return "Undefined" ;
 		}
 		return "Undefined" ;
 	}
 
-	constexpr bool operator==(uint32_t a, KeyCode b) noexcept {
-		return a == static_cast<uint32_t>(b) ;
+	constexpr std::string DescribeSliderState(SliderState state) noexcept {
+		switch (state) {
+			case SliderState::None : return "None" ;
+			case SliderState::Start : return "Start" ;
+			case SliderState::End : return "End" ;
+			case SliderState::Changed : return "Changed" ;
+			case SliderState::Hover : return "Hover" ;
+			default : return "Undefined" ;
+		}
+		return "Undefined" ;
 	}
 
-	constexpr bool operator!=(uint32_t a, KeyCode b) noexcept {
-		return a != static_cast<uint32_t>(b) ;
+	constexpr std::string DescribeButtonState(ButtonState state) noexcept {
+		switch (state) {
+			case ButtonState::None : return "None" ;
+			case ButtonState::Press : return "Press" ;
+			case ButtonState::Release : return "Release" ;
+			case ButtonState::Hover : return "Hover" ;
+			default : return "Undefined" ;
+		}
+		return "Undefined" ;
 	}
 
-	static inline bool PollEvent(Event& e) {
-		if (EventSystem::PoolEvent(e)) {
+	// runs the pumps and moves the native message queue into EventSystem. True when WM_QUIT came
+	// out of it, quit holds the Quit event then and the rest of the native queue waits.
+	inline bool PumpEvents(Event& quit) {
+		EventSystem::Pump() ;
+
+		#ifdef ZKETCH_WIN32
+			MSG msg{};
+			while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+				if (msg.message == WM_QUIT) {
+				
+					#ifdef POLLEVENT_DEBUG
+						logger::info("PollEvent - WM_QUIT received via PeekMessage.") ;
+					#endif
+
+					quit = Event::CreateCommonEvent(nullptr, EventType::Quit) ;
+					return true ;
+				}
+
+				Event ecvt = Event::CreateEventFromMSG(msg) ;
+
+				if (ecvt != EventType::None) {
+					EventSystem::PushEvent(ecvt) ;
+				}
+
+				TranslateMessage(&msg) ;
+				DispatchMessage(&msg) ;
+			}
+		#else
+			(void)quit ;
+		#endif
+
+		return false ;
+	}
+
+	inline bool PollEvent(Event& e) {
+		if (EventSystem::PollEvent(e)) {
 			return true ;
 		}
 
-		MSG msg{};
-		while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
-			if (msg.message == WM_QUIT) {
-				logger::info("PollEvent: WM_QUIT received via PeekMessage.") ;
-				e = Event::CreateNormalEvent(nullptr, EventType::Quit) ;
-				return true ;
-			}
+		if (PumpEvents(e)) {
+			return true ;
+		}
 
-			Event ecvt = Event::FromMSG(msg) ;
+		return EventSystem::PollEvent(e) ;
+	}
 
-			if (ecvt != EventType::None) {
-				EventSystem::PushEvent(ecvt) ;
+	// pumps once, then takes up to out.size() pending events in mask. A Quit from the native queue
+	// comes last.
+	inline size_t DrainEvents(std::span<Event> out, EventMask mask = EventMask::All) {
+		Event quit ;
+		const bool quitting = PumpEvents(quit) ;
+		size_t n = EventSystem::DrainEvents(out, mask) ;
+		if (quitting) {
+			if (n < out.size() && (mask & EventType::Quit)) {
+				out[n++] = quit ;
+			} else {
+				EventSystem::Defer(quit) ;
 			}
+		}
+		return n ;
+	}
+
+	// pumps once, then visits every pending event in mask.
+	template <typename Fn>
+	inline size_t ForEachEvent(Fn&& visitor, EventMask mask = EventMask::All) {
+		Event quit ;
+		const bool quitting = PumpEvents(quit) ;
+		size_t n = EventSystem::ForEachEvent(visitor, mask) ;
+		if (quitting) {
+			if (mask & EventType::Quit) {
+				visitor(static_cast<const Event&>(quit)) ;
+				++n ;
+			} else {
+				EventSystem::Defer(quit) ;
+			}
+		}
+		return n ;
+	}
+
+	// PollEvent for loops without a FrameScheduler: sleeps until input, a pushed event, a ready
+	// source, a due timer or the timeout. A source callback or timer that pushes nothing still ends
+	// the wait, false then.
+	inline bool WaitEvent(Event& e, std::optional<std::chrono::nanoseconds> timeout = std::nullopt) {
+		if (PollEvent(e)) {
+			return true ;
+		}
 
-			TranslateMessage(&msg) ;
-			DispatchMessage(&msg) ;
+		// no later than the next timer, Pump fires it
+		if (const auto deadline = EventSystem::GetNextTimerDeadline()) {
+			const uint64_t now = MonotonicTime() ;
+			const std::chrono::nanoseconds left(*deadline > now ? *deadline - now : 0) ;
+			timeout = timeout ? std::min(*timeout, left) : left ;
 		}
 
-		return EventSystem::PoolEvent(e) ;
+		GetMainWakeSignal().Wait(timeout) ;
+		return PollEvent(e) ;
 	}
 
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+}
@@ -0,0 +1,467 @@
+#pragma once
+#include "event.hpp"
+#include "capture.hpp"
+
+namespace zketch {
+
+	// ------------------------------ event log ------------------------------
+	//
+	// header		"ZKEVTLOG" u32 version, u32 reserved
+	// record		u8 tag, varint zigzag ns since the previous record, then by tag:
+	//	Frame		nothing, the events before it were handled in one frame
+	//	Close, Quit	varint window
+	//	Key			varint window, u8 state, varint key code
+	//	Mouse		varint window, u8 button, u8 state, varint zigzag dx, varint zigzag dy from the
+	//				previous mouse record, varint zigzag value
+	//	Resize		varint window, varint width, varint height
+	//
+	// windows are numbered 1, 2... in the order they first show up, 0 is no window. Slider and Button
+	// events aren't recorded, widgets push them again when they see the input replayed.
+
+	struct EventLog {
+		static constexpr char ___MAGIC___[8] = {'Z', 'K', 'E', 'V', 'T', 'L', 'O', 'G'} ;
+		static constexpr uint32_t ___VERSION___ = 1 ;
+		static constexpr size_t ___HEADER_SIZE___ = 16 ;
+		static constexpr uint8_t ___FRAME___ = 0xFF ;	// other tags are the EventType
+
+		static constexpr uint64_t ZigZag(int64_t v) noexcept { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63) ; }
+		static constexpr int64_t UnZigZag(uint64_t v) noexcept { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1) ; }
+	} ;
+
+	struct EventLogStats {
+		uint64_t events_ = 0 ;
+		uint64_t frames_ = 0 ;
+		uint64_t bytes_ = 0 ;
+	} ;
+
+	// records what PollEvent hands out into an event log. Call MarkFrame once per frame, after the
+	// frame's events were handled. Open and Close on the event loop's thread.
+	class EventLogWriter {
+	private :
+		static constexpr size_t ___FLUSH___ = 1 << 16 ;
+
+		std::ofstream file_ ;
+		std::vector<uint8_t> buffer_ ;
+		std::vector<HWND> windows_ ;	// window n is windows_[n - 1]
+		uint64_t last_ = 0 ;			// time of the previous record
+		Point mouse_ {} ;
+		EventLogStats stats_ ;
+		bool open_ = false ;
+
+		static void OnPoll(const Event& e, void* self) noexcept {
+			static_cast<EventLogWriter*>(self)->Record(e) ;
+		}
+
+		void PutVarint(uint64_t v) {
+			uint8_t bytes[10] ;
+			buffer_.insert(buffer_.end(), bytes, codec::PutVarint(bytes, v)) ;
+		}
+
+		void PutHead(uint8_t tag, uint64_t time) {
+			buffer_.push_back(tag) ;
+			PutVarint(EventLog::ZigZag(static_cast<int64_t>(time - last_))) ;
+			last_ = time ;
+		}
+
+		uint64_t WindowIndex(HWND handle) {
+			if (!handle) {
+				return 0 ;
+			}
+
+			for (size_t i = 0 ; i < windows_.size() ; ++i) {
+				if (windows_[i] == handle) {
+					return i + 1 ;
+				}
+			}
+
+			windows_.push_back(handle) ;
+			return windows_.size() ;
+		}
+
+		bool Flush() noexcept {
+			if (buffer_.empty()) {
+				return true ;
+			}
+
+			file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size())) ;
+			stats_.bytes_ += buffer_.size() ;
+			buffer_.clear() ;
+			return static_cast<bool>(file_) ;
+		}
+
+	public :
+		EventLogWriter() noexcept = default ;
+		EventLogWriter(const EventLogWriter&) = delete ;
+		EventLogWriter& operator=(const EventLogWriter&) = delete ;
+
+		~EventLogWriter() noexcept {
+			Close() ;
+		}
+
+		bool Open(const std::string& path) noexcept {
+			Close() ;
+
+			file_ = std::ofstream(path, std::ios::binary | std::ios::trunc) ;
+			uint8_t head[EventLog::___HEADER_SIZE___] = {} ;
+			memcpy(head, EventLog::___MAGIC___, 8) ;
+			codec::PutU32LE(head + 8, EventLog::___VERSION___) ;
+			if (!file_ || !file_.write(reinterpret_cast<const char*>(head), sizeof(head)) || !EventSystem::AddPollHook(&EventLogWriter::OnPoll, this)) {
+
+				#ifdef EVENTLOG_DEBUG
+					logger::error("EventLogWriter::Open - Failed to open ", path) ;
+				#endif
+
+				file_.close() ;
+				return false ;
+			}
+
+			windows_.clear() ;
+			last_ = MonotonicTime() ;
+			mouse_ = {} ;
+			stats_ = {} ;
+			stats_.bytes_ = sizeof(head) ;
+			open_ = true ;
+			return true ;
+		}
+
+		void Close() noexcept {
+			if (!open_) {
+				return ;
+			}
+
+			EventSystem::RemovePollHook(&EventLogWriter::OnPoll, this) ;
+			Flush() ;
+			file_.close() ;
+			open_ = false ;
+		}
+
+		// events that aren't polled can be recorded by hand, the open writer sees polled ones already.
+		void Record(const Event& e) noexcept {
+			const EventType type = e.GetEventType() ;
+			if (!open_ || type == EventType::None || type == EventType::Slider || type == EventType::Button || type == EventType::Timer) {
+				return ;
+			}
+
+			try {
+				// coalesced events carry the time of the oldest input, the log stays in poll order
+				PutHead(static_cast<uint8_t>(type), std::max(e.GetTimeStamp(), last_)) ;
+				PutVarint(WindowIndex(e.GetHandle())) ;
+
+				switch (type) {
+					case EventType::Key :
+						buffer_.push_back(static_cast<uint8_t>(e.GetKeyState())) ;
+						PutVarint(e.GetKeyCode()) ;
+						break ;
+					case EventType::Mouse : {
+						const Point pos = e.GetMousePosition() ;
+						buffer_.push_back(static_cast<uint8_t>(e.GetMouseButton())) ;
+						buffer_.push_back(static_cast<uint8_t>(e.GetMouseState())) ;
+						PutVarint(EventLog::ZigZag(static_cast<int64_t>(pos.x) - mouse_.x)) ;
+						PutVarint(EventLog::ZigZag(static_cast<int64_t>(pos.y) - mouse_.y)) ;
+						PutVarint(EventLog::ZigZag(e.GetMouseWheelValue())) ;
+						mouse_ = pos ;
+						break ;
+					}
+					case EventType::Resize :
+						PutVarint(e.GetResizedSize().x) ;
+						PutVarint(e.GetResizedSize().y) ;
+						break ;
+					default :
+						break ;
+				}
+			} catch (...) {
+				return ;
+			}
+
+			++stats_.events_ ;
+		}
+
+		// ends the frame the events recorded since the last mark were handled in.
+		void MarkFrame() noexcept {
+			if (!open_) {
+				return ;
+			}
+
+			try {
+				PutHead(EventLog::___FRAME___, MonotonicTime()) ;
+			} catch (...) {
+				return ;
+			}
+
+			++stats_.frames_ ;
+			if (buffer_.size() >= ___FLUSH___) {
+				Flush() ;
+			}
+		}
+
+		bool IsOpen() const noexcept { return open_ ; }
+		const EventLogStats& GetStats() const noexcept { return stats_ ; }
+	} ;
+
+	enum class ReplayPace : uint8_t {
+		Recorded,	// every frame starts as long after the first as it did when recorded
+		Unpaced		// frames follow each other as fast as the loop runs
+	} ;
+
+	struct ReplayStats {
+		uint64_t frames_ = 0 ;
+		uint64_t events_ = 0 ;
+		uint64_t dropped_ = 0 ;			// the queue was full
+		std::chrono::nanoseconds p50_ {} ;	// of the frame times
+		std::chrono::nanoseconds p99_ {} ;
+		std::chrono::nanoseconds max_ {} ;
+		std::chrono::nanoseconds total_ {} ;	// their sum, the wall time of a paced replay is longer
+	} ;
+
+	// feeds an event log back through EventSystem a frame at a time. Every NextFrame pushes exactly the
+	// events the recorded frame handled, so each frame gets the same input whatever the pace and the
+	// frame times of two builds can be compared one by one.
+	//
+	//	while (player.NextFrame()) {
+	//		while (PollEvent(e)) { ... }
+	//		... draw and present ...
+	//	}
+	class EventLogPlayer {
+	private :
+		std::vector<uint8_t> log_ ;
+		std::vector<HWND> targets_ ;	// window n replays into targets_[n - 1]
+		HWND target_ = nullptr ;		// windows without a target of their own
+		size_t position_ = 0 ;
+		ReplayPace pace_ = ReplayPace::Unpaced ;
+		uint64_t recorded_ = 0 ;		// record time where the position is, ns since recording started
+		Point mouse_ {} ;
+		std::chrono::steady_clock::time_point start_ {} ;
+		std::chrono::steady_clock::time_point frame_start_ {} ;
+		std::vector<std::chrono::nanoseconds> frame_times_ ;
+		uint64_t events_ = 0 ;
+		uint64_t dropped_ = 0 ;
+		bool started_ = false ;
+		bool in_frame_ = false ;	// NextFrame handed a frame out that hasn't ended yet
+		bool corrupt_ = false ;
+
+		bool GetVarint(uint64_t& v) noexcept {
+			const uint8_t* begin = log_.data() + position_ ;
+			const uint8_t* next = codec::GetVarint(begin, log_.data() + log_.size(), v) ;
+			if (!next) {
+				return false ;
+			}
+			position_ += static_cast<size_t>(next - begin) ;
+			return true ;
+		}
+
+		bool GetByte(uint8_t& v) noexcept {
+			if (position_ >= log_.size()) {
+				return false ;
+			}
+			v = log_[position_++] ;
+			return true ;
+		}
+
+		HWND Target(uint64_t window) const noexcept {
+			if (window == 0) {
+				return nullptr ;
+			}
+			return window <= targets_.size() && targets_[window - 1] ? targets_[window - 1] : target_ ;
+		}
+
+		// one record at position_, false at the end or when it doesn't parse. frame tells a frame mark.
+		bool ReadRecord(bool& frame) noexcept {
+			uint8_t tag ;
+			uint64_t delta ;
+			uint64_t window ;
+			if (!GetByte(tag) || !GetVarint(delta)) {
+				return false ;
+			}
+
+			recorded_ += static_cast<uint64_t>(EventLog::UnZigZag(delta)) ;
+			frame = tag == EventLog::___FRAME___ ;
+			if (frame) {
+				return true ;
+			}
+
+			if (!GetVarint(window)) {
+				return false ;
+			}
+
+			const HWND handle = Target(window) ;
+			Event e ;
+			switch (static_cast<EventType>(tag)) {
+				case EventType::Quit :
+				case EventType::Close :
+					e = Event::CreateCommonEvent(handle, static_cast<EventType>(tag)) ;
+					break ;
+				case EventType::Key : {
+					uint8_t state ;
+					uint64_t code ;
+					if (!GetByte(state) || !GetVarint(code) || state > static_cast<uint8_t>(KeyState::Down)) {
+						return false ;
+					}
+					e = Event::CreateKeyEvent(handle, static_cast<KeyState>(state), static_cast<uint32_t>(code)) ;
+					break ;
+				}
+				case EventType::Mouse : {
+					uint8_t button, state ;
+					uint64_t dx, dy, value ;
+					if (!GetByte(button) || !GetByte(state) || !GetVarint(dx) || !GetVarint(dy) || !GetVarint(value) ||
+						button > static_cast<uint8_t>(MouseButton::Middle) || state > static_cast<uint8_t>(MouseState::Wheel)) {
+						return false ;
+					}
+					mouse_.x += static_cast<int32_t>(EventLog::UnZigZag(dx)) ;
+					mouse_.y += static_cast<int32_t>(EventLog::UnZigZag(dy)) ;
+					e = Event::CreateMouseEvent(handle, static_cast<MouseButton>(button), static_cast<MouseState>(state), mouse_, static_cast<int32_t>(EventLog::UnZigZag(value))) ;
+					break ;
+				}
+				case EventType::Resize : {
+					uint64_t width, height ;
+					if (!GetVarint(width) || !GetVarint(height)) {
+						return false ;
+					}
+					e = Event::CreateResizeEvent(handle, {static_cast<int32_t>(width), static_cast<int32_t>(height)}) ;
+					break ;
+				}
+				default :
+					return false ;
+			}
+
+			++events_ ;
+			dropped_ += EventSystem::PushEvent(e) ? 0 : 1 ;
+			return true ;
+		}
+
+	public :
+		EventLogPlayer() noexcept = default ;
+
+		bool Open(const std::string& path) noexcept {
+			std::ifstream file(path, std::ios::binary) ;
+			try {
+				log_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()) ;
+			} catch (...) {
+				log_.clear() ;
+				return false ;
+			}
+
+			if (log_.size() < EventLog::___HEADER_SIZE___ || memcmp(log_.data(), EventLog::___MAGIC___, 8) != 0 || codec::GetU32LE(log_.data() + 8) != EventLog::___VERSION___) {
+
+				#ifdef EVENTLOG_DEBUG
+					logger::error("EventLogPlayer::Open - ", path, " isn't an event log.") ;
+				#endif
+
+				log_.clear() ;
+				return false ;
+			}
+
+			Rewind() ;
+			return true ;
+		}
+
+		// back to the first frame, the frame times start over.
+		void Rewind() noexcept {
+			position_ = EventLog::___HEADER_SIZE___ ;
+			recorded_ = 0 ;
+			mouse_ = {} ;
+			frame_times_.clear() ;
+			events_ = 0 ;
+			dropped_ = 0 ;
+			started_ = false ;
+			in_frame_ = false ;
+			corrupt_ = false ;
+		}
+
+		// recorded windows replay into handle unless MapWindow gave them their own.
+		void SetTarget(HWND handle) noexcept { target_ = handle ; }
+
+		// window is the recorded number, 1 for the first window that had input.
+		bool MapWindow(uint32_t window, HWND handle) noexcept {
+			if (window == 0) {
+				return false ;
+			}
+
+			try {
+				if (targets_.size() < window) {
+					targets_.resize(window, nullptr) ;
+				}
+			} catch (...) {
+				return false ;
+			}
+
+			targets_[window - 1] = handle ;
+			return true ;
+		}
+
+		void SetPace(ReplayPace pace) noexcept { pace_ = pace ; }
+		ReplayPace GetPace() const noexcept { return pace_ ; }
+
+		// ends the frame before, pushes the events of the next recorded frame and, at the recorded pace,
+		// waits until it is due. False once the log is over or broken.
+		bool NextFrame() noexcept {
+			const auto now = std::chrono::steady_clock::now() ;
+			if (in_frame_) {
+				try {
+					frame_times_.push_back(now - frame_start_) ;
+				} catch (...) {}
+				in_frame_ = false ;
+			}
+
+			if (!started_) {
+				start_ = now ;
+				started_ = true ;
+			}
+
+			if (corrupt_ || position_ >= log_.size()) {
+				return false ;
+			}
+
+			const uint64_t first = recorded_ ;
+			bool frame = false ;
+			while (!frame && position_ < log_.size()) {
+				if (!ReadRecord(frame)) {
+
+					#ifdef EVENTLOG_DEBUG
+						logger::error("EventLogPlayer::NextFrame - The log is corrupt at byte ", position_) ;
+					#endif
+
+					corrupt_ = true ;
+					return false ;
+				}
+			}
+
+			if (pace_ == ReplayPace::Recorded && first != 0) {
+				// the frame began where the previous mark was recorded
+				std::this_thread::sleep_until(start_ + std::chrono::nanoseconds(first)) ;
+			}
+
+			frame_start_ = std::chrono::steady_clock::now() ;
+			in_frame_ = true ;
+			return true ;
+		}
+
+		// what each replayed frame took: from NextFrame returning to the next call, so the sleep of a
+		// paced replay is left out. One per replayed frame.
+		const std::vector<std::chrono::nanoseconds>& GetFrameTimes() const noexcept { return frame_times_ ; }
+
+		ReplayStats GetStats() const noexcept {
+			ReplayStats stats ;
+			stats.frames_ = frame_times_.size() ;
+			stats.events_ = events_ ;
+			stats.dropped_ = dropped_ ;
+			if (frame_times_.empty()) {
+				return stats ;
+			}
+
+			try {
+				std::vector<std::chrono::nanoseconds> sorted = frame_times_ ;
+				std::sort(sorted.begin(), sorted.end()) ;
+				stats.p50_ = sorted[sorted.size() / 2] ;
+				stats.p99_ = sorted[sorted.size() * 99 / 100] ;
+				stats.max_ = sorted.back() ;
+				for (const auto& t : sorted) {
+					stats.total_ += t ;
+				}
+			} catch (...) {}
+			return stats ;
+		}
+
+		bool IsOpen() const noexcept { return !log_.empty() ; }
+		bool IsFinished() const noexcept { return corrupt_ || position_ >= log_.size() ; }
+	} ;
+}
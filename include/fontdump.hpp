@@ -19,7 +19,10 @@ namespace ___FONT_DUMP___ {
 		bool write_bom_ = true ;
 		bool write_header_ = true ;
 		size_t reserve_bytes_ = 1 << 20 ;
-		uint32_t charset_ = DEFAULT_CHARSET ;
+
+		#ifdef ZKETCH_WIN32
+			uint32_t charset_ = DEFAULT_CHARSET ;
+		#endif
 
 		static inline void ___trim___(std::string& s) noexcept {
 			auto it = s.begin() ;
@@ -67,6 +70,7 @@ namespace ___FONT_DUMP___ {
 			out.push_back('"') ;
 		}
 
+		#ifdef ZKETCH_WIN32
 		static int CALLBACK CollectFontFamiliesProc(const LOGFONTW* lpelfe, const TEXTMETRICW*, DWORD, LPARAM lParam) {
 			if (!lpelfe || !lParam) return 1 ;
 			auto* ctx = reinterpret_cast<__collect_ctx__*>(lParam) ;
@@ -88,6 +92,8 @@ namespace ___FONT_DUMP___ {
 			}
 		}
 
+		#endif
+
 		[[nodiscard]] static inline const ___FONT_DATA___::__font_data__* ___find_font___(const std::unordered_map<std::string, ___FONT_DATA___::__font_data__>& fontMap, const std::string_view name, uint8_t style = 0) noexcept {
 			std::string key ;
 			key.reserve(name.size() + 2) ;
@@ -99,6 +105,7 @@ namespace ___FONT_DUMP___ {
 			return (it != fontMap.end()) ? &it->second : nullptr ;
 		}
 
+		#ifdef ZKETCH_WIN32
 		[[nodiscard]] static inline std::optional<___FONT_DATA___::__font_data__> ___try_create_font___(HDC hdc, const std::wstring& fontname, int reqWeight, bool reqItalic) noexcept {
 			LOGFONTW lf {} ;
 			wcscpy_s(lf.lfFaceName, fontname.c_str()) ;
@@ -163,8 +170,19 @@ namespace ___FONT_DUMP___ {
 			
 			return entry ;
 		}
+		#endif
 
+		// installed fonts are enumerated through GDI, without it there is nothing to dump.
 		[[nodiscard]] static inline std::optional<std::pair<size_t, size_t>> ___dump_installed_fonts___(const __font_dump__& opt) noexcept {
+			#ifndef ZKETCH_WIN32
+				(void)opt ;
+
+				#ifdef FONT_DEBUG
+					logger::warning("___dump_installed_fonts___ - No GDI on this platform, no fonts to dump.") ;
+				#endif
+
+				return std::nullopt ;
+			#else
 			HDC screen = GetDC(nullptr) ;
 			if (!screen) {
 				return std::nullopt ;
@@ -303,6 +321,7 @@ namespace ___FONT_DUMP___ {
 			}
 
 			return std::make_pair(entries.size(), std::max(csvBytes, binBytes)) ;
+			#endif
 		}
 
 	public :
@@ -0,0 +1,232 @@
+#pragma once
+#include "event.hpp"
+
+namespace zketch {
+
+	struct FrameStats {
+		uint64_t frames_ = 0 ;
+		uint64_t over_budget_ = 0 ;			// frames whose work took longer than the frame interval
+		uint64_t idle_waits_ = 0 ;			// times the loop blocked with nothing to do
+		std::chrono::nanoseconds last_work_ {} ;
+		std::chrono::nanoseconds average_work_ {} ;
+		std::chrono::nanoseconds busy_ {} ;	// total time between BeginFrame and EndFrame
+		std::chrono::nanoseconds idle_ {} ;	// total time spent blocked or pacing
+
+		double GetLoad() const noexcept {
+			const auto total = busy_ + idle_ ;
+			return total.count() != 0 ? static_cast<double>(busy_.count()) / static_cast<double>(total.count()) : 0.0 ;
+		}
+	} ;
+
+	// paces the application loop. BeginFrame() sleeps until the next frame is due and, in idle mode,
+	// until input, a posted task, a due timer or Invalidate() gives it something to do. On the event
+	// loop thread the timers of EventSystem count too, the frame that wakes for one fires it polling,
+	// and so do events a bounded drain or a mask left pending: frames keep coming until they are taken.
+	//
+	//	while (Application) {
+	//		scheduler.BeginFrame() ;
+	//		while (PollEvent(e)) { ... }
+	//		...
+	//		scheduler.EndFrame() ;
+	//	}
+	class FrameScheduler {
+	private :
+		using Clock = std::chrono::steady_clock ;
+
+		// where sleeps are relative and overshoot, the last stretch before a deadline is yielded away.
+		static constexpr auto ___SPIN_SLACK___ = std::chrono::microseconds(100) ;
+
+		struct Timer {
+			Clock::time_point due_ ;
+			std::function<void()> task_ ;
+
+			bool operator>(const Timer& other) const noexcept { return due_ > other.due_ ; }
+		} ;
+
+		WakeSignal& signal_ ;
+		std::mutex mutex_ ;
+		std::vector<std::function<void()>> tasks_ ;
+		std::vector<Timer> timers_ ;	// min-heap on due_
+		std::vector<std::function<void()>> running_ ;
+		std::atomic<bool> invalidated_ {true} ;
+
+		Clock::duration interval_ {} ;
+		Clock::time_point next_frame_ {} ;
+		Clock::time_point frame_begin_ {} ;
+		FrameStats stats_ {} ;
+		bool idle_mode_ = false ;
+
+		bool HasWork(Clock::time_point now, std::optional<Clock::time_point>& next_timer) noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			next_timer.reset() ;
+			if (!timers_.empty()) {
+				next_timer = timers_.front().due_ ;
+			}
+			if (const auto deadline = EventSystem::GetNextTimerDeadline()) {
+				const Clock::time_point due {std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(*deadline))} ;
+				next_timer = next_timer ? std::min(*next_timer, due) : due ;
+			}
+			return !tasks_.empty() || (next_timer && *next_timer <= now) || EventSystem::HasPendingEvents() ;
+		}
+
+		void RunTasks(Clock::time_point now) noexcept {
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				running_.swap(tasks_) ;
+				while (!timers_.empty() && timers_.front().due_ <= now) {
+					std::pop_heap(timers_.begin(), timers_.end(), std::greater<>{}) ;
+					try {
+						running_.push_back(std::move(timers_.back().task_)) ;
+					} catch (...) {}
+					timers_.pop_back() ;
+				}
+			}
+
+			for (auto& task : running_) {
+				task() ;
+			}
+			running_.clear() ;
+		}
+
+		Clock::time_point SleepUntil(Clock::time_point deadline) noexcept {
+			Clock::time_point now = Clock::now() ;
+
+			#ifdef ZKETCH_LINUX
+				// steady_clock is CLOCK_MONOTONIC, the kernel wakes the thread at the deadline itself
+				const auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count() ;
+				const timespec at {static_cast<time_t>(since / 1000000000), static_cast<long>(since % 1000000000)} ;
+				while (now < deadline && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, nullptr) == EINTR) {
+					now = Clock::now() ;
+				}
+				now = Clock::now() ;
+			#endif
+
+			while (now < deadline) {
+				if (deadline - now > ___SPIN_SLACK___) {
+					std::this_thread::sleep_for(deadline - now - ___SPIN_SLACK___) ;
+				} else {
+					std::this_thread::yield() ;
+				}
+				now = Clock::now() ;
+			}
+			return now ;
+		}
+
+	public :
+		FrameScheduler(const FrameScheduler&) = delete ;
+		FrameScheduler& operator=(const FrameScheduler&) = delete ;
+
+		explicit FrameScheduler(WakeSignal& signal = GetMainWakeSignal()) noexcept : signal_(signal) {}
+		~FrameScheduler() = default ;
+
+		// 0 leaves the loop uncapped.
+		void SetTargetFps(double fps) noexcept {
+			interval_ = fps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) : Clock::duration::zero() ;
+		}
+
+		// when set, frames only run while there is something to do, see Invalidate().
+		void SetIdleMode(bool idle) noexcept { idle_mode_ = idle ; }
+
+		// asks for another frame, animations call it every frame they want to keep running. Thread safe.
+		void Invalidate() noexcept {
+			invalidated_.store(true) ;
+			signal_.Notify() ;
+		}
+
+		// runs task on the loop thread at the start of the next frame. Thread safe.
+		bool Post(std::function<void()> task) noexcept {
+			try {
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				tasks_.push_back(std::move(task)) ;
+			} catch (...) {
+				return false ;
+			}
+
+			signal_.Notify() ;
+			return true ;
+		}
+
+		// runs task on the loop thread at the first frame after delay. Thread safe.
+		bool PostDelayed(std::chrono::nanoseconds delay, std::function<void()> task) noexcept {
+			try {
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				timers_.push_back({Clock::now() + std::chrono::duration_cast<Clock::duration>(delay), std::move(task)}) ;
+				std::push_heap(timers_.begin(), timers_.end(), std::greater<>{}) ;
+			} catch (...) {
+				return false ;
+			}
+
+			signal_.Notify() ;
+			return true ;
+		}
+
+		// blocks until the next frame should run, then runs the due tasks.
+		void BeginFrame() noexcept {
+			Clock::time_point now = Clock::now() ;
+			std::optional<Clock::time_point> next_timer ;
+
+			if (idle_mode_) {
+				while (!invalidated_.load() && !HasWork(now, next_timer)) {
+					++stats_.idle_waits_ ;
+
+					std::optional<std::chrono::nanoseconds> timeout ;
+					if (next_timer) {
+						timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(*next_timer - now) ;
+					}
+
+					WakeReason reason = signal_.Wait(timeout) ;
+					Clock::time_point after = Clock::now() ;
+					stats_.idle_ += after - now ;
+					now = after ;
+
+					if (reason != WakeReason::Timeout) {
+						break ;
+					}
+				}
+			}
+
+			if (interval_ != Clock::duration::zero() && now < next_frame_) {
+				Clock::time_point after = SleepUntil(next_frame_) ;
+				stats_.idle_ += after - now ;
+				now = after ;
+			}
+
+			// a loop that fell more than a frame behind restarts its cadence instead of bursting
+			next_frame_ = (now - next_frame_ < interval_ ? next_frame_ : now) + interval_ ;
+			frame_begin_ = now ;
+
+			// the frame polls and runs everything a Notify() so far announced, the Invalidate() of a
+			// callback in the last frame included. Left pending it would wake the next wait for nothing.
+			signal_.Clear() ;
+			invalidated_.store(false) ;
+			RunTasks(now) ;
+		}
+
+		void EndFrame() noexcept {
+			const auto work = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frame_begin_) ;
+
+			++stats_.frames_ ;
+			stats_.last_work_ = work ;
+			stats_.average_work_ += (work - stats_.average_work_) / 16 ;
+			stats_.busy_ += work ;
+
+			if (interval_ != Clock::duration::zero() && work > interval_) {
+				++stats_.over_budget_ ;
+			}
+		}
+
+		// time left before the current frame overruns its budget, zero when uncapped or already late.
+		std::chrono::nanoseconds GetRemainingBudget() const noexcept {
+			if (interval_ == Clock::duration::zero()) {
+				return std::chrono::nanoseconds::zero() ;
+			}
+			return std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(frame_begin_ + interval_ - Clock::now()), std::chrono::nanoseconds::zero()) ;
+		}
+
+		std::chrono::nanoseconds GetBudget() const noexcept { return std::chrono::duration_cast<std::chrono::nanoseconds>(interval_) ; }
+		bool IsIdleMode() const noexcept { return idle_mode_ ; }
+		const FrameStats& GetStats() const noexcept { return stats_ ; }
+		void ResetStats() noexcept { stats_ = {} ; }
+		WakeSignal& GetSignal() noexcept { return signal_ ; }
+	} ;
+}
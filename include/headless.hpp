@@ -0,0 +1,154 @@
+#pragma once
+#include "windowbackend.hpp"
+
+namespace zketch {
+
+	// backend without a native window: presented frames are kept in memory and resize, close and input
+	// are injected by hand. Lets a whole application run in CI or under a benchmark.
+	//
+	//	auto backend = std::make_unique<HeadlessBackend>("bench", 1280, 720) ;
+	//	HeadlessBackend* headless = backend.get() ;
+	//	Window window(std::move(backend)) ;
+	//	headless->SendMouse(MouseButton::Left, MouseState::Down, {10, 10}) ;
+	class HeadlessBackend : public WindowBackend {
+	private :
+		std::string title_ ;
+		Rect bound_ {} ;
+		std::vector<Canvas> frames_ ;	// oldest first, they share pixels with the window until it draws again
+		DamageList damage_ ;			// of the last present
+		mutable std::mutex mutex_ ;		// frames_ and presented_ may be written by the present thread
+		size_t history_ = 1 ;
+		uint64_t presented_ = 0 ;
+		bool visible_ = false ;
+		bool minimized_ = false ;
+		bool destroyed_ = false ;
+
+	public :
+		HeadlessBackend(const char* title, int32_t xpos, int32_t ypos, int32_t width, int32_t height) noexcept : title_(title ? title : ""), bound_{xpos, ypos, std::max(width, 0), std::max(height, 0)} {}
+		HeadlessBackend(const char* title, int32_t width, int32_t height) noexcept : HeadlessBackend(title, 0, 0, width, height) {}
+
+		~HeadlessBackend() noexcept override = default ;
+
+		HWND GetHandle() const noexcept override { return destroyed_ ? nullptr : reinterpret_cast<HWND>(const_cast<HeadlessBackend*>(this)) ; }
+		Rect GetClientBound() const noexcept override { return {0, 0, static_cast<int32_t>(bound_.w), static_cast<int32_t>(bound_.h)} ; }
+		Rect GetWindowBound() const noexcept override { return bound_ ; }
+
+		void Show() noexcept override {
+			visible_ = true ;
+			minimized_ = false ;
+		}
+
+		void Hide() noexcept override { visible_ = false ; }
+		void Minimize() noexcept override { minimized_ = true ; }
+		void Maximize() noexcept override { minimized_ = false ; }
+		void Restore() noexcept override { minimized_ = false ; }
+		void SetTitle(const char* title) noexcept override { title_ = title ? title : "" ; }
+
+		void Present(const Canvas& frame, const DamageList& damage) noexcept override {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			++presented_ ;
+			damage_.Clear() ;
+			damage_.Add(damage, frame.GetSize()) ;
+			if (history_ == 0) {
+				return ;
+			}
+
+			try {
+				frames_.push_back(frame) ;
+			} catch (...) {
+				return ;
+			}
+
+			if (frames_.size() > history_) {
+				frames_.erase(frames_.begin(), frames_.end() - history_) ;
+			}
+		}
+
+		void Destroy() noexcept override {
+			if (destroyed_) {
+				return ;
+			}
+
+			NotifyDestroy() ;
+			destroyed_ = true ;
+
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			frames_.clear() ;
+		}
+
+		// --- synthetic input, everything lands in EventSystem like native input would ---
+
+		// behaves like a WM_SIZE: a Resize event is queued and the window canvases are recreated
+		// when its next frame begins.
+		void Resize(const Size& size) noexcept {
+			if (destroyed_) {
+				return ;
+			}
+
+			bound_.w = size.x ;
+			bound_.h = size.y ;
+			NotifyResize(size) ;
+		}
+
+		// behaves like a WM_CLOSE: a Close event is pushed and the window reports IsCloseRequested().
+		void RequestClose() noexcept {
+			if (!destroyed_) {
+				NotifyClose() ;
+			}
+		}
+
+		void SendMouse(MouseButton button, MouseState state, const Point& pos, int32_t value = 0) noexcept {
+			if (!destroyed_) {
+				EventSystem::PushEvent(Event::CreateMouseEvent(GetHandle(), button, state, pos, value)) ;
+			}
+		}
+
+		void SendKey(KeyState state, uint32_t key_code) noexcept {
+			if (!destroyed_) {
+				EventSystem::PushEvent(Event::CreateKeyEvent(GetHandle(), state, key_code)) ;
+			}
+		}
+
+		// --- presented frames ---
+
+		// how many presented frames are kept, 0 only counts them.
+		void SetHistory(size_t frames) noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			history_ = frames ;
+			if (frames_.size() > history_) {
+				frames_.erase(frames_.begin(), frames_.end() - history_) ;
+			}
+		}
+
+		// copies share the pixels, they stay valid while the window keeps drawing.
+		Canvas GetLastFrame() const noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			return frames_.empty() ? Canvas{} : frames_.back() ;
+		}
+
+		std::vector<Canvas> GetFrames() const noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			try {
+				return frames_ ;
+			} catch (...) {
+				return {} ;
+			}
+		}
+
+		DamageList GetLastDamage() const noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			DamageList damage ;
+			// Add clamps to the bound as int32_t, the damage is already inside the frame
+			damage.Add(damage_, {static_cast<uint32_t>(INT32_MAX), static_cast<uint32_t>(INT32_MAX)}) ;
+			return damage ;
+		}
+
+		uint64_t GetPresentCount() const noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			return presented_ ;
+		}
+		const std::string& GetTitle() const noexcept { return title_ ; }
+		bool IsVisible() const noexcept { return visible_ && !minimized_ ; }
+		bool IsDestroyed() const noexcept { return destroyed_ ; }
+	} ;
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include "event.hpp"
+
+namespace zketch {
+
+	struct LatencySummary {
+		std::chrono::nanoseconds p50_ {} ;
+		std::chrono::nanoseconds p99_ {} ;
+		std::chrono::nanoseconds max_ {} ;
+	} ;
+
+	// the percentiles are over the last frames that showed input, one sample per frame taken from
+	// the oldest input it showed.
+	struct LatencyStats {
+		uint64_t inputs_ = 0 ;		// traced all the way to a present
+		uint64_t frames_ = 0 ;		// presents that showed input
+		uint64_t dropped_ = 0 ;		// given up on, too many inputs waited for a frame
+		LatencySummary total_ ;		// the input to the end of the present showing it
+		LatencySummary queue_ ;		// the input to PollEvent handing it out
+		LatencySummary handling_ ;	// PollEvent to Renderer::End of the frame showing it
+		LatencySummary present_ ;	// Renderer::End to the end of the present
+	} ;
+
+	// follows the input of one window to the screen. Window::SetLatencyTracer attaches it: from then
+	// on every key and mouse event PollEvent hands out for the window is pending, the next frame
+	// Renderer::End finishes takes all pending input as its own, and the present of that frame, on
+	// the window's thread or the present thread, closes it. The clock stops when the backend's
+	// Present returns, the compositor and the display add their own latency after that.
+	class LatencyTracer {
+	private :
+		static constexpr size_t ___MAX_PENDING___ = 4096 ;
+		static constexpr size_t ___HISTORY___ = 1024 ;
+
+		struct Pending {
+			uint64_t input_ ;
+			uint64_t polled_ ;
+			uint64_t rendered_ ;
+			uint64_t frame_ ;	// 0 until a finished frame takes it
+		} ;
+
+		struct Sample {
+			uint64_t total_ ;
+			uint64_t queue_ ;
+			uint64_t handling_ ;
+			uint64_t present_ ;
+		} ;
+
+		mutable std::mutex mutex_ ;	// frames may end on render threads and present on the present thread
+		HWND handle_ = nullptr ;
+		bool attached_ = false ;
+		std::vector<Pending> pending_ ;
+		std::vector<Sample> history_ ;	// ring of ___HISTORY___ once full
+		uint64_t inputs_ = 0 ;
+		uint64_t frames_ = 0 ;
+		uint64_t dropped_ = 0 ;
+
+		static void OnPoll(const Event& e, void* self) noexcept {
+			static_cast<LatencyTracer*>(self)->OnInput(e) ;
+		}
+
+		static LatencySummary Summarize(std::vector<uint64_t>& values) noexcept {
+			if (values.empty()) {
+				return {} ;
+			}
+
+			auto at = [&](size_t i) {
+				std::nth_element(values.begin(), values.begin() + i, values.end()) ;
+				return std::chrono::nanoseconds(values[i]) ;
+			} ;
+
+			LatencySummary summary ;
+			summary.p50_ = at(values.size() / 2) ;
+			summary.p99_ = at(values.size() * 99 / 100) ;
+			summary.max_ = std::chrono::nanoseconds(*std::max_element(values.begin(), values.end())) ;
+			return summary ;
+		}
+
+	public :
+		LatencyTracer() noexcept = default ;
+		LatencyTracer(const LatencyTracer&) = delete ;
+		LatencyTracer& operator=(const LatencyTracer&) = delete ;
+
+		~LatencyTracer() noexcept {
+			Detach() ;
+		}
+
+		// starts watching what PollEvent hands out for handle, on the event loop's thread.
+		bool Attach(HWND handle) noexcept {
+			Detach() ;
+			if (!EventSystem::AddPollHook(&LatencyTracer::OnPoll, this)) {
+				return false ;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			handle_ = handle ;
+			attached_ = true ;
+			return true ;
+		}
+
+		void Detach() noexcept {
+			if (!attached_) {
+				return ;
+			}
+
+			EventSystem::RemovePollHook(&LatencyTracer::OnPoll, this) ;
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			attached_ = false ;
+			pending_.clear() ;
+		}
+
+		// attached tracers see polled input already, this is for input delivered some other way.
+		void OnInput(const Event& e) noexcept {
+			if (!(e.IsKeyEvent() || e.IsMouseEvent()) || e.GetHandle() != handle_ || e.GetTimeStamp() == 0) {
+				return ;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			if (pending_.size() >= ___MAX_PENDING___) {
+				++dropped_ ;
+				return ;
+			}
+
+			try {
+				pending_.push_back({e.GetTimeStamp(), MonotonicTime(), 0, 0}) ;
+			} catch (...) {
+				++dropped_ ;
+			}
+		}
+
+		// the window finished frame, it shows every input polled until now.
+		void OnFrame(uint64_t frame) noexcept {
+			const uint64_t now = MonotonicTime() ;
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			for (auto& p : pending_) {
+				if (p.frame_ == 0) {
+					p.frame_ = frame ;
+					p.rendered_ = now ;
+				}
+			}
+		}
+
+		// frame, and the ones before it, reached the output.
+		void OnPresent(uint64_t frame) noexcept {
+			const uint64_t now = MonotonicTime() ;
+			std::lock_guard<std::mutex> lock(mutex_) ;
+
+			const Pending* oldest = nullptr ;
+			uint64_t shown = 0 ;
+			for (const auto& p : pending_) {
+				if (p.frame_ != 0 && p.frame_ <= frame) {
+					++shown ;
+					oldest = !oldest || p.input_ < oldest->input_ ? &p : oldest ;
+				}
+			}
+
+			if (!oldest) {
+				return ;
+			}
+
+			const Sample sample = {
+				now - std::min(oldest->input_, now),
+				oldest->polled_ - std::min(oldest->input_, oldest->polled_),
+				oldest->rendered_ - oldest->polled_,
+				now - oldest->rendered_
+			} ;
+
+			if (history_.size() < ___HISTORY___) {
+				try {
+					history_.push_back(sample) ;
+				} catch (...) {}
+			} else {
+				history_[frames_ % ___HISTORY___] = sample ;
+			}
+
+			inputs_ += shown ;
+			++frames_ ;
+			pending_.erase(std::remove_if(pending_.begin(), pending_.end(), [frame](const Pending& p) { return p.frame_ != 0 && p.frame_ <= frame ; }), pending_.end()) ;
+		}
+
+		LatencyStats GetStats() const noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			LatencyStats stats ;
+			stats.inputs_ = inputs_ ;
+			stats.frames_ = frames_ ;
+			stats.dropped_ = dropped_ ;
+
+			try {
+				std::vector<uint64_t> values(history_.size()) ;
+				auto summarize = [&](uint64_t Sample::* field) {
+					for (size_t i = 0 ; i < history_.size() ; ++i) {
+						values[i] = history_[i].*field ;
+					}
+					return Summarize(values) ;
+				} ;
+
+				stats.total_ = summarize(&Sample::total_) ;
+				stats.queue_ = summarize(&Sample::queue_) ;
+				stats.handling_ = summarize(&Sample::handling_) ;
+				stats.present_ = summarize(&Sample::present_) ;
+			} catch (...) {}
+
+			return stats ;
+		}
+
+		void Reset() noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			history_.clear() ;
+			inputs_ = 0 ;
+			frames_ = 0 ;
+			dropped_ = 0 ;
+		}
+
+		HWND GetHandle() const noexcept { return handle_ ; }
+		bool IsAttached() const noexcept { return attached_ ; }
+	} ;
+}
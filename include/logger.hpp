@@ -6,6 +6,7 @@ namespace zketch {
 
 	class logger {
 	private :
+		#ifdef ZKETCH_WIN32
 		static inline HANDLE out_handle() noexcept {
 			static HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE) ;
 			return h ;
@@ -25,6 +26,20 @@ namespace zketch {
 		static inline void restore_color(WORD old) noexcept {
 			SetConsoleTextAttribute(out_handle(), old) ;
 		}
+		#else
+		// the same three colors as ANSI escapes, only when stdout is a terminal. One write per line,
+		// lines from different threads don't mix.
+		static inline void write_line(int32_t lv, std::string& line) noexcept {
+			static const bool tty = isatty(STDOUT_FILENO) != 0 ;
+			const char* color = lv == 0 ? "\x1b[92m" : lv == 1 ? "\x1b[93m" : lv == 2 ? "\x1b[91m" : nullptr ;
+			if (tty && color) {
+				line.insert(0, color) ;
+				line.insert(line.size() - 1, "\x1b[0m") ;
+			}
+			std::fwrite(line.data(), 1, line.size(), stdout) ;
+			std::fflush(stdout) ;
+		}
+		#endif
 
 		template <typename T>
 		static inline void append_narrow(std::string& out, T v) {
@@ -109,13 +124,17 @@ namespace zketch {
 			(append_narrow(buf, std::forward<Args>(args)), ...) ;
 			buf.push_back('\n') ;
 
-			CONSOLE_SCREEN_BUFFER_INFO info ;
-			GetConsoleScreenBufferInfo(out_handle(), &info) ;
-			WORD old = info.wAttributes ;
-			set_color(lv) ;
-			DWORD written = 0 ;
-			WriteConsoleA(out_handle(), buf.data(), static_cast<DWORD>(buf.size()), &written, nullptr) ;
-			restore_color(old) ;
+			#ifdef ZKETCH_WIN32
+				CONSOLE_SCREEN_BUFFER_INFO info ;
+				GetConsoleScreenBufferInfo(out_handle(), &info) ;
+				WORD old = info.wAttributes ;
+				set_color(lv) ;
+				DWORD written = 0 ;
+				WriteConsoleA(out_handle(), buf.data(), static_cast<DWORD>(buf.size()), &written, nullptr) ;
+				restore_color(old) ;
+			#else
+				write_line(lv, buf) ;
+			#endif
 		}
 
 		template <typename ... Args>
@@ -128,13 +147,19 @@ namespace zketch {
 			(append_wide(buf, std::forward<Args>(args)), ...) ;
 			buf.push_back(L'\n') ;
 
-			CONSOLE_SCREEN_BUFFER_INFO info ;
-			GetConsoleScreenBufferInfo(out_handle(), &info) ;
-			WORD old = info.wAttributes ;
-			set_color(lv) ;
-			DWORD written = 0 ;
-			WriteConsoleW(out_handle(), buf.data(), static_cast<DWORD>(buf.size()), &written, nullptr) ;
-			restore_color(old) ;
+			#ifdef ZKETCH_WIN32
+				CONSOLE_SCREEN_BUFFER_INFO info ;
+				GetConsoleScreenBufferInfo(out_handle(), &info) ;
+				WORD old = info.wAttributes ;
+				set_color(lv) ;
+				DWORD written = 0 ;
+				WriteConsoleW(out_handle(), buf.data(), static_cast<DWORD>(buf.size()), &written, nullptr) ;
+				restore_color(old) ;
+			#else
+				std::string line(static_cast<size_t>(WideCharToMultiByte(CP_UTF8, 0, buf.data(), static_cast<int>(buf.size()), nullptr, 0, nullptr, nullptr)), '\0') ;
+				WideCharToMultiByte(CP_UTF8, 0, buf.data(), static_cast<int>(buf.size()), line.data(), static_cast<int>(line.size()), nullptr, nullptr) ;
+				write_line(lv, line) ;
+			#endif
 		}
 
 	public :
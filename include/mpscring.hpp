@@ -0,0 +1,109 @@
+#pragma once
+#include "env.hpp"
+
+namespace zketch {
+
+	// bounded lock-free queue, any number of producers and one consumer. Every cell carries a
+	// sequence number telling whose turn it is: producers claim a position with one CAS on tail_,
+	// write the value and publish it by bumping the sequence, the consumer reads cells in order and
+	// hands them back a lap later. A full ring fails the push instead of waiting.
+	template <typename T, size_t N>
+	class MpscRing {
+		static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing size must be a power of two") ;
+		static_assert(std::is_trivially_copyable_v<T>, "MpscRing holds trivially copyable values") ;
+
+	private :
+		static constexpr size_t ___MASK___ = N - 1 ;
+
+		struct Cell {
+			std::atomic<size_t> sequence_ ;	// position + 1 once written, position + N once consumed
+			T value_ ;
+		} ;
+
+		std::unique_ptr<Cell[]> cells_ ;
+		alignas(64) std::atomic<size_t> tail_ {0} ;	// next position producers claim
+		alignas(64) std::atomic<size_t> head_ {0} ;	// next position the consumer reads, only it writes
+
+	public :
+		MpscRing(const MpscRing&) = delete ;
+		MpscRing& operator=(const MpscRing&) = delete ;
+
+		MpscRing() noexcept : cells_(new (std::nothrow) Cell[N]) {
+			if (cells_) {
+				for (size_t i = 0 ; i < N ; ++i) {
+					cells_[i].sequence_.store(i, std::memory_order_relaxed) ;
+				}
+			}
+		}
+
+		// any thread, false when the ring is full. position receives the slot's place in line, see GetTail.
+		bool TryPush(const T& value, size_t* position = nullptr) noexcept {
+			if (!cells_) {
+				return false ;
+			}
+
+			size_t pos = tail_.load(std::memory_order_relaxed) ;
+			while (true) {
+				Cell& cell = cells_[pos & ___MASK___] ;
+				const size_t sequence = cell.sequence_.load(std::memory_order_acquire) ;
+				const intptr_t turn = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) ;
+				if (turn == 0) {
+					if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						cell.value_ = value ;
+						cell.sequence_.store(pos + 1, std::memory_order_release) ;
+						if (position) {
+							*position = pos ;
+						}
+						return true ;
+					}
+				} else if (turn < 0) {
+					// the cell still holds the value from a lap ago
+					return false ;
+				} else {
+					pos = tail_.load(std::memory_order_relaxed) ;
+				}
+			}
+		}
+
+		// consumer only. A producer that claimed the front but hasn't written yet reads as empty.
+		bool TryPop(T& value) noexcept {
+			if (!cells_) {
+				return false ;
+			}
+
+			const size_t head = head_.load(std::memory_order_relaxed) ;
+			Cell& cell = cells_[head & ___MASK___] ;
+			if (cell.sequence_.load(std::memory_order_acquire) != head + 1) {
+				return false ;
+			}
+
+			value = cell.value_ ;
+			cell.sequence_.store(head + N, std::memory_order_release) ;
+			head_.store(head + 1, std::memory_order_relaxed) ;
+			return true ;
+		}
+
+		// consumer only, the front value stays until TryPop.
+		const T* Peek() const noexcept {
+			if (!cells_) {
+				return nullptr ;
+			}
+
+			const size_t head = head_.load(std::memory_order_relaxed) ;
+			const Cell& cell = cells_[head & ___MASK___] ;
+			return cell.sequence_.load(std::memory_order_acquire) == head + 1 ? &cell.value_ : nullptr ;
+		}
+
+		// a snapshot, stale as soon as it's returned.
+		size_t GetSize() const noexcept {
+			const size_t head = head_.load(std::memory_order_relaxed) ;
+			const size_t tail = tail_.load(std::memory_order_relaxed) ;
+			return tail > head ? std::min(tail - head, N) : 0 ;
+		}
+
+		// positions handed out so far, the next push gets this one.
+		size_t GetTail() const noexcept { return tail_.load(std::memory_order_acquire) ; }
+
+		static constexpr size_t GetCapacity() noexcept { return N ; }
+	} ;
+}
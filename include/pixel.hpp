@@ -0,0 +1,411 @@
+#pragma once
+#include "env.hpp"
+
+#if !defined(ZKETCH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define ZKETCH_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace zketch {
+
+	// Layout of canvas storage. ARGB and XRGB are 32 bit words 0xAARRGGBB (byte order B, G, R, A),
+	// XRGB ignores the alpha byte, RGB565 is a 16 bit word and A8 is a single coverage byte.
+	enum class ColorFormat : uint8_t {
+		ARGB,
+		XRGB,
+		RGB565,
+		A8
+	} ;
+
+	constexpr uint32_t BytesPerPixel(ColorFormat format) noexcept {
+		switch (format) {
+			case ColorFormat::ARGB : return 4 ;
+			case ColorFormat::XRGB : return 4 ;
+			case ColorFormat::RGB565 : return 2 ;
+			case ColorFormat::A8 : return 1 ;
+		}
+		return 4 ;
+	}
+
+	// rows are padded to 16 bytes, which also satisfies the 4 byte stride GDI+ asks for.
+	constexpr uint32_t StrideOf(ColorFormat format, uint32_t width) noexcept {
+		return (width * BytesPerPixel(format) + 15u) & ~15u ;
+	}
+
+	constexpr bool HasAlpha(ColorFormat format) noexcept {
+		return format == ColorFormat::ARGB || format == ColorFormat::A8 ;
+	}
+
+	namespace pixel {
+
+		inline constexpr uint32_t Div255(uint32_t v) noexcept {
+			v += 128 ;
+			return (v + (v >> 8)) >> 8 ;
+		}
+
+		inline constexpr uint32_t Expand565(uint16_t p) noexcept {
+			uint32_t r = (p >> 11) & 0x1F ;
+			uint32_t g = (p >> 5) & 0x3F ;
+			uint32_t b = p & 0x1F ;
+			r = (r << 3) | (r >> 2) ;
+			g = (g << 2) | (g >> 4) ;
+			b = (b << 3) | (b >> 2) ;
+			return 0xFF000000u | (r << 16) | (g << 8) | b ;
+		}
+
+		inline constexpr uint16_t Pack565(uint32_t p) noexcept {
+			return static_cast<uint16_t>(((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F)) ;
+		}
+
+		inline constexpr uint32_t Tint(uint8_t coverage, uint32_t color) noexcept {
+			return (Div255(coverage * (color >> 24)) << 24) | (color & 0x00FFFFFF) ;
+		}
+
+		// straight (non premultiplied) source over, the same model GDI+ uses for PixelFormat32bppARGB.
+		inline constexpr uint32_t Over(uint32_t s, uint32_t d) noexcept {
+			uint32_t sa = s >> 24 ;
+			if (sa == 0) {
+				return d ;
+			}
+
+			uint32_t da = d >> 24 ;
+			if (sa == 255 || da == 0) {
+				return s ;
+			}
+
+			uint32_t dw = da * (255 - sa) ;
+			uint32_t ow = sa * 255 + dw ;
+			uint32_t out = ((ow + 127) / 255) << 24 ;
+			for (uint32_t shift = 0 ; shift < 24 ; shift += 8) {
+				uint32_t sc = (s >> shift) & 0xFF ;
+				uint32_t dc = (d >> shift) & 0xFF ;
+				out |= ((sc * sa * 255 + dc * dw + ow / 2) / ow) << shift ;
+			}
+			return out ;
+		}
+
+		inline constexpr uint32_t OverOpaque(uint32_t s, uint32_t d) noexcept {
+			uint32_t sa = s >> 24 ;
+			uint32_t out = 0xFF000000u ;
+			for (uint32_t shift = 0 ; shift < 24 ; shift += 8) {
+				uint32_t sc = (s >> shift) & 0xFF ;
+				uint32_t dc = (d >> shift) & 0xFF ;
+				out |= Div255(sc * sa + dc * (255 - sa)) << shift ;
+			}
+			return out ;
+		}
+
+		// ------------------------------ conversion kernels ------------------------------
+
+		inline void ArgbToXrgb(const uint32_t* src, uint32_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u)) ;
+				for ( ; i + 4 <= count ; i += 4) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(v, alpha)) ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				dst[i] = src[i] | 0xFF000000u ;
+			}
+		}
+
+		inline void ArgbToRgb565(const uint32_t* src, uint16_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i mr = _mm_set1_epi32(0xF800) ;
+				const __m128i mg = _mm_set1_epi32(0x07E0) ;
+				const __m128i mb = _mm_set1_epi32(0x001F) ;
+				const __m128i bias32 = _mm_set1_epi32(0x8000) ;
+				const __m128i bias16 = _mm_set1_epi16(static_cast<int16_t>(0x8000)) ;
+				for ( ; i + 8 <= count ; i += 8) {
+					__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) ;
+					__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)) ;
+					__m128i p0 = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(v0, 8), mr), _mm_and_si128(_mm_srli_epi32(v0, 5), mg)), _mm_and_si128(_mm_srli_epi32(v0, 3), mb)) ;
+					__m128i p1 = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(v1, 8), mr), _mm_and_si128(_mm_srli_epi32(v1, 5), mg)), _mm_and_si128(_mm_srli_epi32(v1, 3), mb)) ;
+					// packs is signed, so shift into the int16 range and back
+					__m128i packed = _mm_packs_epi32(_mm_sub_epi32(p0, bias32), _mm_sub_epi32(p1, bias32)) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi16(packed, bias16)) ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				dst[i] = Pack565(src[i]) ;
+			}
+		}
+
+		inline void Rgb565ToArgb(const uint16_t* src, uint32_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i zero = _mm_setzero_si128() ;
+				const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u)) ;
+				const __m128i m5 = _mm_set1_epi32(0x1F) ;
+				const __m128i m6 = _mm_set1_epi32(0x3F) ;
+				for ( ; i + 8 <= count ; i += 8) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) ;
+					__m128i halves[2] = { _mm_unpacklo_epi16(v, zero), _mm_unpackhi_epi16(v, zero) } ;
+					for (int32_t h = 0 ; h < 2 ; ++h) {
+						__m128i p = halves[h] ;
+						__m128i r = _mm_and_si128(_mm_srli_epi32(p, 11), m5) ;
+						__m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), m6) ;
+						__m128i b = _mm_and_si128(p, m5) ;
+						r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2)) ;
+						g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4)) ;
+						b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2)) ;
+						__m128i out = _mm_or_si128(_mm_or_si128(alpha, _mm_slli_epi32(r, 16)), _mm_or_si128(_mm_slli_epi32(g, 8), b)) ;
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + h * 4), out) ;
+					}
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				dst[i] = Expand565(src[i]) ;
+			}
+		}
+
+		inline void ArgbToA8(const uint32_t* src, uint8_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				for ( ; i + 16 <= count ; i += 16) {
+					__m128i a0 = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), 24) ;
+					__m128i a1 = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), 24) ;
+					__m128i a2 = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)), 24) ;
+					__m128i a3 = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), 24) ;
+					__m128i packed = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed) ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				dst[i] = static_cast<uint8_t>(src[i] >> 24) ;
+			}
+		}
+
+		// expands a coverage mask into color * coverage.
+		inline void A8ToArgb(const uint8_t* src, uint32_t* dst, size_t count, uint32_t color) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i zero = _mm_setzero_si128() ;
+				const __m128i ca = _mm_set1_epi16(static_cast<int16_t>(color >> 24)) ;
+				const __m128i round = _mm_set1_epi16(128) ;
+				const __m128i rgb = _mm_set1_epi32(static_cast<int32_t>(color & 0x00FFFFFF)) ;
+				for ( ; i + 8 <= count ; i += 8) {
+					__m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)), zero) ;
+					__m128i t = _mm_add_epi16(_mm_mullo_epi16(a, ca), round) ;
+					t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8) ;
+					__m128i lo = _mm_or_si128(_mm_slli_epi32(_mm_unpacklo_epi16(t, zero), 24), rgb) ;
+					__m128i hi = _mm_or_si128(_mm_slli_epi32(_mm_unpackhi_epi16(t, zero), 24), rgb) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), hi) ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				dst[i] = Tint(src[i], color) ;
+			}
+		}
+
+		// ------------------------------ blend kernels ------------------------------
+
+		// source over onto a destination known to be opaque, result stays opaque.
+		inline void BlendOverOpaque(const uint32_t* src, uint32_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i zero = _mm_setzero_si128() ;
+				const __m128i full = _mm_set1_epi16(255) ;
+				const __m128i round = _mm_set1_epi16(128) ;
+				const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u)) ;
+				for ( ; i + 4 <= count ; i += 4) {
+					__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) ;
+					__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)) ;
+					__m128i s_alpha = _mm_srli_epi32(s, 24) ;
+					int32_t transparent = _mm_movemask_epi8(_mm_cmpeq_epi32(s_alpha, zero)) ;
+					if (transparent == 0xFFFF) {
+						continue ;
+					}
+
+					__m128i out[2] ;
+					for (int32_t h = 0 ; h < 2 ; ++h) {
+						__m128i s16 = h == 0 ? _mm_unpacklo_epi8(s, zero) : _mm_unpackhi_epi8(s, zero) ;
+						__m128i d16 = h == 0 ? _mm_unpacklo_epi8(d, zero) : _mm_unpackhi_epi8(d, zero) ;
+						__m128i a16 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xFF), 0xFF) ;
+						__m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s16, a16), _mm_mullo_epi16(d16, _mm_sub_epi16(full, a16))), round) ;
+						out[h] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8) ;
+					}
+					__m128i result = _mm_or_si128(_mm_packus_epi16(out[0], out[1]), alpha) ;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result) ;
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				uint32_t sa = src[i] >> 24 ;
+				if (sa == 0) {
+					continue ;
+				}
+				dst[i] = sa == 255 ? src[i] : OverOpaque(src[i], dst[i]) ;
+			}
+		}
+
+		inline void BlendOver(const uint32_t* src, uint32_t* dst, size_t count) noexcept {
+			size_t i = 0 ;
+
+			#ifdef ZKETCH_SSE2
+				const __m128i opaque = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u)) ;
+				for ( ; i + 4 <= count ; i += 4) {
+					__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)) ;
+					int32_t dst_opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(d, opaque), opaque)) ;
+					if (dst_opaque == 0xFFFF) {
+						BlendOverOpaque(src + i, dst + i, 4) ;
+						continue ;
+					}
+
+					for (size_t j = i ; j < i + 4 ; ++j) {
+						dst[j] = Over(src[j], dst[j]) ;
+					}
+				}
+			#endif
+
+			for ( ; i < count ; ++i) {
+				dst[i] = Over(src[i], dst[i]) ;
+			}
+		}
+
+		inline void BlendAlpha(const uint32_t* src, uint8_t* dst, size_t count) noexcept {
+			for (size_t i = 0 ; i < count ; ++i) {
+				uint32_t sa = src[i] >> 24 ;
+				dst[i] = static_cast<uint8_t>(sa + Div255(dst[i] * (255 - sa))) ;
+			}
+		}
+
+		// ------------------------------ row dispatch ------------------------------
+
+		// rows wider than this are processed in chunks through a stack buffer.
+		static constexpr size_t ___ROW_CHUNK___ = 256 ;
+
+		inline void ToArgb(const uint8_t* src, ColorFormat format, uint32_t* dst, size_t count, uint32_t tint) noexcept {
+			switch (format) {
+				case ColorFormat::ARGB :
+					memcpy(dst, src, count * 4) ;
+					break ;
+				case ColorFormat::XRGB :
+					ArgbToXrgb(reinterpret_cast<const uint32_t*>(src), dst, count) ;
+					break ;
+				case ColorFormat::RGB565 :
+					Rgb565ToArgb(reinterpret_cast<const uint16_t*>(src), dst, count) ;
+					break ;
+				case ColorFormat::A8 :
+					A8ToArgb(src, dst, count, tint) ;
+					break ;
+			}
+		}
+
+		inline void FromArgb(const uint32_t* src, uint8_t* dst, ColorFormat format, size_t count) noexcept {
+			switch (format) {
+				case ColorFormat::ARGB :
+					memcpy(dst, src, count * 4) ;
+					break ;
+				case ColorFormat::XRGB :
+					ArgbToXrgb(src, reinterpret_cast<uint32_t*>(dst), count) ;
+					break ;
+				case ColorFormat::RGB565 :
+					ArgbToRgb565(src, reinterpret_cast<uint16_t*>(dst), count) ;
+					break ;
+				case ColorFormat::A8 :
+					ArgbToA8(src, dst, count) ;
+					break ;
+			}
+		}
+
+		// copies count pixels converting between formats, tint colors A8 sources.
+		inline void ConvertRow(const uint8_t* src, ColorFormat src_format, uint8_t* dst, ColorFormat dst_format, size_t count, uint32_t tint = 0xFF000000u) noexcept {
+			if (src_format == dst_format) {
+				memcpy(dst, src, count * BytesPerPixel(src_format)) ;
+				return ;
+			}
+
+			if (src_format == ColorFormat::ARGB) {
+				FromArgb(reinterpret_cast<const uint32_t*>(src), dst, dst_format, count) ;
+				return ;
+			}
+
+			if (dst_format == ColorFormat::ARGB) {
+				ToArgb(src, src_format, reinterpret_cast<uint32_t*>(dst), count, tint) ;
+				return ;
+			}
+
+			alignas(16) uint32_t temp[___ROW_CHUNK___] ;
+			const uint32_t sbpp = BytesPerPixel(src_format) ;
+			const uint32_t dbpp = BytesPerPixel(dst_format) ;
+			for (size_t i = 0 ; i < count ; i += ___ROW_CHUNK___) {
+				size_t n = std::min(___ROW_CHUNK___, count - i) ;
+				ToArgb(src + i * sbpp, src_format, temp, n, tint) ;
+				FromArgb(temp, dst + i * dbpp, dst_format, n) ;
+			}
+		}
+
+		// source over of count pixels, tint colors A8 sources.
+		inline void BlendRow(const uint8_t* src, ColorFormat src_format, uint8_t* dst, ColorFormat dst_format, size_t count, uint32_t tint = 0xFF000000u) noexcept {
+			// opaque sources simply replace the destination
+			if (!HasAlpha(src_format)) {
+				ConvertRow(src, src_format, dst, dst_format, count) ;
+				if (dst_format == ColorFormat::A8) {
+					memset(dst, 0xFF, count) ;
+				}
+				return ;
+			}
+
+			alignas(16) uint32_t s[___ROW_CHUNK___] ;
+			alignas(16) uint32_t d[___ROW_CHUNK___] ;
+			const uint32_t sbpp = BytesPerPixel(src_format) ;
+			const uint32_t dbpp = BytesPerPixel(dst_format) ;
+
+			for (size_t i = 0 ; i < count ; i += ___ROW_CHUNK___) {
+				size_t n = std::min(___ROW_CHUNK___, count - i) ;
+				const uint32_t* sp = s ;
+				if (src_format == ColorFormat::ARGB) {
+					sp = reinterpret_cast<const uint32_t*>(src + i * sbpp) ;
+				} else {
+					ToArgb(src + i * sbpp, src_format, s, n, tint) ;
+				}
+
+				uint8_t* dp = dst + i * dbpp ;
+				switch (dst_format) {
+					case ColorFormat::ARGB :
+						BlendOver(sp, reinterpret_cast<uint32_t*>(dp), n) ;
+						break ;
+					case ColorFormat::XRGB :
+						BlendOverOpaque(sp, reinterpret_cast<uint32_t*>(dp), n) ;
+						break ;
+					case ColorFormat::RGB565 :
+						Rgb565ToArgb(reinterpret_cast<const uint16_t*>(dp), d, n) ;
+						BlendOverOpaque(sp, d, n) ;
+						ArgbToRgb565(d, reinterpret_cast<uint16_t*>(dp), n) ;
+						break ;
+					case ColorFormat::A8 :
+						BlendAlpha(sp, dp, n) ;
+						break ;
+				}
+			}
+		}
+
+		inline void ConvertRect(const uint8_t* src, size_t src_stride, ColorFormat src_format, uint8_t* dst, size_t dst_stride, ColorFormat dst_format, uint32_t width, uint32_t height, uint32_t tint = 0xFF000000u) noexcept {
+			for (uint32_t y = 0 ; y < height ; ++y) {
+				ConvertRow(src + y * src_stride, src_format, dst + y * dst_stride, dst_format, width, tint) ;
+			}
+		}
+
+		inline void BlendRect(const uint8_t* src, size_t src_stride, ColorFormat src_format, uint8_t* dst, size_t dst_stride, ColorFormat dst_format, uint32_t width, uint32_t height, uint32_t tint = 0xFF000000u) noexcept {
+			for (uint32_t y = 0 ; y < height ; ++y) {
+				BlendRow(src + y * src_stride, src_format, dst + y * dst_stride, dst_format, width, tint) ;
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "env.hpp"
+
+// ZKETCH_WIN32 / ZKETCH_LINUX pick the native backends, the rest of the library is written
+// against the neutral types built on top of them. ZKETCH_X11 opts into the X11 window backend.
+// Without windows.h the Win32 names and the GDI+ subset come from win32names.hpp and softgdi.hpp.
+#if defined(_WIN32)
+	#define ZKETCH_WIN32
+	#include "win32init.hpp"
+	#include "gdiplusinit.hpp"
+#elif defined(__linux__)
+	#define ZKETCH_LINUX
+	#include "softgdi.hpp"
+	#include <poll.h>
+	#include <unistd.h>
+	#include <sys/eventfd.h>
+	#include <sys/epoll.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+
+	#ifdef ZKETCH_X11
+		#include <sys/ipc.h>
+		#include <sys/shm.h>
+		#include <X11/Xlib.h>
+		#include <X11/Xutil.h>
+		#include <X11/keysym.h>
+		#include <X11/extensions/XShm.h>
+
+		// Xlib macros that collide with zketch names, X11 code spells them out instead
+		#undef None
+		#undef Bool
+		#undef Status
+		#undef True
+		#undef False
+		#undef Success
+		#undef Always
+	#endif
+#endif
@@ -0,0 +1,192 @@
+#pragma once
+#include "windowbackend.hpp"
+#include "latency.hpp"
+
+namespace zketch {
+
+	// presents a window on its own thread with mailbox semantics. Submit() only swaps buffers and
+	// never waits for a present, the thread always shows the newest submitted frame and frames it
+	// never got to are dropped. Together with the window's back buffer this is triple buffering.
+	class PresentThread {
+	private :
+		WindowBackend* backend_ = nullptr ;
+		PresentCounters* counters_ = nullptr ;
+		std::unique_ptr<Canvas> mailbox_ ;		// newest finished frame, waiting for the thread
+		std::unique_ptr<Canvas> presenting_ ;	// owned by the thread while it presents
+		DamageList mailbox_damage_ ;			// everything changed since the last frame the thread took
+		DamageList presenting_damage_ ;
+		uint64_t mailbox_frame_ = 0 ;			// the window's frame number of each buffer
+		uint64_t presenting_frame_ = 0 ;
+		LatencyTracer* tracer_ = nullptr ;		// changed only while holding both mutexes
+		std::mutex mutex_ ;						// guards the mailbox, full_, refresh_ and stop_
+		std::mutex present_mutex_ ;				// held for the duration of a present
+		std::condition_variable cv_ ;
+		bool full_ = false ;
+		bool refresh_ = false ;
+		bool stop_ = false ;
+		std::atomic<uint64_t> submitted_ {0} ;
+		std::atomic<uint64_t> presented_ {0} ;
+		std::atomic<uint64_t> dropped_ {0} ;
+		std::thread thread_ ;
+
+		void Run() noexcept {
+			std::unique_lock<std::mutex> lock(mutex_) ;
+			while (true) {
+				cv_.wait(lock, [this] { return full_ || refresh_ || stop_ ; }) ;
+				if (stop_) {
+					return ;
+				}
+
+				presenting_damage_.Clear() ;
+				if (full_) {
+					std::swap(mailbox_, presenting_) ;
+					std::swap(mailbox_frame_, presenting_frame_) ;
+					presenting_damage_.Swap(mailbox_damage_) ;
+					full_ = false ;
+				}
+
+				if (refresh_) {
+					presenting_damage_.SetAll(presenting_->GetSize()) ;
+					refresh_ = false ;
+				}
+				lock.unlock() ;
+
+				{
+					std::lock_guard<std::mutex> present(present_mutex_) ;
+					backend_->Present(*presenting_, presenting_damage_) ;
+					if (tracer_) {
+						tracer_->OnPresent(presenting_frame_) ;
+					}
+				}
+				presented_.fetch_add(1, std::memory_order_relaxed) ;
+				if (counters_) {
+					counters_->Record(presenting_damage_.GetArea()) ;
+				}
+
+				lock.lock() ;
+			}
+		}
+
+	public :
+		PresentThread(const PresentThread&) = delete ;
+		PresentThread& operator=(const PresentThread&) = delete ;
+
+		// front becomes the presenting buffer, a third one is allocated for the mailbox.
+		PresentThread(WindowBackend* backend, std::unique_ptr<Canvas> front, PresentCounters* counters = nullptr) noexcept : backend_(backend), counters_(counters), presenting_(std::move(front)) {}
+
+		~PresentThread() noexcept {
+			Stop() ;
+		}
+
+		bool Start() noexcept {
+			if (thread_.joinable() || !backend_ || !presenting_ || !presenting_->IsValid()) {
+				return false ;
+			}
+
+			try {
+				mailbox_ = std::make_unique<Canvas>() ;
+				if (!mailbox_->Create(presenting_->GetSize(), presenting_->GetFormat())) {
+					return false ;
+				}
+
+				stop_ = false ;
+				thread_ = std::thread(&PresentThread::Run, this) ;
+			} catch (...) {
+
+				#ifdef WINDOW_DEBUG
+					logger::error("PresentThread::Start - Failed to start the present thread.") ;
+				#endif
+
+				return false ;
+			}
+			return true ;
+		}
+
+		// joins the thread and returns the newest frame: the one still waiting in the mailbox, the
+		// presented one otherwise. What the output doesn't show of it yet is added to unpresented.
+		std::unique_ptr<Canvas> Stop(DamageList* unpresented = nullptr) noexcept {
+			if (thread_.joinable()) {
+				{
+					std::lock_guard<std::mutex> lock(mutex_) ;
+					stop_ = true ;
+				}
+				cv_.notify_one() ;
+				thread_.join() ;
+			}
+
+			if (full_) {
+				std::swap(mailbox_, presenting_) ;
+				std::swap(mailbox_frame_, presenting_frame_) ;
+				if (unpresented) {
+					unpresented->Add(mailbox_damage_, presenting_->GetSize()) ;
+				}
+			}
+			if (refresh_ && unpresented && presenting_) {
+				unpresented->SetAll(presenting_->GetSize()) ;
+			}
+
+			mailbox_.reset() ;
+			mailbox_damage_.Clear() ;
+			full_ = false ;
+			refresh_ = false ;
+			return std::move(presenting_) ;
+		}
+
+		// hands a finished frame and what it changed over, frame gets the previous mailbox buffer back
+		// to draw the next one into. Returns the submitted buffer, it stays untouched until the next Submit.
+		// number is the window's frame number, handed to the latency tracer once it is presented.
+		const Canvas* Submit(std::unique_ptr<Canvas>& frame, const DamageList& damage, uint64_t number = 0) noexcept {
+			const Canvas* submitted = frame.get() ;
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				if (full_) {
+					dropped_.fetch_add(1, std::memory_order_relaxed) ;
+				}
+
+				// a dropped frame's changes never reached the output, they ride along with this one
+				mailbox_damage_.Add(damage, frame->GetSize()) ;
+				std::swap(frame, mailbox_) ;
+				mailbox_frame_ = number ;
+				full_ = true ;
+			}
+
+			submitted_.fetch_add(1, std::memory_order_relaxed) ;
+			cv_.notify_one() ;
+			return submitted ;
+		}
+
+		// presents the current frame in full again, for outputs that lost their content.
+		void Refresh() noexcept {
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				refresh_ = true ;
+			}
+			cv_.notify_one() ;
+		}
+
+		// reallocates the buffers the thread owns, waits for a present in flight.
+		bool Resize(const Size& size, ColorFormat format) noexcept {
+			std::lock_guard<std::mutex> present(present_mutex_) ;
+			std::lock_guard<std::mutex> lock(mutex_) ;
+
+			full_ = false ;
+			mailbox_damage_.Clear() ;
+			if (!mailbox_ || !presenting_) {
+				return false ;
+			}
+			return mailbox_->Create(size, format) && presenting_->Create(size, format) ;
+		}
+
+		// told about every present from the thread, null detaches it.
+		void SetLatencyTracer(LatencyTracer* tracer) noexcept {
+			std::lock_guard<std::mutex> present(present_mutex_) ;
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			tracer_ = tracer ;
+		}
+
+		bool IsRunning() const noexcept { return thread_.joinable() ; }
+		uint64_t GetSubmittedCount() const noexcept { return submitted_.load(std::memory_order_relaxed) ; }
+		uint64_t GetPresentedCount() const noexcept { return presented_.load(std::memory_order_relaxed) ; }
+		uint64_t GetDroppedCount() const noexcept { return dropped_.load(std::memory_order_relaxed) ; }
+	} ;
+}
@@ -0,0 +1,335 @@
+#pragma once
+#include "canvas.hpp"
+#include "damage.hpp"
+#include "capture.hpp"
+
+namespace zketch {
+
+	struct RecorderStats {
+		uint64_t frames_ = 0 ;			// written to the file
+		uint64_t key_frames_ = 0 ;
+		uint64_t dropped_ = 0 ;			// folded into the next frame because the encoder fell behind
+		uint64_t raw_bytes_ = 0 ;		// pixel bytes of the recorded rects
+		uint64_t file_bytes_ = 0 ;
+		std::chrono::nanoseconds capture_time_ {} ;	// spent in Capture on the caller's thread
+		std::chrono::nanoseconds encode_time_ {} ;	// spent on the recorder's thread
+
+		double GetRatio() const noexcept { return file_bytes_ ? static_cast<double>(raw_bytes_) / static_cast<double>(file_bytes_) : 0.0 ; }
+		std::chrono::nanoseconds GetAverageCaptureTime() const noexcept { return frames_ + dropped_ ? capture_time_ / static_cast<int64_t>(frames_ + dropped_) : std::chrono::nanoseconds {} ; }
+	} ;
+
+	// records frames into a capture file (capture.hpp). Capture only keeps a copy-on-write reference
+	// to the frame, the XOR against the previous frame, encoding and writing run on the recorder's
+	// thread. Attach it to a Window with SetRecorder or feed it any Canvas.
+	class FrameRecorder {
+	private :
+		static constexpr size_t ___MAX_PENDING___ = 2 ;
+
+		struct Job {
+			Canvas frame_ ;		// shares the pixels until the encoder is done with them
+			std::vector<CaptureRect> rects_ ;
+			uint64_t timestamp_ = 0 ;
+		} ;
+
+		// caller side
+		std::mutex mutex_ ;
+		std::condition_variable cv_ ;
+		std::deque<Job> queue_ ;
+		size_t busy_ = 0 ;
+		DamageList carry_ ;				// damage of frames that were dropped
+		Size size_ {} ;					// of the last queued frame
+		ColorFormat format_ = ColorFormat::ARGB ;
+		std::chrono::steady_clock::time_point start_ {} ;
+		RecorderStats stats_ ;
+		bool stop_ = false ;
+		std::thread thread_ ;
+
+		// recorder thread
+		std::ofstream file_ ;
+		std::vector<CaptureFile::Entry> index_ ;
+		std::vector<uint8_t> previous_ ;	// last recorded frame, rows padded to 4 bytes
+		std::vector<uint32_t> delta_ ;
+		std::vector<uint8_t> encoded_ ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		ColorFormat encoded_format_ = ColorFormat::ARGB ;
+		uint32_t key_interval_ = 0 ;
+		uint32_t since_key_ = 0 ;
+		uint64_t offset_ = 0 ;
+
+		void Run() noexcept {
+			std::unique_lock<std::mutex> lock(mutex_) ;
+			while (true) {
+				cv_.wait(lock, [this] { return stop_ || !queue_.empty() ; }) ;
+				if (queue_.empty()) {
+					return ;
+				}
+
+				Job job = std::move(queue_.front()) ;
+				queue_.pop_front() ;
+				++busy_ ;
+				lock.unlock() ;
+
+				const auto t0 = std::chrono::steady_clock::now() ;
+				RecorderStats done ;
+				Encode(job, done) ;
+				done.encode_time_ = std::chrono::steady_clock::now() - t0 ;
+
+				lock.lock() ;
+				--busy_ ;
+				stats_.frames_ += done.frames_ ;
+				stats_.key_frames_ += done.key_frames_ ;
+				stats_.raw_bytes_ += done.raw_bytes_ ;
+				stats_.file_bytes_ += done.file_bytes_ ;
+				stats_.encode_time_ += done.encode_time_ ;
+				cv_.notify_all() ;
+			}
+		}
+
+		void Encode(Job& job, RecorderStats& done) noexcept {
+			// a scrolled ring buffer goes out in logical order, unwrapping copies the pixels for the job alone
+			if (!job.frame_.Unwrap()) {
+
+				#ifdef CAPTURE_DEBUG
+					logger::error("FrameRecorder::Encode - Failed to unwrap frame, the next one is recorded as key frame.") ;
+				#endif
+
+				previous_.clear() ;
+				return ;
+			}
+
+			const ImageView view = job.frame_.GetView() ;
+			const uint32_t bpp = BytesPerPixel(view.format_) ;
+			const size_t stride = CaptureFile::PaddedRow(view.width_, view.format_) ;
+			const bool key = previous_.empty() || view.width_ != width_ || view.height_ != height_ || view.format_ != encoded_format_ || since_key_ >= key_interval_ ;
+
+			try {
+				if (key) {
+					width_ = view.width_ ;
+					height_ = view.height_ ;
+					encoded_format_ = view.format_ ;
+					since_key_ = 0 ;
+					previous_.assign(stride * height_, 0) ;
+					job.rects_.assign(1, {0, 0, width_, height_}) ;
+				}
+
+				size_t words = 0 ;
+				for (const CaptureRect& r : job.rects_) {
+					words += CaptureFile::PaddedRow(r.w, view.format_) / 4 * r.h ;
+				}
+				delta_.resize(words) ;
+
+				uint8_t* out = reinterpret_cast<uint8_t*>(delta_.data()) ;
+				for (const CaptureRect& r : job.rects_) {
+					const size_t bytes = static_cast<size_t>(r.w) * bpp ;
+					const size_t padded = CaptureFile::PaddedRow(r.w, view.format_) ;
+					for (uint32_t y = 0 ; y < r.h ; ++y) {
+						codec::XorDelta(out, previous_.data() + (r.y + y) * stride + r.x * bpp, view.GetRow(r.y + y) + r.x * bpp, bytes) ;
+						std::fill(out + bytes, out + padded, 0) ;
+						out += padded ;
+					}
+					done.raw_bytes_ += bytes * r.h ;
+				}
+
+				// nothing reads the frame past this point, the window can draw into it in place again
+				job.frame_ = {} ;
+
+				encoded_.resize(CaptureFile::___FRAME_SIZE___ + job.rects_.size() * CaptureFile::___RECT_SIZE___ + codec::WordRunBound(words)) ;
+				uint8_t* head = encoded_.data() ;
+				uint8_t* rects = head + CaptureFile::___FRAME_SIZE___ ;
+				uint8_t* payload = rects + job.rects_.size() * CaptureFile::___RECT_SIZE___ ;
+				uint8_t* end = codec::WordRunEncode(delta_.data(), words, payload) ;
+
+				codec::PutU32LE(head, width_) ;
+				codec::PutU32LE(head + 4, height_) ;
+				head[8] = static_cast<uint8_t>(encoded_format_) ;
+				head[9] = key ? CaptureFile::___KEY_FRAME___ : 0 ;
+				head[10] = static_cast<uint8_t>(job.rects_.size()) ;
+				head[11] = static_cast<uint8_t>(job.rects_.size() >> 8) ;
+				codec::PutU32LE(head + 12, static_cast<uint32_t>(end - payload)) ;
+				codec::PutU64LE(head + 16, job.timestamp_) ;
+				for (const CaptureRect& r : job.rects_) {
+					codec::PutU32LE(rects, static_cast<uint32_t>(r.x)) ;
+					codec::PutU32LE(rects + 4, static_cast<uint32_t>(r.y)) ;
+					codec::PutU32LE(rects + 8, r.w) ;
+					codec::PutU32LE(rects + 12, r.h) ;
+					rects += CaptureFile::___RECT_SIZE___ ;
+				}
+
+				const size_t size = static_cast<size_t>(end - head) ;
+				file_.write(reinterpret_cast<const char*>(head), static_cast<std::streamsize>(size)) ;
+				if (key) {
+					file_.flush() ;
+				}
+
+				index_.push_back({offset_, job.timestamp_, key ? CaptureFile::___KEY_FRAME___ : 0u}) ;
+				offset_ += size ;
+				++since_key_ ;
+				++done.frames_ ;
+				done.key_frames_ += key ? 1 : 0 ;
+				done.file_bytes_ += size ;
+			} catch (...) {
+
+				#ifdef CAPTURE_DEBUG
+					logger::error("FrameRecorder::Encode - Failed to encode frame, the next one is recorded as key frame.") ;
+				#endif
+
+				previous_.clear() ;
+			}
+		}
+
+	public :
+		FrameRecorder(const FrameRecorder&) = delete ;
+		FrameRecorder& operator=(const FrameRecorder&) = delete ;
+		FrameRecorder() noexcept = default ;
+
+		~FrameRecorder() noexcept {
+			Close() ;
+		}
+
+		// a key frame is written every key_interval frames, seeking decodes at most that many.
+		bool Open(const std::string& path, uint32_t key_interval = 120) noexcept {
+			Close() ;
+
+			file_.open(path, std::ios::binary | std::ios::trunc) ;
+			if (!file_) {
+
+				#ifdef CAPTURE_DEBUG
+					logger::error("FrameRecorder::Open - Failed to open ", path, '.') ;
+				#endif
+
+				return false ;
+			}
+
+			// frame count and index stay 0 until Close, readers scan a file that never got there
+			uint8_t header[CaptureFile::___HEADER_SIZE___] {} ;
+			memcpy(header, CaptureFile::___MAGIC___, 8) ;
+			codec::PutU32LE(header + 8, CaptureFile::___VERSION___) ;
+			codec::PutU32LE(header + 16, std::max(key_interval, 1u)) ;
+			file_.write(reinterpret_cast<const char*>(header), sizeof(header)) ;
+
+			key_interval_ = std::max(key_interval, 1u) ;
+			since_key_ = 0 ;
+			offset_ = sizeof(header) ;
+			previous_.clear() ;
+			index_.clear() ;
+			carry_.Clear() ;
+			size_ = {} ;
+			stats_ = {} ;
+			stop_ = false ;
+			start_ = std::chrono::steady_clock::now() ;
+
+			try {
+				thread_ = std::thread(&FrameRecorder::Run, this) ;
+			} catch (...) {
+				file_.close() ;
+				return false ;
+			}
+			return true ;
+		}
+
+		// queues frame, damage is what changed since the previously captured frame. Returns false when
+		// the frame wasn't queued, a frame dropped because the encoder fell behind is folded into the
+		// next one. timestamp defaults to the time since Open.
+		bool Capture(const Canvas& frame, const DamageList& damage, std::optional<std::chrono::nanoseconds> timestamp = std::nullopt) noexcept {
+			const auto t0 = std::chrono::steady_clock::now() ;
+			if (!IsRecording() || !frame.IsValid()) {
+				return false ;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			const Size size = frame.GetSize() ;
+			const bool resized = size != size_ || frame.GetFormat() != format_ ;
+			if (resized) {
+				carry_.SetAll(size) ;
+			} else {
+				carry_.Add(damage, size) ;
+			}
+
+			bool queued = false ;
+			if (queue_.size() + busy_ >= ___MAX_PENDING___) {
+				++stats_.dropped_ ;
+			} else if (!carry_.IsEmpty()) {
+				try {
+					Job job ;
+					job.frame_ = frame ;
+					job.timestamp_ = static_cast<uint64_t>((timestamp ? *timestamp : std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - start_)).count()) ;
+					job.rects_.reserve(carry_.GetCount()) ;
+					for (const Rect& r : carry_) {
+						job.rects_.push_back({r.x, r.y, r.w, r.h}) ;
+					}
+
+					queue_.push_back(std::move(job)) ;
+					size_ = size ;
+					format_ = frame.GetFormat() ;
+					carry_.Clear() ;
+					queued = true ;
+					cv_.notify_all() ;
+				} catch (...) {
+					++stats_.dropped_ ;
+				}
+			}
+
+			stats_.capture_time_ += std::chrono::steady_clock::now() - t0 ;
+			return queued ;
+		}
+
+		// the whole canvas, for sources that don't track damage.
+		bool Capture(const Canvas& frame, std::optional<std::chrono::nanoseconds> timestamp = std::nullopt) noexcept {
+			DamageList all ;
+			all.SetAll(frame.GetSize()) ;
+			return Capture(frame, all, timestamp) ;
+		}
+
+		// waits for queued frames, then writes the index and finalizes the header.
+		bool Close() noexcept {
+			if (!thread_.joinable()) {
+				return false ;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				stop_ = true ;
+			}
+			cv_.notify_all() ;
+			thread_.join() ;
+
+			const uint64_t index = offset_ ;
+			try {
+				std::vector<uint8_t> raw(index_.size() * CaptureFile::___INDEX_SIZE___, 0) ;
+				for (size_t i = 0 ; i < index_.size() ; ++i) {
+					uint8_t* e = raw.data() + i * CaptureFile::___INDEX_SIZE___ ;
+					codec::PutU64LE(e, index_[i].offset_) ;
+					codec::PutU64LE(e + 8, index_[i].timestamp_) ;
+					codec::PutU32LE(e + 16, index_[i].flags_) ;
+				}
+				file_.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size())) ;
+			} catch (...) {
+				file_.close() ;
+				return false ;
+			}
+
+			uint8_t patch[8] ;
+			codec::PutU32LE(patch, static_cast<uint32_t>(index_.size())) ;
+			file_.seekp(12) ;
+			file_.write(reinterpret_cast<const char*>(patch), 4) ;
+			codec::PutU64LE(patch, index) ;
+			file_.seekp(24) ;
+			file_.write(reinterpret_cast<const char*>(patch), 8) ;
+
+			const bool ok = static_cast<bool>(file_) ;
+			file_.close() ;
+			previous_ = {} ;
+			delta_ = {} ;
+			encoded_ = {} ;
+			return ok ;
+		}
+
+		bool IsRecording() const noexcept { return thread_.joinable() ; }
+
+		RecorderStats GetStats() noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			return stats_ ;
+		}
+	} ;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "platform.hpp"
+#include "logger.hpp"
+
+namespace zketch {
+
+	// a 32-bit name for something that may die while events still point at it: the low bits pick a
+	// slot of a fixed table, the high bits are the slot's generation. Releasing bumps the generation,
+	// so an id handed out before resolves to nothing afterwards instead of to a dangling pointer.
+	// 0 never names anything.
+	using WindowId = uint32_t ;
+	using WidgetId = uint32_t ;
+
+	// lock-free, any thread may acquire, resolve and release. Objects are compared by value, the
+	// table never owns them. An object lives in the first free slot probing from its hash, so a
+	// lookup stays O(1) however many objects are registered. A full table hands out 0.
+	template <typename T, uint32_t IndexBits>
+	class Registry {
+		static_assert(std::is_pointer_v<T>, "Registry holds pointers") ;
+		static_assert(IndexBits > 0 && IndexBits < 24, "Registry needs bits left for generations") ;
+
+	private :
+		static constexpr uint32_t ___SLOTS___ = 1u << IndexBits ;
+		static constexpr uint32_t ___INDEX_MASK___ = ___SLOTS___ - 1 ;
+		static constexpr uint32_t ___GENERATIONS___ = UINT32_MAX >> IndexBits ;
+
+		struct Entry {
+			std::atomic<T> object_ ;
+			std::atomic<uint32_t> generation_ ;	// one less than the one in ids, so a zeroed table is valid
+		} ;
+
+		static inline std::array<Entry, ___SLOTS___> g_entries_ {} ;
+
+		// a released slot never gets generation 0 back, so 0 with no object means never taken and ends
+		// a probe.
+		static constexpr uint32_t NextGeneration(uint32_t generation) noexcept {
+			return generation + 1 < ___GENERATIONS___ ? generation + 1 : 1 ;
+		}
+
+		static constexpr uint32_t Compose(uint32_t index, uint32_t generation) noexcept {
+			return ((generation + 1) << IndexBits) | index ;
+		}
+
+		static uint32_t Home(T object) noexcept {
+			return static_cast<uint32_t>((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object)) * 0x9E3779B97F4A7C15ull) >> (64 - IndexBits)) ;
+		}
+
+		static uint32_t Find(T object) noexcept {
+			uint32_t index = Home(object) ;
+			for (uint32_t probe = 0 ; probe < ___SLOTS___ ; ++probe, index = (index + 1) & ___INDEX_MASK___) {
+				const Entry& entry = g_entries_[index] ;
+				const T held = entry.object_.load(std::memory_order_acquire) ;
+				if (held == object) {
+					return index ;
+				}
+				if (!held && entry.generation_.load(std::memory_order_acquire) == 0) {
+					break ;
+				}
+			}
+			return ___SLOTS___ ;
+		}
+
+	public :
+		Registry() = delete ;
+
+		// the id of object, registering it the first time it is seen. 0 for null or a full table.
+		static uint32_t Acquire(T object) noexcept {
+			if (!object) {
+				return 0 ;
+			}
+
+			while (true) {
+				uint32_t index = Find(object) ;
+				if (index == ___SLOTS___) {
+					index = Home(object) ;
+					uint32_t probe = 0 ;
+					for ( ; probe < ___SLOTS___ ; ++probe, index = (index + 1) & ___INDEX_MASK___) {
+						// another thread registering object at the same time lands on the same slot first
+						T expected = nullptr ;
+						if (g_entries_[index].object_.compare_exchange_strong(expected, object, std::memory_order_acq_rel) || expected == object) {
+							break ;
+						}
+					}
+
+					if (probe == ___SLOTS___) {
+						logger::error("Registry::Acquire - All ", ___SLOTS___, " slots are taken, the object gets no id.") ;
+						return 0 ;
+					}
+				}
+
+				// released in between, the generation read may already belong to the next object
+				const Entry& entry = g_entries_[index] ;
+				const uint32_t generation = entry.generation_.load(std::memory_order_acquire) ;
+				if (entry.object_.load(std::memory_order_acquire) == object) {
+					return Compose(index, generation) ;
+				}
+			}
+		}
+
+		// the object id was acquired for, null once it was released.
+		static T Resolve(uint32_t id) noexcept {
+			if (id == 0) {
+				return nullptr ;
+			}
+
+			const Entry& entry = g_entries_[id & ___INDEX_MASK___] ;
+			const T object = entry.object_.load(std::memory_order_acquire) ;
+			return Compose(0, entry.generation_.load(std::memory_order_acquire)) == (id & ~___INDEX_MASK___) ? object : nullptr ;
+		}
+
+		static bool IsAlive(uint32_t id) noexcept { return Resolve(id) != nullptr ; }
+
+		// the table slot id lives in. Ids of objects that held the slot one after the other share it.
+		static constexpr uint32_t IndexOf(uint32_t id) noexcept { return id & ___INDEX_MASK___ ; }
+
+		// every id of object goes stale, the slot is free for the next one.
+		static void Release(T object) noexcept {
+			if (!object) {
+				return ;
+			}
+
+			const uint32_t index = Find(object) ;
+			if (index == ___SLOTS___) {
+				return ;
+			}
+
+			Entry& entry = g_entries_[index] ;
+			entry.generation_.store(NextGeneration(entry.generation_.load(std::memory_order_relaxed)), std::memory_order_release) ;
+			entry.object_.store(nullptr, std::memory_order_release) ;
+		}
+
+		// objects registered right now.
+		static size_t GetCount() noexcept {
+			size_t count = 0 ;
+			for (const Entry& entry : g_entries_) {
+				count += entry.object_.load(std::memory_order_relaxed) ? 1 : 0 ;
+			}
+			return count ;
+		}
+	} ;
+
+	// windows register the first time an event names them and go stale when they are destroyed.
+	using WindowRegistry = Registry<HWND, 10> ;
+
+	// widgets register the first time they push an event and go stale when they are destroyed.
+	using WidgetRegistry = Registry<void*, 12> ;
+}
@@ -0,0 +1,1113 @@
+#pragma once
+#include "canvas.hpp"
+#include "damage.hpp"
+#include "capture.hpp"
+#include "event.hpp"
+#include "waitable.hpp"
+
+namespace zketch {
+
+	// ------------------------------ streams ------------------------------
+
+	// a connection to one remote client. Write blocks until everything is sent, Read never blocks.
+	// Implement it to serve over anything that moves bytes both ways.
+	class RemoteStream : public ImageWriter {
+	public :
+		// bytes read, 0 when nothing is waiting, -1 once the peer is gone.
+		virtual int64_t Read(void* data, size_t size) noexcept = 0 ;
+
+		// readable whenever Read has data, the server sleeps on it. -1 makes it poll Read instead.
+		virtual int GetFd() const noexcept { return -1 ; }
+	} ;
+
+	#ifdef ZKETCH_LINUX
+
+		class UnixSocketStream : public RemoteStream {
+		private :
+			static constexpr int ___SEND_TIMEOUT___ = 2 ;	// seconds, a client stalled longer is dropped
+
+			int fd_ = -1 ;
+
+		public :
+			UnixSocketStream(const UnixSocketStream&) = delete ;
+			UnixSocketStream& operator=(const UnixSocketStream&) = delete ;
+
+			explicit UnixSocketStream(int fd) noexcept : fd_(fd) {
+				timeval timeout {___SEND_TIMEOUT___, 0} ;
+				setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) ;
+			}
+
+			~UnixSocketStream() noexcept {
+				if (fd_ >= 0) {
+					close(fd_) ;
+				}
+			}
+
+			static std::unique_ptr<UnixSocketStream> Connect(const std::string& path) noexcept {
+				sockaddr_un addr {} ;
+				if (path.size() >= sizeof(addr.sun_path)) {
+					return nullptr ;
+				}
+
+				addr.sun_family = AF_UNIX ;
+				memcpy(addr.sun_path, path.c_str(), path.size() + 1) ;
+
+				int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) ;
+				if (fd < 0) {
+					return nullptr ;
+				}
+
+				if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+
+					#ifdef REMOTE_DEBUG
+						logger::error("UnixSocketStream::Connect - Failed to connect to ", path, '.') ;
+					#endif
+
+					close(fd) ;
+					return nullptr ;
+				}
+
+				std::unique_ptr<UnixSocketStream> stream(new (std::nothrow) UnixSocketStream(fd)) ;
+				if (!stream) {
+					close(fd) ;
+				}
+				return stream ;
+			}
+
+			// both ends of a connected socket, a loopback without touching the file system.
+			static std::pair<std::unique_ptr<UnixSocketStream>, std::unique_ptr<UnixSocketStream>> Pair() noexcept {
+				int fds[2] ;
+				if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+					return {} ;
+				}
+
+				std::unique_ptr<UnixSocketStream> a(new (std::nothrow) UnixSocketStream(fds[0])) ;
+				std::unique_ptr<UnixSocketStream> b(new (std::nothrow) UnixSocketStream(fds[1])) ;
+				if (!a || !b) {
+					if (!a) {
+						close(fds[0]) ;
+					}
+					if (!b) {
+						close(fds[1]) ;
+					}
+					return {} ;
+				}
+				return {std::move(a), std::move(b)} ;
+			}
+
+			bool Write(const void* data, size_t size) noexcept override {
+				const uint8_t* bytes = static_cast<const uint8_t*>(data) ;
+				while (size > 0) {
+					ssize_t n = send(fd_, bytes, size, MSG_NOSIGNAL) ;
+					if (n < 0 && errno == EINTR) {
+						continue ;
+					}
+					if (n <= 0) {
+						return false ;
+					}
+					bytes += n ;
+					size -= static_cast<size_t>(n) ;
+				}
+				return true ;
+			}
+
+			int64_t Read(void* data, size_t size) noexcept override {
+				ssize_t n = recv(fd_, data, size, MSG_DONTWAIT) ;
+				if (n > 0) {
+					return n ;
+				}
+				if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+					return 0 ;
+				}
+				return -1 ;
+			}
+
+			int GetFd() const noexcept override { return fd_ ; }
+		} ;
+
+	#endif
+
+	// ------------------------------ protocol ------------------------------
+	//
+	// message		u8 type, u8[3] reserved, u32 body size, body
+	//
+	// server		hello		u32 version, u32 tile size, u32 cache slots
+	//				frame		u32 width, u32 height, u32 tile count,
+	//							tile count * (u32 x, u32 y, u16 w, u16 h, u8 encoding, u8[3] reserved, u64 hash, u32 size, payload)
+	// client		input		u8 event type (Key or Mouse), u8 button, u8 state, u8 reserved, i32 x, i32 y, i32 value
+	//				encoding	u8 RemoteEncoding
+	//				refresh		empty, the server resends every tile
+	//
+	// all little endian. The window is cut into tile size squares, a frame carries the tiles the client
+	// doesn't show yet as 0xAARRGGBB pixels. Both sides remember the last tile sent per cache slot
+	// (hash % slots), a tile found there is sent as a reference to it without payload.
+
+	enum class RemoteEncoding : uint8_t {
+		Raw,
+		Rle,	// word runs (capture.hpp)
+		Qoi,
+		Auto	// the smaller of Rle and Qoi per tile
+	} ;
+
+	struct RemoteProtocol {
+		static constexpr uint32_t ___VERSION___ = 1 ;
+		static constexpr uint32_t ___TILE___ = 64 ;
+		static constexpr uint32_t ___CACHE_SLOTS___ = 512 ;
+		static constexpr size_t ___MESSAGE_SIZE___ = 8 ;
+		static constexpr size_t ___HELLO_SIZE___ = 12 ;
+		static constexpr size_t ___FRAME_SIZE___ = 12 ;
+		static constexpr size_t ___TILE_SIZE___ = 28 ;
+		static constexpr size_t ___INPUT_SIZE___ = 16 ;
+		static constexpr size_t ___MAX_CLIENT_MESSAGE___ = 64 ;
+
+		// what a client accepts from a server: frames up to 8192 x 8192, a message up to such a frame
+		// sent whole and raw
+		static constexpr size_t ___MAX_FRAME_PIXELS___ = size_t(8192) * 8192 ;
+		static constexpr size_t ___MAX_SERVER_MESSAGE___ = ___FRAME_SIZE___ + ___MAX_FRAME_PIXELS___ * 4 + (8192 / ___TILE___ + 1) * (8192 / ___TILE___ + 1) * ___TILE_SIZE___ ;
+
+		static constexpr uint8_t ___HELLO___ = 1 ;
+		static constexpr uint8_t ___FRAME___ = 2 ;
+		static constexpr uint8_t ___INPUT___ = 16 ;
+		static constexpr uint8_t ___ENCODING___ = 17 ;
+		static constexpr uint8_t ___REFRESH___ = 18 ;
+
+		// tile encodings, Raw, Rle and Qoi match RemoteEncoding
+		static constexpr uint8_t ___CACHED___ = 3 ;
+
+		static void PutMessage(uint8_t* out, uint8_t type, uint32_t size) noexcept {
+			out[0] = type ;
+			out[1] = out[2] = out[3] = 0 ;
+			codec::PutU32LE(out + 4, size) ;
+		}
+
+		// never 0, that marks a tile the client hasn't got.
+		static uint64_t HashTile(const uint32_t* pixels, uint32_t stride, uint32_t w, uint32_t h) noexcept {
+			uint64_t hash = 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(w) << 32 | h) ;
+			for (uint32_t y = 0 ; y < h ; ++y) {
+				const uint32_t* row = pixels + static_cast<size_t>(y) * stride ;
+				uint32_t x = 0 ;
+				for ( ; x + 2 <= w ; x += 2) {
+					uint64_t word ;
+					memcpy(&word, row + x, sizeof(word)) ;
+					hash = (hash ^ word) * 0xFF51AFD7ED558CCDull ;
+					hash ^= hash >> 32 ;
+				}
+				if (x < w) {
+					hash = (hash ^ row[x]) * 0xFF51AFD7ED558CCDull ;
+					hash ^= hash >> 32 ;
+				}
+			}
+			return hash ? hash : 1 ;
+		}
+	} ;
+
+	// ------------------------------ server ------------------------------
+
+	struct RemoteStats {
+		uint64_t clients_ = 0 ;			// connected right now
+		uint64_t frames_ = 0 ;			// frame messages sent, summed over clients
+		uint64_t tiles_ = 0 ;			// sent with pixels
+		uint64_t cached_tiles_ = 0 ;	// sent as a cache reference
+		uint64_t raw_bytes_ = 0 ;		// 32 bit pixels of every tile sent
+		uint64_t sent_bytes_ = 0 ;
+		uint64_t events_ = 0 ;			// input events pushed into EventSystem
+
+		double GetRatio() const noexcept { return sent_bytes_ ? static_cast<double>(raw_bytes_) / static_cast<double>(sent_bytes_) : 0.0 ; }
+	} ;
+
+	// streams a window to remote clients and feeds their input back into EventSystem. Submit only
+	// keeps a copy-on-write reference to the frame, copying, hashing, encoding and all socket work
+	// run on the server's thread. Attach it to a Window with SetFramebufferServer or feed it any Canvas.
+	//
+	// the server mirrors the frame and hashes it per tile, every client gets the tiles whose hash
+	// differs from what it shows, so a slow client skips frames instead of queueing them and a new
+	// client gets the whole picture without the window redrawing.
+	class FramebufferServer {
+	private :
+		static constexpr auto ___POLL___ = std::chrono::milliseconds(8) ;	// for streams without fd
+
+		struct Client {
+			std::unique_ptr<RemoteStream> stream_ ;
+			std::vector<uint64_t> shown_ ;		// tile hash per cell the client shows, 0 unknown
+			std::vector<uint64_t> cache_ ;		// tile hash per cache slot
+			std::vector<uint8_t> in_ ;
+			RemoteEncoding encoding_ = RemoteEncoding::Auto ;
+		} ;
+
+		// caller side
+		std::mutex mutex_ ;
+		Canvas pending_ ;
+		DamageList damage_ ;				// since the frame the server last picked up
+		Size size_ {} ;						// of the last submitted frame
+		std::vector<std::unique_ptr<RemoteStream>> joining_ ;
+		HWND target_ = nullptr ;
+		RemoteStats stats_ ;
+		bool stop_ = false ;
+		WakeSignal wake_ ;
+		std::thread thread_ ;
+
+		// server thread
+		std::vector<Client> clients_ ;
+		std::vector<uint32_t> mirror_ ;		// last frame as 0xAARRGGBB
+		std::vector<uint64_t> hashes_ ;		// per tile of mirror_
+		std::vector<uint8_t> dirty_ ;
+		std::vector<uint32_t> tile_ ;
+		std::vector<uint8_t> scratch_ ;
+		std::vector<uint8_t> out_ ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		uint32_t columns_ = 0 ;
+		uint32_t rows_ = 0 ;
+
+		#ifdef ZKETCH_LINUX
+			int listener_ = -1 ;
+			std::string path_ ;
+		#endif
+
+		void Run() noexcept {
+			while (true) {
+				Canvas frame ;
+				DamageList damage ;
+				HWND target ;
+				{
+					std::unique_lock<std::mutex> lock(mutex_) ;
+					if (stop_) {
+						break ;
+					}
+
+					for (auto& stream : joining_) {
+						Adopt(std::move(stream)) ;
+					}
+					joining_.clear() ;
+
+					frame = pending_ ;
+					pending_ = {} ;
+					damage = damage_ ;
+					damage_.Clear() ;
+					target = target_ ;
+				}
+
+				if (frame.IsValid()) {
+					Update(frame, damage) ;
+				}
+
+				RemoteStats done ;
+				Accept() ;
+				Receive(target, done) ;
+				Send(done) ;
+
+				bool poll = false ;
+				for (const Client& client : clients_) {
+					#ifdef ZKETCH_LINUX
+						poll |= client.stream_->GetFd() < 0 ;
+					#else
+						poll = true ;
+					#endif
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(mutex_) ;
+					stats_.clients_ = clients_.size() ;
+					stats_.frames_ += done.frames_ ;
+					stats_.tiles_ += done.tiles_ ;
+					stats_.cached_tiles_ += done.cached_tiles_ ;
+					stats_.raw_bytes_ += done.raw_bytes_ ;
+					stats_.sent_bytes_ += done.sent_bytes_ ;
+					stats_.events_ += done.events_ ;
+				}
+
+				wake_.Wait(poll ? std::optional<std::chrono::nanoseconds>(___POLL___) : std::nullopt) ;
+			}
+
+			while (!clients_.empty()) {
+				Drop(clients_.size() - 1) ;
+			}
+		}
+
+		void Adopt(std::unique_ptr<RemoteStream> stream) noexcept {
+			try {
+				Client client ;
+				client.stream_ = std::move(stream) ;
+				client.cache_.assign(RemoteProtocol::___CACHE_SLOTS___, 0) ;
+
+				uint8_t hello[RemoteProtocol::___MESSAGE_SIZE___ + RemoteProtocol::___HELLO_SIZE___] ;
+				RemoteProtocol::PutMessage(hello, RemoteProtocol::___HELLO___, RemoteProtocol::___HELLO_SIZE___) ;
+				codec::PutU32LE(hello + 8, RemoteProtocol::___VERSION___) ;
+				codec::PutU32LE(hello + 12, RemoteProtocol::___TILE___) ;
+				codec::PutU32LE(hello + 16, RemoteProtocol::___CACHE_SLOTS___) ;
+				if (!client.stream_->Write(hello, sizeof(hello))) {
+					return ;
+				}
+
+				#ifdef ZKETCH_LINUX
+					if (client.stream_->GetFd() >= 0) {
+						wake_.AddWatch(client.stream_->GetFd()) ;
+					}
+				#endif
+
+				clients_.push_back(std::move(client)) ;
+			} catch (...) {
+
+				#ifdef REMOTE_DEBUG
+					logger::error("FramebufferServer::Adopt - Failed to add client.") ;
+				#endif
+
+			}
+		}
+
+		void Drop(size_t i) noexcept {
+			#ifdef ZKETCH_LINUX
+				if (clients_[i].stream_->GetFd() >= 0) {
+					wake_.RemoveWatch(clients_[i].stream_->GetFd()) ;
+				}
+			#endif
+
+			clients_.erase(clients_.begin() + i) ;
+		}
+
+		void Accept() noexcept {
+			#ifdef ZKETCH_LINUX
+				if (listener_ < 0) {
+					return ;
+				}
+
+				while (true) {
+					int fd = accept4(listener_, nullptr, nullptr, SOCK_CLOEXEC) ;
+					if (fd < 0) {
+						return ;
+					}
+
+					std::unique_ptr<RemoteStream> stream(new (std::nothrow) UnixSocketStream(fd)) ;
+					if (!stream) {
+						close(fd) ;
+						return ;
+					}
+					Adopt(std::move(stream)) ;
+				}
+			#endif
+		}
+
+		// copies the damaged tiles of frame into the mirror, then lets go of frame before hashing.
+		void Update(Canvas& frame, const DamageList& damage) noexcept {
+			// a scrolled ring buffer is mirrored in logical order
+			if (!frame.Unwrap()) {
+				return ;
+			}
+
+			const ImageView view = frame.GetView() ;
+			const uint32_t bpp = BytesPerPixel(view.format_) ;
+
+			try {
+				if (view.width_ != width_ || view.height_ != height_) {
+					width_ = view.width_ ;
+					height_ = view.height_ ;
+					columns_ = (width_ + RemoteProtocol::___TILE___ - 1) / RemoteProtocol::___TILE___ ;
+					rows_ = (height_ + RemoteProtocol::___TILE___ - 1) / RemoteProtocol::___TILE___ ;
+					mirror_.assign(static_cast<size_t>(width_) * height_, 0) ;
+					hashes_.assign(static_cast<size_t>(columns_) * rows_, 0) ;
+					dirty_.assign(hashes_.size(), 1) ;
+				} else {
+					std::fill(dirty_.begin(), dirty_.end(), 0) ;
+					for (const Rect& r : damage) {
+						const uint32_t x1 = (static_cast<uint32_t>(r.x) + r.w - 1) / RemoteProtocol::___TILE___ ;
+						const uint32_t y1 = (static_cast<uint32_t>(r.y) + r.h - 1) / RemoteProtocol::___TILE___ ;
+						for (uint32_t ty = static_cast<uint32_t>(r.y) / RemoteProtocol::___TILE___ ; ty <= y1 && ty < rows_ ; ++ty) {
+							for (uint32_t tx = static_cast<uint32_t>(r.x) / RemoteProtocol::___TILE___ ; tx <= x1 && tx < columns_ ; ++tx) {
+								dirty_[static_cast<size_t>(ty) * columns_ + tx] = 1 ;
+							}
+						}
+					}
+				}
+			} catch (...) {
+				width_ = height_ = columns_ = rows_ = 0 ;
+				mirror_.clear() ;
+				hashes_.clear() ;
+				dirty_.clear() ;
+				return ;
+			}
+
+			for (uint32_t ty = 0 ; ty < rows_ ; ++ty) {
+				const uint32_t y0 = ty * RemoteProtocol::___TILE___ ;
+				const uint32_t h = std::min(RemoteProtocol::___TILE___, height_ - y0) ;
+				for (uint32_t tx = 0 ; tx < columns_ ; ++tx) {
+					if (!dirty_[static_cast<size_t>(ty) * columns_ + tx]) {
+						continue ;
+					}
+
+					// neighbouring dirty tiles of a row are converted in one go
+					uint32_t end = tx + 1 ;
+					while (end < columns_ && dirty_[static_cast<size_t>(ty) * columns_ + end]) {
+						++end ;
+					}
+
+					const uint32_t x0 = tx * RemoteProtocol::___TILE___ ;
+					const uint32_t w = std::min(end * RemoteProtocol::___TILE___, width_) - x0 ;
+					for (uint32_t y = y0 ; y < y0 + h ; ++y) {
+						codec::ToArgbRow(view.GetRow(y) + static_cast<size_t>(x0) * bpp, view.format_, mirror_.data() + static_cast<size_t>(y) * width_ + x0, w) ;
+					}
+					tx = end - 1 ;
+				}
+			}
+
+			// nothing reads the frame past this point, the window can draw into it in place again
+			frame = {} ;
+
+			for (uint32_t ty = 0 ; ty < rows_ ; ++ty) {
+				for (uint32_t tx = 0 ; tx < columns_ ; ++tx) {
+					const size_t cell = static_cast<size_t>(ty) * columns_ + tx ;
+					if (dirty_[cell]) {
+						const Rect r = GetTile(tx, ty) ;
+						hashes_[cell] = RemoteProtocol::HashTile(mirror_.data() + static_cast<size_t>(r.y) * width_ + r.x, width_, r.w, r.h) ;
+					}
+				}
+			}
+		}
+
+		Rect GetTile(uint32_t tx, uint32_t ty) const noexcept {
+			const uint32_t x = tx * RemoteProtocol::___TILE___ ;
+			const uint32_t y = ty * RemoteProtocol::___TILE___ ;
+			return {static_cast<int32_t>(x), static_cast<int32_t>(y), std::min(RemoteProtocol::___TILE___, width_ - x), std::min(RemoteProtocol::___TILE___, height_ - y)} ;
+		}
+
+		void Receive(HWND target, RemoteStats& done) noexcept {
+			for (size_t i = clients_.size() ; i-- > 0 ; ) {
+				Client& client = clients_[i] ;
+				bool alive = true ;
+
+				try {
+					uint8_t buffer[4096] ;
+					while (true) {
+						const int64_t n = client.stream_->Read(buffer, sizeof(buffer)) ;
+						if (n < 0) {
+							alive = false ;
+						}
+						if (n <= 0) {
+							break ;
+						}
+						client.in_.insert(client.in_.end(), buffer, buffer + n) ;
+					}
+
+					size_t at = 0 ;
+					while (alive && client.in_.size() - at >= RemoteProtocol::___MESSAGE_SIZE___) {
+						const uint8_t* message = client.in_.data() + at ;
+						const uint32_t size = codec::GetU32LE(message + 4) ;
+						if (size > RemoteProtocol::___MAX_CLIENT_MESSAGE___) {
+							alive = false ;
+							break ;
+						}
+						if (client.in_.size() - at < RemoteProtocol::___MESSAGE_SIZE___ + size) {
+							break ;
+						}
+
+						alive = Handle(client, message[0], message + RemoteProtocol::___MESSAGE_SIZE___, size, target, done) ;
+						at += RemoteProtocol::___MESSAGE_SIZE___ + size ;
+					}
+					client.in_.erase(client.in_.begin(), client.in_.begin() + static_cast<ptrdiff_t>(std::min(at, client.in_.size()))) ;
+				} catch (...) {
+					alive = false ;
+				}
+
+				if (!alive) {
+
+					#ifdef REMOTE_DEBUG
+						logger::info("FramebufferServer::Receive - Client disconnected.") ;
+					#endif
+
+					Drop(i) ;
+				}
+			}
+		}
+
+		// false drops the client, it broke the protocol.
+		bool Handle(Client& client, uint8_t type, const uint8_t* body, uint32_t size, HWND target, RemoteStats& done) noexcept {
+			switch (type) {
+				case RemoteProtocol::___INPUT___ : {
+					if (size < RemoteProtocol::___INPUT_SIZE___) {
+						return false ;
+					}
+
+					const EventType kind = static_cast<EventType>(body[0]) ;
+					const Point pos {static_cast<int32_t>(codec::GetU32LE(body + 4)), static_cast<int32_t>(codec::GetU32LE(body + 8))} ;
+					const int32_t value = static_cast<int32_t>(codec::GetU32LE(body + 12)) ;
+					if (kind == EventType::Mouse && body[1] <= static_cast<uint8_t>(MouseButton::Middle) && body[2] <= static_cast<uint8_t>(MouseState::Wheel)) {
+						if (target) {
+							EventSystem::PushEvent(Event::CreateMouseEvent(target, static_cast<MouseButton>(body[1]), static_cast<MouseState>(body[2]), pos, value)) ;
+							++done.events_ ;
+						}
+						return true ;
+					}
+					if (kind == EventType::Key && (body[2] == static_cast<uint8_t>(KeyState::Up) || body[2] == static_cast<uint8_t>(KeyState::Down))) {
+						if (target) {
+							EventSystem::PushEvent(Event::CreateKeyEvent(target, static_cast<KeyState>(body[2]), static_cast<uint32_t>(value))) ;
+							++done.events_ ;
+						}
+						return true ;
+					}
+					return false ;
+				}
+
+				case RemoteProtocol::___ENCODING___ :
+					if (size < 1 || body[0] > static_cast<uint8_t>(RemoteEncoding::Auto)) {
+						return false ;
+					}
+					client.encoding_ = static_cast<RemoteEncoding>(body[0]) ;
+					return true ;
+
+				case RemoteProtocol::___REFRESH___ :
+					std::fill(client.shown_.begin(), client.shown_.end(), 0) ;
+					return true ;
+
+				default :
+					return false ;
+			}
+		}
+
+		// appends one encoded tile payload to out_, returns its encoding.
+		uint8_t Encode(const Rect& r, RemoteEncoding encoding) {
+			const size_t count = static_cast<size_t>(r.w) * r.h ;
+			tile_.resize(count) ;
+			for (uint32_t y = 0 ; y < r.h ; ++y) {
+				memcpy(tile_.data() + static_cast<size_t>(y) * r.w, mirror_.data() + static_cast<size_t>(r.y + y) * width_ + r.x, r.w * 4) ;
+			}
+
+			const size_t at = out_.size() ;
+			if (encoding == RemoteEncoding::Raw) {
+				out_.resize(at + count * 4) ;
+				for (size_t i = 0 ; i < count ; ++i) {
+					codec::PutU32LE(out_.data() + at + i * 4, tile_[i]) ;
+				}
+				return static_cast<uint8_t>(RemoteEncoding::Raw) ;
+			}
+
+			uint8_t used = static_cast<uint8_t>(RemoteEncoding::Rle) ;
+			if (encoding != RemoteEncoding::Qoi) {
+				out_.resize(at + codec::WordRunBound(count)) ;
+				out_.resize(static_cast<size_t>(codec::WordRunEncode(tile_.data(), count, out_.data() + at) - out_.data())) ;
+			}
+
+			// runs cover flat ui well, anything else compresses better as QOI
+			if (encoding == RemoteEncoding::Qoi || (encoding == RemoteEncoding::Auto && out_.size() - at > count)) {
+				scratch_.resize(count * 5 + 1) ;
+				codec::QoiState state ;
+				uint8_t* end = state.Finish(state.Encode(tile_.data(), count, scratch_.data())) ;
+				const size_t size = static_cast<size_t>(end - scratch_.data()) ;
+				if (encoding == RemoteEncoding::Qoi || size < out_.size() - at) {
+					out_.resize(at + size) ;
+					memcpy(out_.data() + at, scratch_.data(), size) ;
+					used = static_cast<uint8_t>(RemoteEncoding::Qoi) ;
+				}
+			}
+			return used ;
+		}
+
+		void Send(RemoteStats& done) noexcept {
+			if (hashes_.empty()) {
+				return ;
+			}
+
+			for (size_t i = clients_.size() ; i-- > 0 ; ) {
+				Client& client = clients_[i] ;
+				bool alive = true ;
+
+				try {
+					if (client.shown_.size() != hashes_.size()) {
+						client.shown_.assign(hashes_.size(), 0) ;
+					}
+
+					out_.resize(RemoteProtocol::___MESSAGE_SIZE___ + RemoteProtocol::___FRAME_SIZE___) ;
+					uint32_t tiles = 0 ;
+					for (uint32_t ty = 0 ; ty < rows_ ; ++ty) {
+						for (uint32_t tx = 0 ; tx < columns_ ; ++tx) {
+							const size_t cell = static_cast<size_t>(ty) * columns_ + tx ;
+							const uint64_t hash = hashes_[cell] ;
+							if (client.shown_[cell] == hash) {
+								continue ;
+							}
+
+							const Rect r = GetTile(tx, ty) ;
+							const size_t head = out_.size() ;
+							out_.resize(head + RemoteProtocol::___TILE_SIZE___, 0) ;
+
+							uint64_t& slot = client.cache_[hash % RemoteProtocol::___CACHE_SLOTS___] ;
+							uint8_t encoding = RemoteProtocol::___CACHED___ ;
+							if (slot == hash) {
+								++done.cached_tiles_ ;
+							} else {
+								encoding = Encode(r, client.encoding_) ;
+								slot = hash ;
+								++done.tiles_ ;
+							}
+
+							uint8_t* t = out_.data() + head ;
+							codec::PutU32LE(t, static_cast<uint32_t>(r.x)) ;
+							codec::PutU32LE(t + 4, static_cast<uint32_t>(r.y)) ;
+							t[8] = static_cast<uint8_t>(r.w) ;
+							t[9] = static_cast<uint8_t>(r.w >> 8) ;
+							t[10] = static_cast<uint8_t>(r.h) ;
+							t[11] = static_cast<uint8_t>(r.h >> 8) ;
+							t[12] = encoding ;
+							codec::PutU64LE(t + 16, hash) ;
+							codec::PutU32LE(t + 24, static_cast<uint32_t>(out_.size() - head - RemoteProtocol::___TILE_SIZE___)) ;
+
+							client.shown_[cell] = hash ;
+							done.raw_bytes_ += static_cast<uint64_t>(r.w) * r.h * 4 ;
+							++tiles ;
+						}
+					}
+
+					if (tiles == 0) {
+						continue ;
+					}
+
+					RemoteProtocol::PutMessage(out_.data(), RemoteProtocol::___FRAME___, static_cast<uint32_t>(out_.size() - RemoteProtocol::___MESSAGE_SIZE___)) ;
+					codec::PutU32LE(out_.data() + 8, width_) ;
+					codec::PutU32LE(out_.data() + 12, height_) ;
+					codec::PutU32LE(out_.data() + 16, tiles) ;
+					alive = client.stream_->Write(out_.data(), out_.size()) ;
+					++done.frames_ ;
+					done.sent_bytes_ += out_.size() ;
+				} catch (...) {
+					alive = false ;
+				}
+
+				if (!alive) {
+
+					#ifdef REMOTE_DEBUG
+						logger::warning("FramebufferServer::Send - Client stopped receiving, dropped.") ;
+					#endif
+
+					Drop(i) ;
+				}
+			}
+		}
+
+		bool Start() noexcept {
+			if (thread_.joinable()) {
+				return true ;
+			}
+
+			stop_ = false ;
+			try {
+				thread_ = std::thread(&FramebufferServer::Run, this) ;
+			} catch (...) {
+				return false ;
+			}
+			return true ;
+		}
+
+	public :
+		FramebufferServer(const FramebufferServer&) = delete ;
+		FramebufferServer& operator=(const FramebufferServer&) = delete ;
+		FramebufferServer() noexcept = default ;
+
+		~FramebufferServer() noexcept {
+			Stop() ;
+		}
+
+		#ifdef ZKETCH_LINUX
+			// accepts clients on a Unix domain socket at path, a stale socket file there is replaced.
+			bool Listen(const std::string& path) noexcept {
+				if (listener_ >= 0 || thread_.joinable()) {
+
+					#ifdef REMOTE_DEBUG
+						logger::error("FramebufferServer::Listen - Already serving, Listen comes before any client.") ;
+					#endif
+
+					return false ;
+				}
+
+				sockaddr_un addr {} ;
+				if (path.size() >= sizeof(addr.sun_path)) {
+					return false ;
+				}
+
+				addr.sun_family = AF_UNIX ;
+				memcpy(addr.sun_path, path.c_str(), path.size() + 1) ;
+
+				int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0) ;
+				if (fd < 0) {
+					return false ;
+				}
+
+				unlink(path.c_str()) ;
+				if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+
+					#ifdef REMOTE_DEBUG
+						logger::error("FramebufferServer::Listen - Failed to listen on ", path, '.') ;
+					#endif
+
+					close(fd) ;
+					return false ;
+				}
+
+				// the thread isn't running yet, it picks the watch up from here
+				listener_ = fd ;
+				try {
+					path_ = path ;
+				} catch (...) {}
+				wake_.AddWatch(fd) ;
+
+				if (!Start()) {
+					wake_.RemoveWatch(fd) ;
+					close(fd) ;
+					listener_ = -1 ;
+					return false ;
+				}
+				return true ;
+			}
+		#endif
+
+		// serves a client over any stream, the server owns it from here.
+		bool AddClient(std::unique_ptr<RemoteStream> stream) noexcept {
+			if (!stream) {
+				return false ;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				try {
+					joining_.push_back(std::move(stream)) ;
+				} catch (...) {
+					return false ;
+				}
+			}
+
+			if (!Start()) {
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				joining_.clear() ;
+				return false ;
+			}
+			wake_.Notify() ;
+			return true ;
+		}
+
+		// input from clients arrives as events of this window, null drops it.
+		void SetInputTarget(HWND target) noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			target_ = target ;
+		}
+
+		// damage is what changed since the previously submitted frame. Frames submitted faster than
+		// the server picks them up are merged.
+		bool Submit(const Canvas& frame, const DamageList& damage) noexcept {
+			if (!IsRunning() || !frame.IsValid()) {
+				return false ;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				const Size size = frame.GetSize() ;
+				if (size != size_) {
+					damage_.SetAll(size) ;
+					size_ = size ;
+				} else {
+					damage_.Add(damage, size) ;
+				}
+				pending_ = frame ;
+			}
+			wake_.Notify() ;
+			return true ;
+		}
+
+		// the whole canvas, for sources that don't track damage.
+		bool Submit(const Canvas& frame) noexcept {
+			DamageList all ;
+			all.SetAll(frame.GetSize()) ;
+			return Submit(frame, all) ;
+		}
+
+		// disconnects every client and stops listening.
+		void Stop() noexcept {
+			if (!thread_.joinable()) {
+				return ;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				stop_ = true ;
+				pending_ = {} ;
+				joining_.clear() ;
+			}
+			wake_.Notify() ;
+			thread_.join() ;
+
+			#ifdef ZKETCH_LINUX
+				if (listener_ >= 0) {
+					wake_.RemoveWatch(listener_) ;
+					close(listener_) ;
+					unlink(path_.c_str()) ;
+					listener_ = -1 ;
+				}
+			#endif
+
+			size_ = {} ;
+			width_ = height_ = columns_ = rows_ = 0 ;
+			mirror_ = {} ;
+			hashes_ = {} ;
+		}
+
+		bool IsRunning() const noexcept { return thread_.joinable() ; }
+
+		RemoteStats GetStats() noexcept {
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			return stats_ ;
+		}
+	} ;
+
+	// ------------------------------ client ------------------------------
+
+	// the other end of FramebufferServer, keeps the remote frame up to date and sends input. Needs no
+	// window system, a viewer shows GetFrame() however it likes.
+	class FramebufferClient {
+	private :
+		struct Slot {
+			uint64_t hash_ = 0 ;
+			uint32_t w_ = 0 ;
+			uint32_t h_ = 0 ;
+			std::vector<uint32_t> pixels_ ;
+		} ;
+
+		std::unique_ptr<RemoteStream> stream_ ;
+		std::vector<uint8_t> in_ ;
+		std::vector<uint32_t> frame_ ;
+		std::vector<uint32_t> tile_ ;
+		std::vector<Slot> cache_ ;
+		uint32_t width_ = 0 ;
+		uint32_t height_ = 0 ;
+		uint32_t tile_size_ = 0 ;
+		uint64_t frames_ = 0 ;
+		bool hello_ = false ;
+
+		bool SendMessage(uint8_t type, const uint8_t* body, uint32_t size) noexcept {
+			uint8_t message[RemoteProtocol::___MESSAGE_SIZE___ + RemoteProtocol::___INPUT_SIZE___] ;
+			RemoteProtocol::PutMessage(message, type, size) ;
+			if (size) {
+				memcpy(message + RemoteProtocol::___MESSAGE_SIZE___, body, size) ;
+			}
+			return stream_ && stream_->Write(message, RemoteProtocol::___MESSAGE_SIZE___ + size) ;
+		}
+
+		bool SendInput(EventType kind, uint8_t button, uint8_t state, const Point& pos, int32_t value) noexcept {
+			uint8_t body[RemoteProtocol::___INPUT_SIZE___] {} ;
+			body[0] = static_cast<uint8_t>(kind) ;
+			body[1] = button ;
+			body[2] = state ;
+			codec::PutU32LE(body + 4, static_cast<uint32_t>(pos.x)) ;
+			codec::PutU32LE(body + 8, static_cast<uint32_t>(pos.y)) ;
+			codec::PutU32LE(body + 12, static_cast<uint32_t>(value)) ;
+			return SendMessage(RemoteProtocol::___INPUT___, body, sizeof(body)) ;
+		}
+
+		bool HandleHello(const uint8_t* body, uint32_t size) {
+			if (size < RemoteProtocol::___HELLO_SIZE___ || codec::GetU32LE(body) != RemoteProtocol::___VERSION___) {
+				return false ;
+			}
+
+			tile_size_ = codec::GetU32LE(body + 4) ;
+			const uint32_t slots = codec::GetU32LE(body + 8) ;
+			if (tile_size_ == 0 || tile_size_ > 0xFFFF || slots == 0 || slots > 65536) {
+				return false ;
+			}
+
+			cache_.assign(slots, {}) ;
+			hello_ = true ;
+			return true ;
+		}
+
+		bool HandleFrame(const uint8_t* body, uint32_t size) {
+			if (!hello_ || size < RemoteProtocol::___FRAME_SIZE___) {
+				return false ;
+			}
+
+			const uint32_t width = codec::GetU32LE(body) ;
+			const uint32_t height = codec::GetU32LE(body + 4) ;
+			const uint32_t tiles = codec::GetU32LE(body + 8) ;
+			if (static_cast<uint64_t>(width) * height > RemoteProtocol::___MAX_FRAME_PIXELS___) {
+				return false ;
+			}
+			if (width != width_ || height != height_) {
+				width_ = width ;
+				height_ = height ;
+				frame_.assign(static_cast<size_t>(width_) * height_, 0) ;
+			}
+
+			const uint8_t* in = body + RemoteProtocol::___FRAME_SIZE___ ;
+			const uint8_t* end = body + size ;
+			for (uint32_t i = 0 ; i < tiles ; ++i) {
+				if (static_cast<size_t>(end - in) < RemoteProtocol::___TILE_SIZE___) {
+					return false ;
+				}
+
+				const uint32_t x = codec::GetU32LE(in) ;
+				const uint32_t y = codec::GetU32LE(in + 4) ;
+				const uint32_t w = static_cast<uint32_t>(in[8] | in[9] << 8) ;
+				const uint32_t h = static_cast<uint32_t>(in[10] | in[11] << 8) ;
+				const uint8_t encoding = in[12] ;
+				const uint64_t hash = codec::GetU64LE(in + 16) ;
+				const uint32_t bytes = codec::GetU32LE(in + 24) ;
+				in += RemoteProtocol::___TILE_SIZE___ ;
+
+				if (w == 0 || h == 0 || w > tile_size_ || h > tile_size_ || w > width_ || h > height_ || x > width_ - w || y > height_ - h || static_cast<size_t>(end - in) < bytes) {
+					return false ;
+				}
+
+				const size_t count = static_cast<size_t>(w) * h ;
+				Slot& slot = cache_[hash % cache_.size()] ;
+				if (encoding == RemoteProtocol::___CACHED___) {
+					if (slot.hash_ != hash || slot.w_ != w || slot.h_ != h) {
+						return false ;
+					}
+				} else {
+					tile_.resize(count) ;
+					bool ok = false ;
+					if (encoding == static_cast<uint8_t>(RemoteEncoding::Raw)) {
+						ok = bytes == count * 4 ;
+						for (size_t p = 0 ; ok && p < count ; ++p) {
+							tile_[p] = codec::GetU32LE(in + p * 4) ;
+						}
+					} else if (encoding == static_cast<uint8_t>(RemoteEncoding::Rle)) {
+						ok = codec::WordRunDecode(in, bytes, tile_.data(), count) ;
+					} else if (encoding == static_cast<uint8_t>(RemoteEncoding::Qoi)) {
+						codec::QoiState state ;
+						ok = state.Decode(in, in + bytes, tile_.data(), count) != nullptr ;
+					}
+
+					if (!ok) {
+						return false ;
+					}
+
+					slot.hash_ = hash ;
+					slot.w_ = w ;
+					slot.h_ = h ;
+					slot.pixels_.assign(tile_.begin(), tile_.end()) ;
+				}
+
+				for (uint32_t row = 0 ; row < h ; ++row) {
+					memcpy(frame_.data() + static_cast<size_t>(y + row) * width_ + x, slot.pixels_.data() + static_cast<size_t>(row) * w, w * 4) ;
+				}
+				in += bytes ;
+			}
+
+			++frames_ ;
+			return true ;
+		}
+
+	public :
+		FramebufferClient(const FramebufferClient&) = delete ;
+		FramebufferClient& operator=(const FramebufferClient&) = delete ;
+		FramebufferClient() noexcept = default ;
+
+		bool Connect(std::unique_ptr<RemoteStream> stream) noexcept {
+			stream_ = std::move(stream) ;
+			in_.clear() ;
+			frame_.clear() ;
+			cache_.clear() ;
+			width_ = height_ = tile_size_ = 0 ;
+			frames_ = 0 ;
+			hello_ = false ;
+			return stream_ != nullptr ;
+		}
+
+		// applies whatever arrived, returns false once the server is gone or sent garbage.
+		bool Receive() noexcept {
+			if (!stream_) {
+				return false ;
+			}
+
+			try {
+				uint8_t buffer[65536] ;
+				while (true) {
+					const int64_t n = stream_->Read(buffer, sizeof(buffer)) ;
+					if (n < 0) {
+						stream_.reset() ;
+						return false ;
+					}
+					if (n == 0) {
+						break ;
+					}
+					in_.insert(in_.end(), buffer, buffer + n) ;
+				}
+
+				size_t at = 0 ;
+				while (in_.size() - at >= RemoteProtocol::___MESSAGE_SIZE___) {
+					const uint8_t* message = in_.data() + at ;
+					const uint32_t size = codec::GetU32LE(message + 4) ;
+					if (size > RemoteProtocol::___MAX_SERVER_MESSAGE___) {
+
+						#ifdef REMOTE_DEBUG
+							logger::error("FramebufferClient::Receive - Message from server too large, disconnected.") ;
+						#endif
+
+						stream_.reset() ;
+						return false ;
+					}
+					if (in_.size() - at < RemoteProtocol::___MESSAGE_SIZE___ + static_cast<size_t>(size)) {
+						break ;
+					}
+
+					const uint8_t* body = message + RemoteProtocol::___MESSAGE_SIZE___ ;
+					const bool ok = message[0] == RemoteProtocol::___HELLO___ ? HandleHello(body, size) : message[0] == RemoteProtocol::___FRAME___ ? HandleFrame(body, size) : false ;
+					if (!ok) {
+
+						#ifdef REMOTE_DEBUG
+							logger::error("FramebufferClient::Receive - Malformed message from server, disconnected.") ;
+						#endif
+
+						stream_.reset() ;
+						return false ;
+					}
+					at += RemoteProtocol::___MESSAGE_SIZE___ + size ;
+				}
+				in_.erase(in_.begin(), in_.begin() + static_cast<ptrdiff_t>(at)) ;
+			} catch (...) {
+				stream_.reset() ;
+				return false ;
+			}
+			return true ;
+		}
+
+		// receives until a new frame arrived or timeout passed.
+		bool WaitFrame(std::chrono::milliseconds timeout) noexcept {
+			const uint64_t seen = frames_ ;
+			const auto deadline = std::chrono::steady_clock::now() + timeout ;
+			while (Receive() && frames_ == seen) {
+				if (std::chrono::steady_clock::now() >= deadline) {
+					return false ;
+				}
+
+				#ifdef ZKETCH_LINUX
+					pollfd pfd {stream_->GetFd(), POLLIN, 0} ;
+					if (pfd.fd >= 0) {
+						poll(&pfd, 1, 1) ;
+						continue ;
+					}
+				#endif
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1)) ;
+			}
+			return frames_ != seen ;
+		}
+
+		bool SendMouse(MouseButton button, MouseState state, const Point& pos, int32_t value = 0) noexcept {
+			return SendInput(EventType::Mouse, static_cast<uint8_t>(button), static_cast<uint8_t>(state), pos, value) ;
+		}
+
+		bool SendKey(KeyState state, uint32_t key_code) noexcept {
+			return SendInput(EventType::Key, 0, static_cast<uint8_t>(state), {}, static_cast<int32_t>(key_code)) ;
+		}
+
+		bool SetEncoding(RemoteEncoding encoding) noexcept {
+			const uint8_t body = static_cast<uint8_t>(encoding) ;
+			return SendMessage(RemoteProtocol::___ENCODING___, &body, 1) ;
+		}
+
+		// asks for every tile again, tiles still in the cache come as references to it.
+		bool RequestRefresh() noexcept {
+			return SendMessage(RemoteProtocol::___REFRESH___, nullptr, 0) ;
+		}
+
+		ImageView GetFrame() const noexcept { return {reinterpret_cast<const uint8_t*>(frame_.data()), width_, height_, width_ * 4, ColorFormat::ARGB} ; }
+		uint64_t GetFrameCount() const noexcept { return frames_ ; }
+		bool IsConnected() const noexcept { return stream_ != nullptr ; }
+	} ;
+}
@@ -1,18 +1,25 @@
-<<<<<<< HEAD
 #pragma once
 #include "window.hpp"
+#include "tiledcanvas.hpp"
+#include "displaylist.hpp"
 
 namespace zketch {
 
 	class Renderer {
 	private :
 		std::unique_ptr<Gdiplus::Graphics> gfx_ {} ;
+		std::unique_ptr<Canvas> scratch_ {} ;
 		Canvas* canvas_target_ = nullptr ;
+		TiledCanvas* tiled_target_ = nullptr ;
 		Window* window_target_ = nullptr ;
+		Rect clip_ {} ;
 		bool is_drawing_ = false ;
+		bool reduced_ = false ;	// drawing a window mid-resize at reduced quality
+		CanvasStorage* bound_ = nullptr ;	// storage of the canvas drawn into
+		DisplayListWriter* list_ = nullptr ;	// gets every primitive drawn, see SetDisplayList()
 
 		bool IsValid() const noexcept {
-			if (!canvas_target_) {
+			if (!canvas_target_ && !tiled_target_) {
 
 				#ifdef RENDERER_DEBUG
 					logger::warning("Renderer::IsValid - Target canvas is null!") ;
@@ -21,8 +28,8 @@ namespace zketch {
 				return false ;
 			}
 
-			if (!gfx_ || !is_drawing_) {
-				if (!gfx_) {
+			if ((!gfx_ && !tiled_target_) || !is_drawing_) {
+				if (!gfx_ && !tiled_target_) {
 
 					#ifdef RENDERER_DEBUG
 						logger::warning("Renderer::IsValid - gfx is null!") ;
@@ -43,14 +50,267 @@ namespace zketch {
 			return true ;
 		}
 
+		// a canvas is drawn into by one Renderer at a time, whichever thread that Renderer runs on.
+		bool Bind(Canvas& target) noexcept {
+			const void* expected = nullptr ;
+			if (!target.storage_->writer_.compare_exchange_strong(expected, this, std::memory_order_acquire)) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("Renderer::Begin - Canvas is bound by another renderer!") ;
+				#endif
+
+				return false ;
+			}
+
+			bound_ = target.storage_.get() ;
+			return true ;
+		}
+
+		void Unbind() noexcept {
+			if (bound_) {
+				bound_->version_ = CanvasStorage::NextVersion() ;
+				bound_->writer_.store(nullptr, std::memory_order_release) ;
+				bound_ = nullptr ;
+			}
+		}
+
+		// GDI+ can't draw into 8bpp coverage, A8 targets are rendered through an ARGB scratch bitmap
+		// that End() folds back into the mask.
+		Gdiplus::Bitmap* AcquireSurface(Canvas& src) noexcept {
+			if (src.GetFormat() != ColorFormat::A8) {
+				return src.GetBitmap() ;
+			}
+
+			if (!scratch_) {
+				scratch_ = std::make_unique<Canvas>() ;
+			}
+
+			if (scratch_->GetSize() != src.GetSize() || !scratch_->IsValid()) {
+				if (!scratch_->Create(src.GetSize(), ColorFormat::ARGB)) {
+					return nullptr ;
+				}
+			}
+
+			pixel::ConvertRect(src.GetPixels(), src.GetStride(), ColorFormat::A8, scratch_->GetPixels(), scratch_->GetStride(), ColorFormat::ARGB, src.GetWidth(), src.GetHeight()) ;
+			return scratch_->GetBitmap() ;
+		}
+
+		Canvas* GetSurface() const noexcept {
+			return canvas_target_ && canvas_target_->GetFormat() == ColorFormat::A8 ? scratch_.get() : canvas_target_ ;
+		}
+
+		// sources still being drawn into, by this renderer or another, aren't sent.
+		bool IsRecordable(const Canvas& src) const noexcept {
+			return list_ && src.storage_->writer_.load(std::memory_order_acquire) == nullptr ;
+		}
+
+		static void Configure(Gdiplus::Graphics& gfx) noexcept {
+			gfx.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality) ;
+			gfx.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic) ;
+			gfx.SetPixelOffsetMode(Gdiplus::PixelOffsetModeHighQuality) ;
+			gfx.SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
+			gfx.SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
+		}
+
+		// cheapest settings, for frames drawn while their window is being resized.
+		static void ConfigureReduced(Gdiplus::Graphics& gfx) noexcept {
+			gfx.SetSmoothingMode(Gdiplus::SmoothingModeNone) ;
+			gfx.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor) ;
+			gfx.SetPixelOffsetMode(Gdiplus::PixelOffsetModeNone) ;
+		}
+
+		// pixel bound of a primitive, pad covers pen width and anti aliasing.
+		static Rect ToPixelBound(const RectF& bound, float pad = 1.0f) noexcept {
+			const int32_t x0 = static_cast<int32_t>(std::floor(bound.x - pad)) ;
+			const int32_t y0 = static_cast<int32_t>(std::floor(bound.y - pad)) ;
+			const int32_t x1 = static_cast<int32_t>(std::ceil(bound.x + bound.w + pad)) ;
+			const int32_t y1 = static_cast<int32_t>(std::ceil(bound.y + bound.h + pad)) ;
+			return {x0, y0, x1 - x0, y1 - y0} ;
+		}
+
+		// calls fn(surface, graphics, origin, clip) for every surface a primitive covering bound lands on:
+		// the target canvas, each storage piece of a wrapped canvas or each touched tile of a tiled
+		// target. origin is the logical position of the surface's (0, 0), clip the writable part of it.
+		template <typename F>
+		void ForEachSurface(const Rect& bound, F&& fn) noexcept {
+			if (!tiled_target_) {
+				canvas_target_->MarkInvalidate() ;
+				if (window_target_) {
+					window_target_->AddDamage(bound) ;
+				}
+
+				Canvas& surface = *GetSurface() ;
+				if (!canvas_target_->IsWrapped()) {
+					fn(surface, *gfx_, Point{0, 0}, Rect{0, 0, surface.GetWidth(), surface.GetHeight()}) ;
+					return ;
+				}
+
+				// ring buffer targets get the primitive once per storage piece it overlaps
+				canvas_target_->ForEachWrapPiece(bound, [&](const Rect& piece, const Point& offset) {
+					gfx_->SetClip(Gdiplus::Rect(piece.x, piece.y, piece.w, piece.h)) ;
+					gfx_->TranslateTransform(static_cast<Gdiplus::REAL>(offset.x), static_cast<Gdiplus::REAL>(offset.y)) ;
+					fn(surface, *gfx_, Point{-offset.x, -offset.y}, piece) ;
+					gfx_->ResetTransform() ;
+					gfx_->ResetClip() ;
+				}) ;
+				return ;
+			}
+
+			const int32_t x0 = std::max(bound.x, clip_.x) ;
+			const int32_t y0 = std::max(bound.y, clip_.y) ;
+			const int32_t x1 = std::min(bound.x + static_cast<int32_t>(bound.w), clip_.x + static_cast<int32_t>(clip_.w)) ;
+			const int32_t y1 = std::min(bound.y + static_cast<int32_t>(bound.h), clip_.y + static_cast<int32_t>(clip_.h)) ;
+			if (x0 >= x1 || y0 >= y1) {
+				return ;
+			}
+
+			tiled_target_->ForEachTileIn({x0, y0, x1 - x0, y1 - y0}, [&](uint32_t tx, uint32_t ty) {
+				bool fresh = false ;
+				TiledCanvas::Tile* tile = tiled_target_->AcquireTile(tx, ty, fresh) ;
+				if (!tile) {
+					return ;
+				}
+
+				const Rect tile_bound = tiled_target_->GetTileBound(tx, ty) ;
+				if (!tile->gfx_) {
+					tile->gfx_ = std::make_unique<Gdiplus::Graphics>(tile->canvas_.GetBitmap()) ;
+					if (tile->gfx_->GetLastStatus() != Gdiplus::Ok) {
+
+						#ifdef RENDERER_DEBUG
+							logger::error("Renderer::ForEachSurface - Failed to bind tile [", tx, ", ", ty, "].") ;
+						#endif
+
+						tile->gfx_.reset() ;
+						return ;
+					}
+
+					Configure(*tile->gfx_) ;
+					tile->gfx_->TranslateTransform(static_cast<Gdiplus::REAL>(-tile_bound.x), static_cast<Gdiplus::REAL>(-tile_bound.y)) ;
+				}
+
+				if (fresh && tiled_target_->background_.GetA() != 0) {
+					tile->gfx_->Clear(tiled_target_->background_) ;
+				}
+
+				tile->dirty_ = tile->dirty_ || !tiled_target_->regenerating_ ;
+				tile->canvas_.MarkInvalidate() ;
+				fn(tile->canvas_, *tile->gfx_, tile_bound.GetPos(), Rect{0, 0, tile_bound.w, tile_bound.h}) ;
+			}) ;
+		}
+
+		template <typename F>
+		void Draw(const RectF& bound, float pad, F&& fn) noexcept {
+			ForEachSurface(ToPixelBound(bound, pad), [&](Canvas&, Gdiplus::Graphics& gfx, const Point&, const Rect&) {
+				fn(gfx) ;
+			}) ;
+		}
+
+		// blends region (storage coordinates) of src with its top left corner at pos.
+		void Composite(const Canvas& src, const Rect& region, const Point& pos, uint32_t tint) noexcept {
+			ForEachSurface({pos.x, pos.y, region.w, region.h}, [&](Canvas& dst, Gdiplus::Graphics& gfx, const Point& origin, const Rect& clip) {
+				if (&src == &dst) {
+					return ;
+				}
+
+				// another Renderer, possibly on another thread, is drawing into src
+				const void* writer = src.storage_->writer_.load(std::memory_order_acquire) ;
+				if (writer && writer != this) {
+
+					#ifdef RENDERER_DEBUG
+						logger::warning("Renderer::DrawCanvas - Source canvas is bound by another renderer, skipped.") ;
+					#endif
+
+					return ;
+				}
+
+				const int32_t dx = pos.x - origin.x ;
+				const int32_t dy = pos.y - origin.y ;
+				const int32_t x0 = std::max(dx, clip.x) ;
+				const int32_t y0 = std::max(dy, clip.y) ;
+				const int32_t x1 = std::min(dx + static_cast<int32_t>(region.w), clip.x + static_cast<int32_t>(clip.w)) ;
+				const int32_t y1 = std::min(dy + static_cast<int32_t>(region.h), clip.y + static_cast<int32_t>(clip.h)) ;
+				if (x0 >= x1 || y0 >= y1) {
+					return ;
+				}
+
+				// primitives queued on the GDI+ side have to land before the pixels are touched directly
+				gfx.Flush(Gdiplus::FlushIntentionSync) ;
+
+				const uint32_t sbpp = BytesPerPixel(src.GetFormat()) ;
+				const uint32_t dbpp = BytesPerPixel(dst.GetFormat()) ;
+				pixel::BlendRect(
+					src.GetRow(region.y + y0 - dy) + (region.x + x0 - dx) * sbpp, src.GetStride(), src.GetFormat(),
+					dst.GetRow(y0) + x0 * dbpp, dst.GetStride(), dst.GetFormat(),
+					x1 - x0, y1 - y0, tint
+				) ;
+			}) ;
+		}
+
+		// blends a logical region of src, a wrapped source splits into two or four clipped blits.
+		void CompositeCanvas(const Canvas& src, const Rect& region, const Point& pos, uint32_t tint) noexcept {
+			src.ForEachWrapPiece(region, [&](const Rect& piece, const Point& offset) {
+				Composite(src, piece, {pos.x + piece.x - offset.x - region.x, pos.y + piece.y - offset.y - region.y}, tint) ;
+			}) ;
+		}
+
+		// clamps region to src, shifting pos by what was cut from the top left.
+		static bool ClipRegion(const Size& src, Rect& region, Point& pos) noexcept {
+			const int32_t x0 = std::max(region.x, 0) ;
+			const int32_t y0 = std::max(region.y, 0) ;
+			const int32_t x1 = std::min(region.x + static_cast<int32_t>(region.w), static_cast<int32_t>(src.x)) ;
+			const int32_t y1 = std::min(region.y + static_cast<int32_t>(region.h), static_cast<int32_t>(src.y)) ;
+			if (x0 >= x1 || y0 >= y1) {
+				return false ;
+			}
+
+			pos.x += x0 - region.x ;
+			pos.y += y0 - region.y ;
+			region = {x0, y0, x1 - x0, y1 - y0} ;
+			return true ;
+		}
+
+		static RectF GetVertexBound(const Vertex& vertices) noexcept {
+			float x0 = vertices.front().x ;
+			float y0 = vertices.front().y ;
+			float x1 = x0 ;
+			float y1 = y0 ;
+			for (const auto& v : vertices) {
+				x0 = std::min(x0, v.x) ;
+				y0 = std::min(y0, v.y) ;
+				x1 = std::max(x1, v.x) ;
+				y1 = std::max(y1, v.y) ;
+			}
+			return {x0, y0, x1 - x0, y1 - y0} ;
+		}
+
+		TiledCanvas::Tile* RegenerateTile(TiledCanvas& src, uint32_t tx, uint32_t ty) noexcept {
+			if (!src.redraw_) {
+				return nullptr ;
+			}
+
+			Renderer render ;
+			if (!render.Begin(src, src.GetTileBound(tx, ty))) {
+				return nullptr ;
+			}
+
+			src.regenerating_ = true ;
+			src.redraw_(render, src.GetTileBound(tx, ty)) ;
+			src.regenerating_ = false ;
+			render.End() ;
+			++src.regenerated_ ;
+			return src.FindTile(tx, ty) ;
+		}
+
 	public :
 		Renderer(const Renderer&) = delete ;
 		Renderer& operator=(const Renderer&) = delete ;
 		Renderer() = default ;
 
 		Renderer(Renderer&& o) noexcept : 
-		gfx_(std::move(o.gfx_)), canvas_target_(std::exchange(o.canvas_target_, nullptr)), 
-		is_drawing_(std::exchange(o.is_drawing_, false)) {}
+		gfx_(std::move(o.gfx_)), scratch_(std::move(o.scratch_)), canvas_target_(std::exchange(o.canvas_target_, nullptr)), 
+		tiled_target_(std::exchange(o.tiled_target_, nullptr)), window_target_(std::exchange(o.window_target_, nullptr)), 
+		clip_(o.clip_), is_drawing_(std::exchange(o.is_drawing_, false)), reduced_(std::exchange(o.reduced_, false)), bound_(std::exchange(o.bound_, nullptr)), 
+		list_(std::exchange(o.list_, nullptr)) {}
 
 		Renderer& operator=(Renderer&& o) noexcept {
 			if (this != &o) {
@@ -59,8 +319,15 @@ namespace zketch {
 				} 
 
 				gfx_ = std::move(o.gfx_) ;
+				scratch_ = std::move(o.scratch_) ;
 				canvas_target_ = std::exchange(o.canvas_target_, nullptr) ;
+				tiled_target_ = std::exchange(o.tiled_target_, nullptr) ;
+				window_target_ = std::exchange(o.window_target_, nullptr) ;
+				clip_ = o.clip_ ;
 				is_drawing_ = std::exchange(o.is_drawing_, false) ;
+				reduced_ = std::exchange(o.reduced_, false) ;
+				bound_ = std::exchange(o.bound_, nullptr) ;
+				list_ = std::exchange(o.list_, nullptr) ;
 			}
 
 			return *this ;
@@ -96,12 +363,27 @@ namespace zketch {
 				return false ;
 			}
 
-			auto* bmp = src.GetBitmap() ;
+			// a canvas sharing its pixels gets its own copy before anything is drawn
+			if (!src.Detach()) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("Renderer::Begin - Failed to detach shared canvas!") ;
+				#endif
+
+				return false ;
+			}
+
+			if (!Bind(src)) {
+				return false ;
+			}
+
+			auto* bmp = AcquireSurface(src) ;
 			if (!bmp) {
 				#ifdef RENDERER_DEBUG
 					logger::error("Renderer::Begin - source bitmap is null!") ;
 				#endif
 
+				Unbind() ;
 				return false ;
 			}
 
@@ -111,6 +393,7 @@ namespace zketch {
 					logger::error("Renderer::Begin - Failed to create graphics object!") ;
 				#endif
 
+				Unbind() ;
 				return false ;
 			}
 
@@ -120,17 +403,18 @@ namespace zketch {
 				#endif
 
 				gfx_.reset() ;
+				Unbind() ;
 				return false ;
 			}
 
 			canvas_target_ = &src ;
 			is_drawing_ = true ;
 
-			gfx_->SetSmoothingMode(Gdiplus::SmoothingModeHighQuality) ;
-			gfx_->SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic) ;
-			gfx_->SetPixelOffsetMode(Gdiplus::PixelOffsetModeHighQuality) ;
-			gfx_->SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
-			gfx_->SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
+			Configure(*gfx_) ;
+
+			if (list_) {
+				list_->BeginFrame(src.GetSize()) ;
+			}
 
 			return true ;
 		}
@@ -145,6 +429,9 @@ namespace zketch {
 				return false ;
 			}
 
+			// sizes reported since the last frame are only applied now, once
+			window.ApplyResize() ;
+
 			if (!window.IsCanvasValid()) {
 
 				#ifdef RENDERER_DEBUG
@@ -154,12 +441,20 @@ namespace zketch {
 				return false ;
 			}
 
+			// presented frames may still be held by the backend
+			if (!window.back_buffer_->Detach() || !Bind(*window.back_buffer_)) {
+				return false ;
+			}
+
+			window.BeginFrame() ;
+
 			auto* bmp = window.back_buffer_->GetBitmap() ;
 			if (!bmp) {
 				#ifdef RENDERER_DEBUG
 					logger::error("Renderer::Begin - source bitmap is null!") ;
 				#endif
 
+				Unbind() ;
 				return false ;
 			}
 
@@ -169,6 +464,7 @@ namespace zketch {
 					logger::error("Renderer::Begin - Failed to create graphics object!") ;
 				#endif
 
+				Unbind() ;
 				return false ;
 			}
 
@@ -178,6 +474,7 @@ namespace zketch {
 				#endif
 
 				gfx_.reset() ;
+				Unbind() ;
 				return false ;
 			}
 
@@ -185,35 +482,128 @@ namespace zketch {
 			window_target_ = &window ;
 			is_drawing_ = true ;
 
-			gfx_->SetSmoothingMode(Gdiplus::SmoothingModeHighQuality) ;
-			gfx_->SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic) ;
-			gfx_->SetPixelOffsetMode(Gdiplus::PixelOffsetModeHighQuality) ;
-			gfx_->SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
-			gfx_->SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
+			Configure(*gfx_) ;
+			reduced_ = window.resize_.reduce_quality_ && window.IsResizing() ;
+			window.resize_.reduced_frame_ = reduced_ ;
+			if (reduced_) {
+				ConfigureReduced(*gfx_) ;
+			}
+
+			if (list_) {
+				list_->BeginFrame(canvas_target_->GetSize()) ;
+			}
+
+			return true ;
+		}
+
+		// tiles are bound lazily, the first primitive touching one allocates it.
+		bool Begin(TiledCanvas& target) noexcept {
+			return Begin(target, {0, 0, static_cast<int32_t>(target.GetWidth()), static_cast<int32_t>(target.GetHeight())}) ;
+		}
+
+		// only tiles overlapping region are drawn into.
+		bool Begin(TiledCanvas& target, const Rect& region) noexcept {
+			if (is_drawing_) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("Renderer::Begin - Already in drawing state!") ;
+				#endif
+
+				return false ;
+			}
+
+			if (!target.IsValid()) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("Renderer::Begin - Invalid tiled canvas!") ;
+				#endif
+
+				return false ;
+			}
+
+			const int32_t x0 = std::max(region.x, 0) ;
+			const int32_t y0 = std::max(region.y, 0) ;
+			const int32_t x1 = std::min(region.x + static_cast<int32_t>(region.w), static_cast<int32_t>(target.GetWidth())) ;
+			const int32_t y1 = std::min(region.y + static_cast<int32_t>(region.h), static_cast<int32_t>(target.GetHeight())) ;
+
+			tiled_target_ = &target ;
+			clip_ = {x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)} ;
+			is_drawing_ = true ;
+
+			if (list_) {
+				list_->BeginFrame(target.GetSize()) ;
+			}
 
 			return true ;
 		}
 
 		void End() noexcept {
+			if (list_ && is_drawing_) {
+				list_->EndFrame() ;
+			}
+
+			if (tiled_target_) {
+				tiled_target_->Unbind() ;
+				tiled_target_ = nullptr ;
+			}
+
+			if (canvas_target_ && is_drawing_ && canvas_target_->GetFormat() == ColorFormat::A8 && scratch_) {
+				gfx_.reset() ;
+				pixel::ConvertRect(scratch_->GetPixels(), scratch_->GetStride(), ColorFormat::ARGB, canvas_target_->GetPixels(), canvas_target_->GetStride(), ColorFormat::A8, canvas_target_->GetWidth(), canvas_target_->GetHeight()) ;
+			}
+
 			if (window_target_) {
 				if (canvas_target_ && is_drawing_) {
-					if (window_target_->front_buffer_ && window_target_->back_buffer_) {
-						std::swap(window_target_->front_buffer_, window_target_->back_buffer_) ;
-						canvas_target_->MarkValidate() ;
-					}
+					gfx_.reset() ;
+					canvas_target_->MarkValidate() ;
+					Unbind() ;
+					window_target_->SwapBuffers() ;
 				}
 			}
 			gfx_.reset() ;
 			canvas_target_ = nullptr ;
 			window_target_ = nullptr ;
 			is_drawing_ = false ;
+			reduced_ = false ;
+			Unbind() ;
 		}
 
 		void Clear(const Color& color) noexcept {
 			if (!IsValid()) {
 				return ;
 			}
+
+			if (tiled_target_) {
+				// clearing everything just drops the tiles, untouched area reads as the background
+				if (clip_ == Rect{0, 0, static_cast<int32_t>(tiled_target_->GetWidth()), static_cast<int32_t>(tiled_target_->GetHeight())}) {
+					if (list_) {
+						list_->Clear(color) ;
+					}
+
+					// an XRGB canvas stores the color opaque, so does its background
+					Color background = color ;
+					if (tiled_target_->GetFormat() == ColorFormat::XRGB) {
+						background.SetA(255) ;
+					}
+
+					tiled_target_->Unbind() ;
+					tiled_target_->Clear() ;
+					tiled_target_->SetBackground(background) ;
+					return ;
+				}
+
+				ClearRect(clip_, color) ;
+				return ;
+			}
 			
+			if (list_) {
+				list_->Clear(color) ;
+			}
+
+			if (window_target_) {
+				window_target_->DamageAll() ;
+			}
+
 			auto prevMode = gfx_->GetCompositingMode() ;
 			gfx_->SetCompositingMode(Gdiplus::CompositingModeSourceCopy) ;
 			gfx_->Clear(color) ;
@@ -224,6 +614,25 @@ namespace zketch {
 			}
 		}
 
+		// replaces the pixels of rect with color, no blending. Handy for the strips Canvas::Scroll exposes.
+		void ClearRect(const Rect& rect, const Color& color) noexcept {
+			if (!IsValid()) {
+				return ;
+			}
+
+			if (list_) {
+				list_->ClearRect(rect, color) ;
+			}
+
+			Gdiplus::SolidBrush b(color) ;
+			ForEachSurface(rect, [&](Canvas&, Gdiplus::Graphics& gfx, const Point&, const Rect&) {
+				auto mode = gfx.GetCompositingMode() ;
+				gfx.SetCompositingMode(Gdiplus::CompositingModeSourceCopy) ;
+				gfx.FillRectangle(&b, Gdiplus::Rect(rect.x, rect.y, rect.w, rect.h)) ;
+				gfx.SetCompositingMode(mode) ;
+			}) ;
+		}
+
 		void DrawRect(const RectF& rect, const Color& color, float thickness = 1.0f) noexcept {
 			if (!IsValid()) {
 				return ;
@@ -238,9 +647,14 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->DrawRect(rect, color, thickness) ;
+			}
+
 			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawRectangle(&p, static_cast<Gdiplus::RectF>(rect)) ;
+			Draw(rect, thickness, [&](Gdiplus::Graphics& gfx) {
+				gfx.DrawRectangle(&p, static_cast<Gdiplus::RectF>(rect)) ;
+			}) ;
 		}
 
 		void FillRect(const Rect& rect, const Color& color) noexcept {
@@ -248,9 +662,14 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->FillRect(rect, color) ;
+			}
+
 			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillRectangle(&b, static_cast<Gdiplus::RectF>(rect)) ;
+			Draw(rect, 1.0f, [&](Gdiplus::Graphics& gfx) {
+				gfx.FillRectangle(&b, static_cast<Gdiplus::RectF>(rect)) ;
+			}) ;
 		}
 
 		void DrawRectRounded(const RectF& rect, const Color& color, float radius, float thickness = 1.0f) noexcept {
@@ -276,7 +695,10 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->DrawRectRounded(rect, color, radius, thickness) ;
+			}
+
 			Gdiplus::GraphicsPath path ;
 			float diameter = radius * 2.0f ;
 			path.AddArc(rect.x, rect.y, diameter, diameter, 180, 90) ;
@@ -285,7 +707,9 @@ namespace zketch {
 			path.AddArc(rect.x, rect.y + rect.h - diameter, diameter, diameter, 90, 90) ;
 			path.CloseFigure() ;
 			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawPath(&p, &path) ;
+			Draw(rect, thickness, [&](Gdiplus::Graphics& gfx) {
+				gfx.DrawPath(&p, &path) ;
+			}) ;
 		}
 
 		void FillRectRounded(const RectF& rect, const Color& color, float radius) noexcept {
@@ -302,7 +726,9 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->FillRectRounded(rect, color, radius) ;
+			}
 
 			Gdiplus::GraphicsPath path ;
 			float diameter = radius * 2.0f ;
@@ -312,7 +738,9 @@ namespace zketch {
 			path.AddArc(rect.x, rect.y + rect.h - diameter, diameter, diameter, 90, 90) ;
 			path.CloseFigure() ;
 			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillPath(&b, &path) ;
+			Draw(rect, 1.0f, [&](Gdiplus::Graphics& gfx) {
+				gfx.FillPath(&b, &path) ;
+			}) ;
 		}
 
 		void DrawEllipse(const RectF& rect, const Color& color, float thickness = 1.0f) noexcept {
@@ -329,9 +757,14 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->DrawEllipse(rect, color, thickness) ;
+			}
+
 			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawEllipse(&p, static_cast<Gdiplus::RectF>(rect)) ;
+			Draw(rect, thickness, [&](Gdiplus::Graphics& gfx) {
+				gfx.DrawEllipse(&p, static_cast<Gdiplus::RectF>(rect)) ;
+			}) ;
 		}
 
 		void FillEllipse(const RectF& rect, const zketch::Color& color) noexcept {
@@ -339,9 +772,14 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->FillEllipse(rect, color) ;
+			}
+
 			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillEllipse(&b, rect.x, rect.y, rect.w, rect.h) ;
+			Draw(rect, 1.0f, [&](Gdiplus::Graphics& gfx) {
+				gfx.FillEllipse(&b, rect.x, rect.y, rect.w, rect.h) ;
+			}) ;
 		}
 
 		void DrawString(const std::wstring& text, const Point& pos, const Color& color, const Font& font) noexcept {
@@ -358,15 +796,32 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->DrawString(text, pos, color, font) ;
+			}
+
 			Gdiplus::SolidBrush brush(color) ;
 			Gdiplus::Font used_font = font ;
-			gfx_->SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAliasGridFit) ;
-			Gdiplus::RectF layout(static_cast<Gdiplus::REAL>(pos.x), static_cast<Gdiplus::REAL>(pos.y), static_cast<Gdiplus::REAL>(canvas_target_ ? canvas_target_->GetWidth() - pos.x : 0), static_cast<Gdiplus::REAL>(canvas_target_ ? canvas_target_->GetHeight() - pos.y : 0));
+			const Size target = tiled_target_ ? tiled_target_->GetSize() : canvas_target_->GetSize() ;
+			Gdiplus::RectF layout(static_cast<Gdiplus::REAL>(pos.x), static_cast<Gdiplus::REAL>(pos.y), static_cast<Gdiplus::REAL>(target.x - pos.x), static_cast<Gdiplus::REAL>(target.y - pos.y)) ;
 			Gdiplus::StringFormat fmt ;
 			fmt.SetAlignment(Gdiplus::StringAlignmentNear) ;
 			fmt.SetLineAlignment(Gdiplus::StringAlignmentNear) ;
-			gfx_->DrawString(text.c_str(), -1, &used_font, layout, &fmt, &brush) ;
+
+			// glyph metrics are approximate, the bound is padded by a line height
+			const float lines = static_cast<float>(std::count(text.begin(), text.end(), L'\n') + 1) ;
+			RectF bound {static_cast<float>(pos.x), static_cast<float>(pos.y), font.GetStringWidth(text), font.GetHeight() * lines} ;
+
+			#ifdef ZKETCH_SOFTGDI
+				// the software GDI+ draws its built in glyphs whatever the font's metrics say
+				const Gdiplus::RectF glyphs = Gdiplus::MeasureGlyphs(text.c_str(), static_cast<INT>(text.size()), used_font.GetSize()) ;
+				bound.w = std::max(bound.w, glyphs.Width) ;
+				bound.h = std::max(bound.h, glyphs.Height) ;
+			#endif
+			Draw(bound, font.GetHeight(), [&](Gdiplus::Graphics& gfx) {
+				gfx.SetTextRenderingHint(reduced_ ? Gdiplus::TextRenderingHintSingleBitPerPixelGridFit : Gdiplus::TextRenderingHintAntiAliasGridFit) ;
+				gfx.DrawString(text.c_str(), -1, &used_font, layout, &fmt, &brush) ;
+			}) ;
 		}
 
 		void DrawString(const std::string& text, const Point& pos, const Color& color, const Font& font) noexcept {
@@ -396,7 +851,6 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
 			std::vector<Gdiplus::PointF> points ;
 			points.reserve(vertices.size()) ;
 
@@ -404,8 +858,14 @@ namespace zketch {
 				points.emplace_back(v.x, v.y) ;
 			}
 
+			if (list_) {
+				list_->DrawPolygon(vertices, color, thickness) ;
+			}
+
 			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawPolygon(&p, points.data(), static_cast<int>(points.size())) ;
+			Draw(GetVertexBound(vertices), thickness, [&](Gdiplus::Graphics& gfx) {
+				gfx.DrawPolygon(&p, points.data(), static_cast<int>(points.size())) ;
+			}) ;
 		}
 
 		void FillPolygon(const Vertex& vertices, const Color& color) noexcept {
@@ -422,7 +882,6 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
 			std::vector<Gdiplus::PointF> points ;
 			points.reserve(vertices.size()) ;
 			
@@ -430,8 +889,14 @@ namespace zketch {
 				points.emplace_back(v.x, v.y) ;
 			}
 
+			if (list_) {
+				list_->FillPolygon(vertices, color) ;
+			}
+
 			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillPolygon(&b, points.data(), static_cast<int>(points.size())) ;
+			Draw(GetVertexBound(vertices), 1.0f, [&](Gdiplus::Graphics& gfx) {
+				gfx.FillPolygon(&b, points.data(), static_cast<int>(points.size())) ;
+			}) ;
 		}
 
 		void DrawLine(const Point& start, const Point& end, const Color& color, float thickness = 1.0f) noexcept {
@@ -448,9 +913,15 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
+			if (list_) {
+				list_->DrawLine(start, end, color, thickness) ;
+			}
+
 			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawLine(&p, start.x, start.y, end.x, end.y) ;
+			const RectF bound {static_cast<float>(std::min(start.x, end.x)), static_cast<float>(std::min(start.y, end.y)), static_cast<float>(std::abs(end.x - start.x)), static_cast<float>(std::abs(end.y - start.y))} ;
+			Draw(bound, thickness, [&](Gdiplus::Graphics& gfx) {
+				gfx.DrawLine(&p, start.x, start.y, end.x, end.y) ;
+			}) ;
 		}
 
 		void DrawCircle(const Point& center, float radius, const Color& color, float thickness = 1.0f) noexcept {
@@ -458,7 +929,6 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
 			DrawEllipse(RectF{static_cast<float>(center.x - radius), static_cast<float>(center.y - radius), radius * 2.0f, radius * 2.0f}, color, thickness) ;
 		}
 
@@ -467,16 +937,16 @@ namespace zketch {
 				return ;
 			}
 
-			canvas_target_->MarkInvalidate() ;
 			FillEllipse(RectF{static_cast<float>(center.x - radius), static_cast<float>(center.y - radius), radius * 2.0f, radius * 2.0f}, color) ;
 		}
 
+		// blits with the pixel kernels instead of GDI+, any format onto any format. A8 sources are drawn black.
 		void DrawCanvas(const Canvas* src, const Point& pos) noexcept {
-			if (!IsValid() || !src->IsValid()) { 
+			if (!IsValid()) { 
 				return ; 
 			}
 
-			if (!src) {
+			if (!src || !src->IsValid()) {
 
 				#ifdef RENDERER_DEBUG
 					logger::warning("Renderer::DrawCanvas - Canvas source is null!") ;
@@ -485,359 +955,139 @@ namespace zketch {
 				return ;
 			}
 
-			auto* bitmap = src->GetBitmap() ;
-			if (!bitmap) {
-
-				#ifdef RENDERER_DEBUG
-					logger::warning("Renderer::DrawCanvas - Bitmap is null!") ;
-				#endif
-
-				return ;
-			}
-
-			gfx_->DrawImage(bitmap, pos.x, pos.y ) ;
-			canvas_target_->MarkInvalidate() ;
-		}
-
-		bool IsDrawing() const noexcept { return is_drawing_ ; }
-		Canvas* GetTarget() const noexcept { return canvas_target_ ; }
-	} ;
-=======
-#pragma once
-
-#include "canvas.hpp"
-
-namespace zketch {
-
-	class Drawer {
-	private:
-		std::unique_ptr<Gdiplus::Graphics> gfx_ = nullptr ;
-		Canvas* to_ = nullptr ;
-		bool is_drawing_ = false ;
-
-		bool IsValid() const noexcept {
-			if (!to_) {
-				logger::warning("Renderer - target canvas is null!") ;
-				return false ;
-			}
-
-			if (!gfx_ || !is_drawing_) {
-				if (!gfx_) {
-					logger::warning("Renderer - gfx is nullptr!") ;
-				}
-				if (!is_drawing_) {
-					logger::warning("Renderer - not in drawing state!") ;
-				}
-				return false ;
-			}
-			return true ;
-		}
-
-	public:
-		Drawer() = default ;
-		~Drawer() noexcept {
-			if (is_drawing_) {
-				logger::warning("Renderer destroyed while drawing - calling End().") ;
-				End() ;
-			}
-		}
-
-		Drawer(const Drawer&) = delete ;
-		Drawer& operator=(const Drawer&) = delete ;
-
-		Drawer(Drawer&& o) noexcept
-			: gfx_(std::move(o.gfx_)), to_(std::exchange(o.to_, nullptr))
-			, is_drawing_(std::exchange(o.is_drawing_, false)) {}
-
-		Drawer& operator=(Drawer&& o) noexcept {
-			if (this != &o) {
-				if (is_drawing_) End() ;
-				gfx_ = std::move(o.gfx_) ;
-				to_ = std::exchange(o.to_, nullptr) ;
-				is_drawing_ = std::exchange(o.is_drawing_, false) ;
-			}
-			return *this ;
-		}
-
-		bool Begin(Canvas& src, bool auto_clear = true) noexcept {
-			if (is_drawing_) {
-				logger::error("Renderer Begin() already in drawing state.") ;
-				return false ;
-			}
-
-			if (!src.IsValid()) {
-				logger::error("Renderer Begin() invalid canvas.") ;
-				return false ;
-			}
-
-			auto* back = src.GetBackBuffer() ;
-			if (!back) {
-				logger::error("Renderer Begin() - back buffer is null.") ;
-				return false ;
-			}
-
-			gfx_ = std::make_unique<Gdiplus::Graphics>(back) ;
-			if (!gfx_) {
-				logger::error("Renderer Begin() failed to create graphics object.") ;
-				return false ;
-			}
-
-			if (gfx_->GetLastStatus() != Gdiplus::Ok) {
-				logger::error("Renderer Begin() graphics status not OK: ", static_cast<int32_t>(gfx_ ? gfx_->GetLastStatus() : Gdiplus::GenericError)) ;
-				gfx_.reset() ;
-				return false ;
-			}
-
-			to_ = &src ;
-			is_drawing_ = true ;
-
-			// Quality settings BEFORE any drawing
-			gfx_->SetSmoothingMode(Gdiplus::SmoothingModeHighQuality) ;
-			gfx_->SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic) ;
-			gfx_->SetPixelOffsetMode(Gdiplus::PixelOffsetModeHighQuality) ;
-			gfx_->SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
-
-			// FIX: Use SourceCopy mode for clearing to completely replace pixels
-			// This prevents artifacts when using transparent backgrounds
-			if (auto_clear) {
-				gfx_->SetCompositingMode(Gdiplus::CompositingModeSourceCopy) ;
-				gfx_->Clear(static_cast<Gdiplus::Color>(src.GetClearColor())) ;
+			if (IsRecordable(*src)) {
+				list_->DrawCanvas(*src, {0, 0, src->GetWidth(), src->GetHeight()}, pos) ;
 			}
-			
-			// Set to SourceOver for normal drawing operations
-			gfx_->SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
 
-			return true ;
+			CompositeCanvas(*src, {0, 0, src->GetWidth(), src->GetHeight()}, pos, Black.GetARGB()) ;
 		}
 
-		void End() noexcept {
-			if (to_ && is_drawing_) {
-				to_->SwapBuffers() ;
+		// draws region of src with its top left corner at pos.
+		void DrawCanvas(const Canvas* src, const Rect& region, const Point& pos) noexcept {
+			if (!IsValid()) { 
+				return ; 
 			}
 
-			gfx_.reset() ;
-			to_ = nullptr ;
-			is_drawing_ = false ;
-		}
+			if (!src || !src->IsValid()) {
 
-		void Clear(const Color& color) noexcept {
-			if (!IsValid()) 
-				return ;
-			
-			// FIX: Use SourceCopy to completely replace pixels (not blend)
-			// This ensures transparent clear actually clears everything
-			auto prevMode = gfx_->GetCompositingMode() ;
-			gfx_->SetCompositingMode(Gdiplus::CompositingModeSourceCopy) ;
-			gfx_->Clear(color) ;
-			gfx_->SetCompositingMode(prevMode) ;
-			
-			if (to_) to_->MarkDirty() ;
-		}
-
-		void DrawRect(const RectF& rect, const Color& color, float thickness = 1.0f) noexcept {
-			if (!IsValid()) {
-				return ;
-			}
+				#ifdef RENDERER_DEBUG
+					logger::warning("Renderer::DrawCanvas - Canvas source is null!") ;
+				#endif
 
-			if (thickness < 0.1f) {
-				logger::warning("DrawRect - thickness lower than 0.1") ;
 				return ;
 			}
 
-			to_->MarkDirty() ;
-			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawRectangle(&p, static_cast<Gdiplus::RectF>(rect)) ;
-		}
-
-		void FillRect(const Rect& rect, const Color& color) noexcept {
-			if (!IsValid()) 
-				return ;
-
-			to_->MarkDirty() ;
-			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillRectangle(&b, static_cast<Gdiplus::RectF>(rect)) ;
-		}
+			Rect clipped = region ;
+			Point at = pos ;
+			if (ClipRegion(src->GetSize(), clipped, at)) {
+				if (IsRecordable(*src)) {
+					list_->DrawCanvas(*src, clipped, at) ;
+				}
 
-		void DrawRectRounded(const RectF& rect, const Color& color, float radius, float thickness = 1.0f) noexcept {
-			if (!IsValid()) {
-				return ;
+				CompositeCanvas(*src, clipped, at, Black.GetARGB()) ;
 			}
-
-			if (thickness < 0.1f || radius < 0.0f) 
-				return ;
-
-			to_->MarkDirty() ;
-			Gdiplus::GraphicsPath path ;
-			float diameter = radius * 2.0f ;
-			path.AddArc(rect.x, rect.y, diameter, diameter, 180, 90) ;
-			path.AddArc(rect.x + rect.w - diameter, rect.y, diameter, diameter, 270, 90) ;
-			path.AddArc(rect.x + rect.w - diameter, rect.y + rect.h - diameter, diameter, diameter, 0, 90) ;
-			path.AddArc(rect.x, rect.y + rect.h - diameter, diameter, diameter, 90, 90) ;
-			path.CloseFigure() ;
-
-			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawPath(&p, &path) ;
 		}
 
-		void FillRectRounded(const RectF& rect, const Color& color, float radius) noexcept {
-			if (!IsValid()) {
-				return ;
-			}
-
-			if (radius < 0.0f) {
-				return ;
+		// draws region of a tiled canvas. Missing tiles read as its background, or are regenerated
+		// through its redraw callback when one is set.
+		void DrawCanvas(TiledCanvas* src, const Rect& region, const Point& pos) noexcept {
+			if (!IsValid()) { 
+				return ; 
 			}
 
-			to_->MarkDirty() ;
+			if (!src || !src->IsValid()) {
 
-			Gdiplus::GraphicsPath path ;
-			float diameter = radius * 2.0f ;
-			path.AddArc(rect.x, rect.y, diameter, diameter, 180, 90) ;
-			path.AddArc(rect.x + rect.w - diameter, rect.y, diameter, diameter, 270, 90) ;
-			path.AddArc(rect.x + rect.w - diameter, rect.y + rect.h - diameter, diameter, diameter, 0, 90) ;
-			path.AddArc(rect.x, rect.y + rect.h - diameter, diameter, diameter, 90, 90) ;
-			path.CloseFigure() ;
-
-			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillPath(&b, &path) ;
-		}
-
-		void DrawEllipse(const RectF& rect, const Color& color, float thickness = 1.0f) noexcept {
-			if (!IsValid()) {
-				return ;
-			}
+				#ifdef RENDERER_DEBUG
+					logger::warning("Renderer::DrawCanvas - Tiled canvas source is null!") ;
+				#endif
 
-			if (thickness < 0.1f) {
 				return ;
 			}
 
-			to_->MarkDirty() ;
-			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawEllipse(&p, static_cast<Gdiplus::RectF>(rect)) ;
-		}
-
-		void FillEllipse(const RectF& rect, const zketch::Color& color) noexcept {
-			if (!IsValid()) {
-				return ;
-			}
+			if (src == tiled_target_) {
 
-			to_->MarkDirty() ;
-			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillEllipse(&b, rect.x, rect.y, rect.w, rect.h) ;
-		}
+				#ifdef RENDERER_DEBUG
+					logger::warning("Renderer::DrawCanvas - Tiled canvas can't be drawn onto itself!") ;
+				#endif
 
-		void DrawString(const std::wstring& text, const Point& pos, const Color& color, const Font& font) noexcept {
-			if (!IsValid()) {
 				return ;
 			}
 
-			if (text.empty()) {
+			Rect clipped = region ;
+			Point at = pos ;
+			if (!ClipRegion(src->GetSize(), clipped, at)) {
 				return ;
 			}
 
-			to_->MarkDirty() ;
-			Gdiplus::SolidBrush brush(color) ;
-			Gdiplus::FontFamily family(font.GetFamily().c_str()) ;
-			Gdiplus::Font f(&family, font.GetSize(), font.GetStyle(), Gdiplus::UnitPixel) ;
-
-			gfx_->SetTextRenderingHint(Gdiplus::TextRenderingHintAntiAliasGridFit) ;
-
-			Gdiplus::RectF layout(static_cast<Gdiplus::REAL>(pos.x), static_cast<Gdiplus::REAL>(pos.y), static_cast<Gdiplus::REAL>(to_ ? to_->GetWidth() - pos.x : 0), static_cast<Gdiplus::REAL>(to_ ? to_->GetHeight() - pos.y : 0));
-
-			Gdiplus::StringFormat fmt ;
-			fmt.SetAlignment(Gdiplus::StringAlignmentNear) ;
-			fmt.SetLineAlignment(Gdiplus::StringAlignmentNear) ;
-
-			gfx_->DrawString(text.c_str(), -1, &f, layout, &fmt, &brush) ;
-		}
-
-		void DrawPolygon(const Vertex& vertices, const Color& color, float thickness = 1.0f) noexcept {
-			if (!IsValid() || vertices.empty()) {
-				return ;
-			}
+			src->ForEachTileIn(clipped, [&](uint32_t tx, uint32_t ty) {
+				const Rect tile_bound = src->GetTileBound(tx, ty) ;
+				const int32_t x0 = std::max(clipped.x, tile_bound.x) ;
+				const int32_t y0 = std::max(clipped.y, tile_bound.y) ;
+				const int32_t x1 = std::min(clipped.x + static_cast<int32_t>(clipped.w), tile_bound.x + static_cast<int32_t>(tile_bound.w)) ;
+				const int32_t y1 = std::min(clipped.y + static_cast<int32_t>(clipped.h), tile_bound.y + static_cast<int32_t>(tile_bound.h)) ;
+				const Point dst {at.x + x0 - clipped.x, at.y + y0 - clipped.y} ;
 
-			if (thickness < 0.1f) {
-				return ;
-			}
+				// regenerating ends a nested Renderer, whose trim mustn't take the tile back before it is read
+				src->pinned_ = TiledCanvas::KeyOf(tx, ty) ;
+				TiledCanvas::Tile* tile = src->FindTile(tx, ty) ;
+				if (!tile) {
+					tile = RegenerateTile(*src, tx, ty) ;
+				}
 
-			to_->MarkDirty() ;
-			std::vector<Gdiplus::PointF> points ;
-			points.reserve(vertices.size()) ;
+				if (tile) {
+					// tiles go out as canvases of their own, a receiver has no tiled sources
+					if (IsRecordable(tile->canvas_)) {
+						list_->DrawCanvas(tile->canvas_, {x0 - tile_bound.x, y0 - tile_bound.y, x1 - x0, y1 - y0}, dst) ;
+					}
 
-			for (const auto& v : vertices) {
-				points.emplace_back(v.x, v.y) ;
-			}
+					Composite(tile->canvas_, {x0 - tile_bound.x, y0 - tile_bound.y, x1 - x0, y1 - y0}, dst, Black.GetARGB()) ;
+				} else if (src->GetBackground().GetA() != 0) {
+					FillRect({dst.x, dst.y, x1 - x0, y1 - y0}, src->GetBackground()) ;
+				}
 
-			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawPolygon(&p, points.data(), static_cast<int>(points.size())) ;
+				src->pinned_ = TiledCanvas::___NO_TILE___ ;
+				src->Trim() ;
+			}) ;
 		}
 
-		void FillPolygon(const Vertex& vertices, const Color& color) noexcept {
-			if (!IsValid() || vertices.empty()) {
-				return ;
+		// draws an A8 coverage mask (text, shadows) tinted with color.
+		void DrawMask(const Canvas* mask, const Point& pos, const Color& color) noexcept {
+			if (!IsValid()) { 
+				return ; 
 			}
 
-			to_->MarkDirty() ;
-			std::vector<Gdiplus::PointF> points ;
-			points.reserve(vertices.size()) ;
-			
-			for (const auto& v : vertices) {
-				points.emplace_back(v.x, v.y) ;
-			}
+			if (!mask || !mask->IsValid()) {
 
-			Gdiplus::SolidBrush b(color) ;
-			gfx_->FillPolygon(&b, points.data(), static_cast<int>(points.size())) ;
-		}
+				#ifdef RENDERER_DEBUG
+					logger::warning("Renderer::DrawMask - Mask is null!") ;
+				#endif
 
-		void DrawLine(const Point& start, const Point& end, const Color& color, float thickness = 1.0f) noexcept {
-			if (!IsValid()) {
 				return ;
 			}
 
-			if (thickness < 0.1f) {
-				return ;
-			}
+			if (mask->GetFormat() != ColorFormat::A8) {
 
-			to_->MarkDirty() ;
-			Gdiplus::Pen p(color, thickness) ;
-			gfx_->DrawLine(&p, start.x, start.y, end.x, end.y) ;
-		}
+				#ifdef RENDERER_DEBUG
+					logger::warning("Renderer::DrawMask - Mask isn't ColorFormat::A8, drawing as canvas.") ;
+				#endif
 
-		void DrawCircle(const Point& center, float radius, const Color& color, float thickness = 1.0f) noexcept {
-			if (!IsValid()) {
-				return ;
 			}
 
-			to_->MarkDirty() ;
-			DrawEllipse(RectF{static_cast<float>(center.x - radius), static_cast<float>(center.y - radius), radius * 2.0f, radius * 2.0f}, color, thickness) ;
-		}
-
-		void FillCircle(const Point& center, float radius, const Color& color) noexcept {
-			if (!IsValid()) {
-				return ;
+			if (IsRecordable(*mask)) {
+				list_->DrawMask(*mask, pos, color) ;
 			}
 
-			to_->MarkDirty() ;
-			FillEllipse(RectF{static_cast<float>(center.x - radius), static_cast<float>(center.y - radius), radius * 2.0f, radius * 2.0f}, color) ;
-		}
-
-		bool IsDrawing() const noexcept { 
-			return is_drawing_ ; 
+			CompositeCanvas(*mask, {0, 0, mask->GetWidth(), mask->GetHeight()}, pos, color.GetARGB()) ;
 		}
 
-		Canvas* GetTarget() const noexcept { 
-			return to_ ; 
+		// every frame drawn from the next Begin() on is also written to list, nullptr stops it.
+		void SetDisplayList(DisplayListWriter* list) noexcept {
+			list_ = list ;
 		}
 
-		// Helper to composite another canvas onto current target
-		void DrawCanvas(const Canvas* src, float x, float y) noexcept {
-			if (!IsValid() || !src || !src->IsValid()) return;
-			auto* bitmap = src->GetBitmap();
-			if (bitmap) {
-				gfx_->DrawImage(bitmap, x, y);
-				if (to_) to_->MarkDirty();
-			}
-		}
+		bool IsDrawing() const noexcept { return is_drawing_ ; }
+		Canvas* GetTarget() const noexcept { return canvas_target_ ; }
+		TiledCanvas* GetTiledTarget() const noexcept { return tiled_target_ ; }
+		DisplayListWriter* GetDisplayList() const noexcept { return list_ ; }
 	} ;
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+}
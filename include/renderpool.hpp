@@ -0,0 +1,162 @@
+#pragma once
+#include "renderer.hpp"
+
+namespace zketch {
+
+	// renders independent windows concurrently. Every worker and the calling thread own a Renderer,
+	// Render() hands the windows out between them, waits until all are drawn and then presents them
+	// in order on the calling thread.
+	//
+	// while a frame is in flight:
+	//  - the draw callback runs on any of the threads, it may only touch the window it was given and
+	//    objects no other window's callback touches. Canvas copies sharing pixels can be read by all.
+	//  - a canvas bound by one Renderer can't be bound by another and reads as nothing to DrawCanvas.
+	//  - Font values are safe anywhere, Application::LoadFonts is refused until the frame is done.
+	//  - EventSystem::PushEvent works from the callback, polling stays on the event loop's thread.
+	class WindowRenderPool {
+	private :
+		using DrawFn = std::function<void(Renderer&, Window&)> ;
+
+		std::vector<std::thread> workers_ ;
+		std::vector<Renderer> renderers_ ;	// one per worker, the last one is the caller's
+		std::mutex mutex_ ;
+		std::condition_variable start_ ;
+		std::condition_variable done_ ;
+		std::span<Window* const> windows_ ;
+		const DrawFn* draw_ = nullptr ;
+		std::atomic<size_t> next_ {0} ;
+		std::atomic<size_t> drawn_ {0} ;
+		size_t busy_ = 0 ;		// workers inside Work, windows_ and draw_ only change while it's 0
+		uint64_t generation_ = 0 ;
+		bool stop_ = false ;
+
+		void Work(Renderer& renderer) noexcept {
+			while (true) {
+				const size_t i = next_.fetch_add(1, std::memory_order_relaxed) ;
+				if (i >= windows_.size()) {
+					return ;
+				}
+
+				Window& window = *windows_[i] ;
+				if (renderer.Begin(window)) {
+					try {
+						(*draw_)(renderer, window) ;
+					} catch (...) {
+
+						#ifdef RENDERER_DEBUG
+							logger::error("WindowRenderPool::Render - Draw callback threw, frame dropped.") ;
+						#endif
+
+					}
+					renderer.End() ;
+					drawn_.fetch_add(1, std::memory_order_relaxed) ;
+				}
+			}
+		}
+
+		void Run(size_t index) noexcept {
+			uint64_t seen = 0 ;
+			std::unique_lock<std::mutex> lock(mutex_) ;
+			while (true) {
+				start_.wait(lock, [&] { return stop_ || generation_ != seen ; }) ;
+				if (stop_) {
+					return ;
+				}
+
+				seen = generation_ ;
+				++busy_ ;
+				lock.unlock() ;
+				Work(renderers_[index]) ;
+				lock.lock() ;
+				if (--busy_ == 0) {
+					done_.notify_one() ;
+				}
+			}
+		}
+
+	public :
+		WindowRenderPool(const WindowRenderPool&) = delete ;
+		WindowRenderPool& operator=(const WindowRenderPool&) = delete ;
+
+		// 0 uses one thread per core, the calling thread counts as one of them.
+		explicit WindowRenderPool(size_t threads = 0) noexcept {
+			if (threads == 0) {
+				threads = std::max<size_t>(std::thread::hardware_concurrency(), 1) ;
+			}
+
+			try {
+				renderers_.resize(threads) ;
+				workers_.reserve(threads - 1) ;
+				for (size_t i = 0 ; i + 1 < threads ; ++i) {
+					workers_.emplace_back(&WindowRenderPool::Run, this, i) ;
+				}
+			} catch (...) {
+
+				#ifdef RENDERER_DEBUG
+					logger::error("WindowRenderPool::WindowRenderPool - Failed to start workers, running with ", workers_.size(), ".") ;
+				#endif
+
+			}
+		}
+
+		~WindowRenderPool() noexcept {
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				stop_ = true ;
+			}
+			start_.notify_all() ;
+			for (auto& worker : workers_) {
+				worker.join() ;
+			}
+		}
+
+		// draw(renderer, window) runs between Begin and End for every window, each window at most
+		// once per call. Returns how many windows were drawn. Windows presenting asynchronously are
+		// submitted by End, the rest are presented here in the order given.
+		size_t Render(std::span<Window* const> windows, const DrawFn& draw) noexcept {
+			for (size_t i = 0 ; i < windows.size() ; ++i) {
+				if (!windows[i] || std::find(windows.begin() + i + 1, windows.end(), windows[i]) != windows.end()) {
+
+					#ifdef RENDERER_DEBUG
+						logger::error("WindowRenderPool::Render - Windows must be non null and distinct.") ;
+					#endif
+
+					return 0 ;
+				}
+			}
+
+			if (windows.empty() || renderers_.empty()) {
+				return 0 ;
+			}
+
+			Application::parallel_frames_.fetch_add(1, std::memory_order_acq_rel) ;
+			{
+				// a worker that woke up late for the previous call may still be looking at it
+				std::unique_lock<std::mutex> lock(mutex_) ;
+				done_.wait(lock, [this] { return busy_ == 0 ; }) ;
+				windows_ = windows ;
+				draw_ = &draw ;
+				next_.store(0, std::memory_order_relaxed) ;
+				drawn_.store(0, std::memory_order_relaxed) ;
+				++generation_ ;
+			}
+			start_.notify_all() ;
+
+			Work(renderers_.back()) ;
+			{
+				std::unique_lock<std::mutex> lock(mutex_) ;
+				done_.wait(lock, [this] { return busy_ == 0 ; }) ;
+				windows_ = {} ;
+				draw_ = nullptr ;
+			}
+			Application::parallel_frames_.fetch_sub(1, std::memory_order_acq_rel) ;
+
+			for (Window* window : windows) {
+				window->Present() ;
+			}
+			return drawn_.load(std::memory_order_relaxed) ;
+		}
+
+		size_t GetThreadCount() const noexcept { return renderers_.size() ; }
+	} ;
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include "canvas.hpp"
+
+namespace zketch {
+
+	enum class ReclaimMode : uint8_t {
+		Keep,		// hidden surfaces stay resident
+		Release,	// pixels are dropped and redrawn when shown again
+		Compress	// pixels are kept compressed in memory and decoded when shown again
+	} ;
+
+	struct ResidencyStats {
+		size_t reclaimed_bytes_ = 0 ;		// bitmap bytes currently given back
+		size_t compressed_bytes_ = 0 ;		// bytes currently held by compressed surfaces
+		size_t resident_count_ = 0 ;		// registered surfaces
+		uint64_t released_ = 0 ;
+		uint64_t compressed_ = 0 ;
+		uint64_t restored_ = 0 ;			// decoded back from memory
+		uint64_t rerasterized_ = 0 ;		// lost their pixels and had to be drawn again
+	} ;
+
+	class ResidentSurface ;
+
+	// reclaims the canvases of surfaces hidden for longer than the idle time. Collect() and the
+	// widgets it walks belong to the UI thread.
+	class Residency {
+		friend class ResidentSurface ;
+
+	private :
+		static inline std::unordered_set<ResidentSurface*> g_surfaces_ ;
+		static inline std::mutex g_mutex_ ;
+		static inline std::atomic<ReclaimMode> g_mode_ {ReclaimMode::Keep} ;
+		static inline std::atomic<int64_t> g_idle_ms_ {5000} ;
+
+		static inline std::atomic<size_t> g_reclaimed_bytes_ {0} ;
+		static inline std::atomic<size_t> g_compressed_bytes_ {0} ;
+		static inline std::atomic<uint64_t> g_released_ {0} ;
+		static inline std::atomic<uint64_t> g_compressed_ {0} ;
+		static inline std::atomic<uint64_t> g_restored_ {0} ;
+		static inline std::atomic<uint64_t> g_rerasterized_ {0} ;
+
+	public :
+		Residency() = delete ;
+
+		static void SetPolicy(ReclaimMode mode, std::chrono::milliseconds idle = std::chrono::milliseconds(5000)) noexcept {
+			g_mode_.store(mode, std::memory_order_relaxed) ;
+			g_idle_ms_.store(idle.count(), std::memory_order_relaxed) ;
+		}
+
+		static ReclaimMode GetMode() noexcept { return g_mode_.load(std::memory_order_relaxed) ; }
+		static std::chrono::milliseconds GetIdleTime() noexcept { return std::chrono::milliseconds(g_idle_ms_.load(std::memory_order_relaxed)) ; }
+
+		// sweeps every registered surface, returns the bytes reclaimed by this pass.
+		static size_t Collect() noexcept ;
+
+		static ResidencyStats GetStats() noexcept {
+			ResidencyStats stats ;
+			stats.reclaimed_bytes_ = g_reclaimed_bytes_.load(std::memory_order_relaxed) ;
+			stats.compressed_bytes_ = g_compressed_bytes_.load(std::memory_order_relaxed) ;
+			stats.released_ = g_released_.load(std::memory_order_relaxed) ;
+			stats.compressed_ = g_compressed_.load(std::memory_order_relaxed) ;
+			stats.restored_ = g_restored_.load(std::memory_order_relaxed) ;
+			stats.rerasterized_ = g_rerasterized_.load(std::memory_order_relaxed) ;
+
+			std::lock_guard<std::mutex> lock(g_mutex_) ;
+			stats.resident_count_ = g_surfaces_.size() ;
+			return stats ;
+		}
+	} ;
+
+	// something owning a canvas that can be reclaimed while hidden, Widget derives from it.
+	class ResidentSurface {
+		friend class Residency ;
+
+	private :
+		std::chrono::steady_clock::time_point hidden_since_ {} ;
+		size_t reclaimed_ = 0 ;
+		size_t compressed_ = 0 ;
+		bool hidden_ = false ;
+
+		void Forget() noexcept {
+			Residency::g_reclaimed_bytes_.fetch_sub(reclaimed_, std::memory_order_relaxed) ;
+			Residency::g_compressed_bytes_.fetch_sub(compressed_, std::memory_order_relaxed) ;
+			reclaimed_ = 0 ;
+			compressed_ = 0 ;
+		}
+
+	protected :
+		virtual Canvas* GetResidentCanvas() noexcept = 0 ;
+
+		ResidentSurface() noexcept {
+			try {
+				std::lock_guard<std::mutex> lock(Residency::g_mutex_) ;
+				Residency::g_surfaces_.insert(this) ;
+			} catch (...) {}
+		}
+
+		ResidentSurface(const ResidentSurface&) = delete ;
+		ResidentSurface& operator=(const ResidentSurface&) = delete ;
+
+		virtual ~ResidentSurface() noexcept {
+			Forget() ;
+			std::lock_guard<std::mutex> lock(Residency::g_mutex_) ;
+			Residency::g_surfaces_.erase(this) ;
+		}
+
+		void MarkHidden() noexcept {
+			if (!hidden_) {
+				hidden_ = true ;
+				hidden_since_ = std::chrono::steady_clock::now() ;
+			}
+		}
+
+		// returns false when the pixels were released and have to be drawn again.
+		bool MarkShown() noexcept {
+			hidden_ = false ;
+
+			Canvas* canvas = GetResidentCanvas() ;
+			if (!canvas || canvas->IsValid()) {
+				return true ;
+			}
+
+			bool kept = canvas->IsCompressed() ;
+			if (!canvas->Restore()) {
+				return false ;
+			}
+
+			Forget() ;
+			if (kept) {
+				Residency::g_restored_.fetch_add(1, std::memory_order_relaxed) ;
+			} else {
+				Residency::g_rerasterized_.fetch_add(1, std::memory_order_relaxed) ;
+			}
+			return kept ;
+		}
+
+		size_t Reclaim(std::chrono::steady_clock::time_point now) noexcept {
+			ReclaimMode mode = Residency::GetMode() ;
+			if (!hidden_ || mode == ReclaimMode::Keep || now - hidden_since_ < Residency::GetIdleTime()) {
+				return 0 ;
+			}
+
+			Canvas* canvas = GetResidentCanvas() ;
+			if (!canvas || !canvas->IsValid()) {
+				return 0 ;
+			}
+
+			// shared pixels stay alive for the other owners, dropping our reference is all that helps
+			const bool shared = canvas->IsShared() ;
+			const size_t bytes = canvas->GetByteSize() ;
+
+			if (mode == ReclaimMode::Compress && !shared && canvas->Compress()) {
+				compressed_ = canvas->GetCompressedSize() ;
+				reclaimed_ = bytes > compressed_ ? bytes - compressed_ : 0 ;
+				Residency::g_compressed_.fetch_add(1, std::memory_order_relaxed) ;
+				Residency::g_compressed_bytes_.fetch_add(compressed_, std::memory_order_relaxed) ;
+			} else {
+				canvas->Release() ;
+				reclaimed_ = shared ? 0 : bytes ;
+				Residency::g_released_.fetch_add(1, std::memory_order_relaxed) ;
+			}
+
+			Residency::g_reclaimed_bytes_.fetch_add(reclaimed_, std::memory_order_relaxed) ;
+
+			#ifdef CANVAS_DEBUG
+				logger::info("ResidentSurface::Reclaim - Reclaimed ", reclaimed_, " of ", bytes, " bytes.") ;
+			#endif
+
+			return reclaimed_ ;
+		}
+
+	public :
+		bool IsHidden() const noexcept { return hidden_ ; }
+	} ;
+
+	inline size_t Residency::Collect() noexcept {
+		if (GetMode() == ReclaimMode::Keep) {
+			return 0 ;
+		}
+
+		auto now = std::chrono::steady_clock::now() ;
+		size_t total = 0 ;
+
+		std::lock_guard<std::mutex> lock(g_mutex_) ;
+		for (ResidentSurface* surface : g_surfaces_) {
+			total += surface->Reclaim(now) ;
+		}
+		return total ;
+	}
+}
@@ -0,0 +1,684 @@
+#pragma once
+#include "win32names.hpp"
+#include "pixel.hpp"
+
+// the part of GDI+ Canvas and Renderer draw with, rasterized in software for builds without
+// gdiplus.h. Bitmaps wrap caller owned 32bpp ARGB, 32bpp RGB or 16bpp RGB565 rows like the real
+// ones. Shapes are filled by pixel centers without anti aliasing, strokes are the union of a quad
+// per segment and a disc per joint so nothing is blended twice. Clip and transform are an integer
+// rectangle and a translation, which is all the Renderer sets. Text is drawn with a built in 5x8
+// bitmap font of the printable ASCII range, scaled by whole pixels to the font size, whatever the
+// family. It only stands in for real glyphs so text shows up in headless output.
+#define ZKETCH_SOFTGDI
+
+namespace Gdiplus {
+
+	using REAL = float ;
+	using ARGB = uint32_t ;
+	using PixelFormat = INT ;
+
+	enum Status {
+		Ok = 0,
+		GenericError = 1,
+		InvalidParameter = 2,
+		OutOfMemory = 3,
+		NotImplemented = 6
+	} ;
+
+	enum Unit { UnitWorld, UnitDisplay, UnitPixel, UnitPoint } ;
+	enum FlushIntention { FlushIntentionFlush, FlushIntentionSync } ;
+	enum CompositingMode { CompositingModeSourceOver, CompositingModeSourceCopy } ;
+	enum CompositingQuality { CompositingQualityDefault, CompositingQualityHighSpeed, CompositingQualityHighQuality } ;
+	enum SmoothingMode { SmoothingModeDefault, SmoothingModeHighSpeed, SmoothingModeHighQuality, SmoothingModeNone, SmoothingModeAntiAlias } ;
+	enum PixelOffsetMode { PixelOffsetModeDefault, PixelOffsetModeHighSpeed, PixelOffsetModeHighQuality, PixelOffsetModeNone, PixelOffsetModeHalf } ;
+	enum TextRenderingHint { TextRenderingHintSystemDefault, TextRenderingHintSingleBitPerPixelGridFit, TextRenderingHintSingleBitPerPixel, TextRenderingHintAntiAliasGridFit, TextRenderingHintAntiAlias } ;
+	enum StringAlignment { StringAlignmentNear, StringAlignmentCenter, StringAlignmentFar } ;
+	enum FontStyle { FontStyleRegular = 0, FontStyleBold = 1, FontStyleItalic = 2, FontStyleBoldItalic = 3 } ;
+
+	enum InterpolationMode {
+		InterpolationModeDefault, InterpolationModeLowQuality, InterpolationModeHighQuality, InterpolationModeBilinear,
+		InterpolationModeBicubic, InterpolationModeNearestNeighbor, InterpolationModeHighQualityBilinear, InterpolationModeHighQualityBicubic
+	} ;
+
+	struct Point {
+		INT X = 0, Y = 0 ;
+		Point() = default ;
+		Point(INT x, INT y) noexcept : X(x), Y(y) {}
+	} ;
+
+	struct PointF {
+		REAL X = 0.0f, Y = 0.0f ;
+		PointF() = default ;
+		PointF(REAL x, REAL y) noexcept : X(x), Y(y) {}
+	} ;
+
+	struct Rect {
+		INT X = 0, Y = 0, Width = 0, Height = 0 ;
+		Rect() = default ;
+		Rect(INT x, INT y, INT w, INT h) noexcept : X(x), Y(y), Width(w), Height(h) {}
+	} ;
+
+	struct RectF {
+		REAL X = 0.0f, Y = 0.0f, Width = 0.0f, Height = 0.0f ;
+		RectF() = default ;
+		RectF(REAL x, REAL y, REAL w, REAL h) noexcept : X(x), Y(y), Width(w), Height(h) {}
+	} ;
+
+	class Color {
+	private :
+		ARGB argb_ = 0xFF000000u ;
+
+	public :
+		Color() = default ;
+		Color(ARGB argb) noexcept : argb_(argb) {}
+		Color(BYTE a, BYTE r, BYTE g, BYTE b) noexcept : argb_((ARGB(a) << 24) | (ARGB(r) << 16) | (ARGB(g) << 8) | b) {}
+
+		ARGB GetValue() const noexcept { return argb_ ; }
+		BYTE GetA() const noexcept { return static_cast<BYTE>(argb_ >> 24) ; }
+		BYTE GetR() const noexcept { return static_cast<BYTE>(argb_ >> 16) ; }
+		BYTE GetG() const noexcept { return static_cast<BYTE>(argb_ >> 8) ; }
+		BYTE GetB() const noexcept { return static_cast<BYTE>(argb_) ; }
+	} ;
+
+	class Brush {
+	protected :
+		Color color_ ;
+		explicit Brush(const Color& color) noexcept : color_(color) {}
+
+	public :
+		Color GetColor() const noexcept { return color_ ; }
+	} ;
+
+	class SolidBrush : public Brush {
+	public :
+		explicit SolidBrush(const Color& color) noexcept : Brush(color) {}
+	} ;
+
+	class Pen {
+	private :
+		Color color_ ;
+		REAL width_ ;
+
+	public :
+		Pen(const Color& color, REAL width = 1.0f) noexcept : color_(color), width_(width) {}
+
+		Color GetColor() const noexcept { return color_ ; }
+		REAL GetWidth() const noexcept { return width_ ; }
+	} ;
+
+	class Font {
+	private :
+		std::wstring family_ ;
+		REAL size_ ;
+		INT style_ ;
+
+	public :
+		Font(const wchar_t* family, REAL size, INT style = FontStyleRegular, Unit = UnitPoint) : family_(family ? family : L""), size_(size), style_(style) {}
+
+		REAL GetSize() const noexcept { return size_ ; }
+		INT GetStyle() const noexcept { return style_ ; }
+	} ;
+
+	class StringFormat {
+	private :
+		StringAlignment align_ = StringAlignmentNear ;
+		StringAlignment line_align_ = StringAlignmentNear ;
+
+	public :
+		Status SetAlignment(StringAlignment align) noexcept { align_ = align ; return Ok ; }
+		Status SetLineAlignment(StringAlignment align) noexcept { line_align_ = align ; return Ok ; }
+		StringAlignment GetAlignment() const noexcept { return align_ ; }
+		StringAlignment GetLineAlignment() const noexcept { return line_align_ ; }
+	} ;
+
+	// glyphs of ' ' to '~', a byte per column with the top row in bit 0. Cells are 6x9 with the spacing.
+	static constexpr BYTE ___GLYPHS___[95][5] = {
+		{0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+		{0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00},
+		{0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+		{0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+		{0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33},
+		{0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+		{0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00}, {0x00, 0x40, 0x34, 0x00, 0x00},
+		{0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14}, {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06},
+		{0x3E, 0x41, 0x5D, 0x59, 0x4E}, {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+		{0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x41, 0x51, 0x73},
+		{0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+		{0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+		{0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x26, 0x49, 0x49, 0x49, 0x32},
+		{0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+		{0x63, 0x14, 0x08, 0x14, 0x63}, {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+		{0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+		{0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40}, {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28},
+		{0x38, 0x44, 0x44, 0x28, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0xA4, 0x7C},
+		{0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+		{0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78}, {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+		{0xFC, 0x24, 0x24, 0x24, 0x18}, {0x18, 0x24, 0x24, 0x24, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+		{0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+		{0x44, 0x28, 0x10, 0x28, 0x44}, {0x1C, 0xA0, 0xA0, 0xA0, 0x7C}, {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+		{0x00, 0x00, 0x77, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02}
+	} ;
+
+	static constexpr INT ___GLYPH_ADVANCE___ = 6 ;
+	static constexpr INT ___GLYPH_LINE___ = 9 ;
+
+	// whole pixels per glyph pixel at a font size, sizes under a line draw at 1.
+	inline REAL GlyphScale(REAL size) noexcept {
+		return std::max(1.0f, std::floor(size / static_cast<REAL>(___GLYPH_LINE___))) ;
+	}
+
+	// the box DrawString fills for text at size, from the top left of its layout rect.
+	inline RectF MeasureGlyphs(const wchar_t* text, INT length, REAL size) noexcept {
+		const size_t count = !text ? 0 : length < 0 ? std::wcslen(text) : static_cast<size_t>(length) ;
+		size_t lines = 1 ;
+		size_t widest = 0 ;
+		size_t column = 0 ;
+		for (size_t i = 0 ; i < count ; ++i) {
+			if (text[i] == L'\n') {
+				++lines ;
+				column = 0 ;
+			} else if (text[i] != L'\r') {
+				widest = std::max(widest, ++column) ;
+			}
+		}
+
+		const REAL scale = GlyphScale(size) ;
+		return {0.0f, 0.0f, static_cast<REAL>(widest * ___GLYPH_ADVANCE___) * scale, static_cast<REAL>(lines * ___GLYPH_LINE___) * scale} ;
+	}
+
+	// figures flattened into polylines as they are added, arcs in steps of about two pixels.
+	class GraphicsPath {
+		friend class Graphics ;
+
+	private :
+		struct Figure {
+			std::vector<PointF> points_ ;
+			bool closed_ = false ;
+		} ;
+
+		std::vector<Figure> figures_ ;
+
+		Figure& Open() {
+			if (figures_.empty() || figures_.back().closed_) {
+				figures_.emplace_back() ;
+			}
+			return figures_.back() ;
+		}
+
+	public :
+		// angles in degrees, clockwise from the x axis like GDI+.
+		Status AddArc(REAL x, REAL y, REAL width, REAL height, REAL start, REAL sweep) noexcept {
+			try {
+				Figure& figure = Open() ;
+				const REAL rx = width * 0.5f ;
+				const REAL ry = height * 0.5f ;
+				const REAL a0 = start * 3.14159265f / 180.0f ;
+				const REAL da = sweep * 3.14159265f / 180.0f ;
+				const int32_t steps = std::clamp(static_cast<int32_t>(std::ceil(std::abs(da) * std::max(rx, ry) * 0.5f)), 1, 256) ;
+				for (int32_t i = 0 ; i <= steps ; ++i) {
+					const REAL a = a0 + da * static_cast<REAL>(i) / static_cast<REAL>(steps) ;
+					figure.points_.emplace_back(x + rx + rx * std::cos(a), y + ry + ry * std::sin(a)) ;
+				}
+				return Ok ;
+			} catch (...) {
+				return OutOfMemory ;
+			}
+		}
+
+		Status CloseFigure() noexcept {
+			if (!figures_.empty()) {
+				figures_.back().closed_ = true ;
+			}
+			return Ok ;
+		}
+	} ;
+
+	class Bitmap {
+		friend class Graphics ;
+
+	private :
+		BYTE* scan0_ ;
+		INT width_ ;
+		INT height_ ;
+		INT stride_ ;
+		PixelFormat format_ ;
+		Status status_ = Ok ;
+
+	public :
+		Bitmap(INT width, INT height, INT stride, PixelFormat format, BYTE* scan0) noexcept ;
+
+		Status GetLastStatus() const noexcept { return status_ ; }
+		UINT GetWidth() const noexcept { return static_cast<UINT>(width_) ; }
+		UINT GetHeight() const noexcept { return static_cast<UINT>(height_) ; }
+	} ;
+}
+
+inline constexpr Gdiplus::PixelFormat PixelFormat16bppRGB565 = 0x00021005 ;
+inline constexpr Gdiplus::PixelFormat PixelFormat32bppRGB = 0x00022009 ;
+inline constexpr Gdiplus::PixelFormat PixelFormat32bppARGB = 0x0026200A ;
+
+namespace Gdiplus {
+
+	inline Bitmap::Bitmap(INT width, INT height, INT stride, PixelFormat format, BYTE* scan0) noexcept
+	: scan0_(scan0), width_(width), height_(height), stride_(stride), format_(format) {
+		const INT bpp = format == PixelFormat16bppRGB565 ? 2 : 4 ;
+		if (format != PixelFormat32bppARGB && format != PixelFormat32bppRGB && format != PixelFormat16bppRGB565) {
+			status_ = NotImplemented ;
+		} else if (!scan0 || width <= 0 || height <= 0 || stride < width * bpp) {
+			status_ = InvalidParameter ;
+		}
+	}
+
+	class Graphics {
+	private :
+		struct Edge {
+			REAL x0_, y0_, x1_, y1_ ;
+			int32_t winding_ ;
+		} ;
+
+		Bitmap* target_ ;
+		Status status_ = Ok ;
+		CompositingMode mode_ = CompositingModeSourceOver ;
+		Rect clip_ {} ;		// device pixels, already inside the bitmap
+		REAL dx_ = 0.0f ;
+		REAL dy_ = 0.0f ;
+		std::vector<Edge> edges_ ;
+		std::vector<std::pair<REAL, int32_t>> crossings_ ;
+
+		Rect Bounds() const noexcept { return {0, 0, target_->width_, target_->height_} ; }
+
+		// writes color over pixels [x0, x1) of row y, the caller clipped them.
+		void Span(INT y, INT x0, INT x1, ARGB color) noexcept {
+			BYTE* row = target_->scan0_ + static_cast<size_t>(y) * static_cast<size_t>(target_->stride_) ;
+			const bool copy = mode_ == CompositingModeSourceCopy || (color >> 24) == 255 ;
+			if (target_->format_ == PixelFormat16bppRGB565) {
+				uint16_t* px = reinterpret_cast<uint16_t*>(row) ;
+				const uint16_t packed = zketch::pixel::Pack565(color) ;
+				for (INT x = x0 ; x < x1 ; ++x) {
+					px[x] = copy ? packed : zketch::pixel::Pack565(zketch::pixel::OverOpaque(color, zketch::pixel::Expand565(px[x]))) ;
+				}
+				return ;
+			}
+
+			uint32_t* px = reinterpret_cast<uint32_t*>(row) ;
+			if (target_->format_ == PixelFormat32bppRGB) {
+				for (INT x = x0 ; x < x1 ; ++x) {
+					px[x] = copy ? color | 0xFF000000u : zketch::pixel::OverOpaque(color, px[x] | 0xFF000000u) ;
+				}
+				return ;
+			}
+
+			if (copy) {
+				std::fill(px + x0, px + x1, color) ;
+				return ;
+			}
+			for (INT x = x0 ; x < x1 ; ++x) {
+				px[x] = zketch::pixel::Over(color, px[x]) ;
+			}
+		}
+
+		// pixels whose centers fall inside [x0, x1) x [y0, y1), device coordinates.
+		void FillBox(REAL x0, REAL y0, REAL x1, REAL y1, ARGB color) noexcept {
+			const INT px0 = std::max(clip_.X, static_cast<INT>(std::ceil(x0 - 0.5f))) ;
+			const INT py0 = std::max(clip_.Y, static_cast<INT>(std::ceil(y0 - 0.5f))) ;
+			const INT px1 = std::min(clip_.X + clip_.Width, static_cast<INT>(std::ceil(x1 - 0.5f))) ;
+			const INT py1 = std::min(clip_.Y + clip_.Height, static_cast<INT>(std::ceil(y1 - 0.5f))) ;
+			for (INT y = py0 ; y < py1 ; ++y) {
+				Span(y, px0, std::max(px0, px1), color) ;
+			}
+		}
+
+		// every polygon is wound the same way, so nonzero filling of overlapping ones is their union.
+		void AddPolygon(const PointF* points, size_t count) {
+			REAL area = 0.0f ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				const PointF& a = points[i] ;
+				const PointF& b = points[(i + 1) % count] ;
+				area += a.X * b.Y - b.X * a.Y ;
+			}
+
+			const int32_t sign = area < 0.0f ? -1 : 1 ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				const PointF& a = points[i] ;
+				const PointF& b = points[(i + 1) % count] ;
+				if (a.Y != b.Y) {
+					edges_.push_back({a.X + dx_, a.Y + dy_, b.X + dx_, b.Y + dy_, (a.Y < b.Y ? 1 : -1) * sign}) ;
+				}
+			}
+		}
+
+		// a quad around segment a-b and a disc around b, both width wide.
+		void AddStroke(const PointF& a, const PointF& b, REAL width) {
+			const REAL half = std::max(width, 1.0f) * 0.5f ;
+			const REAL ex = b.X - a.X ;
+			const REAL ey = b.Y - a.Y ;
+			const REAL length = std::sqrt(ex * ex + ey * ey) ;
+			if (length > 0.0f) {
+				const REAL nx = -ey / length * half ;
+				const REAL ny = ex / length * half ;
+				const PointF quad[4] = {{a.X + nx, a.Y + ny}, {b.X + nx, b.Y + ny}, {b.X - nx, b.Y - ny}, {a.X - nx, a.Y - ny}} ;
+				AddPolygon(quad, 4) ;
+			}
+
+			if (half > 1.0f) {
+				PointF disc[12] ;
+				for (int32_t i = 0 ; i < 12 ; ++i) {
+					const REAL angle = static_cast<REAL>(i) * 3.14159265f / 6.0f ;
+					disc[i] = {b.X + half * std::cos(angle), b.Y + half * std::sin(angle)} ;
+				}
+				AddPolygon(disc, 12) ;
+			}
+		}
+
+		void AddStrokes(const PointF* points, size_t count, bool closed, REAL width) {
+			for (size_t i = 0 ; i + 1 < count ; ++i) {
+				AddStroke(points[i], points[i + 1], width) ;
+			}
+			if (closed && count > 1) {
+				AddStroke(points[count - 1], points[0], width) ;
+			}
+		}
+
+		// scanline fill of the collected edges, nonzero winding or alternate (even odd).
+		void FillEdges(ARGB color, bool nonzero) noexcept {
+			if (edges_.empty()) {
+				return ;
+			}
+
+			REAL top = edges_[0].y0_, bottom = edges_[0].y0_ ;
+			for (const Edge& e : edges_) {
+				top = std::min({top, e.y0_, e.y1_}) ;
+				bottom = std::max({bottom, e.y0_, e.y1_}) ;
+			}
+
+			const INT y0 = std::max(clip_.Y, static_cast<INT>(std::ceil(top - 0.5f))) ;
+			const INT y1 = std::min(clip_.Y + clip_.Height, static_cast<INT>(std::ceil(bottom - 0.5f))) ;
+			for (INT y = y0 ; y < y1 ; ++y) {
+				const REAL center = static_cast<REAL>(y) + 0.5f ;
+				crossings_.clear() ;
+				for (const Edge& e : edges_) {
+					const REAL ey0 = std::min(e.y0_, e.y1_) ;
+					const REAL ey1 = std::max(e.y0_, e.y1_) ;
+					if (center >= ey0 && center < ey1) {
+						crossings_.emplace_back(e.x0_ + (center - e.y0_) * (e.x1_ - e.x0_) / (e.y1_ - e.y0_), e.winding_) ;
+					}
+				}
+				std::sort(crossings_.begin(), crossings_.end(), [](const auto& a, const auto& b) { return a.first < b.first ; }) ;
+
+				int32_t winding = 0 ;
+				for (size_t i = 0 ; i + 1 < crossings_.size() ; ++i) {
+					winding += nonzero ? crossings_[i].second : 1 ;
+					if (nonzero ? winding == 0 : (winding & 1) == 0) {
+						continue ;
+					}
+
+					const INT x0 = std::max(clip_.X, static_cast<INT>(std::ceil(crossings_[i].first - 0.5f))) ;
+					const INT x1 = std::min(clip_.X + clip_.Width, static_cast<INT>(std::ceil(crossings_[i + 1].first - 0.5f))) ;
+					if (x0 < x1) {
+						Span(y, x0, x1, color) ;
+					}
+				}
+			}
+		}
+
+		template <typename F>
+		Status Rasterize(ARGB color, bool nonzero, F&& collect) noexcept {
+			if (status_ != Ok) {
+				return status_ ;
+			}
+
+			edges_.clear() ;
+			try {
+				collect() ;
+			} catch (...) {
+				edges_.clear() ;
+				return OutOfMemory ;
+			}
+			FillEdges(color, nonzero) ;
+			edges_.clear() ;
+			return Ok ;
+		}
+
+		static void Ellipse(REAL x, REAL y, REAL w, REAL h, std::vector<PointF>& out) {
+			GraphicsPath path ;
+			path.AddArc(x, y, w, h, 0.0f, 360.0f) ;
+			out = std::move(path.figures_[0].points_) ;
+			out.pop_back() ;
+		}
+
+	public :
+		explicit Graphics(Bitmap* target) noexcept : target_(target) {
+			if (!target || target->GetLastStatus() != Ok) {
+				status_ = InvalidParameter ;
+				return ;
+			}
+			clip_ = Bounds() ;
+		}
+
+		Graphics(const Graphics&) = delete ;
+		Graphics& operator=(const Graphics&) = delete ;
+
+		Status GetLastStatus() const noexcept { return status_ ; }
+
+		// drawing is immediate, there is nothing queued to flush.
+		Status Flush(FlushIntention = FlushIntentionFlush) noexcept { return status_ ; }
+
+		Status SetCompositingMode(CompositingMode mode) noexcept { mode_ = mode ; return Ok ; }
+		CompositingMode GetCompositingMode() const noexcept { return mode_ ; }
+
+		// quality settings have nothing to pick from here.
+		Status SetCompositingQuality(CompositingQuality) noexcept { return Ok ; }
+		Status SetSmoothingMode(SmoothingMode) noexcept { return Ok ; }
+		Status SetInterpolationMode(InterpolationMode) noexcept { return Ok ; }
+		Status SetPixelOffsetMode(PixelOffsetMode) noexcept { return Ok ; }
+		Status SetTextRenderingHint(TextRenderingHint) noexcept { return Ok ; }
+
+		Status SetClip(const Rect& rect) noexcept {
+			if (status_ != Ok) {
+				return status_ ;
+			}
+
+			const Rect bounds = Bounds() ;
+			const INT x0 = std::max(bounds.X, rect.X + static_cast<INT>(dx_)) ;
+			const INT y0 = std::max(bounds.Y, rect.Y + static_cast<INT>(dy_)) ;
+			const INT x1 = std::min(bounds.Width, rect.X + static_cast<INT>(dx_) + rect.Width) ;
+			const INT y1 = std::min(bounds.Height, rect.Y + static_cast<INT>(dy_) + rect.Height) ;
+			clip_ = {x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)} ;
+			return Ok ;
+		}
+
+		Status ResetClip() noexcept {
+			if (status_ == Ok) {
+				clip_ = Bounds() ;
+			}
+			return status_ ;
+		}
+
+		Status TranslateTransform(REAL dx, REAL dy) noexcept {
+			dx_ += dx ;
+			dy_ += dy ;
+			return Ok ;
+		}
+
+		Status ResetTransform() noexcept {
+			dx_ = 0.0f ;
+			dy_ = 0.0f ;
+			return Ok ;
+		}
+
+		// replaces every pixel of the clip, whatever the compositing mode.
+		Status Clear(const Color& color) noexcept {
+			if (status_ != Ok) {
+				return status_ ;
+			}
+
+			const CompositingMode mode = mode_ ;
+			mode_ = CompositingModeSourceCopy ;
+			for (INT y = clip_.Y ; y < clip_.Y + clip_.Height ; ++y) {
+				Span(y, clip_.X, clip_.X + clip_.Width, color.GetValue()) ;
+			}
+			mode_ = mode ;
+			return Ok ;
+		}
+
+		Status FillRectangle(const Brush* brush, const RectF& rect) noexcept {
+			if (status_ != Ok || !brush) {
+				return status_ != Ok ? status_ : InvalidParameter ;
+			}
+
+			FillBox(rect.X + dx_, rect.Y + dy_, rect.X + rect.Width + dx_, rect.Y + rect.Height + dy_, brush->GetColor().GetValue()) ;
+			return Ok ;
+		}
+
+		Status FillRectangle(const Brush* brush, const Rect& rect) noexcept {
+			return FillRectangle(brush, RectF(static_cast<REAL>(rect.X), static_cast<REAL>(rect.Y), static_cast<REAL>(rect.Width), static_cast<REAL>(rect.Height))) ;
+		}
+
+		Status DrawRectangle(const Pen* pen, const RectF& rect) noexcept {
+			if (!pen) {
+				return InvalidParameter ;
+			}
+
+			const PointF corners[4] = {{rect.X, rect.Y}, {rect.X + rect.Width, rect.Y}, {rect.X + rect.Width, rect.Y + rect.Height}, {rect.X, rect.Y + rect.Height}} ;
+			return DrawPolygon(pen, corners, 4) ;
+		}
+
+		Status FillPolygon(const Brush* brush, const PointF* points, INT count) noexcept {
+			if (!brush || !points || count < 3) {
+				return InvalidParameter ;
+			}
+
+			return Rasterize(brush->GetColor().GetValue(), false, [&] { AddPolygon(points, static_cast<size_t>(count)) ; }) ;
+		}
+
+		Status DrawPolygon(const Pen* pen, const PointF* points, INT count) noexcept {
+			if (!pen || !points || count < 2) {
+				return InvalidParameter ;
+			}
+
+			return Rasterize(pen->GetColor().GetValue(), true, [&] { AddStrokes(points, static_cast<size_t>(count), true, pen->GetWidth()) ; }) ;
+		}
+
+		Status DrawLine(const Pen* pen, REAL x0, REAL y0, REAL x1, REAL y1) noexcept {
+			if (!pen) {
+				return InvalidParameter ;
+			}
+
+			const PointF ends[2] = {{x0, y0}, {x1, y1}} ;
+			return Rasterize(pen->GetColor().GetValue(), true, [&] { AddStrokes(ends, 2, false, pen->GetWidth()) ; }) ;
+		}
+
+		Status DrawLine(const Pen* pen, INT x0, INT y0, INT x1, INT y1) noexcept {
+			return DrawLine(pen, static_cast<REAL>(x0), static_cast<REAL>(y0), static_cast<REAL>(x1), static_cast<REAL>(y1)) ;
+		}
+
+		Status FillPath(const Brush* brush, const GraphicsPath* path) noexcept {
+			if (!brush || !path) {
+				return InvalidParameter ;
+			}
+
+			return Rasterize(brush->GetColor().GetValue(), false, [&] {
+				for (const auto& figure : path->figures_) {
+					AddPolygon(figure.points_.data(), figure.points_.size()) ;
+				}
+			}) ;
+		}
+
+		Status DrawPath(const Pen* pen, const GraphicsPath* path) noexcept {
+			if (!pen || !path) {
+				return InvalidParameter ;
+			}
+
+			return Rasterize(pen->GetColor().GetValue(), true, [&] {
+				for (const auto& figure : path->figures_) {
+					AddStrokes(figure.points_.data(), figure.points_.size(), figure.closed_, pen->GetWidth()) ;
+				}
+			}) ;
+		}
+
+		Status FillEllipse(const Brush* brush, REAL x, REAL y, REAL width, REAL height) noexcept {
+			if (!brush) {
+				return InvalidParameter ;
+			}
+
+			std::vector<PointF> points ;
+			return Rasterize(brush->GetColor().GetValue(), false, [&] {
+				Ellipse(x, y, width, height, points) ;
+				AddPolygon(points.data(), points.size()) ;
+			}) ;
+		}
+
+		Status DrawEllipse(const Pen* pen, const RectF& rect) noexcept {
+			if (!pen) {
+				return InvalidParameter ;
+			}
+
+			std::vector<PointF> points ;
+			return Rasterize(pen->GetColor().GetValue(), true, [&] {
+				Ellipse(rect.X, rect.Y, rect.Width, rect.Height, points) ;
+				AddStrokes(points.data(), points.size(), true, pen->GetWidth()) ;
+			}) ;
+		}
+
+		// lines of ___GLYPHS___ placed in layout by the format's alignments and clipped to it. Bold
+		// smears each column into the next one, characters outside the table draw as '?'.
+		Status DrawString(const wchar_t* text, INT length, const Font* font, const RectF& layout, const StringFormat* format, const Brush* brush) noexcept {
+			if (status_ != Ok) {
+				return status_ ;
+			}
+
+			if (!text || !font || !brush) {
+				return InvalidParameter ;
+			}
+
+			const size_t count = length < 0 ? std::wcslen(text) : static_cast<size_t>(length) ;
+			const REAL scale = GlyphScale(font->GetSize()) ;
+			const bool bold = (font->GetStyle() & FontStyleBold) != 0 ;
+			const ARGB color = brush->GetColor().GetValue() ;
+			const StringAlignment align = format ? format->GetAlignment() : StringAlignmentNear ;
+			const StringAlignment line_align = format ? format->GetLineAlignment() : StringAlignmentNear ;
+
+			auto offset = [](StringAlignment alignment, REAL room, REAL used) noexcept {
+				return alignment == StringAlignmentCenter ? (room - used) * 0.5f : alignment == StringAlignmentFar ? room - used : 0.0f ;
+			} ;
+
+			const REAL right = layout.X + layout.Width ;
+			const REAL bottom = layout.Y + layout.Height ;
+			REAL y = layout.Y + offset(line_align, layout.Height, MeasureGlyphs(text, static_cast<INT>(count), font->GetSize()).Height) ;
+			for (size_t start = 0 ; start <= count ; y += ___GLYPH_LINE___ * scale) {
+				size_t end = start ;
+				while (end < count && text[end] != L'\n') {
+					++end ;
+				}
+
+				REAL x = layout.X + offset(align, layout.Width, MeasureGlyphs(text + start, static_cast<INT>(end - start), font->GetSize()).Width) ;
+				for (size_t i = start ; i < end ; ++i) {
+					if (text[i] == L'\r') {
+						continue ;
+					}
+
+					const BYTE* glyph = ___GLYPHS___[text[i] >= L' ' && text[i] <= L'~' ? text[i] - L' ' : L'?' - L' '] ;
+					for (INT c = 0 ; c < 6 ; ++c) {
+						const uint32_t bits = (c < 5 ? glyph[c] : 0u) | (bold && c > 0 ? glyph[c - 1] : 0u) ;
+						for (INT r = 0 ; r < 8 ; ++r) {
+							if (!((bits >> r) & 1)) {
+								continue ;
+							}
+
+							const REAL x0 = std::max(layout.X, x + static_cast<REAL>(c) * scale) ;
+							const REAL y0 = std::max(layout.Y, y + static_cast<REAL>(r) * scale) ;
+							const REAL x1 = std::min(right, x + static_cast<REAL>(c + 1) * scale) ;
+							const REAL y1 = std::min(bottom, y + static_cast<REAL>(r + 1) * scale) ;
+							if (x0 < x1 && y0 < y1) {
+								FillBox(x0 + dx_, y0 + dy_, x1 + dx_, y1 + dy_, color) ;
+							}
+						}
+					}
+					x += ___GLYPH_ADVANCE___ * scale ;
+				}
+				start = end + 1 ;
+			}
+			return Ok ;
+		}
+	} ;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "canvas.hpp"
+
+namespace zketch {
+
+	// fingerprints whatever a widget draws besides its size and state, chained through seed.
+	template <typename T>
+	inline uint64_t HashValue(const T& value, uint64_t seed = 0) noexcept {
+		static_assert(std::is_trivially_copyable_v<T>) ;
+		return codec::Hash64(&value, sizeof(T), seed) ;
+	}
+
+	struct SurfaceKey {
+		Size size_ {} ;
+		uint32_t state_ = 0 ;
+		uint64_t skin_ = 0 ;
+		uint64_t content_ = 0 ;
+
+		bool operator==(const SurfaceKey& o) const noexcept {
+			return size_ == o.size_ && state_ == o.state_ && skin_ == o.skin_ && content_ == o.content_ ;
+		}
+	} ;
+
+	struct SurfaceKeyHash {
+		size_t operator()(const SurfaceKey& key) const noexcept {
+			uint64_t h = HashValue(key.size_.x) ;
+			h = HashValue(key.size_.y, h) ;
+			h = HashValue(key.state_, h) ;
+			h = HashValue(key.skin_, h) ;
+			return static_cast<size_t>(HashValue(key.content_, h)) ;
+		}
+	} ;
+
+	// rasterized widget surfaces shared by key. A widget whose key is already cached takes a
+	// copy-on-write reference instead of drawing, so identical widgets hold a single bitmap.
+	class SurfaceCache {
+	private :
+		static inline std::unordered_map<SurfaceKey, Canvas, SurfaceKeyHash> g_surfaces_ ;
+		static inline std::mutex g_mutex_ ;
+		static inline size_t g_budget_ = 32u << 20 ;
+		static inline size_t g_bytes_ = 0 ;
+		static inline uint64_t g_hits_ = 0 ;
+		static inline uint64_t g_misses_ = 0 ;
+		static inline std::atomic<uint64_t> g_next_skin_ {1} ;
+
+		// drops the entries nobody but the cache references anymore, caller holds the lock
+		static void TrimLocked() noexcept {
+			for (auto it = g_surfaces_.begin() ; it != g_surfaces_.end() && g_bytes_ > g_budget_ ; ) {
+				if (it->second.GetShareCount() == 1) {
+					g_bytes_ -= it->second.GetByteSize() ;
+					it = g_surfaces_.erase(it) ;
+				} else {
+					++it ;
+				}
+			}
+		}
+
+	public :
+		// unique skin id for a custom drawing logic, 0 means "never share".
+		static uint64_t NewSkin() noexcept { return g_next_skin_.fetch_add(1, std::memory_order_relaxed) ; }
+
+		static bool Find(const SurfaceKey& key, Canvas& out) noexcept {
+			std::lock_guard<std::mutex> lock(g_mutex_) ;
+			auto it = g_surfaces_.find(key) ;
+			if (it == g_surfaces_.end()) {
+				++g_misses_ ;
+				return false ;
+			}
+
+			++g_hits_ ;
+			out = it->second ;
+			out.MarkInvalidate() ;
+			return true ;
+		}
+
+		static void Store(const SurfaceKey& key, const Canvas& surface) noexcept {
+			if (!surface.IsValid()) {
+				return ;
+			}
+
+			std::lock_guard<std::mutex> lock(g_mutex_) ;
+			try {
+				auto [it, inserted] = g_surfaces_.try_emplace(key, surface) ;
+				if (!inserted) {
+					g_bytes_ -= it->second.GetByteSize() ;
+					it->second = surface ;
+				}
+				g_bytes_ += surface.GetByteSize() ;
+			} catch (...) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("SurfaceCache::Store - Failed to insert surface.") ;
+				#endif
+
+				return ;
+			}
+
+			if (g_bytes_ > g_budget_) {
+				TrimLocked() ;
+			}
+		}
+
+		static void Trim() noexcept {
+			std::lock_guard<std::mutex> lock(g_mutex_) ;
+			TrimLocked() ;
+		}
+
+		static void Clear() noexcept {
+			std::lock_guard<std::mutex> lock(g_mutex_) ;
+			g_surfaces_.clear() ;
+			g_bytes_ = 0 ;
+		}
+
+		// entries still referenced by a widget are kept even past the budget.
+		static void SetBudget(size_t bytes) noexcept {
+			std::lock_guard<std::mutex> lock(g_mutex_) ;
+			g_budget_ = bytes ;
+			TrimLocked() ;
+		}
+
+		static size_t GetBytes() noexcept { std::lock_guard<std::mutex> lock(g_mutex_) ; return g_bytes_ ; }
+		static size_t GetCount() noexcept { std::lock_guard<std::mutex> lock(g_mutex_) ; return g_surfaces_.size() ; }
+		static uint64_t GetHits() noexcept { std::lock_guard<std::mutex> lock(g_mutex_) ; return g_hits_ ; }
+		static uint64_t GetMisses() noexcept { std::lock_guard<std::mutex> lock(g_mutex_) ; return g_misses_ ; }
+	} ;
+}
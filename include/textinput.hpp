@@ -8,11 +8,10 @@ namespace zketch {
 
 	private :
 		uint16_t cursor_interval_ = 500 ;
-		uint32_t cursor_timer_ = 0 ;
+		TimerHandle cursor_timer_ {} ;	// blinks the caret while active
 		bool cursor_visible_ = false ;
 		bool is_active_ = false ;
 		bool is_hovered_ = false ;
-		std::chrono::steady_clock::time_point last_update_ ;
 		size_t cursor_index_ = 0 ;
 		PointF text_offset_ = {} ;
 		std::wstring text_ ;
@@ -32,6 +31,28 @@ namespace zketch {
 			drawing_logic_(canvas_.get(), *this) ;
 		}
 
+		static void OnBlink(TimerHandle, void* self) noexcept {
+			InputBox* input = static_cast<InputBox*>(self) ;
+			input->cursor_visible_ = !input->cursor_visible_ ;
+			input->update_ = true ;
+		}
+
+		// shows the caret and starts its blink over, typing keeps it steady.
+		void RestartBlink() noexcept {
+			cursor_visible_ = true ;
+			EventSystem::RemoveTimer(cursor_timer_) ;
+			if (is_active_) {
+				const auto interval = std::chrono::milliseconds(cursor_interval_) ;
+				cursor_timer_ = EventSystem::AddTimer(interval, &InputBox::OnBlink, this, interval) ;
+			}
+		}
+
+		void StopBlink() noexcept {
+			cursor_visible_ = false ;
+			EventSystem::RemoveTimer(cursor_timer_) ;
+			cursor_timer_ = {} ;
+		}
+
 		void AutoScrollToCursor() noexcept {
 			if (text_.empty() || cursor_index_ == 0) {
 				text_offset_.x = 0 ;
@@ -148,8 +169,10 @@ namespace zketch {
 
                 render.End() ;
 			}) ;
+		}
 
-			last_update_ = std::chrono::steady_clock::now() ;
+		~InputBox() noexcept {
+			EventSystem::RemoveTimer(cursor_timer_) ;
 		}
 
 		// common method
@@ -193,8 +216,7 @@ namespace zketch {
 				}
 				
 				// Reset cursor blink
-				cursor_visible_ = true ;
-				cursor_timer_ = 0 ;
+				RestartBlink() ;
 				update_ = true ;
 				
 				return true ;
@@ -202,7 +224,7 @@ namespace zketch {
 				// Clicked outside - deactivate
 				if (was_active) {
 					is_active_ = false ;
-					cursor_visible_ = false ;
+					StopBlink() ;
 					update_ = true ;
 				}
 				return false ;
@@ -213,29 +235,28 @@ namespace zketch {
 			return !bound_.Contain(mouse_pos) ;
 		}
 
+		// the caret blinks on an EventSystem timer fired while polling, nothing is left to do per
+		// frame. Kept for loops that call it: it only starts or stops the timer when it is out of step.
 		void UpdateCursor() noexcept {
 			if (!is_active_) {
+				if (cursor_timer_) {
+					StopBlink() ;
+				}
 				cursor_visible_ = false ;
 				return ;
 			}
 
-			auto now = std::chrono::steady_clock::now() ;
-			auto delta_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update_).count() ;
-			cursor_timer_ += delta_time_ms ;
-			if (cursor_timer_ >= cursor_interval_) {
-				cursor_visible_ = !cursor_visible_ ;
-				cursor_timer_ = 0 ;
+			if (!EventSystem::IsTimerActive(cursor_timer_)) {
+				RestartBlink() ;
 				update_ = true ;
 			}
-			last_update_ = now ;
 		}
 
 		void MoveCursorNext() noexcept { 
 			if (cursor_index_ < text_.size()) {
 				++cursor_index_ ;
 				AutoScrollToCursor() ;
-				cursor_visible_ = true ;
-				cursor_timer_ = 0 ;
+				RestartBlink() ;
 				update_ = true ;
 			}
 		}
@@ -244,8 +265,7 @@ namespace zketch {
 			if (cursor_index_ > 0) {
 				--cursor_index_ ;
 				AutoScrollToCursor() ;
-				cursor_visible_ = true ;
-				cursor_timer_ = 0 ;
+				RestartBlink() ;
 				update_ = true ;
 			}
 		}
@@ -253,16 +273,14 @@ namespace zketch {
 		void MoveCursorToStart() noexcept {
 			cursor_index_ = 0 ;
 			AutoScrollToCursor() ;
-			cursor_visible_ = true ;
-			cursor_timer_ = 0 ;
+			RestartBlink() ;
 			update_ = true ;
 		}
 
 		void MoveCursorToEnd() noexcept {
 			cursor_index_ = text_.size() ;
 			AutoScrollToCursor() ;
-			cursor_visible_ = true ;
-			cursor_timer_ = 0 ;
+			RestartBlink() ;
 			update_ = true ;
 		}
 
@@ -270,8 +288,7 @@ namespace zketch {
 			text_.insert(text_.begin() + cursor_index_, c) ;
 			++cursor_index_ ;
 			AutoScrollToCursor() ;
-			cursor_visible_ = true ;
-			cursor_timer_ = 0 ;
+			RestartBlink() ;
 			update_ = true ;
 		}
 
@@ -280,8 +297,7 @@ namespace zketch {
 				text_.erase(cursor_index_ - 1, 1) ;
 				--cursor_index_ ;
 				AutoScrollToCursor() ;
-				cursor_visible_ = true ;
-				cursor_timer_ = 0 ;
+				RestartBlink() ;
 				update_ = true ;
 			}
 		}
@@ -290,8 +306,7 @@ namespace zketch {
 			if (cursor_index_ < text_.size()) {
 				text_.erase(cursor_index_, 1) ;
 				AutoScrollToCursor() ;
-				cursor_visible_ = true ;
-				cursor_timer_ = 0 ;
+				RestartBlink() ;
 				update_ = true ;
 			}
 		}
@@ -300,14 +315,13 @@ namespace zketch {
 			text_.clear() ;
 			cursor_index_ = 0 ;
 			text_offset_.x = 0 ;
-			cursor_visible_ = true ;
-			cursor_timer_ = 0 ;
+			RestartBlink() ;
 			update_ = true ;
 		}
 
 		void Submit() noexcept {
 			is_active_ = false ;
-			cursor_visible_ = false ;
+			StopBlink() ;
 			update_ = true ;
 			
 			if (callback_) {
@@ -331,6 +345,9 @@ namespace zketch {
 
 		void SetCursorInterval(uint32_t ms) noexcept { 
 			cursor_interval_ = ms ; 
+			if (cursor_timer_) {
+				RestartBlink() ;
+			}
 			update_ = true ;
 		}
 
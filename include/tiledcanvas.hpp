@@ -0,0 +1,246 @@
+#pragma once
+#include "canvas.hpp"
+
+namespace zketch {
+
+	// large logical surface split into fixed tiles, a tile is only allocated once a Renderer
+	// primitive touches it. Untouched area reads as the background color.
+	class TiledCanvas {
+		friend class Renderer ;
+
+	public :
+		static constexpr uint32_t ___TILE_SIZE___ = 256 ;
+
+	private :
+		static constexpr uint64_t ___NO_TILE___ = UINT64_MAX ;
+
+		struct Tile {
+			Canvas canvas_ {} ;
+			std::unique_ptr<Gdiplus::Graphics> gfx_ {} ;
+			std::list<uint64_t>::iterator use_ {} ;	// its key in lru_
+			bool dirty_ = false ;	// holds drawing the redraw callback can't reproduce
+		} ;
+
+		std::unordered_map<uint64_t, Tile> tiles_ ;
+		std::list<uint64_t> lru_ ;	// keys of every tile, most recently used first
+		std::function<void(Renderer&, const Rect&)> redraw_ ;
+		Size size_ {} ;
+		ColorFormat format_ = ColorFormat::ARGB ;
+		Color background_ = Transparent ;
+		size_t budget_ = 0 ;
+		size_t bytes_ = 0 ;
+		uint64_t pinned_ = ___NO_TILE___ ;	// being read while drawing may evict, never evicted
+		uint64_t evicted_ = 0 ;
+		uint64_t regenerated_ = 0 ;
+		bool regenerating_ = false ;
+
+		static constexpr uint64_t KeyOf(uint32_t tx, uint32_t ty) noexcept { return (static_cast<uint64_t>(ty) << 32) | tx ; }
+
+		Rect GetTileBound(uint32_t tx, uint32_t ty) const noexcept {
+			const int32_t x = static_cast<int32_t>(tx * ___TILE_SIZE___) ;
+			const int32_t y = static_cast<int32_t>(ty * ___TILE_SIZE___) ;
+			return {x, y, std::min<int32_t>(___TILE_SIZE___, static_cast<int32_t>(size_.x) - x), std::min<int32_t>(___TILE_SIZE___, static_cast<int32_t>(size_.y) - y)} ;
+		}
+
+		Tile* FindTile(uint32_t tx, uint32_t ty) noexcept {
+			auto it = tiles_.find(KeyOf(tx, ty)) ;
+			if (it == tiles_.end()) {
+				return nullptr ;
+			}
+
+			lru_.splice(lru_.begin(), lru_, it->second.use_) ;
+			return &it->second ;
+		}
+
+		// fresh is set when the tile was just allocated and still has to be filled with the background.
+		Tile* AcquireTile(uint32_t tx, uint32_t ty, bool& fresh) noexcept {
+			fresh = false ;
+			if (Tile* tile = FindTile(tx, ty)) {
+				return tile ;
+			}
+
+			Rect bound = GetTileBound(tx, ty) ;
+			Size size {static_cast<uint32_t>(bound.w), static_cast<uint32_t>(bound.h)} ;
+			const size_t bytes = static_cast<size_t>(StrideOf(format_, size.x)) * size.y ;
+
+			if (budget_ != 0 && bytes_ + bytes > budget_) {
+				Evict(bytes_ + bytes - budget_) ;
+			}
+
+			Tile tile ;
+			if (!tile.canvas_.Create(size, format_)) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("TiledCanvas::AcquireTile - Failed to create tile [", tx, ", ", ty, "].") ;
+				#endif
+
+				return nullptr ;
+			}
+
+			try {
+				lru_.push_front(KeyOf(tx, ty)) ;
+			} catch (...) {
+				return nullptr ;
+			}
+
+			try {
+				auto [it, inserted] = tiles_.emplace(KeyOf(tx, ty), std::move(tile)) ;
+				it->second.use_ = lru_.begin() ;
+				bytes_ += bytes ;
+				fresh = true ;
+				return &it->second ;
+			} catch (...) {
+				lru_.pop_front() ;
+				return nullptr ;
+			}
+		}
+
+		// drops least recently used clean tiles that aren't bound to a Renderer or pinned, dirty tiles
+		// are never evicted. One walk from the cold end of lru_.
+		void Evict(size_t needed) noexcept {
+			size_t freed = 0 ;
+			for (auto use = lru_.end() ; freed < needed && use != lru_.begin() ; ) {
+				--use ;
+				auto it = tiles_.find(*use) ;
+				if (it->second.dirty_ || it->second.gfx_ || *use == pinned_) {
+					continue ;
+				}
+
+				const size_t bytes = it->second.canvas_.GetByteSize() ;
+				freed += bytes ;
+				bytes_ -= bytes ;
+				++evicted_ ;
+				tiles_.erase(it) ;
+				use = lru_.erase(use) ;
+			}
+		}
+
+		void Trim() noexcept {
+			if (budget_ != 0 && bytes_ > budget_) {
+				Evict(bytes_ - budget_) ;
+			}
+		}
+
+		// calls fn(tx, ty) for every tile overlapping bound.
+		template <typename F>
+		void ForEachTileIn(const Rect& bound, F&& fn) const noexcept {
+			const int32_t x0 = std::max(bound.x, 0) ;
+			const int32_t y0 = std::max(bound.y, 0) ;
+			const int32_t x1 = std::min(bound.x + static_cast<int32_t>(bound.w), static_cast<int32_t>(size_.x)) ;
+			const int32_t y1 = std::min(bound.y + static_cast<int32_t>(bound.h), static_cast<int32_t>(size_.y)) ;
+			if (x0 >= x1 || y0 >= y1) {
+				return ;
+			}
+
+			for (uint32_t ty = y0 / ___TILE_SIZE___ ; ty <= static_cast<uint32_t>(y1 - 1) / ___TILE_SIZE___ ; ++ty) {
+				for (uint32_t tx = x0 / ___TILE_SIZE___ ; tx <= static_cast<uint32_t>(x1 - 1) / ___TILE_SIZE___ ; ++tx) {
+					fn(tx, ty) ;
+				}
+			}
+		}
+
+		void Unbind() noexcept {
+			for (auto& [key, tile] : tiles_) {
+				if (tile.gfx_) {
+					tile.gfx_->Flush(Gdiplus::FlushIntentionSync) ;
+					tile.gfx_.reset() ;
+				}
+			}
+			Trim() ;
+		}
+
+	public :
+		TiledCanvas(const TiledCanvas&) = delete ;
+		TiledCanvas& operator=(const TiledCanvas&) = delete ;
+		TiledCanvas(TiledCanvas&&) = default ;
+		TiledCanvas& operator=(TiledCanvas&&) = default ;
+		TiledCanvas() = default ;
+		~TiledCanvas() = default ;
+
+		bool Create(const Size& size, ColorFormat format = ColorFormat::ARGB) noexcept {
+			Clear() ;
+
+			if (size.x == 0 || size.y == 0) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("TiledCanvas::Create - Invalid size.") ;
+				#endif
+
+				return false ;
+			}
+
+			if (format == ColorFormat::A8) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("TiledCanvas::Create - ColorFormat::A8 tiles aren't supported.") ;
+				#endif
+
+				return false ;
+			}
+
+			size_ = size ;
+			format_ = format ;
+			if (format_ == ColorFormat::XRGB && background_.GetA() != 255) {
+				background_ = Black ;	// what a zeroed XRGB tile shows
+			}
+			return true ;
+		}
+
+		// drops every tile, the whole canvas reads as the background again.
+		void Clear() noexcept {
+			tiles_.clear() ;
+			lru_.clear() ;
+			bytes_ = 0 ;
+		}
+
+		// what untouched tiles read as and new tiles start from. XRGB tiles have no alpha to show a
+		// translucent one with, false then and the background stays.
+		bool SetBackground(const Color& color) noexcept {
+			if (format_ == ColorFormat::XRGB && color.GetA() != 255) {
+
+				#ifdef CANVAS_DEBUG
+					logger::error("TiledCanvas::SetBackground - ColorFormat::XRGB tiles need an opaque background.") ;
+				#endif
+
+				return false ;
+			}
+
+			background_ = color ;
+			return true ;
+		}
+
+		// 0 means unlimited. Only clean tiles can be evicted to honour it.
+		void SetBudget(size_t bytes) noexcept {
+			budget_ = bytes ;
+			Trim() ;
+		}
+
+		// redraw(renderer, region) must reproduce the content of region, tiles it draws are clean
+		// and may be evicted, then regenerated the next time they are read.
+		void SetRedraw(std::function<void(Renderer&, const Rect&)> redraw) noexcept { redraw_ = std::move(redraw) ; }
+
+		// declares the current content reproducible by the redraw callback.
+		void MarkClean() noexcept {
+			for (auto& [key, tile] : tiles_) {
+				tile.dirty_ = false ;
+			}
+		}
+
+		const Canvas* GetTile(uint32_t tx, uint32_t ty) const noexcept {
+			auto it = tiles_.find(KeyOf(tx, ty)) ;
+			return it != tiles_.end() ? &it->second.canvas_ : nullptr ;
+		}
+
+		bool IsValid() const noexcept { return size_.x != 0 && size_.y != 0 ; }
+		Size GetSize() const noexcept { return size_ ; }
+		uint32_t GetWidth() const noexcept { return size_.x ; }
+		uint32_t GetHeight() const noexcept { return size_.y ; }
+		ColorFormat GetFormat() const noexcept { return format_ ; }
+		const Color& GetBackground() const noexcept { return background_ ; }
+		size_t GetTileCount() const noexcept { return tiles_.size() ; }
+		size_t GetByteSize() const noexcept { return bytes_ ; }
+		size_t GetBudget() const noexcept { return budget_ ; }
+		uint64_t GetEvictedCount() const noexcept { return evicted_ ; }
+		uint64_t GetRegeneratedCount() const noexcept { return regenerated_ ; }
+	} ;
+}
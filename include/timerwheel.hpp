@@ -0,0 +1,303 @@
+#pragma once
+#include "env.hpp"
+
+namespace zketch {
+
+	// names a timer of a TimerWheel until it is removed or a one-shot fires. A default one names nothing.
+	struct TimerHandle {
+		uint32_t slot_ = 0 ;
+		uint32_t generation_ = 0 ;	// 0 never names a timer
+
+		constexpr explicit operator bool() const noexcept { return generation_ != 0 ; }
+		constexpr bool operator==(const TimerHandle&) const noexcept = default ;
+	} ;
+
+	// hierarchical timing wheel with a millisecond tick: 6 levels of 64 slots, each slot a list of
+	// timers threaded through a slab. Adding and removing are O(1), advancing only visits the slots
+	// that hold something and one slot per level on a carry, timers far out move down a level at a
+	// time as their slot comes up. Timers fire at the first tick at or after their deadline.
+	//
+	// a timer calls back when fired, it may add and remove timers, itself included. Use it from one
+	// thread.
+	class TimerWheel {
+	public :
+		using Callback = void (*)(TimerHandle, void*) ;
+
+	private :
+		static constexpr uint32_t ___LEVELS___ = 6 ;
+		static constexpr uint32_t ___BITS___ = 6 ;
+		static constexpr uint32_t ___SLOTS___ = 1u << ___BITS___ ;
+		static constexpr uint64_t ___MAX_DELAY___ = (uint64_t(1) << (___LEVELS___ * ___BITS___)) - 1 ;	// ~795 days
+		static constexpr uint32_t ___NIL___ = UINT32_MAX ;
+		static constexpr uint16_t ___FIRING___ = 0xFFFE ;	// bucket_ of a timer taken off its slot to fire
+		static constexpr uint16_t ___FREE___ = 0xFFFF ;
+
+		struct Node {
+			uint64_t due_ ;			// tick
+			uint64_t interval_ ;	// ticks, 0 for a one-shot
+			Callback callback_ ;
+			void* user_ ;
+			uint32_t prev_ ;
+			uint32_t next_ ;
+			uint32_t generation_ ;
+			uint16_t bucket_ ;		// level * ___SLOTS___ + slot, ___FIRING___ or ___FREE___
+		} ;
+
+		std::vector<Node> nodes_ ;
+		std::vector<uint32_t> free_ ;
+		std::array<uint32_t, ___LEVELS___ * ___SLOTS___> heads_ ;
+		std::array<uint64_t, ___LEVELS___> occupied_ {} ;	// a bit per non empty slot
+		std::vector<uint32_t> firing_ ;
+		uint64_t now_ = 0 ;		// the last tick advanced to
+		uint64_t origin_ = 0 ;	// MonotonicTime of tick 0
+		size_t count_ = 0 ;
+		bool advancing_ = false ;
+
+		static constexpr uint32_t NextGeneration(uint32_t generation) noexcept {
+			return generation + 1 != 0 ? generation + 1 : 1 ;
+		}
+
+		static uint64_t Now() noexcept {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) ;
+		}
+
+		static uint64_t ToTicks(std::chrono::nanoseconds t) noexcept {
+			return std::min(static_cast<uint64_t>(std::max<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(t).count(), 0)), ___MAX_DELAY___) ;
+		}
+
+		uint64_t TickOf(uint64_t monotonic) const noexcept {
+			return monotonic > origin_ ? (monotonic - origin_) / 1000000 : 0 ;
+		}
+
+		// the level is the highest 6-bit digit where due and now differ, the slot that digit of due.
+		void Link(uint32_t n) noexcept {
+			Node& node = nodes_[n] ;
+			const uint64_t diff = node.due_ ^ now_ ;
+			const uint32_t level = diff ? std::min(static_cast<uint32_t>(std::bit_width(diff) - 1) / ___BITS___, ___LEVELS___ - 1) : 0 ;
+			const uint32_t slot = static_cast<uint32_t>(node.due_ >> (level * ___BITS___)) & (___SLOTS___ - 1) ;
+			const uint16_t bucket = static_cast<uint16_t>(level * ___SLOTS___ + slot) ;
+
+			node.bucket_ = bucket ;
+			node.prev_ = ___NIL___ ;
+			node.next_ = heads_[bucket] ;
+			if (node.next_ != ___NIL___) {
+				nodes_[node.next_].prev_ = n ;
+			}
+			heads_[bucket] = n ;
+			occupied_[level] |= uint64_t(1) << slot ;
+		}
+
+		void Unlink(uint32_t n) noexcept {
+			Node& node = nodes_[n] ;
+			if (node.prev_ != ___NIL___) {
+				nodes_[node.prev_].next_ = node.next_ ;
+			} else {
+				heads_[node.bucket_] = node.next_ ;
+				if (node.next_ == ___NIL___) {
+					occupied_[node.bucket_ / ___SLOTS___] &= ~(uint64_t(1) << (node.bucket_ % ___SLOTS___)) ;
+				}
+			}
+			if (node.next_ != ___NIL___) {
+				nodes_[node.next_].prev_ = node.prev_ ;
+			}
+		}
+
+		void Free(uint32_t n) noexcept {
+			Node& node = nodes_[n] ;
+			node.generation_ = NextGeneration(node.generation_) ;
+			node.bucket_ = ___FREE___ ;
+			node.callback_ = nullptr ;
+			--count_ ;
+			try {
+				free_.push_back(n) ;
+			} catch (...) {}	// the slot is lost, the handle is dead either way
+		}
+
+		// takes the whole list of a slot, the nodes keep their links among themselves.
+		uint32_t Detach(uint32_t level, uint32_t slot) noexcept {
+			const uint32_t bucket = level * ___SLOTS___ + slot ;
+			const uint32_t head = heads_[bucket] ;
+			heads_[bucket] = ___NIL___ ;
+			occupied_[level] &= ~(uint64_t(1) << slot) ;
+			return head ;
+		}
+
+		// moves the slot of level that now_ just reached down to the levels below.
+		void Cascade(uint32_t level) noexcept {
+			uint32_t n = Detach(level, static_cast<uint32_t>(now_ >> (level * ___BITS___)) & (___SLOTS___ - 1)) ;
+			while (n != ___NIL___) {
+				const uint32_t next = nodes_[n].next_ ;
+				Link(n) ;
+				n = next ;
+			}
+		}
+
+		void Fire() noexcept {
+			uint32_t n = Detach(0, static_cast<uint32_t>(now_) & (___SLOTS___ - 1)) ;
+			if (n == ___NIL___) {
+				return ;
+			}
+
+			firing_.clear() ;
+			while (n != ___NIL___) {
+				nodes_[n].bucket_ = ___FIRING___ ;
+				try {
+					firing_.push_back(n) ;
+				} catch (...) {
+					// out of memory, the rest waits for the next tick
+					nodes_[n].due_ = now_ + 1 ;
+					const uint32_t next = nodes_[n].next_ ;
+					Link(n) ;
+					n = next ;
+					continue ;
+				}
+				n = nodes_[n].next_ ;
+			}
+
+			for (size_t i = 0 ; i < firing_.size() ; ++i) {
+				const uint32_t f = firing_[i] ;
+				Node& node = nodes_[f] ;
+				if (node.bucket_ != ___FIRING___) {
+					continue ;	// removed by an earlier callback of this tick
+				}
+
+				const TimerHandle handle = {f, node.generation_} ;
+				const Callback callback = node.callback_ ;
+				void* user = node.user_ ;
+				if (node.interval_) {
+					// a repeating timer that fell behind skips the ticks it missed instead of bursting
+					node.due_ = std::max(node.due_ + node.interval_, now_ + 1) ;
+					Link(f) ;
+				} else {
+					Free(f) ;
+				}
+				callback(handle, user) ;
+			}
+		}
+
+	public :
+		TimerWheel() noexcept : origin_(Now()) {
+			heads_.fill(___NIL___) ;
+		}
+
+		TimerWheel(const TimerWheel&) = delete ;
+		TimerWheel& operator=(const TimerWheel&) = delete ;
+
+		// calls callback at the first Advance delay from now, then every interval when it isn't zero.
+		// Returns an empty handle when memory ran out.
+		TimerHandle Add(std::chrono::nanoseconds delay, Callback callback, void* user = nullptr, std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero()) noexcept {
+			if (!callback) {
+				return {} ;
+			}
+
+			uint32_t n ;
+			try {
+				if (free_.empty()) {
+					nodes_.push_back({0, 0, nullptr, nullptr, ___NIL___, ___NIL___, 0, ___FREE___}) ;
+					n = static_cast<uint32_t>(nodes_.size() - 1) ;
+				} else {
+					n = free_.back() ;
+					free_.pop_back() ;
+				}
+			} catch (...) {
+				return {} ;
+			}
+
+			// rounded up, a timer never fires early
+			const uint64_t now = Now() ;
+			const uint64_t elapsed = now > origin_ ? now - origin_ : 0 ;
+			const uint64_t wait = std::min(static_cast<uint64_t>(std::max<int64_t>(delay.count(), 0)), ___MAX_DELAY___ * 1000000) ;
+			const uint64_t due = (elapsed + wait + 999999) / 1000000 ;
+
+			Node& node = nodes_[n] ;
+			node.due_ = std::clamp(due, now_ + 1, now_ + ___MAX_DELAY___) ;
+			node.interval_ = ToTicks(interval) ;
+			node.callback_ = callback ;
+			node.user_ = user ;
+			node.generation_ = NextGeneration(node.generation_) ;
+			Link(n) ;
+
+			++count_ ;
+			return {n, node.generation_} ;
+		}
+
+		// false when handle already fired or was removed.
+		bool Remove(TimerHandle handle) noexcept {
+			if (!IsActive(handle)) {
+				return false ;
+			}
+
+			if (nodes_[handle.slot_].bucket_ != ___FIRING___) {
+				Unlink(handle.slot_) ;
+			}
+			Free(handle.slot_) ;
+			return true ;
+		}
+
+		bool IsActive(TimerHandle handle) const noexcept {
+			return handle && handle.slot_ < nodes_.size() && nodes_[handle.slot_].generation_ == handle.generation_ && nodes_[handle.slot_].bucket_ != ___FREE___ ;
+		}
+
+		// fires every timer due by monotonic, a MonotonicTime. Returns how many ticks passed, 0 when
+		// called from a timer's callback.
+		uint64_t Advance(uint64_t monotonic) noexcept {
+			if (advancing_) {
+				return 0 ;
+			}
+
+			advancing_ = true ;
+			const uint64_t target = TickOf(monotonic) ;
+			const uint64_t start = now_ ;
+			while (now_ < target) {
+				if (count_ == 0) {
+					now_ = target ;
+					break ;
+				}
+
+				// the next occupied slot of this lap of level 0, or the carry into the next lap
+				const uint32_t digit = static_cast<uint32_t>(now_) & (___SLOTS___ - 1) ;
+				const uint64_t ahead = digit + 1 < ___SLOTS___ ? occupied_[0] >> (digit + 1) << (digit + 1) : 0 ;
+				const uint64_t lap = now_ | (___SLOTS___ - 1) ;
+				uint64_t next = ahead ? (now_ & ~uint64_t(___SLOTS___ - 1)) + static_cast<uint64_t>(std::countr_zero(ahead)) : lap + 1 ;
+				if (next > target) {
+					now_ = target ;
+					break ;
+				}
+
+				// higher levels first, what they hand down may land in the slots below
+				now_ = next ;
+				for (uint32_t level = ___LEVELS___ - 1 ; level > 0 ; --level) {
+					if ((now_ & ((uint64_t(1) << (level * ___BITS___)) - 1)) == 0) {
+						Cascade(level) ;
+					}
+				}
+				Fire() ;
+			}
+
+			advancing_ = false ;
+			return now_ - start ;
+		}
+
+		// when the next timer may fire as a MonotonicTime, nullopt without timers. Never late, it can be
+		// early for timers on the upper levels: they only move down when their slot comes up.
+		std::optional<uint64_t> GetNextDeadline() const noexcept {
+			if (count_ == 0) {
+				return std::nullopt ;
+			}
+
+			for (uint32_t level = 0 ; level < ___LEVELS___ ; ++level) {
+				if (occupied_[level] == 0) {
+					continue ;
+				}
+
+				const uint32_t shift = level * ___BITS___ ;
+				const uint64_t slot = static_cast<uint64_t>(std::countr_zero(occupied_[level])) ;
+				const uint64_t tick = (now_ >> (shift + ___BITS___) << (shift + ___BITS___)) + (slot << shift) ;
+				return origin_ + std::max(tick, now_ + 1) * 1000000 ;
+			}
+			return origin_ + (now_ + 1) * 1000000 ;	// only timers taken off to fire, Advance is running
+		}
+
+		size_t GetCount() const noexcept { return count_ ; }
+	} ;
+}
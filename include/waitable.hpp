@@ -0,0 +1,272 @@
+#pragma once
+#include "platform.hpp"
+
+namespace zketch {
+
+	enum class WakeReason : uint8_t {
+		Timeout,
+		Signal,	// Notify() was called
+		Input	// the native queue has input (Win32 messages) or a watched source is ready
+	} ;
+
+	// what a WakeSignal can watch besides its own signal: fds on Linux, waitable handles on Win32.
+	#if defined(ZKETCH_WIN32)
+		using WaitSource = HANDLE ;
+	#else
+		using WaitSource = int ;
+	#endif
+
+	enum class SourceEvent : uint8_t {
+		None = 0,
+		Readable = 1,	// also a signaled Win32 handle
+		Writable = 2,
+		Hangup = 4		// peer closed or error, reported whatever was asked for
+	} ;
+
+	constexpr SourceEvent operator|(SourceEvent a, SourceEvent b) noexcept { return static_cast<SourceEvent>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b)) ; }
+	constexpr bool operator&(SourceEvent a, SourceEvent b) noexcept { return (static_cast<uint8_t>(a) & static_cast<uint8_t>(b)) != 0 ; }
+
+	// blocking wait that any thread can interrupt. Win32 waits on an event together with the message
+	// queue and watched handles, Linux on an eventfd and watched fds in one epoll set. Notify() only
+	// makes a syscall when someone is actually asleep.
+	class WakeSignal {
+	private :
+		std::atomic<bool> pending_ {false} ;
+		std::atomic<bool> waiting_ {false} ;
+
+		#if defined(ZKETCH_WIN32)
+			HANDLE event_ = nullptr ;
+			std::vector<HANDLE> handles_ ;	// event_ first, then watched handles
+			HANDLE fired_ = nullptr ;		// watched handle the last wait consumed, auto-reset ones stay reset
+		#elif defined(ZKETCH_LINUX)
+			int fd_ = -1 ;		// eventfd
+			int epoll_ = -1 ;	// fd_ and every watched fd
+
+			static uint32_t ToEpoll(SourceEvent events) noexcept {
+				return (events & SourceEvent::Readable ? EPOLLIN : 0u) | (events & SourceEvent::Writable ? EPOLLOUT : 0u) ;
+			}
+
+			static SourceEvent FromEpoll(uint32_t events) noexcept {
+				SourceEvent ready = SourceEvent::None ;
+				ready = events & EPOLLIN ? ready | SourceEvent::Readable : ready ;
+				ready = events & EPOLLOUT ? ready | SourceEvent::Writable : ready ;
+				ready = events & (EPOLLHUP | EPOLLERR) ? ready | SourceEvent::Hangup : ready ;
+				return ready ;
+			}
+		#else
+			std::mutex mutex_ ;
+			std::condition_variable cv_ ;
+		#endif
+
+		WakeReason WaitNative(std::optional<std::chrono::nanoseconds> timeout) noexcept {
+			#if defined(ZKETCH_WIN32)
+				DWORD ms = INFINITE ;
+				if (timeout) {
+					ms = static_cast<DWORD>(std::max<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(*timeout).count(), 0)) ;
+				}
+
+				const DWORD count = static_cast<DWORD>(handles_.size()) ;
+				DWORD result = MsgWaitForMultipleObjectsEx(count, handles_.data(), ms, QS_ALLINPUT, MWMO_INPUTAVAILABLE) ;
+				if (result == WAIT_OBJECT_0) {
+					return WakeReason::Signal ;
+				}
+
+				if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + count) {
+					fired_ = handles_[result - WAIT_OBJECT_0] ;
+					return WakeReason::Input ;
+				}
+				return result == WAIT_OBJECT_0 + count ? WakeReason::Input : WakeReason::Timeout ;
+			#elif defined(ZKETCH_LINUX)
+				// epoll counts in milliseconds, rounded up so a timer is never woken for early
+				int ms = -1 ;
+				if (timeout) {
+					ms = static_cast<int>(std::clamp<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(*timeout).count(), 0, std::numeric_limits<int>::max())) ;
+				}
+
+				epoll_event events[8] ;
+				const int result = epoll_wait(epoll_, events, 8, ms) ;
+				bool signal = false ;
+				bool input = false ;
+				for (int i = 0 ; i < result ; ++i) {
+					if (events[i].data.fd == fd_) {
+						uint64_t value ;
+						[[maybe_unused]] ssize_t n = read(fd_, &value, sizeof(value)) ;
+						signal = true ;
+					} else {
+						input = true ;
+					}
+				}
+
+				if (input) {
+					return WakeReason::Input ;
+				}
+				return signal ? WakeReason::Signal : WakeReason::Timeout ;
+			#else
+				std::unique_lock<std::mutex> lock(mutex_) ;
+				auto ready = [this] { return pending_.load() ; } ;
+				if (!timeout) {
+					cv_.wait(lock, ready) ;
+					return WakeReason::Signal ;
+				}
+				return cv_.wait_for(lock, *timeout, ready) ? WakeReason::Signal : WakeReason::Timeout ;
+			#endif
+		}
+
+	public :
+		WakeSignal(const WakeSignal&) = delete ;
+		WakeSignal& operator=(const WakeSignal&) = delete ;
+
+		WakeSignal() noexcept {
+			#if defined(ZKETCH_WIN32)
+				event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr) ;
+				try {
+					handles_.push_back(event_) ;
+				} catch (...) {}
+			#elif defined(ZKETCH_LINUX)
+				fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) ;
+				epoll_ = epoll_create1(EPOLL_CLOEXEC) ;
+				epoll_event event {} ;
+				event.events = EPOLLIN ;
+				event.data.fd = fd_ ;
+				epoll_ctl(epoll_, EPOLL_CTL_ADD, fd_, &event) ;
+			#endif
+		}
+
+		~WakeSignal() noexcept {
+			#if defined(ZKETCH_WIN32)
+				if (event_) {
+					CloseHandle(event_) ;
+				}
+			#elif defined(ZKETCH_LINUX)
+				if (epoll_ >= 0) {
+					close(epoll_) ;
+				}
+
+				if (fd_ >= 0) {
+					close(fd_) ;
+				}
+			#endif
+		}
+
+		// safe from any thread.
+		void Notify() noexcept {
+			pending_.store(true) ;
+			if (!waiting_.load()) {
+				return ;
+			}
+
+			#if defined(ZKETCH_WIN32)
+				SetEvent(event_) ;
+			#elif defined(ZKETCH_LINUX)
+				uint64_t one = 1 ;
+				[[maybe_unused]] ssize_t n = write(fd_, &one, sizeof(one)) ;
+			#else
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				cv_.notify_one() ;
+			#endif
+		}
+
+		// blocks until Notify(), native input or the timeout, nullopt waits forever.
+		WakeReason Wait(std::optional<std::chrono::nanoseconds> timeout = std::nullopt) noexcept {
+			waiting_.store(true) ;
+			if (pending_.exchange(false)) {
+				waiting_.store(false) ;
+				return WakeReason::Signal ;
+			}
+
+			WakeReason reason = WaitNative(timeout) ;
+			waiting_.store(false) ;
+
+			if (pending_.exchange(false)) {
+				return WakeReason::Signal ;
+			}
+			return reason == WakeReason::Signal ? WakeReason::Timeout : reason ;
+		}
+
+		// drops a Notify() nobody has waited for yet, for a loop about to handle whatever it announced.
+		void Clear() noexcept { pending_.store(false) ; }
+
+		bool IsPending() const noexcept { return pending_.load() ; }
+
+		#if defined(ZKETCH_WIN32)
+			HANDLE GetHandle() const noexcept { return event_ ; }
+
+			// a signaled handle wakes Wait() as WakeReason::Input. MsgWaitForMultipleObjectsEx takes
+			// MAXIMUM_WAIT_OBJECTS - 1 handles, event_ included. Belongs to the waiting thread.
+			bool AddWatch(WaitSource handle, SourceEvent = SourceEvent::Readable) noexcept {
+				if (handles_.size() >= MAXIMUM_WAIT_OBJECTS - 1 || std::find(handles_.begin(), handles_.end(), handle) != handles_.end()) {
+					return false ;
+				}
+
+				try {
+					handles_.push_back(handle) ;
+					return true ;
+				} catch (...) {
+					return false ;
+				}
+			}
+
+			void RemoveWatch(WaitSource handle) noexcept {
+				handles_.erase(std::remove(handles_.begin() + 1, handles_.end(), handle), handles_.end()) ;
+				fired_ = fired_ == handle ? nullptr : fired_ ;
+			}
+
+			// calls fn(handle, events) for every watched handle signaled now, without blocking.
+			template <typename F>
+			void ForEachReady(F&& fn) noexcept {
+				for (size_t i = 1 ; i < handles_.size() ; ++i) {
+					HANDLE handle = handles_[i] ;
+					const bool fired = handle == fired_ ;
+					if (fired) {
+						fired_ = nullptr ;
+					}
+
+					if (fired || WaitForSingleObject(handle, 0) == WAIT_OBJECT_0) {
+						fn(handle, SourceEvent::Readable) ;
+					}
+				}
+			}
+		#elif defined(ZKETCH_LINUX)
+			int GetFd() const noexcept { return fd_ ; }
+
+			// a ready fd wakes Wait() as WakeReason::Input, the Linux side of the Win32 message queue
+			// wait. Level triggered, whoever is woken has to drain it. Belongs to the waiting thread.
+			bool AddWatch(WaitSource fd, SourceEvent events = SourceEvent::Readable) noexcept {
+				epoll_event event {} ;
+				event.events = ToEpoll(events) ;
+				event.data.fd = fd ;
+				return epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) == 0 || (errno == EEXIST && epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &event) == 0) ;
+			}
+
+			// closing a watched fd drops it too, call this first all the same: the number gets reused.
+			void RemoveWatch(WaitSource fd) noexcept {
+				epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr) ;
+			}
+
+			// calls fn(fd, events) for every watched fd ready now, without blocking.
+			template <typename F>
+			void ForEachReady(F&& fn) noexcept {
+				epoll_event events[16] ;
+				const int count = epoll_wait(epoll_, events, 16, 0) ;
+				for (int i = 0 ; i < count ; ++i) {
+					if (events[i].data.fd != fd_) {
+						fn(events[i].data.fd, FromEpoll(events[i].events)) ;
+					}
+				}
+			}
+		#else
+			// nothing native to watch without a platform
+			bool AddWatch(WaitSource, SourceEvent = SourceEvent::Readable) noexcept { return false ; }
+			void RemoveWatch(WaitSource) noexcept {}
+
+			template <typename F>
+			void ForEachReady(F&&) noexcept {}
+		#endif
+	} ;
+
+	// the signal the main loop sleeps on, EventSystem pokes it whenever an event is pushed.
+	inline WakeSignal& GetMainWakeSignal() noexcept {
+		static WakeSignal signal ;
+		return signal ;
+	}
+}
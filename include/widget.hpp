@@ -1,34 +1,58 @@
-<<<<<<< HEAD
 #pragma once
 #include "renderer.hpp"
+#include "surfacecache.hpp"
+#include "residency.hpp"
 
 namespace zketch {
 	template <typename Derived>
-    class Widget {
+    class Widget : public ResidentSurface {
     protected:
         std::unique_ptr<Canvas> canvas_ ;
         RectF bound_ ;
         bool update_ = true ;
         bool visible_ = true ;
+		WidgetId id_ = 0 ;	// taken the first time an event names the widget
         
         bool IsValid() const noexcept {
             return canvas_ && canvas_->IsValid() ; 
         }
+
+		Canvas* GetResidentCanvas() noexcept override { return canvas_.get() ; }
         
     public:
         Widget() noexcept = default ;
-        virtual ~Widget() noexcept = default ;
+
+        virtual ~Widget() noexcept {
+			// events still queued for the widget resolve to null from here on
+			if (id_) {
+				WidgetRegistry::Release(WidgetRegistry::Resolve(id_)) ;
+			}
+		}
         
         void InvokeUpdate() noexcept { 
             if (update_ && visible_) {
                 static_cast<Derived*>(this)->UpdateImpl() ;
                 update_ = false ;
-            }
+            } else if (!visible_ && Residency::GetMode() != ReclaimMode::Keep) {
+				Reclaim(std::chrono::steady_clock::now()) ;
+			}
         }
         
+		// hidden canvases may be reclaimed by the Residency policy, showing the widget restores them
+		// and only redraws when the pixels were released.
         void SetVisible(bool visible) noexcept { 
+			if (visible == visible_) {
+				// showing a shown widget still asks for a redraw, as it always has
+				if (visible) {
+					update_ = true ;
+				}
+				return ;
+			}
+
             visible_ = visible ; 
-            if (visible) {
+            if (!visible) {
+				MarkHidden() ;
+			} else if (!MarkShown()) {
 				update_ = true ;
 			}
         }
@@ -58,85 +82,15 @@ namespace zketch {
 			return canvas_.get() ;
 		}
 
-		bool IsVisible() const noexcept { return visible_ ; }
-		bool IsUpdate() const noexcept { return update_ ; }
-    } ;
-=======
-#pragma once
-#include "renderer.hpp"
-#include "event.hpp"
-
-namespace zketch {
-	template <typename Derived>
-    class Widget {
-    protected:
-        std::unique_ptr<Canvas> canvas_ ;
-        RectF bound_ ;
-        bool needs_redraw_ = true ;
-        bool visible_ = true ;
-        
-        bool ValidateCanvas(const char* context) const noexcept {
-            if (!canvas_ || !canvas_->IsValid()) {
-                return false ;
-            }
-            return true ;
-        }
-        
-    public:
-        Widget() noexcept = default ;
-        virtual ~Widget() noexcept = default ;
-        
-        const RectF& GetBound() const noexcept { 
-			return bound_ ; 
-		}
-
-        const Canvas* GetCanvas() const noexcept { 
-			return canvas_.get() ; 
-		}
-        
-        void Update() noexcept { 
-            if (needs_redraw_ && visible_) {
-                static_cast<Derived*>(this)->UpdateImpl() ;
-                needs_redraw_ = false ;
-            }
-        }
-        
-        void Present(HWND hwnd) noexcept { 
-            if (!visible_) return ;
-            Update() ;
-            static_cast<Derived*>(this)->PresentImpl(hwnd) ;
-        }
-        
-        void MarkDirty() noexcept { 
-			needs_redraw_ = true ; 
-		}
-
-        bool NeedsRedraw() const noexcept { 
-			return needs_redraw_ ; 
-		}
-        
-        void SetVisible(bool visible) noexcept { 
-            visible_ = visible ; 
-            if (visible) MarkDirty() ;
-        }
-
-        bool IsVisible() const noexcept { 
-			return visible_ ; 
+		// what events of this widget carry instead of its address, 0 when the registry is full.
+		WidgetId GetWidgetId() noexcept {
+			if (!id_) {
+				id_ = WidgetRegistry::Acquire(static_cast<void*>(static_cast<Derived*>(this))) ;
+			}
+			return id_ ;
 		}
-        
-        void SetPosition(const PointF& pos) noexcept {
-            bound_.x = pos.x ;
-            bound_.y = pos.y ;
-            MarkDirty() ;
-        }
 
-		void SetClearColor(const Color& color) noexcept {
-			canvas_->SetClearColor(color) ;
-		}
+		bool IsVisible() const noexcept { return visible_ ; }
+		bool IsUpdate() const noexcept { return update_ ; }
     } ;
-
-	namespace Integration {
-	
-	}
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include "env.hpp"
+
+// the Win32 names the portable code is spelled with, for builds without windows.h. Values are the
+// Win32 ones, so key codes and window styles mean the same on every backend. Handles are opaque:
+// HWND only names a window, nothing here talks to a window system.
+
+typedef struct HWND__* HWND ;
+
+using BYTE = uint8_t ;
+using WORD = uint16_t ;
+using DWORD = uint32_t ;
+using UINT = unsigned int ;
+using INT = int ;
+using LONG = int32_t ;
+using ULONG_PTR = uintptr_t ;
+
+// ------------------------------ window class styles ------------------------------
+
+inline constexpr uint32_t CS_VREDRAW = 0x0001 ;
+inline constexpr uint32_t CS_HREDRAW = 0x0002 ;
+inline constexpr uint32_t CS_DBLCLKS = 0x0008 ;
+inline constexpr uint32_t CS_OWNDC = 0x0020 ;
+inline constexpr uint32_t CS_CLASSDC = 0x0040 ;
+inline constexpr uint32_t CS_PARENTDC = 0x0080 ;
+inline constexpr uint32_t CS_NOCLOSE = 0x0200 ;
+inline constexpr uint32_t CS_SAVEBITS = 0x0800 ;
+inline constexpr uint32_t CS_BYTEALIGNCLIENT = 0x1000 ;
+inline constexpr uint32_t CS_BYTEALIGNWINDOW = 0x2000 ;
+inline constexpr uint32_t CS_GLOBALCLASS = 0x4000 ;
+inline constexpr uint32_t CS_IME = 0x00010000 ;
+inline constexpr uint32_t CS_DROPSHADOW = 0x00020000 ;
+
+// ------------------------------ virtual keys ------------------------------
+
+inline constexpr uint32_t VK_BACK = 0x08 ;
+inline constexpr uint32_t VK_TAB = 0x09 ;
+inline constexpr uint32_t VK_RETURN = 0x0D ;
+inline constexpr uint32_t VK_SHIFT = 0x10 ;
+inline constexpr uint32_t VK_CONTROL = 0x11 ;
+inline constexpr uint32_t VK_MENU = 0x12 ;
+inline constexpr uint32_t VK_PAUSE = 0x13 ;
+inline constexpr uint32_t VK_CAPITAL = 0x14 ;
+inline constexpr uint32_t VK_ESCAPE = 0x1B ;
+inline constexpr uint32_t VK_SPACE = 0x20 ;
+inline constexpr uint32_t VK_PRIOR = 0x21 ;
+inline constexpr uint32_t VK_NEXT = 0x22 ;
+inline constexpr uint32_t VK_END = 0x23 ;
+inline constexpr uint32_t VK_HOME = 0x24 ;
+inline constexpr uint32_t VK_LEFT = 0x25 ;
+inline constexpr uint32_t VK_UP = 0x26 ;
+inline constexpr uint32_t VK_RIGHT = 0x27 ;
+inline constexpr uint32_t VK_DOWN = 0x28 ;
+inline constexpr uint32_t VK_SNAPSHOT = 0x2C ;
+inline constexpr uint32_t VK_INSERT = 0x2D ;
+inline constexpr uint32_t VK_DELETE = 0x2E ;
+inline constexpr uint32_t VK_LWIN = 0x5B ;
+inline constexpr uint32_t VK_RWIN = 0x5C ;
+inline constexpr uint32_t VK_NUMPAD0 = 0x60 ;
+inline constexpr uint32_t VK_NUMPAD1 = 0x61 ;
+inline constexpr uint32_t VK_NUMPAD2 = 0x62 ;
+inline constexpr uint32_t VK_NUMPAD3 = 0x63 ;
+inline constexpr uint32_t VK_NUMPAD4 = 0x64 ;
+inline constexpr uint32_t VK_NUMPAD5 = 0x65 ;
+inline constexpr uint32_t VK_NUMPAD6 = 0x66 ;
+inline constexpr uint32_t VK_NUMPAD7 = 0x67 ;
+inline constexpr uint32_t VK_NUMPAD8 = 0x68 ;
+inline constexpr uint32_t VK_NUMPAD9 = 0x69 ;
+inline constexpr uint32_t VK_MULTIPLY = 0x6A ;
+inline constexpr uint32_t VK_ADD = 0x6B ;
+inline constexpr uint32_t VK_SUBTRACT = 0x6D ;
+inline constexpr uint32_t VK_DECIMAL = 0x6E ;
+inline constexpr uint32_t VK_DIVIDE = 0x6F ;
+inline constexpr uint32_t VK_F1 = 0x70 ;
+inline constexpr uint32_t VK_SCROLL = 0x91 ;
+inline constexpr uint32_t VK_LSHIFT = 0xA0 ;
+inline constexpr uint32_t VK_RSHIFT = 0xA1 ;
+inline constexpr uint32_t VK_LCONTROL = 0xA2 ;
+inline constexpr uint32_t VK_RCONTROL = 0xA3 ;
+inline constexpr uint32_t VK_LMENU = 0xA4 ;
+inline constexpr uint32_t VK_RMENU = 0xA5 ;
+inline constexpr uint32_t VK_OEM_1 = 0xBA ;
+inline constexpr uint32_t VK_OEM_PLUS = 0xBB ;
+inline constexpr uint32_t VK_OEM_COMMA = 0xBC ;
+inline constexpr uint32_t VK_OEM_MINUS = 0xBD ;
+inline constexpr uint32_t VK_OEM_PERIOD = 0xBE ;
+inline constexpr uint32_t VK_OEM_2 = 0xBF ;
+inline constexpr uint32_t VK_OEM_3 = 0xC0 ;
+inline constexpr uint32_t VK_OEM_4 = 0xDB ;
+inline constexpr uint32_t VK_OEM_5 = 0xDC ;
+inline constexpr uint32_t VK_OEM_6 = 0xDD ;
+inline constexpr uint32_t VK_OEM_7 = 0xDE ;
+
+// ------------------------------ text conversion ------------------------------
+
+// UTF-8 to and from wchar_t (UTF-32 here), with the Win32 calling convention: a source length of
+// -1 includes the terminator, a null or empty destination asks for the size. Malformed bytes become
+// U+FFFD.
+inline constexpr UINT CP_UTF8 = 65001 ;
+
+inline int MultiByteToWideChar(UINT, DWORD, const char* src, int src_len, wchar_t* dst, int dst_len) noexcept {
+	if (!src) {
+		return 0 ;
+	}
+
+	const size_t size = src_len < 0 ? std::strlen(src) + 1 : static_cast<size_t>(src_len) ;
+	const auto* p = reinterpret_cast<const uint8_t*>(src) ;
+	const auto* end = p + size ;
+	int count = 0 ;
+	while (p < end) {
+		uint32_t c = *p++ ;
+		uint32_t extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0 ;
+		if (c >= 0x80 && c < 0xC0) {
+			c = 0xFFFD ;
+		} else if (extra) {
+			c &= 0x3F >> extra ;
+			for ( ; extra && p < end && (*p & 0xC0) == 0x80 ; --extra) {
+				c = (c << 6) | (*p++ & 0x3F) ;
+			}
+			c = extra ? 0xFFFD : c ;
+		}
+
+		if (dst && dst_len > 0) {
+			if (count == dst_len) {
+				return 0 ;
+			}
+			dst[count] = static_cast<wchar_t>(c) ;
+		}
+		++count ;
+	}
+	return count ;
+}
+
+inline int WideCharToMultiByte(UINT, DWORD, const wchar_t* src, int src_len, char* dst, int dst_len, const char*, int*) noexcept {
+	if (!src) {
+		return 0 ;
+	}
+
+	const size_t size = src_len < 0 ? std::char_traits<wchar_t>::length(src) + 1 : static_cast<size_t>(src_len) ;
+	int count = 0 ;
+	for (size_t i = 0 ; i < size ; ++i) {
+		uint32_t c = static_cast<uint32_t>(src[i]) ;
+		c = c > 0x10FFFF || (c >= 0xD800 && c < 0xE000) ? 0xFFFD : c ;
+
+		char bytes[4] ;
+		int n = 0 ;
+		if (c < 0x80) {
+			bytes[n++] = static_cast<char>(c) ;
+		} else if (c < 0x800) {
+			bytes[n++] = static_cast<char>(0xC0 | (c >> 6)) ;
+			bytes[n++] = static_cast<char>(0x80 | (c & 0x3F)) ;
+		} else if (c < 0x10000) {
+			bytes[n++] = static_cast<char>(0xE0 | (c >> 12)) ;
+			bytes[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F)) ;
+			bytes[n++] = static_cast<char>(0x80 | (c & 0x3F)) ;
+		} else {
+			bytes[n++] = static_cast<char>(0xF0 | (c >> 18)) ;
+			bytes[n++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F)) ;
+			bytes[n++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F)) ;
+			bytes[n++] = static_cast<char>(0x80 | (c & 0x3F)) ;
+		}
+
+		if (dst && dst_len > 0) {
+			if (count + n > dst_len) {
+				return 0 ;
+			}
+			std::memcpy(dst + count, bytes, static_cast<size_t>(n)) ;
+		}
+		count += n ;
+	}
+	return count ;
+}
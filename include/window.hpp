@@ -1,19 +1,29 @@
-<<<<<<< HEAD
 #pragma once
-#include "canvas.hpp"
-#include "event.hpp"
+#include "headless.hpp"
+#include "x11backend.hpp"
+#include "presenter.hpp"
+#include "recorder.hpp"
+#include "remote.hpp"
 
 namespace zketch {
 
-	inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
+	#ifdef ZKETCH_WIN32
+		inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
+	#endif
 
 	class Application {
-		friend inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
+		#ifdef ZKETCH_WIN32
+			friend inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
+		#endif
+
 		friend class Window ;
+		friend class WindowBackend ;
+		friend class WindowRenderPool ;
 
 	private :
 		static inline std::unordered_map<HWND, Window*> g_windows_ ;
 		static inline bool app_is_runing_ = true ;
+		static inline std::atomic<uint32_t> parallel_frames_ {0} ;	// WindowRenderPool::Render calls in flight
 
 		static void RegisterWindow(HWND hwnd, Window* window) noexcept {
 			if (hwnd && window) {
@@ -45,35 +55,31 @@ namespace zketch {
 				}
 			}
 		}
+
+		// what every backend reports, defined after Window.
+		static void OnResize(HWND hwnd, const Size& size) noexcept ;
+		static void OnClose(HWND hwnd) noexcept ;
+		static void OnDestroy(HWND hwnd) noexcept ;
+		static void OnExpose(HWND hwnd) noexcept ;
 	
 	public :
-		static void QuitProgram() noexcept {
-			std::vector<HWND> destroy_sequence ;
-			destroy_sequence.reserve(g_windows_.size()) ;
-			for (auto& w : g_windows_) {
-				destroy_sequence.push_back(w.first) ;
-			}
-
-			for (auto& w : destroy_sequence) {
-				if (IsWindow(w)) {
-					DestroyWindow(w) ;
-				}
-			}
-
-			g_windows_.clear() ;
-			app_is_runing_ = false ;
-			PostQuitMessage(0) ;
-
-			#ifdef APPLICATION_DEBUG
-				logger::info("Application::QuitProgram - PostQuitMessage done.") ;
-			#endif
-		}
+		static void QuitProgram() noexcept ;
 
 		static bool IsRunning() noexcept {
 			return app_is_runing_ ;
 		}
 
+		// workers read the font table while windows render in parallel, it can't be replaced then.
 		static bool LoadFonts() noexcept {
+			if (parallel_frames_.load(std::memory_order_acquire) != 0) {
+
+				#ifdef APPLICATION_DEBUG
+					logger::error("Application::LoadFonts - Windows are rendering in parallel, fonts can't be reloaded now.") ;
+				#endif
+
+				return false ;
+			}
+
 			auto fontMapOpt = ___FONT_DUMP___::__font_dump__::LoadFontsFromBin("fonts.bin") ;
 			
 			if (!fontMapOpt) {
@@ -141,79 +147,354 @@ namespace zketch {
 		}
 	} ;
 
-	namespace AppRegistry {
-		static inline HINSTANCE g_hinstance_ = GetModuleHandleW(nullptr) ;
-		static inline std::string g_window_class_name_ = "zketch_app" ;
-		static inline bool window_was_registered = false ;
+	#ifdef ZKETCH_WIN32
+		namespace AppRegistry {
+			static inline HINSTANCE g_hinstance_ = GetModuleHandleW(nullptr) ;
+			static inline std::string g_window_class_name_ = "zketch_app" ;
+			static inline bool window_was_registered = false ;
 
-		static void SetWindowClass(std::string&& windowclassname) noexcept {
-			if (window_was_registered) {
+			static void SetWindowClass(std::string&& windowclassname) noexcept {
+				if (window_was_registered) {
 
-				#ifdef APPREGISTRY_DEBUG
-					logger::warning("AppRegistry::SetWindowClass - Failed to register window class name, window class name was registered.") ;
-				#endif
+					#ifdef APPREGISTRY_DEBUG
+						logger::warning("AppRegistry::SetWindowClass - Failed to register window class name, window class name was registered.") ;
+					#endif
 
-				return ;
-			} 
-			g_window_class_name_ = std::move(windowclassname) ;
-		}
+					return ;
+				} 
+				g_window_class_name_ = std::move(windowclassname) ;
+			}
+
+			static void RegisterWindowClass() {
+				if (window_was_registered) {
+
+					#ifdef APPREGISTRY_DEBUG
+						logger::warning("AppRegistry::RegisterWindowClass - Failed to register window class name, window class name was registered.") ;
+					#endif
+
+					return ;
+				}
+
+				WNDCLASSEX wc = {
+					sizeof(wc),
+					CS_HREDRAW | CS_VREDRAW | CS_OWNDC,
+					wndproc,
+					0,
+					0,
+					AppRegistry::g_hinstance_,
+					LoadIcon(nullptr, IDI_APPLICATION),
+					LoadCursor(nullptr, IDC_ARROW),
+					nullptr,
+					nullptr,
+					AppRegistry::g_window_class_name_.c_str(),
+					LoadIcon(nullptr, IDI_APPLICATION)
+				} ;
 
-		static void RegisterWindowClass() {
-			if (window_was_registered) {
+				if (!RegisterClassEx(&wc)) {
+
+					#ifdef APPREGISTRY_DEBUG
+						logger::error("AppRegistry::RegisterWindowClass - Failed to register window class!") ;
+					#endif
+
+					return ;
+				}
 
 				#ifdef APPREGISTRY_DEBUG
-					logger::warning("AppRegistry::RegisterWindowClass - Failed to register window class name, window class name was registered.") ;
+					logger::info("AppRegistry::RegisterWindowClass - Successfully register window class.") ;
 				#endif
 
-				return ;
+				window_was_registered = true ;
 			}
+		} ;
 
-			WNDCLASSEX wc = {
-				sizeof(wc),
-				CS_HREDRAW | CS_VREDRAW | CS_OWNDC,
-				wndproc,
-				0,
-				0,
-				AppRegistry::g_hinstance_,
-				LoadIcon(nullptr, IDI_APPLICATION),
-				LoadCursor(nullptr, IDC_ARROW),
-				nullptr,
-				nullptr,
-				AppRegistry::g_window_class_name_.c_str(),
-				LoadIcon(nullptr, IDI_APPLICATION)
-			} ;
+		// native Win32 window, frames are blitted through GDI+.
+		class Win32Backend : public WindowBackend {
+		private :
+			HWND handle_ = nullptr ;
 
-			if (!RegisterClassEx(&wc)) {
+		public :
+			Win32Backend(const char* title, int32_t xpos, int32_t ypos, int32_t width, int32_t height) noexcept {
+				handle_ = CreateWindowEx(
+					0,
+					AppRegistry::g_window_class_name_.c_str(),
+					title,
+					WS_OVERLAPPEDWINDOW,
+					xpos,
+					ypos,
+					width,
+					height,
+					nullptr,
+					nullptr,
+					AppRegistry::g_hinstance_,
+					nullptr
+				) ;
+			}
 
-				#ifdef APPREGISTRY_DEBUG
-					logger::error("AppRegistry::RegisterWindowClass - Failed to register window class!") ;
-				#endif
+			~Win32Backend() noexcept override {
+				Destroy() ;
+			}
 
-				return ;
+			HWND GetHandle() const noexcept override { return handle_ ; }
+
+			Rect GetClientBound() const noexcept override {
+				tagRECT r ;
+				GetClientRect(handle_, &r) ;
+				return static_cast<Rect>(r) ;
 			}
 
-			#ifdef APPREGISTRY_DEBUG
-				logger::info("AppRegistry::RegisterWindowClass - Successfully register window class.") ;
-			#endif
+			Rect GetWindowBound() const noexcept override {
+				tagRECT r ;
+				GetWindowRect(handle_, &r) ;
+				return static_cast<Rect>(r) ; 
+			}
 
-			window_was_registered = true ;
-		}
+			void Show() noexcept override {
+				if (handle_) {
+					ShowWindow(handle_, SW_SHOWDEFAULT) ;
+					UpdateWindow(handle_) ;
+				}
+			}
+
+			void Hide() noexcept override {
+				if (handle_) {
+					ShowWindow(handle_, SW_HIDE) ; 
+				}
+			}
+
+			void Minimize() noexcept override { 
+				if (handle_) {
+					ShowWindow(handle_, SW_MINIMIZE) ; 
+				}
+			}
+
+			void Maximize() noexcept override { 
+				if (handle_) {
+					ShowWindow(handle_, SW_MAXIMIZE) ; 
+				}
+			}
+
+			void Restore() noexcept override { 
+				if (handle_) {
+					ShowWindow(handle_, SW_RESTORE) ; 
+				}
+			}
+
+			void SetTitle(const char* title) noexcept override {
+				if (handle_) {
+					SetWindowText(handle_, title) ;
+				}
+			}
+
+			void Present(const Canvas& frame, const DamageList& damage) noexcept override {
+				HDC hdc = GetDC(handle_) ;
+				if (!hdc) {
+
+					#ifdef WINDOW_DEBUG
+						logger::warning("Win32Backend::Present - Invalid HDC!") ;
+					#endif
+					
+					return ;
+				}
+
+				Gdiplus::Graphics screen(hdc) ;
+				if (screen.GetLastStatus() != Gdiplus::Ok) {
+
+					#ifdef WINDOW_DEBUG
+						logger::error("Win32Backend::Present - Graphics creation failed");
+					#endif
+
+					ReleaseDC(handle_, hdc);
+					return;
+				}
+
+				screen.SetCompositingMode(Gdiplus::CompositingModeSourceCopy) ;
+				screen.SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
+				screen.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor) ;
+				for (const Rect& r : damage) {
+					auto status = screen.DrawImage(frame.GetBitmap(), r.x, r.y, r.x, r.y, static_cast<INT>(r.w), static_cast<INT>(r.h), Gdiplus::UnitPixel) ;
+
+					if (status != Gdiplus::Ok) {
+
+						#ifdef WINDOW_DEBUG
+							logger::error("Win32Backend::Present - DrawImage failed: ", static_cast<int>(status));
+						#endif
+
+						break ;
+					}
+				}
+
+				ReleaseDC(handle_, hdc) ;
+			}
+
+			// WM_DESTROY reports the destruction through wndproc.
+			void Destroy() noexcept override {
+				if (handle_ && IsWindow(handle_)) {
+					DestroyWindow(handle_) ;
+				}
+				handle_ = nullptr ;
+			}
+		} ;
+
+		using NativeBackend = Win32Backend ;
+	#elif defined(ZKETCH_X11)
+		using NativeBackend = X11Backend ;
+	#else
+		// no native windowing on this platform, windows run headless.
+		using NativeBackend = HeadlessBackend ;
+	#endif
+
+	struct ResizeStats {
+		uint64_t requests_ = 0 ;		// sizes reported by the backend
+		uint64_t reallocations_ = 0 ;	// times the window canvases were actually recreated
 	} ;
 
 	class Window {
-		friend inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
+		#ifdef ZKETCH_WIN32
+			friend inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
+		#endif
+
+		friend class Application ;
 		friend class Renderer ;
 
 	private :
+		static constexpr uint64_t ___DAMAGE_HISTORY___ = 4 ;
+		static constexpr std::chrono::milliseconds ___RESIZE_SETTLE___ {150} ;
+
+		// a drag-resize reports many sizes per frame, only the latest one is kept and the canvases
+		// are recreated for it when the next frame begins.
+		struct ResizeState {
+			std::optional<Size> pending_ ;
+			std::chrono::steady_clock::time_point last_ {} ;	// when the last size came in
+			ResizeStats stats_ ;
+			bool reduce_quality_ = false ;
+			bool reduced_frame_ = false ;	// the last frame was drawn at reduced quality
+		} ;
+
+		// what changed in the last few frames, used to bring a reused back buffer up to date
+		// (buffer age) instead of copying or redrawing it whole.
+		struct FrameDamage {
+			DamageList drawn_ ;				// touched in the back buffer this frame
+			DamageList unpresented_ ;		// synchronous present: not pushed to the output yet
+			std::array<DamageList, ___DAMAGE_HISTORY___> history_ ;	// damage of frame f at f % ___DAMAGE_HISTORY___
+			std::array<std::pair<const Canvas*, uint64_t>, 3> stamps_ {} ;	// which frame each buffer holds
+			const Canvas* last_frame_ = nullptr ;
+			uint64_t frame_ = 0 ;
+			bool forward_pending_ = false ;
+		} ;
+
+		std::unique_ptr<WindowBackend> backend_ ;
 		HWND handle_ = nullptr ;
 		std::unique_ptr<Canvas> front_buffer_ ;
 		std::unique_ptr<Canvas> back_buffer_ ;
+		std::unique_ptr<PresentThread> presenter_ ;	// owns the front buffer while presenting asynchronously
+		std::unique_ptr<PresentCounters> counters_ = std::make_unique<PresentCounters>() ;
+		FrameRecorder* recorder_ = nullptr ;
+		FramebufferServer* server_ = nullptr ;
+		LatencyTracer* tracer_ = nullptr ;
+		FrameDamage damage_ ;
+		ResizeState resize_ ;
+		std::thread::id owner_ = std::this_thread::get_id() ;	// presents only happen here
 		WindowState state_ = WindowState::None ;
 		bool close_requested_ = false ;
 
+		uint64_t GetStamp(const Canvas* buffer) const noexcept {
+			for (const auto& [canvas, frame] : damage_.stamps_) {
+				if (canvas == buffer) {
+					return frame ;
+				}
+			}
+			return 0 ;
+		}
+
+		void SetStamp(const Canvas* buffer, uint64_t frame) noexcept {
+			auto* slot = &damage_.stamps_[0] ;
+			for (auto& stamp : damage_.stamps_) {
+				if (stamp.first == buffer) {
+					slot = &stamp ;
+					break ;
+				}
+				if (stamp.second < slot->second) {
+					slot = &stamp ;
+				}
+			}
+			*slot = {buffer, frame} ;
+		}
+
+		// Renderer::Begin, the back buffer may be a few frames behind the last finished one.
+		void BeginFrame() noexcept {
+			damage_.drawn_.Clear() ;
+			damage_.forward_pending_ = damage_.last_frame_ && damage_.last_frame_ != back_buffer_.get() ;
+		}
+
+		// copies whatever changed since the back buffer's frame from the last finished frame. Deferred
+		// to the first primitive so frames starting with a full Clear never pay for it.
+		void ForwardBackBuffer() noexcept {
+			damage_.forward_pending_ = false ;
+
+			const Canvas* src = damage_.last_frame_ ;
+			Canvas* dst = back_buffer_.get() ;
+			if (!src || !dst || src->GetSize() != dst->GetSize() || src->GetFormat() != dst->GetFormat()) {
+				return ;
+			}
+
+			const Size size = dst->GetSize() ;
+			const uint64_t stamp = GetStamp(dst) ;
+			DamageList stale ;
+			if (stamp == 0 || damage_.frame_ - stamp > ___DAMAGE_HISTORY___) {
+				stale.SetAll(size) ;
+			} else {
+				for (uint64_t f = stamp + 1 ; f <= damage_.frame_ ; ++f) {
+					stale.Add(damage_.history_[f % ___DAMAGE_HISTORY___], size) ;
+				}
+			}
+
+			// the writable GetPixels detaches and bumps the version, once for the whole copy
+			uint8_t* to = dst->GetPixels() ;
+			const uint8_t* from = src->GetPixels() ;
+			if (!to || !from) {
+				return ;
+			}
+
+			const uint32_t bpp = BytesPerPixel(dst->GetFormat()) ;
+			const size_t to_stride = dst->GetStride() ;
+			const size_t from_stride = src->GetStride() ;
+			for (const Rect& r : stale) {
+				const size_t bytes = static_cast<size_t>(r.w) * bpp ;
+				uint8_t* out = to + static_cast<size_t>(r.y) * to_stride + static_cast<size_t>(r.x) * bpp ;
+				const uint8_t* in = from + static_cast<size_t>(r.y) * from_stride + static_cast<size_t>(r.x) * bpp ;
+				for (uint32_t y = 0 ; y < r.h ; ++y, out += to_stride, in += from_stride) {
+					std::memcpy(out, in, bytes) ;
+				}
+			}
+		}
+
+		void AddDamage(const Rect& rect) noexcept {
+			if (damage_.forward_pending_) {
+				ForwardBackBuffer() ;
+			}
+			damage_.drawn_.Add(rect, back_buffer_->GetSize()) ;
+		}
+
+		// the whole back buffer gets replaced, nothing needs to be carried forward.
+		void DamageAll() noexcept {
+			damage_.forward_pending_ = false ;
+			damage_.drawn_.SetAll(back_buffer_->GetSize()) ;
+		}
+
+		// the output lost its content (WM_PAINT), the last finished frame goes out in full right away:
+		// a loop idle in WaitEvent or FrameScheduler has no present coming.
+		void RefreshOutput() noexcept {
+			if (presenter_) {
+				presenter_->Refresh() ;
+			} else if (front_buffer_ && front_buffer_->IsValid()) {
+				damage_.unpresented_.SetAll(front_buffer_->GetSize()) ;
+				Present() ;
+			}
+		}
+
 		void CreateCanvas(const Size& size) noexcept {
 			if ((state_ & WindowState::Destroyed) != WindowState::Destroyed) {
-				if (!front_buffer_) {
+				if (!front_buffer_ && !presenter_) {
 					front_buffer_ = std::make_unique<Canvas>() ;
 				}
 
@@ -221,28 +502,86 @@ namespace zketch {
 					back_buffer_ = std::make_unique<Canvas>() ;
 				}
 
-				if (!front_buffer_->Create(size)) {
+				// window surfaces are always opaque, XRGB skips the alpha blend on present
+				if (presenter_ ? !presenter_->Resize(size, ColorFormat::XRGB) : !front_buffer_->Create(size, ColorFormat::XRGB)) {
 					#ifdef WINDOW_DEBUG
 						logger::error("Window::CreateCanvas - failed to create front buffer canvas.") ;
 					#endif
 					return ;
 				}
 
-				if (!back_buffer_->Create(size)) {
+				if (!back_buffer_->Create(size, ColorFormat::XRGB)) {
 					#ifdef WINDOW_DEBUG
 						logger::error("Window::CreateCanvas - failed to create back buffer canvas.") ;
 					#endif
 					return ;
 				}
 
+				// every buffer starts blank, there is nothing to carry forward or present
+				damage_ = {} ;
+
 				#ifdef WINDOW_DEBUG
 					logger::info("Window::CreateCanvas - Successfully create with size: [", size.x, "x", size.y, "].") ;
 				#endif
 			}
 		}
 
+		void RequestResize(const Size& size) noexcept {
+			resize_.pending_ = size ;
+			resize_.last_ = std::chrono::steady_clock::now() ;
+			++resize_.stats_.requests_ ;
+		}
+
+		// Renderer::Begin. A minimized window reports 0x0, its canvases are kept as they are.
+		void ApplyResize() noexcept {
+			if (!resize_.pending_) {
+				return ;
+			}
+
+			const Size size = *resize_.pending_ ;
+			resize_.pending_.reset() ;
+			if (size.x == 0 || size.y == 0 || (IsCanvasValid() && back_buffer_->GetSize() == size)) {
+				return ;
+			}
+
+			CreateCanvas(size) ;
+			++resize_.stats_.reallocations_ ;
+		}
+
 		bool IsCanvasValid() const noexcept {
-    		return front_buffer_ && back_buffer_ && front_buffer_->IsValid() && back_buffer_->IsValid() && ((state_ & WindowState::Destroyed) != WindowState::Destroyed) ;
+    		return (presenter_ || (front_buffer_ && front_buffer_->IsValid())) && back_buffer_ && back_buffer_->IsValid() && ((state_ & WindowState::Destroyed) != WindowState::Destroyed) ;
+		}
+
+		// called by Renderer::End once the back buffer holds a finished frame. A frame that drew
+		// nothing isn't swapped, so it is never presented either.
+		void SwapBuffers() noexcept {
+			if (!back_buffer_ || damage_.drawn_.IsEmpty()) {
+				return ;
+			}
+
+			const uint64_t frame = ++damage_.frame_ ;
+			damage_.history_[frame % ___DAMAGE_HISTORY___] = damage_.drawn_ ;
+			SetStamp(back_buffer_.get(), frame) ;
+
+			if (tracer_) {
+				tracer_->OnFrame(frame) ;
+			}
+
+			if (presenter_) {
+				damage_.last_frame_ = presenter_->Submit(back_buffer_, damage_.drawn_, frame) ;
+			} else if (front_buffer_) {
+				std::swap(front_buffer_, back_buffer_) ;
+				damage_.last_frame_ = front_buffer_.get() ;
+				damage_.unpresented_.Add(damage_.drawn_, front_buffer_->GetSize()) ;
+			}
+
+			if (recorder_ && damage_.last_frame_) {
+				recorder_->Capture(*damage_.last_frame_, damage_.drawn_) ;
+			}
+
+			if (server_ && damage_.last_frame_) {
+				server_->Submit(*damage_.last_frame_, damage_.drawn_) ;
+			}
 		}
 
 		void InternalDestroy() noexcept {
@@ -261,9 +600,20 @@ namespace zketch {
 				state_ |= WindowState::UnRegister ;
 			}
 
+			// the present thread has to stop before the backend it presents to goes away
+			presenter_.reset() ;
+
+			if (server_) {
+				server_->SetInputTarget(nullptr) ;
+			}
+
+			if (tracer_) {
+				tracer_->Detach() ;
+			}
+
 			// Destroy window handle
-			if (handle_ && IsWindow(handle_)) {
-				DestroyWindow(handle_) ;
+			if (backend_) {
+				backend_->Destroy() ;
 			}
 			
 			handle_ = nullptr ;
@@ -282,22 +632,18 @@ namespace zketch {
 		Window(const Window&) = delete ;
 		Window& operator=(const Window&) = delete ;
 
-		Window(const char* title, int32_t width, int32_t height) noexcept {
-			handle_ = CreateWindowEx(
-				0,
-				AppRegistry::g_window_class_name_.c_str(),
-				title,
-				WS_OVERLAPPEDWINDOW,
-				CW_USEDEFAULT,
-				CW_USEDEFAULT,
-				width,
-				height,
-				nullptr,
-				nullptr,
-				AppRegistry::g_hinstance_,
-				nullptr
-			) ;
+		Window(const char* title, int32_t width, int32_t height) noexcept : 
+		#ifdef ZKETCH_WIN32
+			Window(title, CW_USEDEFAULT, CW_USEDEFAULT, width, height) {}
+		#else
+			Window(title, 0, 0, width, height) {}
+		#endif
 
+		Window(const char* title, int32_t xpos, int32_t ypos, int32_t width, int32_t height) noexcept : Window(std::make_unique<NativeBackend>(title, xpos, ypos, width, height)) {}
+
+		// runs the window on any backend, e.g. a HeadlessBackend for CI.
+		explicit Window(std::unique_ptr<WindowBackend> backend) noexcept : backend_(std::move(backend)) {
+			handle_ = backend_ ? backend_->GetHandle() : nullptr ;
 			if (!handle_) {
 
 				#ifdef WINDOW_DEBUG
@@ -318,44 +664,19 @@ namespace zketch {
 			CreateCanvas(GetClientBound().GetSize()) ;
 		}
 
-		Window(const char* title, int32_t xpos, int32_t ypos, int32_t width, int32_t height) noexcept {
-			handle_ = CreateWindowEx(
-				0,
-				AppRegistry::g_window_class_name_.c_str(),
-				title,
-				WS_OVERLAPPEDWINDOW,
-				xpos,
-				ypos,
-				width,
-				height,
-				nullptr,
-				nullptr,
-				AppRegistry::g_hinstance_,
-				nullptr
-			) ;
-
-			if (!handle_) {
-				#ifdef WINDOW_DEBUG
-					logger::error("Window::Window - Failed to create Window, window isn't valid.") ;
-				#endif
-				return ;
-			}
-
-			state_ = WindowState::Active ;
-			Application::RegisterWindow(handle_, this) ;
-			state_ |= WindowState::Register ;
-
-			#ifdef WINDOW_DEBUG
-				logger::info("Window::Window - Create Window success.") ;
-			#endif
-
-			CreateCanvas(GetClientBound().GetSize()) ;
-		}
-
 		Window(Window&& o) noexcept : 
+		backend_(std::move(o.backend_)),
 		handle_(std::exchange(o.handle_, nullptr)),
 		front_buffer_(std::move(o.front_buffer_)), 
 		back_buffer_(std::move(o.back_buffer_)),
+		presenter_(std::move(o.presenter_)),
+		counters_(std::move(o.counters_)),
+		recorder_(std::exchange(o.recorder_, nullptr)),
+		server_(std::exchange(o.server_, nullptr)),
+		tracer_(std::exchange(o.tracer_, nullptr)),
+		damage_(std::move(o.damage_)),
+		resize_(std::move(o.resize_)),
+		owner_(o.owner_),
 		state_(std::exchange(o.state_, WindowState::None)),
 		close_requested_(std::exchange(o.close_requested_, false)) {
 
@@ -385,9 +706,18 @@ namespace zketch {
 			if (this != &o) {
 				InternalDestroy() ;
 
+				backend_ = std::move(o.backend_) ;
 				handle_ = std::exchange(o.handle_, nullptr) ;
 				front_buffer_ = std::move(o.front_buffer_) ;
 				back_buffer_ = std::move(o.back_buffer_) ;
+				presenter_ = std::move(o.presenter_) ;
+				counters_ = std::move(o.counters_) ;
+				recorder_ = std::exchange(o.recorder_, nullptr) ;
+				server_ = std::exchange(o.server_, nullptr) ;
+				tracer_ = std::exchange(o.tracer_, nullptr) ;
+				damage_ = std::move(o.damage_) ;
+				resize_ = std::move(o.resize_) ;
+				owner_ = o.owner_ ;
 				state_ = std::exchange(o.state_, WindowState::None) ;
 				close_requested_ = std::exchange(o.close_requested_, false) ;
 
@@ -402,32 +732,31 @@ namespace zketch {
 
 		void Show() const noexcept {
 			if (handle_) {
-				ShowWindow(handle_, SW_SHOWDEFAULT) ;
-				UpdateWindow(handle_) ;
+				backend_->Show() ;
 			}
 		}
 
 		void Hide() const noexcept {
 			if (handle_) {
-				ShowWindow(handle_, SW_HIDE) ; 
+				backend_->Hide() ;
 			}
 		}
 
 		void Minimize() noexcept { 
 			if (handle_) {
-				ShowWindow(handle_, SW_MINIMIZE) ; 
+				backend_->Minimize() ;
 			}
 		}
 
 		void Maximize() noexcept { 
 			if (handle_) {
-				ShowWindow(handle_, SW_MAXIMIZE) ; 
+				backend_->Maximize() ;
 			}
 		}
 
 		void Restore() noexcept { 
 			if (handle_) {
-				ShowWindow(handle_, SW_RESTORE) ; 
+				backend_->Restore() ;
 			}
 		}
 
@@ -440,379 +769,266 @@ namespace zketch {
 			InternalDestroy() ;
 		}
 
-		void Present() const noexcept {
-			if (!front_buffer_ || !front_buffer_->IsValid()) {
+		// pushes what changed since the last present, nothing when no frame was finished since.
+		// With async present on, frames are presented as soon as Renderer::End submits them and
+		// this does nothing. Only the thread that created the window presents, frames may be drawn
+		// on any thread (see WindowRenderPool).
+		void Present() noexcept {
+			if (presenter_) {
+				return ;
+			}
+
+			if (std::this_thread::get_id() != owner_) {
 
 				#ifdef WINDOW_DEBUG
-					logger::warning("Window::Present - Invalid canvas!") ;
+					logger::error("Window::Present - Called from a thread that doesn't own the window.") ;
 				#endif
 
 				return ;
 			}
 
-			HDC hdc = GetDC(handle_) ;
-			if (!hdc) {
-
-				#ifdef WINDOW_DEBUG
-					logger::warning("Window::Present - Invalid HDC!") ;
-				#endif
-				
+			if (damage_.unpresented_.IsEmpty()) {
+				counters_->Skip() ;
 				return ;
 			}
 
-			Gdiplus::Graphics screen(hdc) ;
-			if (screen.GetLastStatus() != Gdiplus::Ok) {
+			if (!front_buffer_ || !front_buffer_->IsValid()) {
 
 				#ifdef WINDOW_DEBUG
-					logger::error("Window::Present - Graphics creation failed");
+					logger::warning("Window::Present - Invalid canvas!") ;
 				#endif
 
-				ReleaseDC(handle_, hdc);
-				return;
+				return ;
 			}
 
-			screen.SetCompositingMode(Gdiplus::CompositingModeSourceOver) ;
-			screen.SetCompositingQuality(Gdiplus::CompositingQualityHighSpeed) ;
-			screen.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor) ;
-			auto status = screen.DrawImage(front_buffer_->GetBitmap(), 0, 0) ;
-
-			if (status != Gdiplus::Ok) {
-
-				#ifdef WINDOW_DEBUG
-					logger::error("Window::Present - DrawImage failed: ", static_cast<int>(status));
-				#endif
-				
+			backend_->Present(*front_buffer_, damage_.unpresented_) ;
+			counters_->Record(damage_.unpresented_.GetArea()) ;
+			damage_.unpresented_.Clear() ;
+			if (tracer_) {
+				tracer_->OnPresent(damage_.frame_) ;
 			}
-
-			ReleaseDC(handle_, hdc) ;
 		}
 
 		void SetTitle(const char* title) noexcept {
 			if (handle_) {
-				SetWindowText(handle_, title) ;
+				backend_->SetTitle(title) ;
 			}
 		}
 
-		Rect GetClientBound() const noexcept {
-			tagRECT r ;
-			GetClientRect(handle_, &r) ;
-			return static_cast<Rect>(r) ;
-		}
-
-		Rect GetWindowBound() const noexcept {
-			tagRECT r ;
-			GetWindowRect(handle_, &r) ;
-			return static_cast<Rect>(r) ; 
-		}
-
-		HWND GetHandle() const noexcept { return handle_ ; }
-		bool IsWindowValid() const noexcept { return handle_ && (state_ & WindowState::Destroyed) != WindowState::Destroyed ; }
-		bool IsCloseRequested() const noexcept { return close_requested_ ; }
-	} ;
-
-	inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) {
-		switch (msg) {
-			case WM_SIZE : {
-				auto it = Application::g_windows_.find(hwnd) ;
-				if (it != Application::g_windows_.end()) {
-					it->second->CreateCanvas({LOWORD(lp), HIWORD(lp)}) ;
-				} 
-				EventSystem::PushEvent(Event::CreateResizeEvent(hwnd, {LOWORD(lp), HIWORD(lp)})) ;
-				break ;
+		// moves presentation onto a dedicated thread with a third buffer. The backend's Present is then
+		// called from that thread.
+		bool SetAsyncPresent(bool enable) noexcept {
+			if (enable == static_cast<bool>(presenter_)) {
+				return true ;
 			}
 
-			case WM_CLOSE : {
-				EventSystem::PushEvent(Event::CreateCommonEvent(hwnd, EventType::Close)) ;
-				
-				auto it = Application::g_windows_.find(hwnd) ;
-				if (it != Application::g_windows_.end()) {
-					it->second->close_requested_ = true ;
+			if (!enable) {
+				// a frame the thread never got to is the newest one, it goes out from here
+				front_buffer_ = presenter_->Stop(&damage_.unpresented_) ;
+				presenter_.reset() ;
+				damage_.last_frame_ = front_buffer_.get() ;
+
+				// the buffer the thread dropped is freed, its stamp must not match a later allocation
+				for (auto& stamp : damage_.stamps_) {
+					if (stamp.first != front_buffer_.get() && stamp.first != back_buffer_.get()) {
+						stamp = {nullptr, 0} ;
+					}
 				}
-				
-				return 0 ;
-			}
 
-			case WM_DESTROY : {
-				Application::UnRegisterWindow(hwnd) ;
-				if (Application::g_windows_.empty()) {
-					PostQuitMessage(0) ;
-					Application::app_is_runing_ = false ;
-					
-					#ifdef WINDOW_DEBUG
-						logger::info("wndproc - All windows closed, posting quit message.") ;
-					#endif
+				if (!damage_.unpresented_.IsEmpty()) {
+					Present() ;
 				}
-				return 0 ;
+				return true ;
 			}
-		}
 
-		return DefWindowProc(hwnd, msg, wp, lp) ;
-	}
-
-=======
-#pragma once
-
-#include "renderer.hpp"
-#include "event.hpp"
-
-namespace zketch {
+			if (!IsCanvasValid()) {
+				return false ;
+			}
 
-	class Window ;
+			// the front buffer is still ahead of the output until the thread's first present
+			damage_.unpresented_.Clear() ;
 
-	class Application_ {
-		friend inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) ;
-		friend class Window ;
-	private :
-		static inline std::unordered_map<HWND, Window*> g_windows_ ;
-		
-		bool is_run_ = true ;
-	
-	public :
-		constexpr Application_() noexcept = default ;
-		void QuitProgram() noexcept {
-			for (auto& w : g_windows_) {
-				if (IsWindow(w.first)) {
-					DestroyWindow(w.first) ;
-				}
+			try {
+				presenter_ = std::make_unique<PresentThread>(backend_.get(), std::move(front_buffer_), counters_.get()) ;
+			} catch (...) {
+				return false ;
 			}
-			g_windows_.clear() ;
-			is_run_ = false ;
-			PostQuitMessage(0) ;
-			logger::info("PostQuitMessage (QuitProgram) done") ;
-		}
-
-		void QuitWindow(HWND hwnd) noexcept {
-			if (hwnd && IsWindow(hwnd)) {
-				SendMessage(hwnd, WM_CLOSE, 0, 0) ;
-				logger::info("SendMessage WM_CLOSE for hwnd") ;
-			}
-		}
-
-		constexpr operator bool() const noexcept {
-			return is_run_ ;
-		}
-	} static Application ;
-
-	inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) {
-		switch (msg) {
-			case WM_SIZE : 
-				EventSystem::PushEvent(Event::CreateResizeEvent(hwnd, {LOWORD(lp), HIWORD(lp)})) ;
-				break ;
-			case WM_CLOSE : 
-				EventSystem::PushEvent(Event::CreateNormalEvent(hwnd, EventType::Close)) ;
-				DestroyWindow(hwnd) ;
-				return 0 ;
-			case WM_DESTROY : 
-				if (hwnd) {
-					auto it = Application_::g_windows_.find(hwnd) ;
-					if (it != Application_::g_windows_.end()) {
-						Application_::g_windows_.erase(it) ;
-						logger::info("erased window from g_windows_. current size : ", Application_::g_windows_.size()) ;
-					} else {
-						logger::info("WM_DESTROY for hwnd not found in g_windows_. size: ", Application_::g_windows_.size()) ;
-					}
-					logger::info("current g_windows size : ", Application_::g_windows_.size()) ;
-				}
-				if (Application_::g_windows_.empty()) {
-					Application.QuitProgram() ;
-				}
-				return 0 ;
-		}
-		return DefWindowProc(hwnd, msg, wp, lp) ;
-	}
+			presenter_->SetLatencyTracer(tracer_) ;
 
-	namespace AppRegistry {
+			if (!presenter_->Start()) {
 
-		static inline HINSTANCE g_hintance_ = GetModuleHandleW(nullptr) ;
-		static inline std::string g_window_class_name_ = "zketch_app" ;
-		static inline bool window_was_registered = false ;
+				#ifdef WINDOW_DEBUG
+					logger::error("Window::SetAsyncPresent - Failed to start async present.") ;
+				#endif
 
-		static void SetWindowClass(std::string&& windowclassname) noexcept {
-			if (window_was_registered) {
-				logger::warning("SetWindowClass() failed : window class name was registered.") ;
-			} else {
-				g_window_class_name_ = std::move(windowclassname) ;
+				front_buffer_ = presenter_->Stop() ;
+				presenter_.reset() ;
+				return false ;
 			}
+			return true ;
 		}
 
-		static void RegisterWindowClass() {
-			if (window_was_registered) {
-				logger::warning("RegisterWindowClass() failed : window class name was registered.") ;
-			} else {
-				WNDCLASSEX wc = {
-					sizeof(wc),
-					CS_HREDRAW | CS_VREDRAW,
-					wndproc,
-					0,
-					0,
-					AppRegistry::g_hintance_,
-					LoadIcon(nullptr, IDI_APPLICATION),
-					LoadCursor(nullptr, IDC_ARROW),
-					reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1),
-					nullptr,
-					AppRegistry::g_window_class_name_.c_str(),
-					LoadIcon(nullptr, IDI_APPLICATION)
-				} ;
+		// frames drawn while the window is being resized skip anti aliasing and smooth text.
+		void SetReducedResizeQuality(bool enable) noexcept { resize_.reduce_quality_ = enable ; }
 
-				if (!RegisterClassEx(&wc)) {
-					logger::error("RegisterWindowClass() failed : Error to registering window class!") ;
-				} else {
-					logger::info("RegisterWindowClass() success") ;
-					window_was_registered = true ;
-				}
-			}
+		// a size came in during the last ___RESIZE_SETTLE___ or hasn't been applied yet.
+		bool IsResizing() const noexcept {
+			return resize_.pending_ || (resize_.stats_.requests_ != 0 && std::chrono::steady_clock::now() - resize_.last_ < ___RESIZE_SETTLE___) ;
 		}
 
-		// next improvement is adding RegisterWindowClass with custom Style, icon, cursor, and other...
-	} ;
+		// the resize settled after a frame drawn at reduced quality, it should be drawn again.
+		bool NeedsQualityRedraw() const noexcept { return resize_.reduced_frame_ && !IsResizing() ; }
 
-	class Window {
-	private :
-		HWND hwnd_ = nullptr ;
+		// every finished frame is handed to recorder, null detaches it. The recorder must outlive
+		// the window or be detached first.
+		void SetRecorder(FrameRecorder* recorder) noexcept { recorder_ = recorder ; }
 
-	public :
-		Window(const Window&) = delete ;
-		Window& operator=(const Window&) = delete ;
-
-		Window(const char* title, int32_t width, int32_t height) noexcept {
-			hwnd_ = CreateWindowEx(
-				0,
-				AppRegistry::g_window_class_name_.c_str(),
-				title,
-				WS_OVERLAPPEDWINDOW,
-				CW_USEDEFAULT,
-				CW_USEDEFAULT,
-				width,
-				height,
-				nullptr,
-				nullptr,
-				AppRegistry::g_hintance_,
-				nullptr
-			) ;
-
-			if (!hwnd_) 
-				logger::error("Window() failed to create Window : window isn't valid") ;
-			Application_::g_windows_.emplace(hwnd_, this) ;
-			logger::info("Window() create Window success") ;
-		}
-
-		Window(const char* title, int32_t xpos, int32_t ypos, int32_t width, int32_t height) noexcept {
-			hwnd_ = CreateWindowEx(
-				0,
-				AppRegistry::g_window_class_name_.c_str(),
-				title,
-				WS_OVERLAPPEDWINDOW,
-				xpos,
-				ypos,
-				width,
-				height,
-				nullptr,
-				nullptr,
-				AppRegistry::g_hintance_,
-				nullptr
-			) ;
-
-			if (!hwnd_) 
-				logger::error("Window() failed to create Window : window isn't valid") ;
-			Application_::g_windows_.emplace(hwnd_, this) ;
-			logger::info("Window() create Window success") ;
-		}
-
-		Window(Window&& o) noexcept : hwnd_(std::exchange(o.hwnd_, nullptr)) {
-			logger::info("Calling move ctor.") ;
-			if (hwnd_) {
-				auto it = Application_::g_windows_.find(o.hwnd_) ;
-				if (it != Application_::g_windows_.end()) 
-					Application_::g_windows_.erase(it) ;
-				Application_::g_windows_[hwnd_] = this ;
+		// streams every finished frame to server's clients and routes their input to this window,
+		// null detaches it. The server must outlive the window or be detached first.
+		void SetFramebufferServer(FramebufferServer* server) noexcept {
+			if (server_ && server_ != server) {
+				server_->SetInputTarget(nullptr) ;
 			}
-		}
 
-		~Window() noexcept {
-			logger::info("Calling dtor of class window") ;
-			if (hwnd_) {
-				if (IsWindow(hwnd_)) {
-					DestroyWindow(hwnd_) ;
+			server_ = server ;
+			if (server_) {
+				server_->SetInputTarget(handle_) ;
+				if (damage_.last_frame_) {
+					server_->Submit(*damage_.last_frame_) ;
 				}
-				hwnd_ = nullptr ;
-				logger::info("Success to set hwnd to nullptr.") ;
-			} else {
-				logger::warning("failed to set hwnd, hwnd is already nullptr.") ;
 			}
 		}
 
-		Window& operator=(Window&& o) noexcept {
-			logger::info("Calling move assignment.") ;
-			if (this != &o) {
-				hwnd_ = std::exchange(o.hwnd_, nullptr) ;
-				auto it = Application_::g_windows_.find(o.hwnd_) ;
-				if (it != Application_::g_windows_.end()) 
-					Application_::g_windows_.erase(it) ;
-				Application_::g_windows_[hwnd_] = this ;
+		// traces this window's input to the present that shows it, null detaches it. Call it on the
+		// event loop's thread, the tracer must outlive the window or be detached first.
+		bool SetLatencyTracer(LatencyTracer* tracer) noexcept {
+			if (tracer_ && tracer_ != tracer) {
+				tracer_->Detach() ;
 			}
-			return *this ;
+
+			if (presenter_) {
+				presenter_->SetLatencyTracer(tracer) ;
+			}
+
+			tracer_ = tracer ;
+			return !tracer_ || tracer_->Attach(handle_) ;
 		}
 
-		bool IsValid() const noexcept {
-			return hwnd_ != nullptr ;
+		Rect GetClientBound() const noexcept { return backend_ ? backend_->GetClientBound() : Rect{} ; }
+		Rect GetWindowBound() const noexcept { return backend_ ? backend_->GetWindowBound() : Rect{} ; }
+
+		HWND GetHandle() const noexcept { return handle_ ; }
+		WindowBackend* GetBackend() const noexcept { return backend_.get() ; }
+		const PresentThread* GetPresentThread() const noexcept { return presenter_.get() ; }
+		bool IsAsyncPresent() const noexcept { return static_cast<bool>(presenter_) ; }
+		PresentStats GetPresentStats() const noexcept { return counters_->Get() ; }
+		void ResetPresentStats() noexcept { counters_->Reset() ; }
+		ResizeStats GetResizeStats() const noexcept { return resize_.stats_ ; }
+		void ResetResizeStats() noexcept { resize_.stats_ = {} ; }
+		bool IsWindowValid() const noexcept { return handle_ && (state_ & WindowState::Destroyed) != WindowState::Destroyed ; }
+		bool IsCloseRequested() const noexcept { return close_requested_ ; }
+	} ;
+
+	inline void Application::QuitProgram() noexcept {
+		std::vector<Window*> destroy_sequence ;
+		destroy_sequence.reserve(g_windows_.size()) ;
+		for (auto& w : g_windows_) {
+			destroy_sequence.push_back(w.second) ;
 		}
 
-		void Show() const noexcept {
-			if (hwnd_) {
-				ShowWindow(hwnd_, SW_SHOWDEFAULT) ;
-				UpdateWindow(hwnd_) ;
+		for (auto* w : destroy_sequence) {
+			if (w->backend_) {
+				w->backend_->Destroy() ;
 			}
 		}
 
-		void Hide() const noexcept {
-			if (hwnd_) 
-				ShowWindow(hwnd_, SW_HIDE) ; 
-		}
+		g_windows_.clear() ;
+		app_is_runing_ = false ;
 
-		void Minimize() noexcept { 
-			if (hwnd_) 
-				ShowWindow(hwnd_, SW_MINIMIZE) ; 
-		}
+		#ifdef ZKETCH_WIN32
+			PostQuitMessage(0) ;
+		#endif
 
-		void Maximize() noexcept { 
-			if (hwnd_) 
-				ShowWindow(hwnd_, SW_MAXIMIZE) ; 
-		}
+		#ifdef APPLICATION_DEBUG
+			logger::info("Application::QuitProgram - PostQuitMessage done.") ;
+		#endif
+	}
 
-		void Restore() noexcept { 
-			if (hwnd_) 
-				ShowWindow(hwnd_, SW_RESTORE) ; 
+	inline void Application::OnResize(HWND hwnd, const Size& size) noexcept {
+		auto it = g_windows_.find(hwnd) ;
+		if (it != g_windows_.end()) {
+			it->second->RequestResize(size) ;
 		}
 
-		void Quit() const noexcept {
-			if (hwnd_) {
-				logger::info("Quit() called for window: ", hwnd_) ;
-				DestroyWindow(hwnd_);
-			} else {
-				logger::warning("Quit() failed: invalid window handle") ;
-			}
-		}
+		// one Resize event per window until the application polls it, carrying the latest size
+		EventSystem::CoalesceEvent(Event::CreateResizeEvent(hwnd, {static_cast<int32_t>(size.x), static_cast<int32_t>(size.y)})) ;
+	}
 
-		Rect GetClientBound() const noexcept {
-			tagRECT r ;
-			GetClientRect(hwnd_, &r) ;
-			return static_cast<Rect>(r) ;
+	inline void Application::OnClose(HWND hwnd) noexcept {
+		EventSystem::PushEvent(Event::CreateCommonEvent(hwnd, EventType::Close)) ;
+		
+		auto it = g_windows_.find(hwnd) ;
+		if (it != g_windows_.end()) {
+			it->second->close_requested_ = true ;
 		}
+	}
 
-		Rect GetClipBound() const noexcept {
-			tagRECT r ;
-			GetWindowRect(hwnd_, &r) ;
-			return static_cast<Rect>(r) ;
+	inline void Application::OnDestroy(HWND hwnd) noexcept {
+		UnRegisterWindow(hwnd) ;
+		WindowRegistry::Release(hwnd) ;	// its queued events now carry a stale WindowId
+		if (g_windows_.empty()) {
+			app_is_runing_ = false ;
+
+			#ifdef ZKETCH_WIN32
+				PostQuitMessage(0) ;
+			#endif
+			
+			#ifdef WINDOW_DEBUG
+				logger::info("Application::OnDestroy - All windows closed, posting quit message.") ;
+			#endif
 		}
+	}
 
-		operator HWND() const noexcept {
-			return hwnd_ ;
+	inline void Application::OnExpose(HWND hwnd) noexcept {
+		auto it = g_windows_.find(hwnd) ;
+		if (it != g_windows_.end()) {
+			it->second->RefreshOutput() ;
 		}
+	}
 
-		void SetTitle(const char* title) noexcept {
-			if (hwnd_)
-				SetWindowText(hwnd_, title) ;
+	inline void WindowBackend::NotifyResize(const Size& size) noexcept { Application::OnResize(GetHandle(), size) ; }
+	inline void WindowBackend::NotifyClose() noexcept { Application::OnClose(GetHandle()) ; }
+	inline void WindowBackend::NotifyDestroy() noexcept { Application::OnDestroy(GetHandle()) ; }
+
+	#ifdef ZKETCH_WIN32
+		inline LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) {
+			switch (msg) {
+				case WM_SIZE : {
+					Application::OnResize(hwnd, {LOWORD(lp), HIWORD(lp)}) ;
+					break ;
+				}
+
+				case WM_PAINT : {
+					PAINTSTRUCT ps ;
+					BeginPaint(hwnd, &ps) ;
+					EndPaint(hwnd, &ps) ;
+					Application::OnExpose(hwnd) ;
+					return 0 ;
+				}
+
+				case WM_CLOSE : {
+					Application::OnClose(hwnd) ;
+					return 0 ;
+				}
+
+				case WM_DESTROY : {
+					Application::OnDestroy(hwnd) ;
+					return 0 ;
+				}
+			}
+
+			return DefWindowProc(hwnd, msg, wp, lp) ;
 		}
-	} ;
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+	#endif
+
+}
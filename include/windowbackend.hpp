@@ -0,0 +1,44 @@
+#pragma once
+#include "canvas.hpp"
+#include "event.hpp"
+#include "damage.hpp"
+
+namespace zketch {
+
+	// the platform half of a Window: native window lifetime, geometry and the present sink. Window
+	// owns the canvases and drawing, a backend only shows finished frames and reports what happens
+	// to the native window through the Notify* hooks.
+	class WindowBackend {
+	protected :
+		// route through Application exactly like the Win32 wndproc does.
+		void NotifyResize(const Size& size) noexcept ;
+		void NotifyClose() noexcept ;
+		void NotifyDestroy() noexcept ;
+
+	public :
+		WindowBackend() = default ;
+		WindowBackend(const WindowBackend&) = delete ;
+		WindowBackend& operator=(const WindowBackend&) = delete ;
+		virtual ~WindowBackend() noexcept = default ;
+
+		// identifies the window in Application and in every Event it produces.
+		virtual HWND GetHandle() const noexcept = 0 ;
+		virtual Rect GetClientBound() const noexcept = 0 ;
+		virtual Rect GetWindowBound() const noexcept = 0 ;
+
+		virtual void Show() noexcept = 0 ;
+		virtual void Hide() noexcept = 0 ;
+		virtual void Minimize() noexcept = 0 ;
+		virtual void Maximize() noexcept = 0 ;
+		virtual void Restore() noexcept = 0 ;
+		virtual void SetTitle(const char* title) noexcept = 0 ;
+
+		// pushes the damaged parts of frame to the output, the rest of the output already shows it.
+		// Runs on the present thread when the window presents asynchronously, everything else stays
+		// on the thread that owns the window.
+		virtual void Present(const Canvas& frame, const DamageList& damage) noexcept = 0 ;
+
+		// tears the native window down, ends with NotifyDestroy().
+		virtual void Destroy() noexcept = 0 ;
+	} ;
+}
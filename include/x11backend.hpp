@@ -0,0 +1,660 @@
+#pragma once
+#include "windowbackend.hpp"
+
+namespace zketch {
+
+	// how an X image stores a pixel: its size, its byte order and where each channel sits. Kept apart
+	// from Xlib so the copy into it can be checked without a display.
+	struct X11PixelFormat {
+		uint32_t bytes_ = 0 ;
+		bool msb_first_ = false ;
+		uint32_t red_mask_ = 0 ;
+		uint32_t green_mask_ = 0 ;
+		uint32_t blue_mask_ = 0 ;
+
+		// rows of an XRGB canvas are already in this layout, byte for byte
+		bool IsXrgb() const noexcept {
+			return bytes_ == 4 && !msb_first_ && red_mask_ == 0xFF0000u && green_mask_ == 0xFF00u && blue_mask_ == 0xFFu ;
+		}
+
+		// 16, 24 or 32 bit pixels with three contiguous channels of 1 to 16 bits that don't overlap.
+		// Anything else (palettes, 8 bit) isn't drawn into.
+		bool IsSupported() const noexcept {
+			if (bytes_ < 2 || bytes_ > 4) {
+				return false ;
+			}
+
+			const uint64_t limit = 1ull << (bytes_ * 8) ;
+			for (uint32_t mask : {red_mask_, green_mask_, blue_mask_}) {
+				const uint32_t bits = static_cast<uint32_t>(std::popcount(mask)) ;
+				if (mask == 0 || mask >= limit || bits > 16 || ((mask >> std::countr_zero(mask)) + 1) != (1ull << bits)) {
+					return false ;
+				}
+			}
+			return (red_mask_ & green_mask_) == 0 && (red_mask_ & blue_mask_) == 0 && (green_mask_ & blue_mask_) == 0 ;
+		}
+	} ;
+
+	// copies rect of an XRGB frame into an image of format, width x height pixels with rows stride bytes
+	// apart. rect is clamped to the frame and the image first, the part copied is returned, empty when
+	// nothing was. format has to be IsSupported().
+	inline Rect X11CopyRect(const Canvas& frame, const Rect& rect, uint8_t* data, size_t stride, uint32_t width, uint32_t height, const X11PixelFormat& format) noexcept {
+		const int32_t x0 = std::max(rect.x, 0) ;
+		const int32_t y0 = std::max(rect.y, 0) ;
+		const int32_t x1 = static_cast<int32_t>(std::min<int64_t>({static_cast<int64_t>(rect.x) + rect.w, width, frame.GetWidth()})) ;
+		const int32_t y1 = static_cast<int32_t>(std::min<int64_t>({static_cast<int64_t>(rect.y) + rect.h, height, frame.GetHeight()})) ;
+		if (x0 >= x1 || y0 >= y1) {
+			return {} ;
+		}
+
+		if (format.IsXrgb()) {
+			const size_t bytes = static_cast<size_t>(x1 - x0) * 4 ;
+			for (int32_t y = y0 ; y < y1 ; ++y) {
+				std::memcpy(data + static_cast<size_t>(y) * stride + static_cast<size_t>(x0) * 4, frame.GetRow(y) + static_cast<size_t>(x0) * 4, bytes) ;
+			}
+			return {x0, y0, x1 - x0, y1 - y0} ;
+		}
+
+		// an 8 bit channel widened or narrowed to its mask, then shifted into place
+		struct Channel {
+			uint32_t from_ ;
+			uint32_t bits_ ;
+			uint32_t to_ ;
+		} ;
+		auto channel = [](uint32_t from, uint32_t mask) {
+			return Channel {from, static_cast<uint32_t>(std::popcount(mask)), static_cast<uint32_t>(std::countr_zero(mask))} ;
+		} ;
+		const Channel channels[3] = {channel(16, format.red_mask_), channel(8, format.green_mask_), channel(0, format.blue_mask_)} ;
+		const uint32_t bytes = format.bytes_ ;
+
+		for (int32_t y = y0 ; y < y1 ; ++y) {
+			const uint32_t* in = reinterpret_cast<const uint32_t*>(frame.GetRow(y)) + x0 ;
+			uint8_t* out = data + static_cast<size_t>(y) * stride + static_cast<size_t>(x0) * bytes ;
+			for (int32_t x = x0 ; x < x1 ; ++x, ++in, out += bytes) {
+				uint32_t value = 0 ;
+				for (const Channel& c : channels) {
+					const uint32_t v = (*in >> c.from_) & 0xFF ;
+					const uint32_t scaled = c.bits_ <= 8 ? v >> (8 - c.bits_) : (v << (c.bits_ - 8)) | (v >> (16 - c.bits_)) ;
+					value |= scaled << c.to_ ;
+				}
+
+				for (uint32_t i = 0 ; i < bytes ; ++i) {
+					out[i] = static_cast<uint8_t>(value >> (8 * (format.msb_first_ ? bytes - 1 - i : i))) ;
+				}
+			}
+		}
+		return {x0, y0, x1 - x0, y1 - y0} ;
+	}
+}
+
+#if defined(ZKETCH_LINUX) && defined(ZKETCH_X11)
+
+namespace zketch {
+
+	class X11Backend ;
+
+	// the process wide X connection every X11Backend shares. Its fd wakes the main WakeSignal and
+	// EventSystem pumps it, so X input arrives through PollEvent like Win32 messages do.
+	class X11Display {
+		friend class X11Backend ;
+
+	private :
+		static inline Display* g_display_ = nullptr ;
+		static inline std::unordered_map<::Window, X11Backend*> g_backends_ ;
+		static inline Atom g_wm_delete_ = 0 ;
+		static inline int g_shm_completion_ = -1 ;	// -1 when MIT-SHM is unavailable (remote display)
+
+		static Display* Acquire() noexcept ;
+		static void Attach(::Window window, X11Backend* backend) noexcept ;
+		static void Detach(::Window window) noexcept ;
+		static void Pump() noexcept ;
+
+	public :
+		X11Display() = delete ;
+
+		static Display* Get() noexcept { return g_display_ ; }
+		static bool HasShm() noexcept { return g_shm_completion_ >= 0 ; }
+	} ;
+
+	// X11 window presenting through MIT-SHM: dirty rows are copied once into a shared segment and
+	// XShmPutImage lets the server read them in place, nothing goes over the socket. Falls back to
+	// XPutImage when the server can't share memory. The copy converts to the server's pixel layout
+	// when it isn't 32 bit XRGB, a visual it can't draw (palettes, 8 bit) gets no window.
+	class X11Backend : public WindowBackend {
+		friend class X11Display ;
+
+	private :
+		Display* display_ = nullptr ;
+		::Window window_ = 0 ;
+		GC gc_ = nullptr ;
+		XImage* image_ = nullptr ;
+		X11PixelFormat format_ {} ;	// of image_
+		XShmSegmentInfo shm_ {} ;
+		Rect bound_ {} ;
+		uint64_t presented_ = 0 ;
+		bool shared_ = false ;
+		bool put_pending_ = false ;	// the server may still be reading the segment
+		std::mutex mutex_ ;			// image_ and put_pending_, Present may run on the present thread
+
+		static inline bool g_attach_failed_ = false ;
+
+		// the layout images of the default visual get, bytes_ 0 when the server has no pixmap format
+		// for its depth.
+		static X11PixelFormat DescribeVisual(Display* display) noexcept {
+			const int screen = DefaultScreen(display) ;
+			const Visual* visual = DefaultVisual(display, screen) ;
+			const int depth = DefaultDepth(display, screen) ;
+
+			X11PixelFormat format ;
+			if (visual->c_class != TrueColor && visual->c_class != DirectColor) {
+				return format ;
+			}
+
+			int count = 0 ;
+			if (XPixmapFormatValues* formats = XListPixmapFormats(display, &count)) {
+				for (int i = 0 ; i < count ; ++i) {
+					if (formats[i].depth == depth && formats[i].bits_per_pixel % 8 == 0) {
+						format.bytes_ = static_cast<uint32_t>(formats[i].bits_per_pixel / 8) ;
+					}
+				}
+				XFree(formats) ;
+			}
+
+			format.msb_first_ = ImageByteOrder(display) == MSBFirst ;
+			format.red_mask_ = static_cast<uint32_t>(visual->red_mask) ;
+			format.green_mask_ = static_cast<uint32_t>(visual->green_mask) ;
+			format.blue_mask_ = static_cast<uint32_t>(visual->blue_mask) ;
+			return format ;
+		}
+
+		static X11PixelFormat DescribeImage(const XImage* image) noexcept {
+			X11PixelFormat format ;
+			format.bytes_ = image->bits_per_pixel % 8 == 0 ? static_cast<uint32_t>(image->bits_per_pixel / 8) : 0 ;
+			format.msb_first_ = image->byte_order == MSBFirst ;
+			format.red_mask_ = static_cast<uint32_t>(image->red_mask) ;
+			format.green_mask_ = static_cast<uint32_t>(image->green_mask) ;
+			format.blue_mask_ = static_cast<uint32_t>(image->blue_mask) ;
+			return format ;
+		}
+
+		// XSync reads whatever input came with the reply into Xlib's queue, where the wait on the
+		// connection's fd doesn't see it. The loop is told to pump it.
+		void Sync() noexcept {
+			XSync(display_, 0) ;
+			if (XEventsQueued(display_, QueuedAlready) > 0) {
+				GetMainWakeSignal().Notify() ;
+			}
+		}
+
+		bool CreateImage(uint32_t width, uint32_t height) noexcept {
+			DestroyImage() ;
+
+			Visual* visual = DefaultVisual(display_, DefaultScreen(display_)) ;
+			const int depth = DefaultDepth(display_, DefaultScreen(display_)) ;
+
+			if (X11Display::HasShm()) {
+				image_ = XShmCreateImage(display_, visual, depth, ZPixmap, nullptr, &shm_, width, height) ;
+				if (image_) {
+					shm_.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(image_->bytes_per_line) * height, IPC_CREAT | 0600) ;
+					shm_.shmaddr = image_->data = shm_.shmid >= 0 ? static_cast<char*>(shmat(shm_.shmid, nullptr, 0)) : reinterpret_cast<char*>(-1) ;
+					shm_.readOnly = 0 ;
+
+					if (shm_.shmaddr != reinterpret_cast<char*>(-1)) {
+						// a remote server refuses the attach asynchronously, catch the error instead of dying on it
+						g_attach_failed_ = false ;
+						auto previous = XSetErrorHandler([](Display*, XErrorEvent*) -> int { g_attach_failed_ = true ; return 0 ; }) ;
+						XShmAttach(display_, &shm_) ;
+						Sync() ;
+						XSetErrorHandler(previous) ;
+
+						if (!g_attach_failed_) {
+							// the segment disappears once both sides detach
+							shmctl(shm_.shmid, IPC_RMID, nullptr) ;
+							shared_ = true ;
+							return CheckImage() ;
+						}
+					}
+
+					if (shm_.shmaddr != reinterpret_cast<char*>(-1)) {
+						shmdt(shm_.shmaddr) ;
+					}
+					if (shm_.shmid >= 0) {
+						shmctl(shm_.shmid, IPC_RMID, nullptr) ;
+					}
+
+					image_->data = nullptr ;
+					XDestroyImage(image_) ;
+					image_ = nullptr ;
+
+					#ifdef WINDOW_DEBUG
+						logger::warning("X11Backend::CreateImage - MIT-SHM attach failed, falling back to XPutImage.") ;
+					#endif
+				}
+			}
+
+			image_ = XCreateImage(display_, visual, depth, ZPixmap, 0, nullptr, width, height, 32, 0) ;
+			if (!image_) {
+				return false ;
+			}
+
+			image_->data = static_cast<char*>(std::malloc(static_cast<size_t>(image_->bytes_per_line) * height)) ;
+			if (!image_->data) {
+				XDestroyImage(image_) ;
+				image_ = nullptr ;
+				return false ;
+			}
+			return CheckImage() ;
+		}
+
+		// the image Xlib made is what Present writes into, not the visual it was asked for.
+		bool CheckImage() noexcept {
+			format_ = DescribeImage(image_) ;
+			if (format_.IsSupported()) {
+				return true ;
+			}
+
+			#ifdef WINDOW_DEBUG
+				logger::error("X11Backend::CheckImage - ", image_->bits_per_pixel, " bit images with masks ", reinterpret_cast<void*>(image_->red_mask), ", ", reinterpret_cast<void*>(image_->green_mask), ", ", reinterpret_cast<void*>(image_->blue_mask), " aren't supported.") ;
+			#endif
+
+			DestroyImage() ;
+			return false ;
+		}
+
+		void DestroyImage() noexcept {
+			if (!image_) {
+				return ;
+			}
+
+			WaitForPut() ;
+			if (shared_) {
+				XShmDetach(display_, &shm_) ;
+				Sync() ;
+				shmdt(shm_.shmaddr) ;
+				image_->data = nullptr ;
+				shared_ = false ;
+			}
+
+			XDestroyImage(image_) ;
+			image_ = nullptr ;
+		}
+
+		// one round trip, only paid when the next frame arrives before the server read the last one.
+		void WaitForPut() noexcept {
+			if (put_pending_) {
+				Sync() ;
+				put_pending_ = false ;
+			}
+		}
+
+		static uint32_t TranslateKey(KeySym sym) noexcept {
+			if (sym >= XK_a && sym <= XK_z) {
+				return static_cast<uint32_t>('A' + (sym - XK_a)) ;
+			}
+			if (sym >= XK_A && sym <= XK_Z) {
+				return static_cast<uint32_t>('A' + (sym - XK_A)) ;
+			}
+			if (sym >= XK_0 && sym <= XK_9) {
+				return static_cast<uint32_t>('0' + (sym - XK_0)) ;
+			}
+			if (sym >= XK_F1 && sym <= XK_F12) {
+				return static_cast<uint32_t>(0x70 + (sym - XK_F1)) ;
+			}
+			if (sym >= XK_KP_0 && sym <= XK_KP_9) {
+				return static_cast<uint32_t>(0x60 + (sym - XK_KP_0)) ;
+			}
+
+			// same values as the Win32 virtual keys KeyCode is built on
+			switch (sym) {
+				case XK_Escape : return 0x1B ;
+				case XK_Tab : return 0x09 ;
+				case XK_Return : return 0x0D ;
+				case XK_KP_Enter : return 0x0D ;
+				case XK_space : return 0x20 ;
+				case XK_BackSpace : return 0x08 ;
+				case XK_minus : return 0xBD ;
+				case XK_equal : return 0xBB ;
+				case XK_bracketleft : return 0xDB ;
+				case XK_bracketright : return 0xDD ;
+				case XK_backslash : return 0xDC ;
+				case XK_semicolon : return 0xBA ;
+				case XK_apostrophe : return 0xDE ;
+				case XK_comma : return 0xBC ;
+				case XK_period : return 0xBE ;
+				case XK_slash : return 0xBF ;
+				case XK_grave : return 0xC0 ;
+				case XK_Prior : return 0x21 ;
+				case XK_Next : return 0x22 ;
+				case XK_End : return 0x23 ;
+				case XK_Home : return 0x24 ;
+				case XK_Left : return 0x25 ;
+				case XK_Up : return 0x26 ;
+				case XK_Right : return 0x27 ;
+				case XK_Down : return 0x28 ;
+				case XK_Insert : return 0x2D ;
+				case XK_Delete : return 0x2E ;
+				case XK_Caps_Lock : return 0x14 ;
+				case XK_Shift_L : return 0xA0 ;
+				case XK_Shift_R : return 0xA1 ;
+				case XK_Control_L : return 0xA2 ;
+				case XK_Control_R : return 0xA3 ;
+				case XK_Alt_L : return 0xA4 ;
+				case XK_Alt_R : return 0xA5 ;
+				case XK_Super_L : return 0x5B ;
+				case XK_Super_R : return 0x5C ;
+				case XK_Print : return 0x2C ;
+				case XK_Scroll_Lock : return 0x91 ;
+				case XK_Pause : return 0x13 ;
+				case XK_KP_Divide : return 0x6F ;
+				case XK_KP_Multiply : return 0x6A ;
+				case XK_KP_Subtract : return 0x6D ;
+				case XK_KP_Add : return 0x6B ;
+				case XK_KP_Decimal : return 0x6E ;
+				default : return 0 ;
+			}
+		}
+
+		void HandleEvent(XEvent& xe) noexcept {
+			HWND handle = GetHandle() ;
+
+			switch (xe.type) {
+				case ConfigureNotify : {
+					bound_.x = xe.xconfigure.x ;
+					bound_.y = xe.xconfigure.y ;
+					if (static_cast<uint32_t>(xe.xconfigure.width) != bound_.w || static_cast<uint32_t>(xe.xconfigure.height) != bound_.h) {
+						bound_.w = static_cast<uint32_t>(xe.xconfigure.width) ;
+						bound_.h = static_cast<uint32_t>(xe.xconfigure.height) ;
+						NotifyResize({bound_.w, bound_.h}) ;
+					}
+					break ;
+				}
+
+				case ClientMessage : {
+					if (static_cast<Atom>(xe.xclient.data.l[0]) == X11Display::g_wm_delete_) {
+						NotifyClose() ;
+					}
+					break ;
+				}
+
+				case Expose : {
+					// the last frame is still in the image, hand the exposed part back to the server
+					std::lock_guard<std::mutex> lock(mutex_) ;
+					if (image_ && xe.xexpose.x < image_->width && xe.xexpose.y < image_->height) {
+						PutImage({xe.xexpose.x, xe.xexpose.y, std::min(xe.xexpose.width, image_->width - xe.xexpose.x), std::min(xe.xexpose.height, image_->height - xe.xexpose.y)}) ;
+					}
+					break ;
+				}
+
+				case MotionNotify : {
+					EventSystem::PushEvent(Event::CreateMouseEvent(handle, MouseButton::None, MouseState::None, {xe.xmotion.x, xe.xmotion.y})) ;
+					break ;
+				}
+
+				case ButtonPress :
+				case ButtonRelease : {
+					const Point pos {xe.xbutton.x, xe.xbutton.y} ;
+					const MouseState state = xe.type == ButtonPress ? MouseState::Down : MouseState::Up ;
+
+					switch (xe.xbutton.button) {
+						case Button1 : EventSystem::PushEvent(Event::CreateMouseEvent(handle, MouseButton::Left, state, pos)) ; break ;
+						case Button2 : EventSystem::PushEvent(Event::CreateMouseEvent(handle, MouseButton::Middle, state, pos)) ; break ;
+						case Button3 : EventSystem::PushEvent(Event::CreateMouseEvent(handle, MouseButton::Right, state, pos)) ; break ;
+
+						// wheel notches arrive as press/release pairs of buttons 4 and 5, WHEEL_DELTA per notch
+						case Button4 :
+						case Button5 : {
+							if (state == MouseState::Down) {
+								EventSystem::PushEvent(Event::CreateMouseEvent(handle, MouseButton::None, MouseState::Wheel, pos, xe.xbutton.button == Button4 ? 120 : -120)) ;
+							}
+							break ;
+						}
+					}
+					break ;
+				}
+
+				case KeyPress :
+				case KeyRelease : {
+					uint32_t key = TranslateKey(XLookupKeysym(&xe.xkey, 0)) ;
+					if (key != 0) {
+						EventSystem::PushEvent(Event::CreateKeyEvent(handle, xe.type == KeyPress ? KeyState::Down : KeyState::Up, key)) ;
+					}
+					break ;
+				}
+
+				default : {
+					if (xe.type == X11Display::g_shm_completion_) {
+						std::lock_guard<std::mutex> lock(mutex_) ;
+						put_pending_ = false ;
+					}
+					break ;
+				}
+			}
+		}
+
+		void PutImage(const Rect& r) noexcept {
+			if (shared_) {
+				XShmPutImage(display_, window_, gc_, image_, r.x, r.y, r.x, r.y, r.w, r.h, 1) ;
+				put_pending_ = true ;
+			} else {
+				XPutImage(display_, window_, gc_, image_, r.x, r.y, r.x, r.y, r.w, r.h) ;
+			}
+		}
+
+	public :
+		X11Backend(const char* title, int32_t xpos, int32_t ypos, int32_t width, int32_t height) noexcept {
+			display_ = X11Display::Acquire() ;
+			if (!display_) {
+
+				#ifdef WINDOW_DEBUG
+					logger::error("X11Backend::X11Backend - Failed to open X display.") ;
+				#endif
+
+				return ;
+			}
+
+			const int screen = DefaultScreen(display_) ;
+			width = std::max(width, 1) ;
+			height = std::max(height, 1) ;
+
+			if (!DescribeVisual(display_).IsSupported()) {
+
+				#ifdef WINDOW_DEBUG
+					logger::error("X11Backend::X11Backend - The default visual isn't 16, 24 or 32 bit TrueColor.") ;
+				#endif
+
+				// closes the connection when no other window holds it
+				X11Display::Detach(0) ;
+				display_ = nullptr ;
+				return ;
+			}
+
+			XSetWindowAttributes attributes {} ;
+			attributes.background_pixmap = 0 ;	// no server side clear, frames cover the whole window
+			attributes.event_mask = ExposureMask | StructureNotifyMask | PointerMotionMask | ButtonPressMask | ButtonReleaseMask | KeyPressMask | KeyReleaseMask ;
+
+			window_ = XCreateWindow(display_, RootWindow(display_, screen), std::max(xpos, 0), std::max(ypos, 0), width, height, 0, CopyFromParent, InputOutput, CopyFromParent, CWBackPixmap | CWEventMask, &attributes) ;
+			if (!window_) {
+
+				#ifdef WINDOW_DEBUG
+					logger::error("X11Backend::X11Backend - XCreateWindow failed.") ;
+				#endif
+
+				return ;
+			}
+
+			XStoreName(display_, window_, title ? title : "") ;
+			XSetWMProtocols(display_, window_, &X11Display::g_wm_delete_, 1) ;
+			gc_ = XCreateGC(display_, window_, 0, nullptr) ;
+			bound_ = {std::max(xpos, 0), std::max(ypos, 0), width, height} ;
+			X11Display::Attach(window_, this) ;
+		}
+
+		X11Backend(const char* title, int32_t width, int32_t height) noexcept : X11Backend(title, 0, 0, width, height) {}
+
+		~X11Backend() noexcept override {
+			Destroy() ;
+		}
+
+		HWND GetHandle() const noexcept override { return window_ ? reinterpret_cast<HWND>(const_cast<X11Backend*>(this)) : nullptr ; }
+		Rect GetClientBound() const noexcept override { return {0, 0, static_cast<int32_t>(bound_.w), static_cast<int32_t>(bound_.h)} ; }
+		Rect GetWindowBound() const noexcept override { return bound_ ; }
+
+		void Show() noexcept override {
+			if (window_) {
+				XMapRaised(display_, window_) ;
+				XFlush(display_) ;
+			}
+		}
+
+		void Hide() noexcept override {
+			if (window_) {
+				XUnmapWindow(display_, window_) ;
+				XFlush(display_) ;
+			}
+		}
+
+		void Minimize() noexcept override {
+			if (window_) {
+				XIconifyWindow(display_, window_, DefaultScreen(display_)) ;
+				XFlush(display_) ;
+			}
+		}
+
+		// maximizing is a window manager request, without one it leaves the window alone.
+		void Maximize() noexcept override { Show() ; }
+		void Restore() noexcept override { Show() ; }
+
+		void SetTitle(const char* title) noexcept override {
+			if (window_) {
+				XStoreName(display_, window_, title ? title : "") ;
+			}
+		}
+
+		// copies the damaged rects into the shared image and puts just those.
+		void Present(const Canvas& frame, const DamageList& damage) noexcept override {
+			if (!window_ || !frame.IsValid() || frame.GetFormat() != ColorFormat::XRGB) {
+				return ;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_) ;
+
+			DamageList full ;
+			const DamageList* rects = &damage ;
+			if (!image_ || static_cast<uint32_t>(image_->width) != frame.GetWidth() || static_cast<uint32_t>(image_->height) != frame.GetHeight()) {
+				if (!CreateImage(frame.GetWidth(), frame.GetHeight())) {
+
+					#ifdef WINDOW_DEBUG
+						logger::error("X11Backend::Present - Failed to create image.") ;
+					#endif
+
+					return ;
+				}
+
+				// a fresh image holds nothing yet
+				full.SetAll(frame.GetSize()) ;
+				rects = &full ;
+			}
+
+			WaitForPut() ;
+
+			for (const Rect& r : *rects) {
+				const Rect copied = X11CopyRect(frame, r, reinterpret_cast<uint8_t*>(image_->data), static_cast<size_t>(image_->bytes_per_line), static_cast<uint32_t>(image_->width), static_cast<uint32_t>(image_->height), format_) ;
+				if (copied.w != 0) {
+					PutImage(copied) ;
+				}
+			}
+
+			XFlush(display_) ;
+			++presented_ ;
+		}
+
+		void Destroy() noexcept override {
+			if (!window_) {
+				return ;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_) ;
+				DestroyImage() ;
+			}
+
+			if (gc_) {
+				XFreeGC(display_, gc_) ;
+				gc_ = nullptr ;
+			}
+
+			NotifyDestroy() ;
+			XDestroyWindow(display_, window_) ;
+			XFlush(display_) ;
+			X11Display::Detach(window_) ;
+			window_ = 0 ;
+			display_ = nullptr ;
+		}
+
+		uint64_t GetPresentCount() const noexcept { return presented_ ; }
+		bool IsShm() const noexcept { return shared_ ; }
+		::Window GetXWindow() const noexcept { return window_ ; }
+	} ;
+
+	inline Display* X11Display::Acquire() noexcept {
+		if (g_display_) {
+			return g_display_ ;
+		}
+
+		// windows may present from their own thread
+		XInitThreads() ;
+		g_display_ = XOpenDisplay(nullptr) ;
+		if (!g_display_) {
+			return nullptr ;
+		}
+
+		g_wm_delete_ = XInternAtom(g_display_, "WM_DELETE_WINDOW", 0) ;
+
+		int major, minor, pixmaps ;
+		if (XShmQueryVersion(g_display_, &major, &minor, &pixmaps)) {
+			g_shm_completion_ = XShmGetEventBase(g_display_) + ShmCompletion ;
+		}
+
+		GetMainWakeSignal().AddWatch(ConnectionNumber(g_display_)) ;
+		EventSystem::AddPump(&X11Display::Pump) ;
+		return g_display_ ;
+	}
+
+	inline void X11Display::Attach(::Window window, X11Backend* backend) noexcept {
+		try {
+			g_backends_[window] = backend ;
+		} catch (...) {}
+	}
+
+	// the connection is closed with the last window.
+	inline void X11Display::Detach(::Window window) noexcept {
+		g_backends_.erase(window) ;
+		if (!g_backends_.empty() || !g_display_) {
+			return ;
+		}
+
+		EventSystem::RemovePump(&X11Display::Pump) ;
+		GetMainWakeSignal().RemoveWatch(ConnectionNumber(g_display_)) ;
+		XCloseDisplay(g_display_) ;
+		g_display_ = nullptr ;
+		g_shm_completion_ = -1 ;
+	}
+
+	inline void X11Display::Pump() noexcept {
+		if (!g_display_) {
+			return ;
+		}
+
+		while (XPending(g_display_) > 0) {
+			XEvent xe ;
+			XNextEvent(g_display_, &xe) ;
+
+			auto it = g_backends_.find(xe.xany.window) ;
+			if (it != g_backends_.end()) {
+				it->second->HandleEvent(xe) ;
+			}
+		}
+	}
+}
+
+#endif
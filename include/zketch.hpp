@@ -1,6 +1,10 @@
-<<<<<<< HEAD
 #pragma once
 #include "renderer.hpp"
+#include "displayplayer.hpp"
+#include "renderpool.hpp"
+#include "framescheduler.hpp"
+#include "dispatcher.hpp"
+#include "eventlog.hpp"
 #include "inputsystem.hpp"
 #include "slider.hpp"
 #include "button.hpp"
@@ -15,7 +19,11 @@ namespace zketch {
 		#endif
 
 		std::thread t1(Application::LoadFonts) ;
-		AppRegistry::RegisterWindowClass() ;
+
+		#ifdef ZKETCH_WIN32
+			AppRegistry::RegisterWindowClass() ;
+		#endif
+
 		EventSystem::Init() ;
 		t1.join() ;
 
@@ -24,18 +32,4 @@ namespace zketch {
 			logger::info("Init time : ", std::chrono::duration_cast<std::chrono::milliseconds>(tm1 - tm0).count(), " ms.") ;
 		#endif
 	}
-=======
-#pragma once
-#include "window.hpp"
-#include "inputsystem.hpp"
-#include "slider.hpp"
-#include "button.hpp"
-#include "textbox.hpp"
-
-namespace zketch {
-	void zketch_init() noexcept {
-		AppRegistry::RegisterWindowClass() ;
-		EventSystem::Initialize() ;
-	}
->>>>>>> dc9e717570a8202f64dc92753ab1b4f737c2a5c6
-}
\ No newline at end of file
+}
@@ -0,0 +1,25 @@
+# cross build untuk Windows dengan MinGW-w64 dari Linux, contoh:
+#   cmake -S . -B build-mingw -DCMAKE_TOOLCHAIN_FILE=scripts/mingw-w64.cmake
+# butuh thread model posix untuk std::thread (Debian/Ubuntu: apt install g++-mingw-w64-x86-64-posix).
+# Kalau wine ada, ctest menjalankan demo lewat wine
+set(CMAKE_SYSTEM_NAME Windows)
+set(CMAKE_SYSTEM_PROCESSOR x86_64)
+
+set(ZKETCH_MINGW_PREFIX x86_64-w64-mingw32 CACHE STRING "Prefix of the MinGW-w64 tools")
+
+find_program(ZKETCH_MINGW_CXX NAMES ${ZKETCH_MINGW_PREFIX}-g++-posix ${ZKETCH_MINGW_PREFIX}-g++ REQUIRED)
+set(CMAKE_CXX_COMPILER ${ZKETCH_MINGW_CXX})
+set(CMAKE_RC_COMPILER ${ZKETCH_MINGW_PREFIX}-windres)
+
+set(CMAKE_FIND_ROOT_PATH /usr/${ZKETCH_MINGW_PREFIX})
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+
+# runtime MinGW di-link statis supaya exe jalan tanpa DLL-nya, di Windows maupun lewat wine
+set(CMAKE_EXE_LINKER_FLAGS_INIT "-static")
+
+find_program(ZKETCH_WINE wine)
+if (ZKETCH_WINE)
+    set(CMAKE_CROSSCOMPILING_EMULATOR ${ZKETCH_WINE})
+endif()
@@ -0,0 +1,28 @@
+#!/bin/sh
+# menjalankan demo X11 di Xvfb dengan layar 4K, contoh:
+#   scripts/run_x11.sh bin/test24
+# layar harus sebesar frame terbesar, bagian window di luar layar tidak pernah dibaca server
+set -e
+
+if [ $# -eq 0 ]; then
+    echo "usage: $0 <program> [args...]" >&2
+    exit 2
+fi
+
+if ! command -v Xvfb >/dev/null 2>&1; then
+    echo "Xvfb not found (Debian/Ubuntu: apt install xvfb)" >&2
+    exit 77
+fi
+
+display=:${ZKETCH_XVFB_DISPLAY:-99}
+Xvfb "$display" -screen 0 3840x2160x24 -nolisten tcp &
+xvfb=$!
+trap 'kill $xvfb 2>/dev/null' EXIT INT TERM
+
+# tunggu sampai server siap menerima koneksi
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    [ -e "/tmp/.X11-unix/X${display#:}" ] && break
+    sleep 0.2
+done
+
+DISPLAY=$display "$@"
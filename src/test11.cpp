@@ -0,0 +1,72 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// replays a 500 step drag-resize on a headless window, several sizes land between two frames like
+// they do while dragging, and reports how often the canvases were recreated and what frames cost.
+int main() {
+	zketch_init() ;
+
+	auto backend = std::make_unique<HeadlessBackend>("zketch resize replay", 800, 600) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+	window.SetReducedResizeQuality(true) ;
+	window.ResetResizeStats() ;
+
+	constexpr uint32_t steps = 500 ;
+	constexpr uint32_t sizes_per_frame = 4 ;
+
+	Renderer renderer ;
+	std::vector<double> frame_ms ;
+	uint64_t resize_events = 0 ;
+	uint64_t reduced_frames = 0 ;
+
+	for (uint32_t step = 0 ; step < steps ; step += sizes_per_frame) {
+		for (uint32_t i = step ; i < std::min(step + sizes_per_frame, steps) ; ++i) {
+			headless->Resize({800 + i, 600 + i / 2}) ;
+		}
+
+		Event e ;
+		while (PollEvent(e)) {
+			if (e == EventType::Resize) {
+				++resize_events ;
+			}
+		}
+
+		auto t0 = std::chrono::steady_clock::now() ;
+		if (renderer.Begin(window)) {
+			const Rect client = window.GetClientBound() ;
+			renderer.Clear(rgba(30, 30, 30, 1)) ;
+			renderer.FillRectRounded({20.0f, 20.0f, static_cast<float>(client.w) - 40.0f, static_cast<float>(client.h) - 40.0f}, rgba(70, 130, 180, 1), 16.0f) ;
+			renderer.FillCircle({static_cast<int32_t>(client.w / 2), static_cast<int32_t>(client.h / 2)}, 100.0f, rgba(255, 255, 255, 1)) ;
+			renderer.End() ;
+		}
+		window.Present() ;
+		auto t1 = std::chrono::steady_clock::now() ;
+
+		reduced_frames += window.IsResizing() ? 1 : 0 ;
+		frame_ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count()) ;
+	}
+
+	std::sort(frame_ms.begin(), frame_ms.end()) ;
+	double total = 0.0 ;
+	for (double ms : frame_ms) {
+		total += ms ;
+	}
+
+	const ResizeStats stats = window.GetResizeStats() ;
+	logger::info("resize steps      : ", steps) ;
+	logger::info("resize requests   : ", stats.requests_) ;
+	logger::info("resize events     : ", resize_events) ;
+	logger::info("reallocations     : ", stats.reallocations_) ;
+	logger::info("frames            : ", frame_ms.size(), " (", reduced_frames, " at reduced quality)") ;
+	logger::info("frame time avg    : ", total / frame_ms.size(), " ms") ;
+	logger::info("frame time p50    : ", frame_ms[frame_ms.size() / 2], " ms") ;
+	logger::info("frame time p99    : ", frame_ms[frame_ms.size() * 99 / 100], " ms") ;
+	logger::info("frame time max    : ", frame_ms.back(), " ms") ;
+	logger::info("final size        : ", headless->GetLastFrame().GetWidth(), "x", headless->GetLastFrame().GetHeight()) ;
+
+	// at most one reallocation per frame, and the last frame has the last size asked for
+	const bool coalesced = stats.reallocations_ <= frame_ms.size() && resize_events <= frame_ms.size() ;
+	const bool settled = headless->GetLastFrame().GetWidth() == 800 + steps - 1 && headless->GetLastFrame().GetHeight() == 600 + (steps - 1) / 2 ;
+	return coalesced && settled ? 0 : 1 ;
+}
@@ -0,0 +1,145 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// serves a 1080p headless window over a Unix domain socket to loopback clients in the same process,
+// one per encoding, for 300 frames. Every frame each client shows is compared with what the window
+// presented, a client joining halfway and one asking for a refresh have to catch up to the current
+// frame, and the clients' clicks and key presses come back as events. Exits non zero on a mismatch.
+// Linux only, the socket lives at argv[1] or /tmp/zketch-remote.sock.
+static constexpr uint32_t ___FRAMES___ = 300 ;
+
+// the client sees 0xAARRGGBB, the window may keep no alpha
+static bool Matches(const FramebufferClient& client, const Canvas& presented, std::vector<uint32_t>& row) {
+	const ImageView remote = client.GetFrame() ;
+	const ImageView local = presented.GetView() ;
+	if (remote.width_ != local.width_ || remote.height_ != local.height_) {
+		return false ;
+	}
+
+	row.resize(local.width_) ;
+	for (uint32_t y = 0 ; y < local.height_ ; ++y) {
+		codec::ToArgbRow(local.GetRow(y), local.format_, row.data(), row.size()) ;
+		if (memcmp(remote.GetRow(y), row.data(), row.size() * 4) != 0) {
+			return false ;
+		}
+	}
+	return true ;
+}
+
+int main(int argc, char** argv) {
+	zketch_init() ;
+
+	const std::string path = argc > 1 ? argv[1] : "/tmp/zketch-remote.sock" ;
+
+	auto backend = std::make_unique<HeadlessBackend>("zketch remote", 1920, 1080) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+
+	FramebufferServer server ;
+	if (!server.Listen(path)) {
+		logger::error("failed to listen on ", path) ;
+		return 1 ;
+	}
+	window.SetFramebufferServer(&server) ;
+
+	const RemoteEncoding encodings[] = {RemoteEncoding::Raw, RemoteEncoding::Rle, RemoteEncoding::Qoi, RemoteEncoding::Auto} ;
+	const char* names[] = {"raw ", "rle ", "qoi ", "auto"} ;
+	constexpr size_t count = std::size(encodings) ;
+
+	// the last one joins halfway
+	FramebufferClient clients[count + 1] ;
+	for (size_t i = 0 ; i < count ; ++i) {
+		if (!clients[i].Connect(UnixSocketStream::Connect(path)) || !clients[i].SetEncoding(encodings[i])) {
+			logger::error("failed to connect to ", path) ;
+			return 1 ;
+		}
+	}
+
+	Renderer renderer ;
+	std::vector<uint32_t> row ;
+	uint32_t mismatched = 0 ;
+	uint32_t clicks = 0 ;
+	uint32_t keys = 0 ;
+	uint32_t clicks_sent = 0 ;
+	uint32_t keys_sent = 0 ;
+	bool joined = false ;
+	bool refreshed = false ;
+	std::vector<double> latency_ms[count] ;
+
+	auto poll = [&] {
+		Event e ;
+		while (PollEvent(e)) {
+			if (e == EventType::Mouse && e.GetMouseState() == MouseState::Down) {
+				++clicks ;
+			} else if (e == EventType::Key && e.GetKeyState() == KeyState::Down) {
+				++keys ;
+			}
+		}
+	} ;
+
+	for (uint32_t frame = 0 ; frame < ___FRAMES___ ; ++frame) {
+		poll() ;
+
+		const Rect client_bound = window.GetClientBound() ;
+		const float x = static_cast<float>((frame * 9) % (client_bound.w - 200)) ;
+		if (renderer.Begin(window)) {
+			renderer.Clear(rgba(30, 30, 30, 1)) ;
+			renderer.FillRect({0.0f, 0.0f, static_cast<float>(client_bound.w), 48.0f}, rgba(48, 80, 160, 1)) ;
+			renderer.FillRectRounded({x, 300.0f, 200.0f, 120.0f}, (frame / 30) % 2 ? rgba(70, 180, 70, 1) : rgba(180, 70, 70, 1), 12.0f) ;
+			renderer.End() ;
+		}
+
+		// the server encodes for every client in one pass and the clients decode here one after the
+		// other, so a client's time includes the ones served and decoded before it
+		auto t0 = std::chrono::steady_clock::now() ;
+		window.Present() ;
+		const size_t connected = count + (joined ? 1 : 0) ;
+		for (size_t i = 0 ; i < connected ; ++i) {
+			if (!clients[i].WaitFrame(std::chrono::milliseconds(500))) {
+				logger::error("frame ", frame, " never reached client ", i) ;
+				return 1 ;
+			}
+			if (i < count) {
+				latency_ms[i].push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()) ;
+			}
+		}
+
+		const Canvas presented = headless->GetLastFrame() ;
+		for (size_t i = 0 ; i < connected ; ++i) {
+			mismatched += Matches(clients[i], presented, row) ? 0 : 1 ;
+		}
+
+		// nothing new is presented while they catch up, what they show has to be this frame
+		if (frame == ___FRAMES___ / 2) {
+			joined = clients[count].Connect(UnixSocketStream::Connect(path)) && clients[count].WaitFrame(std::chrono::milliseconds(500)) && Matches(clients[count], presented, row) ;
+			mismatched += joined ? 0 : 1 ;
+		} else if (frame == ___FRAMES___ * 2 / 3) {
+			refreshed = clients[0].RequestRefresh() && clients[0].WaitFrame(std::chrono::milliseconds(500)) && Matches(clients[0], presented, row) ;
+			mismatched += refreshed ? 0 : 1 ;
+		}
+
+		if (frame % 20 == 0) {
+			clicks_sent += clients[frame / 20 % count].SendMouse(MouseButton::Left, MouseState::Down, {static_cast<int32_t>(x) + 10, 310}) ? 1 : 0 ;
+		}
+		if (frame % 30 == 0) {
+			keys_sent += clients[frame / 30 % count].SendKey(KeyState::Down, 'A' + frame / 30) ? 1 : 0 ;
+		}
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20)) ;
+	poll() ;
+
+	const RemoteStats stats = server.GetStats() ;
+	logger::info("frames            : ", ___FRAMES___, " to ", count, " clients + 1 late (", mismatched, " mismatched)") ;
+	logger::info("late joiner       : ", joined ? "matched" : "failed", ", refresh ", refreshed ? "matched" : "failed") ;
+	logger::info("input received    : ", clicks, " of ", clicks_sent, " clicks, ", keys, " of ", keys_sent, " keys") ;
+	logger::info("tiles sent        : ", stats.tiles_, " (+", stats.cached_tiles_, " from cache, ", 100.0 * stats.cached_tiles_ / std::max<uint64_t>(stats.tiles_ + stats.cached_tiles_, 1), "%)") ;
+	logger::info("bytes             : ", stats.raw_bytes_, " raw -> ", stats.sent_bytes_, " sent (", stats.GetRatio(), "x)") ;
+	for (size_t i = 0 ; i < count ; ++i) {
+		std::sort(latency_ms[i].begin(), latency_ms[i].end()) ;
+		logger::info("present->", names[i], "      : p50 ", latency_ms[i][latency_ms[i].size() / 2], " ms, p99 ", latency_ms[i][latency_ms[i].size() * 99 / 100], " ms") ;
+	}
+
+	window.SetFramebufferServer(nullptr) ;
+	return mismatched == 0 && joined && refreshed && clicks == clicks_sent && keys == keys_sent ? 0 : 1 ;
+}
@@ -0,0 +1,126 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// draws a wallboard into a headless window and ships it two ways over Unix socket pairs: as the
+// Renderer's display list, replayed on the far end by a DisplayListPlayer, and as damaged tiles
+// through a FramebufferServer. Reports bytes per frame of both and how fast the list replays.
+// Linux only.
+int main() {
+	zketch_init() ;
+
+	auto backend = std::make_unique<HeadlessBackend>("zketch display list", 1920, 1080) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+
+	FramebufferServer server ;
+	auto [server_end, client_end] = UnixSocketStream::Pair() ;
+	FramebufferClient client ;
+	if (!server_end || !server.AddClient(std::move(server_end)) || !client.Connect(std::move(client_end))) {
+		logger::error("failed to connect the framebuffer client") ;
+		return 1 ;
+	}
+	client.SetEncoding(RemoteEncoding::Auto) ;
+	window.SetFramebufferServer(&server) ;
+
+	auto [list_out, list_in] = UnixSocketStream::Pair() ;
+	if (!list_out) {
+		logger::error("failed to open the display list socket") ;
+		return 1 ;
+	}
+
+	DisplayListWriter writer(*list_out) ;
+	DisplayListPlayer player ;
+	Canvas replayed ;
+
+	Canvas icons[4] ;
+	for (uint32_t i = 0 ; i < 4 ; ++i) {
+		icons[i].Create({48, 48}) ;
+		Renderer icon ;
+		if (icon.Begin(icons[i])) {
+			icon.Clear(rgba(0, 0, 0, 0)) ;
+			icon.FillCircle({24, 24}, 20.0f, rgba(60 + i * 40, 140, 220 - i * 40, 1)) ;
+			icon.End() ;
+		}
+	}
+
+	// without GDI+ the font table is empty and both ends draw the strings in the default font, which
+	// softgdi renders with its bitmap glyphs
+	Font font ;
+	try {
+		font = Font("Segoe UI", 16) ;
+	} catch (...) {
+		logger::warning("Segoe UI not found, strings are drawn in the default font") ;
+	}
+
+	Renderer renderer ;
+	renderer.SetDisplayList(&writer) ;
+
+	std::vector<uint8_t> received(1 << 16) ;
+	double replay_ms = 0.0 ;
+	uint64_t list_bytes = 0 ;
+
+	for (uint32_t frame = 0 ; frame < 300 ; ++frame) {
+		if (renderer.Begin(window)) {
+			renderer.Clear(rgba(20, 20, 24, 1)) ;
+			renderer.FillRect({0, 0, 1920, 48}, rgba(40, 60, 120, 1)) ;
+			renderer.DrawString(std::wstring(L"Operations"), {16, 12}, rgba(255, 255, 255, 1), font) ;
+
+			for (int32_t card = 0 ; card < 12 ; ++card) {
+				const float x = 24.0f + static_cast<float>(card % 4) * 470.0f ;
+				const float y = 80.0f + static_cast<float>(card / 4) * 320.0f ;
+				renderer.FillRectRounded({x, y, 450.0f, 300.0f}, rgba(36, 36, 44, 1), 10.0f) ;
+				renderer.DrawCanvas(&icons[card % 4], {static_cast<int32_t>(x) + 16, static_cast<int32_t>(y) + 16}) ;
+				renderer.DrawString(std::to_wstring((frame * 7 + card * 13) % 1000) + L" req/s", {static_cast<int32_t>(x) + 80, static_cast<int32_t>(y) + 28}, rgba(120, 220, 120, 1), font) ;
+
+				Vertex line ;
+				for (uint32_t k = 0 ; k < 32 ; ++k) {
+					line.push_back({x + 16.0f + static_cast<float>(k) * 13.0f, y + 280.0f - static_cast<float>((k * k + frame + card * 5) % 120)}) ;
+				}
+				renderer.DrawPolygon(line, rgba(90, 160, 250, 1), 2.0f) ;
+			}
+
+			renderer.End() ;
+		}
+
+		window.Present() ;
+		if (!client.WaitFrame(std::chrono::milliseconds(500))) {
+			logger::error("frame ", frame, " never reached the framebuffer client") ;
+			return 1 ;
+		}
+
+		int64_t n ;
+		while ((n = list_in->Read(received.data(), received.size())) > 0) {
+			list_bytes += static_cast<uint64_t>(n) ;
+			auto t0 = std::chrono::steady_clock::now() ;
+			if (!player.Feed(received.data(), static_cast<size_t>(n), replayed)) {
+				logger::error("display list corrupt at frame ", frame) ;
+				return 1 ;
+			}
+			replay_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+		}
+	}
+
+	// the replayed canvas is rasterized here, it should match the window pixel for pixel
+	const Canvas presented = headless->GetLastFrame() ;
+	uint32_t mismatched_rows = 0 ;
+	for (uint32_t y = 0 ; y < presented.GetHeight() && replayed.GetSize() == presented.GetSize() ; ++y) {
+		std::vector<uint32_t> a(presented.GetWidth()) ;
+		std::vector<uint32_t> b(presented.GetWidth()) ;
+		codec::ToArgbRow(presented.GetRow(y), presented.GetFormat(), a.data(), a.size()) ;
+		codec::ToArgbRow(replayed.GetRow(y), replayed.GetFormat(), b.data(), b.size()) ;
+		mismatched_rows += a != b ? 1 : 0 ;
+	}
+
+	const DisplayListStats list = writer.GetStats() ;
+	const DisplayListStats played = player.GetStats() ;
+	const RemoteStats tiles = server.GetStats() ;
+	const double raw = static_cast<double>(presented.GetWidth()) * presented.GetHeight() * 4.0 ;
+	logger::info("frames             : ", list.frames_, " sent, ", played.frames_, " replayed, ", mismatched_rows, " rows differ") ;
+	logger::info("raw framebuffer    : ", raw / 1024.0, " KB per frame") ;
+	logger::info("framebuffer server : ", static_cast<double>(tiles.sent_bytes_) / list.frames_ / 1024.0, " KB per frame") ;
+	logger::info("display list       : ", static_cast<double>(list_bytes) / list.frames_ / 1024.0, " KB per frame, ", list.commands_ / list.frames_, " commands (", list.define_bytes_ / 1024, " KB definitions, ", list.reused_, " reused)") ;
+	logger::info("replay             : ", replay_ms / played.frames_, " ms per frame") ;
+
+	window.SetFramebufferServer(nullptr) ;
+	return mismatched_rows == 0 ? 0 : 1 ;
+}
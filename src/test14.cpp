@@ -0,0 +1,100 @@
+#include "zketch.hpp"
+#include <fcntl.h>
+using namespace zketch ;
+
+// a loop fed by a pipe: a producer thread writes a timestamp every 5 ms for a second, EventSystem
+// wakes the idle FrameScheduler when the pipe is readable and the callback turns the bytes into a
+// redraw. Reports how long a write took to reach the callback and how much cpu the loop thread
+// spent, it sleeps in between. Exits non zero when a reading went missing. Linux only.
+static constexpr int32_t ___READINGS___ = 200 ;
+
+static double ThreadCpuMs() {
+	timespec ts {} ;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) ;
+	return static_cast<double>(ts.tv_sec) * 1e3 + static_cast<double>(ts.tv_nsec) / 1e6 ;
+}
+
+int main() {
+	zketch_init() ;
+
+	// the read end doesn't block, the callback drains what is there and goes back to sleep
+	int fds[2] ;
+	if (pipe(fds) != 0 || fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK) != 0) {
+		logger::error("failed to open the pipe") ;
+		return 1 ;
+	}
+
+	FrameScheduler scheduler ;
+	scheduler.SetIdleMode(true) ;
+
+	struct Reading {
+		int32_t index_ ;
+		uint64_t written_ ;
+	} ;
+
+	int32_t readings = 0 ;
+	int32_t last = 0 ;
+	bool closed = false ;
+	std::vector<double> latency_us ;
+	latency_us.reserve(___READINGS___) ;
+
+	EventSystem::AddSource(fds[0], [&](WaitSource fd, SourceEvent events) {
+		Reading r ;
+		while (read(fd, &r, sizeof(r)) == sizeof(r)) {
+			if (r.index_ < 0) {
+				closed = true ;
+				break ;
+			}
+
+			latency_us.push_back(static_cast<double>(MonotonicTime() - r.written_) / 1e3) ;
+			last = r.index_ ;
+			++readings ;
+			scheduler.Invalidate() ;
+		}
+
+		if (closed || (events & SourceEvent::Hangup)) {
+			EventSystem::RemoveSource(fd) ;
+			closed = true ;
+		}
+	}) ;
+
+	const double cpu0 = ThreadCpuMs() ;
+	const auto t0 = std::chrono::steady_clock::now() ;
+
+	std::thread producer([fd = fds[1]] {
+		auto next = std::chrono::steady_clock::now() ;
+		for (int32_t i = 0 ; i < ___READINGS___ ; ++i) {
+			next += std::chrono::milliseconds(5) ;
+			std::this_thread::sleep_until(next) ;
+			const Reading r {i, MonotonicTime()} ;
+			[[maybe_unused]] ssize_t n = write(fd, &r, sizeof(r)) ;
+		}
+
+		const Reading done {-1, MonotonicTime()} ;
+		[[maybe_unused]] ssize_t n = write(fd, &done, sizeof(done)) ;
+	}) ;
+
+	while (!closed) {
+		scheduler.BeginFrame() ;
+		Event e ;
+		while (PollEvent(e)) {}
+		scheduler.EndFrame() ;
+	}
+
+	const double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+	const double cpu_ms = ThreadCpuMs() - cpu0 ;
+
+	producer.join() ;
+	close(fds[0]) ;
+	close(fds[1]) ;
+
+	std::sort(latency_us.begin(), latency_us.end()) ;
+	const FrameStats& stats = scheduler.GetStats() ;
+	logger::info("readings   : ", readings, " of ", ___READINGS___, ", last ", last) ;
+	logger::info("frames     : ", stats.frames_, ", ", stats.idle_waits_, " idle waits") ;
+	if (!latency_us.empty()) {
+		logger::info("latency    : write to callback p50 ", latency_us[latency_us.size() / 2], " us, p99 ", latency_us[latency_us.size() * 99 / 100], " us") ;
+	}
+	logger::info("loop cpu   : ", cpu_ms, " ms over ", wall_ms, " ms (", 100.0 * cpu_ms / wall_ms, " %), scheduler load ", stats.GetLoad() * 100.0, " %") ;
+	return readings == ___READINGS___ && last == ___READINGS___ - 1 ? 0 : 1 ;
+}
@@ -0,0 +1,129 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// stresses the event queue: 1 to 16 threads push key events while the loop thread polls, every
+// producer's events have to come out complete and in order. The same runs go through a mutex and a
+// deque, the queue EventSystem had before the ring, for a baseline on the same machine. Then the
+// queue is flooded with nobody polling to show the DropNewest policy, and a resize is coalesced
+// from every thread at once. Exits non zero when an event was lost, reordered or not coalesced.
+static constexpr uint32_t ___PER_PRODUCER___ = 200000 ;
+
+// the old queue: every push and poll takes the lock
+struct MutexQueue {
+	std::mutex mutex_ ;
+	std::deque<Event> events_ ;
+
+	void Push(const Event& e) {
+		std::lock_guard<std::mutex> lock(mutex_) ;
+		events_.push_back(e) ;
+	}
+
+	bool Poll(Event& e) {
+		std::lock_guard<std::mutex> lock(mutex_) ;
+		if (events_.empty()) {
+			return false ;
+		}
+		e = events_.front() ;
+		events_.pop_front() ;
+		return true ;
+	}
+} ;
+
+// M events per second through push and poll, out_of_order counts what came out lost or reordered
+template <typename Push, typename Poll>
+static double Run(uint32_t producers, Push push, Poll poll, uint32_t& out_of_order) {
+	std::vector<uint32_t> next(producers, 0) ;
+	uint64_t received = 0 ;
+	const uint64_t total = static_cast<uint64_t>(producers) * ___PER_PRODUCER___ ;
+
+	auto t0 = std::chrono::steady_clock::now() ;
+	std::vector<std::thread> threads ;
+	for (uint32_t p = 0 ; p < producers ; ++p) {
+		threads.emplace_back([p, &push] {
+			for (uint32_t i = 0 ; i < ___PER_PRODUCER___ ; ++i) {
+				push(Event::CreateKeyEvent(nullptr, KeyState::Down, (p << 24) | i)) ;
+			}
+		}) ;
+	}
+
+	Event e ;
+	while (received < total) {
+		if (!poll(e)) {
+			std::this_thread::yield() ;
+			continue ;
+		}
+
+		const uint32_t p = e.GetKeyCode() >> 24 ;
+		out_of_order += (e.GetKeyCode() & 0xFFFFFF) != next[p]++ ? 1 : 0 ;
+		++received ;
+	}
+
+	for (auto& t : threads) {
+		t.join() ;
+	}
+
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+	return total / ms / 1000.0 ;
+}
+
+int main() {
+	EventSystem::Init() ;
+	logger::info("hardware threads : ", std::thread::hardware_concurrency()) ;
+
+	uint32_t out_of_order = 0 ;
+	for (uint32_t producers : {1u, 2u, 4u, 8u, 16u}) {
+		EventSystem::SetOverflowPolicy(EventOverflow::Block) ;
+		const double ring = Run(producers, [](const Event& e) { EventSystem::PushEvent(e) ; }, [](Event& e) { return EventSystem::PollEvent(e) ; }, out_of_order) ;
+
+		MutexQueue queue ;
+		const double locked = Run(producers, [&queue](const Event& e) { queue.Push(e) ; }, [&queue](Event& e) { return queue.Poll(e) ; }, out_of_order) ;
+
+		logger::info(producers, " producers : ring ", ring, " M events/s, mutex+deque ", locked, " M events/s") ;
+	}
+	logger::info("order     : ", out_of_order, " events lost or out of order") ;
+
+	// nobody polls while 4 threads push twice the capacity
+	EventSystem::SetOverflowPolicy(EventOverflow::DropNewest) ;
+	const uint64_t dropped = EventSystem::GetDroppedCount() ;
+	std::vector<std::thread> flood ;
+	for (uint32_t p = 0 ; p < 4 ; ++p) {
+		flood.emplace_back([] {
+			for (size_t i = 0 ; i < EventSystem::GetQueueCapacity() / 2 ; ++i) {
+				EventSystem::PushEvent(Event::CreateCommonEvent(nullptr, EventType::None)) ;
+			}
+		}) ;
+	}
+
+	for (auto& t : flood) {
+		t.join() ;
+	}
+
+	const size_t queued = EventSystem::GetQueuedCount() ;
+	const uint64_t flood_dropped = EventSystem::GetDroppedCount() - dropped ;
+	logger::info("flood     : ", queued, " queued, ", flood_dropped, " dropped") ;
+	EventSystem::Clear() ;
+
+	// 8 threads resize the same window, one event waits with the last size any of them set
+	std::vector<std::thread> resizers ;
+	for (int32_t p = 0 ; p < 8 ; ++p) {
+		resizers.emplace_back([p] {
+			for (int32_t i = 1 ; i <= 1000 ; ++i) {
+				EventSystem::CoalesceEvent(Event::CreateResizeEvent(nullptr, {p * 1000 + i, i})) ;
+			}
+		}) ;
+	}
+
+	for (auto& t : resizers) {
+		t.join() ;
+	}
+
+	uint32_t resizes = 0 ;
+	Event e ;
+	while (EventSystem::PollEvent(e)) {
+		resizes += e == EventType::Resize ? 1 : 0 ;
+	}
+	logger::info("coalesced : 8000 resizes -> ", resizes, " event, last height ", e.GetResizedSize().y) ;
+
+	const bool flood_ok = queued == EventSystem::GetQueueCapacity() && flood_dropped == EventSystem::GetQueueCapacity() ;
+	return out_of_order == 0 && flood_ok && resizes == 1 ? 0 : 1 ;
+}
@@ -0,0 +1,74 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// an 8 kHz mouse against a 60 Hz loop: 133 moves, a click and a few wheel steps land between two
+// frames. Every delivered move is hit tested against 500 widgets like OnHover would. Run once as
+// is and once with motion coalescing, the second delivers a move per run and keeps the raw ones
+// in GetCoalescedSamples. Exits non zero when coalescing changed the wheel total or let a click
+// overtake its move.
+static constexpr uint32_t ___FRAMES___ = 600 ;
+static constexpr uint32_t ___MOVES_PER_FRAME___ = 133 ;
+static constexpr uint32_t ___WIDGETS___ = 500 ;
+
+int main() {
+	EventSystem::Init() ;
+
+	std::vector<RectF> widgets ;
+	for (uint32_t i = 0 ; i < ___WIDGETS___ ; ++i) {
+		widgets.push_back({static_cast<float>(i % 25) * 40.0f, static_cast<float>(i / 25) * 30.0f, 36.0f, 26.0f}) ;
+	}
+
+	int64_t wheels[2] = {} ;
+	uint32_t misplaced = 0 ;
+	for (bool coalesce : {false, true}) {
+		EventSystem::SetMotionCoalescing(coalesce) ;
+
+		uint64_t delivered = 0 ;
+		uint64_t samples = 0 ;
+		uint64_t hovered = 0 ;
+		int64_t wheel = 0 ;
+		uint32_t misplaced_clicks = 0 ;
+		double ms = 0.0 ;
+
+		for (uint32_t frame = 0 ; frame < ___FRAMES___ ; ++frame) {
+			for (uint32_t i = 0 ; i < ___MOVES_PER_FRAME___ ; ++i) {
+				const Point pos = {static_cast<int32_t>((frame * 7 + i) % 1000), static_cast<int32_t>((frame * 3 + i / 2) % 600)} ;
+				EventSystem::PushEvent(Event::CreateMouseEvent(nullptr, MouseButton::None, MouseState::None, pos)) ;
+				if (i == ___MOVES_PER_FRAME___ / 2) {
+					EventSystem::PushEvent(Event::CreateMouseEvent(nullptr, MouseButton::Left, MouseState::Down, pos)) ;
+				}
+				if (i % 40 == 0) {
+					EventSystem::PushEvent(Event::CreateMouseEvent(nullptr, MouseButton::None, MouseState::Wheel, pos, 120)) ;
+				}
+			}
+
+			auto t0 = std::chrono::steady_clock::now() ;
+			Point last {} ;
+			Event e ;
+			while (EventSystem::PollEvent(e)) {
+				++delivered ;
+				samples += EventSystem::GetCoalescedSamples().size() ;
+				if (e.GetMouseState() == MouseState::None) {
+					last = e.GetMousePosition() ;
+					for (const auto& w : widgets) {
+						hovered += w.Contain(last) ? 1 : 0 ;
+					}
+				} else if (e.GetMouseState() == MouseState::Wheel) {
+					wheel += e.GetMouseWheelValue() ;
+				} else if (e.GetMouseState() == MouseState::Down) {
+					// the click has to arrive after the move that led to it
+					misplaced_clicks += e.GetMousePosition() != last ? 1 : 0 ;
+				}
+			}
+			ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+		}
+
+		logger::info(coalesce ? "coalesced : " : "raw       : ", delivered / ___FRAMES___, " events per frame, ", samples, " samples kept, ", hovered, " hover hits, wheel ", wheel, ", ", misplaced_clicks, " misplaced clicks") ;
+		logger::info("            ", ms / ___FRAMES___ * 1000.0, " us dispatching per frame") ;
+		wheels[coalesce ? 1 : 0] = wheel ;
+		misplaced += misplaced_clicks ;
+	}
+
+	// coalescing may merge moves and wheel steps, never lose a step or let a click overtake a move
+	return wheels[0] == wheels[1] && misplaced == 0 ? 0 : 1 ;
+}
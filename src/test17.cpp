@@ -0,0 +1,93 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// a thread moves the mouse of a headless window at 1 kHz while a 60 fps loop draws a cursor where
+// the last move put it. The LatencyTracer follows every move to the present that shows it, the
+// loop runs once presenting itself and once with async present and motion coalescing. Exits non
+// zero when input goes untraced, a percentile is out of order, a span outgrows the total it is part
+// of, or latency is past bounds loose enough for a loaded machine.
+static bool Ordered(const LatencySummary& s) {
+	return s.p50_ <= s.p99_ && s.p99_ <= s.max_ ;
+}
+
+// every sample's total is its queue, handling and present spans added up, so no span's percentile
+// can be above the total's
+static bool Within(const LatencySummary& span, const LatencySummary& total) {
+	return span.p50_ <= total.p50_ && span.p99_ <= total.p99_ && span.max_ <= total.max_ ;
+}
+
+static bool Run(const char* name, bool async) {
+	auto backend = std::make_unique<HeadlessBackend>("zketch latency", 1280, 720) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+	window.SetAsyncPresent(async) ;
+	EventSystem::SetMotionCoalescing(async) ;
+
+	LatencyTracer tracer ;
+	window.SetLatencyTracer(&tracer) ;
+
+	std::atomic<bool> stop = false ;
+	std::thread mouse([&] {
+		for (int32_t i = 0 ; !stop.load() ; ++i) {
+			headless->SendMouse(MouseButton::None, MouseState::None, {200 + (i * 3) % 880, 100 + (i * 7) % 520}) ;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1)) ;
+		}
+	}) ;
+
+	FrameScheduler scheduler ;
+	scheduler.SetTargetFps(60.0) ;
+	Renderer renderer ;
+	Point cursor {} ;
+	const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2) ;
+
+	while (std::chrono::steady_clock::now() < end) {
+		scheduler.BeginFrame() ;
+		Event e ;
+		while (PollEvent(e)) {
+			if (e.IsMouseEvent()) {
+				cursor = e.GetMousePosition() ;
+			}
+		}
+
+		if (renderer.Begin(window)) {
+			renderer.Clear(rgba(24, 24, 28, 1)) ;
+			for (int32_t y = 0 ; y < 720 ; y += 40) {
+				renderer.FillRect({0.0f, static_cast<float>(y), 1280.0f, 20.0f}, rgba(32, 32, 40, 1)) ;
+			}
+			renderer.FillCircle({static_cast<float>(cursor.x), static_cast<float>(cursor.y)}, 12.0f, rgba(250, 200, 60, 1)) ;
+			renderer.End() ;
+		}
+
+		window.Present() ;
+		scheduler.EndFrame() ;
+	}
+
+	stop = true ;
+	mouse.join() ;
+
+	const LatencyStats stats = tracer.GetStats() ;
+	auto ms = [](std::chrono::nanoseconds t) { return static_cast<double>(t.count()) / 1e6 ; } ;
+	logger::info(name, " : ", stats.inputs_, " moves over ", stats.frames_, " frames") ;
+	logger::info("  input to present p50 ", ms(stats.total_.p50_), " ms, p99 ", ms(stats.total_.p99_), " ms, max ", ms(stats.total_.max_), " ms") ;
+	logger::info("  queue p50 ", ms(stats.queue_.p50_), " ms, handling p50 ", ms(stats.handling_.p50_), " ms, present p50 ", ms(stats.present_.p50_), " ms") ;
+
+	window.SetLatencyTracer(nullptr) ;
+	EventSystem::Clear() ;
+
+	// 2 s at 60 fps, a frame shows the moves since the last one, all of them or the coalesced one
+	const bool traced = stats.frames_ >= 30 && stats.frames_ <= 130 && stats.dropped_ == 0 && stats.inputs_ >= stats.frames_ && (!async || stats.inputs_ <= stats.frames_ * 2) ;
+	const bool ordered = Ordered(stats.total_) && Ordered(stats.queue_) && Ordered(stats.handling_) && Ordered(stats.present_) ;
+	const bool within = Within(stats.queue_, stats.total_) && Within(stats.handling_, stats.total_) && Within(stats.present_, stats.total_) ;
+	const bool bounded = stats.total_.p50_ < std::chrono::milliseconds(100) && stats.total_.p99_ < std::chrono::milliseconds(500) ;
+	if (!traced || !ordered || !within || !bounded) {
+		logger::error(name, " : ", traced ? "" : "untraced input ", ordered ? "" : "percentiles out of order ", within ? "" : "a span past the total ", bounded ? "" : "latency past its bounds") ;
+	}
+	return traced && ordered && within && bounded ;
+}
+
+int main() {
+	zketch_init() ;
+	const bool sync = Run("sync present           ", false) ;
+	const bool async = Run("async present, coalesced", true) ;
+	return sync && async ? 0 : 1 ;
+}
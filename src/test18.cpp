@@ -0,0 +1,142 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// 10k widgets hit testing mouse moves: handed every event by hand, through std::function, and
+// through an EventDispatcher, once with all of them on one window and once spread over 10 windows
+// so a move only reaches the widgets of its own. Then half of them unsubscribe and come back in
+// random order, and a listener removes itself and a neighbour while it is being called. Exits non
+// zero when the paths disagree on the hits or a listener went missing.
+static constexpr uint32_t ___WIDGETS___ = 10000 ;
+static constexpr uint32_t ___EVENTS___ = 2000 ;
+
+struct Hoverable {
+	RectF bound_ ;
+	uint32_t hovered_ = 0 ;
+
+	void OnEvent(const Event& e) noexcept {
+		if (e.IsMouseEvent() && e.GetMouseState() == MouseState::None) {
+			hovered_ += bound_.Contain(e.GetMousePosition()) ? 1 : 0 ;
+		}
+	}
+} ;
+
+static HWND WindowOf(uint32_t i) {
+	return reinterpret_cast<HWND>(static_cast<uintptr_t>(0x1000 + i)) ;
+}
+
+template <typename Fn>
+static double Measure(Fn&& dispatch) {
+	auto t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t i = 0 ; i < ___EVENTS___ ; ++i) {
+		dispatch(Event::CreateMouseEvent(WindowOf(i % 10), MouseButton::None, MouseState::None, {static_cast<int32_t>(i % 1000), static_cast<int32_t>(i % 700)})) ;
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+}
+
+int main() {
+	std::vector<Hoverable> widgets(___WIDGETS___) ;
+	for (uint32_t i = 0 ; i < ___WIDGETS___ ; ++i) {
+		widgets[i].bound_ = {static_cast<float>(i % 100) * 10.0f, static_cast<float>(i / 100) * 7.0f, 9.0f, 6.0f} ;
+	}
+
+	// every path that reaches all widgets has to count the same hits
+	auto hits = [&] {
+		uint64_t n = 0 ;
+		for (const auto& w : widgets) {
+			n += w.hovered_ ;
+		}
+		return n ;
+	} ;
+
+	const double by_hand = Measure([&](const Event& e) {
+		for (auto& w : widgets) {
+			w.OnEvent(e) ;
+		}
+	}) ;
+
+	const uint64_t hand_hits = hits() ;
+
+	std::vector<std::function<void(const Event&)>> functions ;
+	for (auto& w : widgets) {
+		functions.push_back([&w](const Event& e) { w.OnEvent(e) ; }) ;
+	}
+	const double function = Measure([&](const Event& e) {
+		for (auto& f : functions) {
+			f(e) ;
+		}
+	}) ;
+
+	const uint64_t function_hits = hits() - hand_hits ;
+
+	EventDispatcher one ;
+	for (auto& w : widgets) {
+		one.Subscribe<&Hoverable::OnEvent>(EventType::Mouse, &w) ;
+	}
+	const double dispatched = Measure([&](const Event& e) { one.Dispatch(e) ; }) ;
+	const uint64_t dispatched_hits = hits() - hand_hits - function_hits ;
+
+	EventDispatcher spread ;
+	std::vector<ListenerHandle> handles ;
+	for (uint32_t i = 0 ; i < ___WIDGETS___ ; ++i) {
+		handles.push_back(spread.Subscribe<&Hoverable::OnEvent>(EventType::Mouse, &widgets[i], WindowOf(i % 10))) ;
+	}
+	const double per_window = Measure([&](const Event& e) { spread.Dispatch(e) ; }) ;
+
+	auto per_event = [](double ms) { return ms * 1000.0 / ___EVENTS___ ; } ;
+	logger::info("by hand        : ", per_event(by_hand), " us per event") ;
+	logger::info("std::function  : ", per_event(function), " us per event") ;
+	logger::info("dispatcher     : ", per_event(dispatched), " us per event") ;
+	logger::info("per window     : ", per_event(per_window), " us per event, ", ___WIDGETS___ / 10, " listeners each") ;
+	logger::info("hits           : ", hand_hits, " by hand, ", function_hits, " std::function, ", dispatched_hits, " dispatcher") ;
+
+	// half of them leave and come back in a different order
+	std::vector<uint32_t> order(___WIDGETS___) ;
+	uint32_t seed = 7 ;
+	for (uint32_t i = 0 ; i < ___WIDGETS___ ; ++i) {
+		order[i] = i ;
+	}
+	for (uint32_t i = ___WIDGETS___ - 1 ; i > 0 ; --i) {
+		seed = seed * 1664525u + 1013904223u ;
+		std::swap(order[i], order[seed % (i + 1)]) ;
+	}
+
+	auto t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t k = 0 ; k < ___WIDGETS___ / 2 ; ++k) {
+		spread.Unsubscribe(handles[order[k]]) ;
+	}
+	for (uint32_t k = 0 ; k < ___WIDGETS___ / 2 ; ++k) {
+		const uint32_t i = order[___WIDGETS___ / 2 - 1 - k] ;
+		handles[i] = spread.Subscribe<&Hoverable::OnEvent>(EventType::Mouse, &widgets[i], WindowOf(i % 10)) ;
+	}
+	const double churn = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / ___WIDGETS___ ;
+	logger::info("churn          : ", churn, " ns per subscribe or unsubscribe, ", spread.GetListenerCount(), " listeners") ;
+
+	// a listener that drops itself and the next one while the dispatch runs
+	struct Quitter {
+		EventDispatcher* dispatcher_ ;
+		ListenerHandle self_ ;
+		ListenerHandle other_ ;
+		uint32_t calls_ = 0 ;
+
+		void OnEvent(const Event&) noexcept {
+			++calls_ ;
+			dispatcher_->Unsubscribe(self_) ;
+			dispatcher_->Unsubscribe(other_) ;
+		}
+	} ;
+
+	EventDispatcher small ;
+	Quitter a {&small, {}, {}, 0}, b {&small, {}, {}, 0} ;
+	a.self_ = small.Subscribe<&Quitter::OnEvent>(EventType::Key, &a) ;
+	b.self_ = small.Subscribe<&Quitter::OnEvent>(EventType::Key, &b) ;
+	a.other_ = b.self_ ;
+	b.other_ = a.self_ ;
+	// the first dispatch calls one of them, the other is dead before its turn
+	const size_t first = small.Dispatch(Event::CreateKeyEvent(nullptr, KeyState::Down, 'A')) ;
+	const size_t second = small.Dispatch(Event::CreateKeyEvent(nullptr, KeyState::Down, 'A')) ;
+	logger::info("self removal   : ", a.calls_ + b.calls_, " call, dispatch counted ", first, " then ", second, ", ", small.GetListenerCount(), " listeners left") ;
+
+	const bool same_hits = hand_hits == function_hits && hand_hits == dispatched_hits ;
+	const bool churned = spread.GetListenerCount() == ___WIDGETS___ ;
+	return same_hits && churned && a.calls_ + b.calls_ == 1 && first == 1 && second == 0 && small.GetListenerCount() == 0 ? 0 : 1 ;
+}
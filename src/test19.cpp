@@ -0,0 +1,124 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// records two seconds of scripted input into a headless window at 60 fps, then replays the log
+// into a fresh window: twice as fast as possible and once at the recorded pace. The app state at
+// the end has to match the recording every time, the frame times of the unpaced runs are what two
+// builds would be compared on. Linux only, the log is written to argv[1] or /tmp/zketch_session.zevl.
+struct AppState {
+	Point cursor_ {} ;
+	Size size_ {640, 480} ;
+	uint32_t clicks_ = 0 ;
+	uint32_t keys_ = 0 ;
+	int32_t wheel_ = 0 ;
+
+	bool operator==(const AppState&) const noexcept = default ;
+} ;
+
+// one frame of the app: handle the input, then draw something that grows with it.
+static void Frame(Window& window, Renderer& renderer, AppState& state) {
+	Event e ;
+	while (PollEvent(e)) {
+		if (e.IsMouseEvent()) {
+			state.cursor_ = e.GetMousePosition() ;
+			state.clicks_ += e.GetMouseState() == MouseState::Down ? 1 : 0 ;
+			state.wheel_ += e.GetMouseWheelValue() ;
+		} else if (e.IsKeyEvent()) {
+			state.keys_ += e.GetKeyState() == KeyState::Down ? 1 : 0 ;
+		} else if (e.IsResizeEvent()) {
+			state.size_ = {static_cast<int32_t>(e.GetResizedSize().x), static_cast<int32_t>(e.GetResizedSize().y)} ;
+		}
+	}
+
+	if (renderer.Begin(window)) {
+		renderer.Clear(rgba(20, 20, 24, 1)) ;
+		for (uint32_t i = 0 ; i < 50 + state.clicks_ * 20 ; ++i) {
+			renderer.FillRect({static_cast<float>(i * 13 % 600), static_cast<float>(i * 7 % 440), 24.0f, 16.0f}, rgba(40 + i % 200, 90, 160, 1)) ;
+		}
+		renderer.FillCircle({static_cast<float>(state.cursor_.x), static_cast<float>(state.cursor_.y)}, 8.0f, rgba(250, 200, 60, 1)) ;
+		renderer.End() ;
+	}
+	window.Present() ;
+}
+
+static AppState Replay(const char* name, EventLogPlayer& player, ReplayPace pace) {
+	auto backend = std::make_unique<HeadlessBackend>("zketch replay", 640, 480) ;
+	Window window(std::move(backend)) ;
+	Renderer renderer ;
+	AppState state ;
+
+	player.Rewind() ;
+	player.SetTarget(window.GetHandle()) ;
+	player.SetPace(pace) ;
+	const auto t0 = std::chrono::steady_clock::now() ;
+	while (player.NextFrame()) {
+		Frame(window, renderer, state) ;
+	}
+	const double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+
+	const ReplayStats stats = player.GetStats() ;
+	auto ms = [](std::chrono::nanoseconds t) { return static_cast<double>(t.count()) / 1e6 ; } ;
+	logger::info(name, " : ", stats.frames_, " frames, ", stats.events_, " events, ", wall_ms, " ms wall, ", ms(stats.total_), " ms in frames, frame p50 ", ms(stats.p50_), " ms, p99 ", ms(stats.p99_), " ms") ;
+	return state ;
+}
+
+int main(int argc, char** argv) {
+	zketch_init() ;
+	const std::string path = argc > 1 ? argv[1] : "/tmp/zketch_session.zevl" ;
+
+	AppState recorded ;
+	{
+		auto backend = std::make_unique<HeadlessBackend>("zketch record", 640, 480) ;
+		HeadlessBackend* user = backend.get() ;
+		Window window(std::move(backend)) ;
+		Renderer renderer ;
+		FrameScheduler scheduler ;
+		scheduler.SetTargetFps(60.0) ;
+
+		EventLogWriter writer ;
+		if (!writer.Open(path)) {
+			logger::error("failed to open ", path) ;
+			return 1 ;
+		}
+
+		for (int32_t f = 0 ; f < 120 ; ++f) {
+			scheduler.BeginFrame() ;
+
+			// the scripted user: moves every frame, clicks, types and scrolls now and then
+			for (int32_t k = 0 ; k < 4 ; ++k) {
+				user->SendMouse(MouseButton::None, MouseState::None, {(f * 5 + k) % 640, (f * 3 + k * 2) % 480}) ;
+			}
+			if (f % 15 == 0) {
+				user->SendMouse(MouseButton::Left, MouseState::Down, {f % 640, f % 480}) ;
+				user->SendMouse(MouseButton::Left, MouseState::Up, {f % 640, f % 480}) ;
+			}
+			if (f % 10 == 5) {
+				user->SendKey(KeyState::Down, 'A' + f % 26) ;
+				user->SendKey(KeyState::Up, 'A' + f % 26) ;
+			}
+			if (f % 40 == 20) {
+				user->SendMouse(MouseButton::None, MouseState::Wheel, {f % 640, f % 480}, -120) ;
+			}
+
+			Frame(window, renderer, recorded) ;
+			writer.MarkFrame() ;
+			scheduler.EndFrame() ;
+		}
+
+		writer.Close() ;
+		const EventLogStats& stats = writer.GetStats() ;
+		logger::info("recorded : ", stats.frames_, " frames, ", stats.events_, " events, ", stats.bytes_, " bytes (", static_cast<double>(stats.bytes_) / stats.events_, " per event)") ;
+	}
+
+	EventLogPlayer player ;
+	if (!player.Open(path)) {
+		logger::error("failed to read ", path) ;
+		return 1 ;
+	}
+
+	const AppState a = Replay("unpaced  ", player, ReplayPace::Unpaced) ;
+	const AppState b = Replay("unpaced  ", player, ReplayPace::Unpaced) ;
+	const AppState c = Replay("recorded ", player, ReplayPace::Recorded) ;
+	logger::info("state    : ", a == recorded && b == recorded && c == recorded ? "identical" : "DIFFERENT", ", ", recorded.clicks_, " clicks, ", recorded.keys_, " keys, wheel ", recorded.wheel_) ;
+	return a == recorded && b == recorded && c == recorded ? 0 : 1 ;
+}
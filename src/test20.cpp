@@ -0,0 +1,112 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// bursts of 4000 mixed events taken three ways: a PollEvent per event, DrainEvents into one
+// buffer, ForEachEvent with a visitor. Then a burst is drained mouse first and keys after, the
+// keys held back by the first sweep have to come out complete and in order. Last an idle
+// FrameScheduler after a drain that left events behind. Exits non zero when an event was lost or
+// came out of order, or the idle loop slept on events it had left.
+static constexpr uint32_t ___BURST___ = 4000 ;
+static constexpr uint32_t ___ROUNDS___ = 500 ;
+
+static void Burst() {
+	for (uint32_t i = 0 ; i < ___BURST___ ; ++i) {
+		if (i % 4 == 0) {
+			EventSystem::PushEvent(Event::CreateKeyEvent(nullptr, KeyState::Down, i)) ;
+		} else {
+			EventSystem::PushEvent(Event::CreateMouseEvent(nullptr, MouseButton::None, MouseState::None, {static_cast<int32_t>(i), 0})) ;
+		}
+	}
+}
+
+template <typename Fn>
+static double Measure(Fn&& take) {
+	double ms = 0.0 ;
+	for (uint32_t r = 0 ; r < ___ROUNDS___ ; ++r) {
+		Burst() ;
+		auto t0 = std::chrono::steady_clock::now() ;
+		take() ;
+		ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+	}
+	return ms * 1e6 / (static_cast<double>(___ROUNDS___) * ___BURST___) ;
+}
+
+int main() {
+	EventSystem::Init() ;
+
+	int64_t sum = 0 ;
+	auto handle = [&](const Event& e) {
+		sum += e.IsMouseEvent() ? e.GetMousePosition().x : static_cast<int64_t>(e.GetKeyCode()) ;
+	} ;
+
+	const double polled = Measure([&] {
+		Event e ;
+		while (PollEvent(e)) {
+			handle(e) ;
+		}
+	}) ;
+
+	std::vector<Event> buffer(4096) ;
+	const double drained = Measure([&] {
+		size_t n ;
+		while ((n = DrainEvents(buffer)) != 0) {
+			for (size_t i = 0 ; i < n ; ++i) {
+				handle(buffer[i]) ;
+			}
+		}
+	}) ;
+
+	const double visited = Measure([&] { ForEachEvent(handle) ; }) ;
+
+	logger::info("PollEvent    : ", polled, " ns per event") ;
+	logger::info("DrainEvents  : ", drained, " ns per event") ;
+	logger::info("ForEachEvent : ", visited, " ns per event (checksum ", sum, ")") ;
+
+	// the three ways saw the same events
+	const int64_t per_round = static_cast<int64_t>(___BURST___) * (___BURST___ - 1) / 2 ;
+	const bool complete = sum == 3 * static_cast<int64_t>(___ROUNDS___) * per_round ;
+
+	// mouse first, the keys wait
+	Burst() ;
+	const size_t mouse = ForEachEvent(handle, EventMask::Mouse) ;
+	uint32_t expected = 0 ;
+	uint32_t out_of_order = 0 ;
+	const size_t keys = ForEachEvent([&](const Event& e) {
+		out_of_order += e.GetKeyCode() != expected ? 1 : 0 ;
+		expected += 4 ;
+	}, EventMask::Key) ;
+
+	Event e ;
+	const bool left = PollEvent(e) ;
+	logger::info("filtered     : ", mouse, " mouse, then ", keys, " keys, ", out_of_order, " out of order, ", left ? "something left" : "nothing left") ;
+
+	// an idle loop that took part of a burst, by count and by mask, gets the next frame right away
+	// for the rest. The timers only bound a wait that missed them.
+	FrameScheduler scheduler ;
+	scheduler.SetIdleMode(true) ;
+	scheduler.BeginFrame() ;
+	scheduler.EndFrame() ;
+	scheduler.PostDelayed(std::chrono::seconds(2), [] {}) ;
+	scheduler.PostDelayed(std::chrono::seconds(4), [] {}) ;
+
+	auto begin_ms = [&] {
+		const auto t0 = std::chrono::steady_clock::now() ;
+		scheduler.BeginFrame() ;
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+	} ;
+
+	Burst() ;
+	scheduler.BeginFrame() ;
+	DrainEvents(std::span<Event>(buffer.data(), 16)) ;
+	scheduler.EndFrame() ;
+	const double after_drain = begin_ms() ;
+	ForEachEvent(handle, EventMask::Mouse) ;
+	scheduler.EndFrame() ;
+	const double after_mask = begin_ms() ;
+	ForEachEvent(handle) ;
+	scheduler.EndFrame() ;
+	logger::info("idle frame   : ", after_drain, " ms after a bounded drain, ", after_mask, " ms with keys held back") ;
+
+	const bool woken = after_drain < 500.0 && after_mask < 500.0 ;
+	return complete && mouse == ___BURST___ * 3 / 4 && keys == ___BURST___ / 4 && out_of_order == 0 && !left && woken ? 0 : 1 ;
+}
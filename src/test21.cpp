@@ -0,0 +1,88 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// how much room an event takes in the queue, what naming windows by id costs a push and a poll,
+// and what happens to events whose window or widget is gone by the time they are polled: they
+// come out with a null handle or address instead of a dangling one. Exits non zero when one of
+// them doesn't. Linux only.
+static constexpr uint32_t ___BURST___ = 4000 ;
+static constexpr uint32_t ___ROUNDS___ = 500 ;
+
+static HWND WindowOf(uint32_t i) {
+	return reinterpret_cast<HWND>(static_cast<uintptr_t>(0x1000 + i)) ;
+}
+
+int main() {
+	zketch_init() ;
+	logger::info("event size : ", sizeof(Event), " bytes, ", 64 / sizeof(Event), "+ per cache line") ;
+
+	// ten windows taking turns, the registry lookup is on every push and every GetHandle
+	int64_t sum = 0 ;
+	auto t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t r = 0 ; r < ___ROUNDS___ ; ++r) {
+		for (uint32_t i = 0 ; i < ___BURST___ ; ++i) {
+			EventSystem::PushEvent(Event::CreateKeyEvent(WindowOf(i % 10), KeyState::Down, i)) ;
+		}
+		ForEachEvent([&](const Event& e) {
+			sum += reinterpret_cast<uintptr_t>(e.GetHandle()) + e.GetKeyCode() ;
+		}) ;
+	}
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (static_cast<double>(___ROUNDS___) * ___BURST___) ;
+	logger::info("push + poll : ", ns, " ns per event (checksum ", sum, ")") ;
+
+	// the registry alone: an id per push, a pointer back per poll
+	uint32_t ids = 0 ;
+	t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t i = 0 ; i < ___ROUNDS___ * ___BURST___ ; ++i) {
+		ids += WindowRegistry::Acquire(WindowOf(i % 10)) ;
+	}
+	const double acquire_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (static_cast<double>(___ROUNDS___) * ___BURST___) ;
+
+	WindowId window_ids[10] ;
+	for (uint32_t i = 0 ; i < 10 ; ++i) {
+		window_ids[i] = WindowRegistry::Acquire(WindowOf(i)) ;
+	}
+
+	uintptr_t resolved = 0 ;
+	t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t i = 0 ; i < ___ROUNDS___ * ___BURST___ ; ++i) {
+		resolved += reinterpret_cast<uintptr_t>(WindowRegistry::Resolve(window_ids[i % 10])) ;
+	}
+	const double resolve_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (static_cast<double>(___ROUNDS___) * ___BURST___) ;
+	logger::info("registry : ", acquire_ns, " ns per acquire over 10 windows, ", resolve_ns, " ns per resolve (checksum ", ids + resolved, ")") ;
+
+	// a window closed with input still queued
+	auto a = std::make_unique<Window>(std::make_unique<HeadlessBackend>("a", 320, 240)) ;
+	Window b(std::make_unique<HeadlessBackend>("b", 320, 240)) ;
+	for (int32_t i = 0 ; i < 8 ; ++i) {
+		EventSystem::PushEvent(Event::CreateMouseEvent(a->GetHandle(), MouseButton::Left, MouseState::Down, {i, i})) ;
+		EventSystem::PushEvent(Event::CreateMouseEvent(b.GetHandle(), MouseButton::Left, MouseState::Down, {i, i})) ;
+	}
+	const HWND closed = a->GetHandle() ;
+	a.reset() ;
+
+	uint32_t stale = 0, live = 0, wrong = 0 ;
+	ForEachEvent([&](const Event& e) {
+		if (!e.GetHandle()) {
+			++stale ;
+		} else {
+			++live ;
+			wrong += e.GetHandle() == closed ? 1 : 0 ;
+		}
+	}, EventMask::Mouse) ;
+	logger::info("closed window : ", stale, " stale, ", live, " live, ", wrong, " for the closed one") ;
+
+	// a slider destroyed with its change still queued
+	auto slider = std::make_unique<Slider>(Slider::Horizontal, RectF{0.0f, 0.0f, 200.0f, 20.0f}, SizeF{10.0f, 20.0f}) ;
+	Slider kept(Slider::Horizontal, RectF{0.0f, 40.0f, 200.0f, 20.0f}, SizeF{10.0f, 20.0f}) ;
+	EventSystem::PushEvent(Event::CreateSliderEvent(SliderState::Changed, 0.5f, slider->GetWidgetId())) ;
+	EventSystem::PushEvent(Event::CreateSliderEvent(SliderState::Changed, 0.7f, kept.GetWidgetId())) ;
+	slider.reset() ;
+
+	uint32_t sliders_ok = 0 ;
+	ForEachEvent([&](const Event& e) {
+		logger::info("slider event : value ", e.GetSliderValue(), ", id ", e.GetWidgetId(), ", ", e.GetSliderAddress() == &kept ? "the kept slider" : e.GetSliderAddress() ? "DANGLING" : "null") ;
+		sliders_ok += (e.GetSliderValue() == 0.5f && !e.GetSliderAddress()) || (e.GetSliderValue() == 0.7f && e.GetSliderAddress() == &kept) ? 1 : 0 ;
+	}, EventMask::Slider) ;
+	return stale == 8 && live == 8 && wrong == 0 && sliders_ok == 2 ? 0 : 1 ;
+}
@@ -0,0 +1,94 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// a whole frame on a headless window without a window system: shapes drawn by the Renderer, a
+// click injected and polled back, the presented frame read and checked pixel by pixel. Exits non
+// zero on the first pixel that is off, so it runs as a test wherever the library builds.
+static uint32_t PixelAt(const Canvas& frame, int32_t x, int32_t y) {
+	uint32_t argb = 0 ;
+	pixel::ConvertRow(frame.GetRow(static_cast<uint32_t>(y)) + x * BytesPerPixel(frame.GetFormat()), frame.GetFormat(), reinterpret_cast<uint8_t*>(&argb), ColorFormat::ARGB, 1) ;
+	return argb | 0xFF000000u ;
+}
+
+int main() {
+	zketch_init() ;
+
+	auto backend = std::make_unique<HeadlessBackend>("zketch headless", 320, 240) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+	window.Show() ;
+
+	headless->SendMouse(MouseButton::Left, MouseState::Down, {40, 50}) ;
+	Point clicked {-1, -1} ;
+	Event e ;
+	while (PollEvent(e)) {
+		if (e.IsMouseEvent() && e.GetMouseState() == MouseState::Down && e.GetHandle() == window.GetHandle()) {
+			clicked = e.GetMousePosition() ;
+		}
+	}
+
+	Renderer renderer ;
+	if (!renderer.Begin(window)) {
+		logger::error("headless : Renderer::Begin failed") ;
+		return 1 ;
+	}
+	renderer.Clear(rgba(20, 20, 20, 1)) ;
+	renderer.FillRect({clicked.x - 20, clicked.y - 20, 40, 40}, rgba(200, 40, 40, 1)) ;
+	renderer.FillCircle({240, 120}, 50.0f, rgba(40, 200, 40, 1)) ;
+	renderer.DrawLine({0, 200}, {319, 200}, rgba(40, 40, 200, 1), 3.0f) ;
+	renderer.FillRect({100, 150, 60, 60}, rgba(255, 255, 255, 0.5f)) ;
+	renderer.DrawString(L"Hi", {10, 10}, rgba(255, 255, 255, 1), Font()) ;
+	renderer.End() ;
+	window.Present() ;
+
+	const Canvas frame = headless->GetLastFrame() ;
+	if (!frame.IsValid() || frame.GetWidth() != 320 || frame.GetHeight() != 240) {
+		logger::error("headless : nothing presented") ;
+		return 1 ;
+	}
+
+	struct Probe {
+		const char* what_ ;
+		Point at_ ;
+		uint32_t expected_ ;
+	} ;
+
+	std::vector<Probe> probes = {
+		{"background", {5, 5}, 0xFF141414u},
+		{"clicked rect", {40, 50}, 0xFFC82828u},
+		{"rect edge", {59, 69}, 0xFFC82828u},
+		{"outside rect", {60, 70}, 0xFF141414u},
+		{"circle", {240, 120}, 0xFF28C828u},
+		{"circle rim", {240, 73}, 0xFF28C828u},
+		{"outside circle", {290, 75}, 0xFF141414u},
+		{"line", {10, 200}, 0xFF2828C8u},
+		{"half white", {130, 160}, 0xFF8A8A8Au},
+	} ;
+
+	#ifdef ZKETCH_SOFTGDI
+		// the built in glyphs at 1x: the stem of 'H', the space after it, the dot of 'i' and the gap under it
+		probes.push_back({"H stem", {10, 12}, 0xFFFFFFFFu}) ;
+		probes.push_back({"after H", {15, 12}, 0xFF141414u}) ;
+		probes.push_back({"i dot", {18, 10}, 0xFFFFFFFFu}) ;
+		probes.push_back({"under i dot", {18, 11}, 0xFF141414u}) ;
+	#endif
+
+	int32_t failed = 0 ;
+	for (const Probe& p : probes) {
+		const uint32_t got = PixelAt(frame, p.at_.x, p.at_.y) ;
+		// one step either way per channel, blending rounds
+		bool ok = true ;
+		for (uint32_t shift = 0 ; shift < 24 ; shift += 8) {
+			const int32_t d = static_cast<int32_t>((got >> shift) & 0xFF) - static_cast<int32_t>((p.expected_ >> shift) & 0xFF) ;
+			ok = ok && std::abs(d) <= 1 ;
+		}
+
+		if (!ok) {
+			logger::error("headless : ", p.what_, " at ", p.at_.x, ", ", p.at_.y, " is ", reinterpret_cast<void*>(static_cast<uintptr_t>(got)), " instead of ", reinterpret_cast<void*>(static_cast<uintptr_t>(p.expected_))) ;
+			++failed ;
+		}
+	}
+
+	logger::info("headless : click at ", clicked.x, ", ", clicked.y, ", ", headless->GetPresentCount(), " frame presented, ", probes.size() - failed, "/", probes.size(), " pixels as drawn") ;
+	return failed == 0 && clicked == Point{40, 50} ? 0 : 1 ;
+}
@@ -0,0 +1,70 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// what an X11Backend present costs at 1080p and 4K: full frames, then a quarter of the frame damaged,
+// put through MIT-SHM (or XPutImage where the server refuses to share). The clock stops after an
+// XSync, so the server has read every frame. Needs a display, scripts/run_x11.sh starts Xvfb with a
+// 4K screen for it. Without one it exits with 77, which ctest counts as skipped.
+static constexpr uint32_t ___FRAMES___ = 120 ;
+
+struct Result {
+	double presents_ ;	// per second
+	double mbytes_ ;	// copied and put, per second
+} ;
+
+static Result Measure(X11Backend& backend, std::vector<Canvas>& frames, const DamageList& damage, uint64_t bytes_per_frame) {
+	// one unmeasured round so the image exists and the window is mapped
+	backend.Present(frames[0], damage) ;
+	XSync(X11Display::Get(), 0) ;
+
+	auto t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t i = 0 ; i < ___FRAMES___ ; ++i) {
+		backend.Present(frames[i % frames.size()], damage) ;
+	}
+	XSync(X11Display::Get(), 0) ;
+	const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() ;
+	return {___FRAMES___ / s, static_cast<double>(bytes_per_frame) * ___FRAMES___ / s / 1e6} ;
+}
+
+int main() {
+	Display* probe = XOpenDisplay(nullptr) ;
+	if (!probe) {
+		logger::warning("x11 present : no display, skipped (run it through scripts/run_x11.sh)") ;
+		return 77 ;
+	}
+	XCloseDisplay(probe) ;
+
+	const Size sizes[] = {{1920, 1080}, {3840, 2160}} ;
+	for (const Size& size : sizes) {
+		X11Backend backend("zketch x11 present", static_cast<int32_t>(size.x), static_cast<int32_t>(size.y)) ;
+		if (!backend.GetHandle()) {
+			logger::error("x11 present : no window at ", size.x, "x", size.y) ;
+			return 1 ;
+		}
+		backend.Show() ;
+
+		// two frames of different content, so nothing can be skipped as unchanged
+		std::vector<Canvas> frames(2) ;
+		for (size_t i = 0 ; i < frames.size() ; ++i) {
+			if (!frames[i].Create(size, ColorFormat::XRGB)) {
+				logger::error("x11 present : out of memory at ", size.x, "x", size.y) ;
+				return 1 ;
+			}
+			const CanvasRows rows = frames[i].GetRows() ;
+			for (uint32_t y = 0 ; y < size.y ; ++y) {
+				std::memset(rows[y], i ? 0x60 : 0xA0, static_cast<size_t>(size.x) * 4) ;
+			}
+		}
+
+		DamageList full ;
+		full.SetAll(size) ;
+		const Result all = Measure(backend, frames, full, static_cast<uint64_t>(size.x) * size.y * 4) ;
+
+		DamageList quarter ;
+		quarter.Add(Rect{0, 0, static_cast<int32_t>(size.x / 2), static_cast<int32_t>(size.y / 2)}, size) ;
+		const Result part = Measure(backend, frames, quarter, static_cast<uint64_t>(size.x / 2) * (size.y / 2) * 4) ;
+
+		logger::info("x11 present ", size.x, "x", size.y, (backend.IsShm() ? " (MIT-SHM)" : " (XPutImage)"), " : full ", all.presents_, " presents/s, ", all.mbytes_, " MB/s ; quarter ", part.presents_, " presents/s, ", part.mbytes_, " MB/s") ;
+	}
+	return 0 ;
+}
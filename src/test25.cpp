@@ -0,0 +1,62 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// a WindowRenderPool drawing 13 headless windows on 8 threads for 2000 frames. Every window gets its
+// own color each frame, afterwards every window has to be drawn exactly once per frame and show the
+// color of the frame that was just presented. Exits non zero otherwise. Build it with ZKETCH_TSAN
+// to have the pool's handshake checked by ThreadSanitizer on top.
+static constexpr uint32_t ___WINDOWS___ = 13 ;
+static constexpr uint32_t ___THREADS___ = 8 ;
+static constexpr uint32_t ___FRAMES___ = 2000 ;
+
+// 0xRRGGBB for a window in a frame
+static uint32_t ColorOf(uint32_t frame, uint32_t window) {
+	return (((frame * 7 + window) & 0xFF) << 16) | (((window * 19) & 0xFF) << 8) | ((frame * 3) & 0xFF) ;
+}
+
+int main() {
+	zketch_init() ;
+
+	std::vector<HeadlessBackend*> backends ;
+	std::vector<std::unique_ptr<Window>> windows ;
+	std::vector<Window*> order ;
+	for (uint32_t i = 0 ; i < ___WINDOWS___ ; ++i) {
+		auto backend = std::make_unique<HeadlessBackend>("zketch render pool", 64 + i * 8, 48 + i * 4) ;
+		backends.push_back(backend.get()) ;
+		windows.push_back(std::make_unique<Window>(std::move(backend))) ;
+		windows.back()->Show() ;
+		order.push_back(windows.back().get()) ;
+	}
+
+	WindowRenderPool pool(___THREADS___) ;
+	std::vector<std::atomic<uint32_t>> draws(___WINDOWS___) ;
+	std::atomic<uint32_t> frame {0} ;
+	uint64_t wrong_count = 0 ;
+	uint64_t wrong_pixels = 0 ;
+
+	auto t0 = std::chrono::steady_clock::now() ;
+	for (uint32_t f = 0 ; f < ___FRAMES___ ; ++f) {
+		frame.store(f, std::memory_order_relaxed) ;
+		const size_t drawn = pool.Render(order, [&](Renderer& renderer, Window& window) {
+			const uint32_t i = static_cast<uint32_t>(std::find(order.begin(), order.end(), &window) - order.begin()) ;
+			draws[i].fetch_add(1, std::memory_order_relaxed) ;
+			const uint32_t c = ColorOf(frame.load(std::memory_order_relaxed), i) ;
+			renderer.Clear(rgba(static_cast<uint8_t>(c >> 16), static_cast<uint8_t>(c >> 8), static_cast<uint8_t>(c), 1)) ;
+		}) ;
+
+		wrong_count += drawn == ___WINDOWS___ ? 0 : 1 ;
+		for (uint32_t i = 0 ; i < ___WINDOWS___ ; ++i) {
+			wrong_count += draws[i].load(std::memory_order_relaxed) == f + 1 ? 0 : 1 ;
+
+			const Canvas last = backends[i]->GetLastFrame() ;
+			uint32_t argb = 0 ;
+			pixel::ConvertRow(last.GetRow(last.GetHeight() - 1) + (last.GetWidth() - 1) * BytesPerPixel(last.GetFormat()), last.GetFormat(), reinterpret_cast<uint8_t*>(&argb), ColorFormat::ARGB, 1) ;
+			wrong_pixels += (argb & 0x00FFFFFFu) == ColorOf(f, i) ? 0 : 1 ;
+		}
+	}
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+
+	logger::info("render pool : ", ___WINDOWS___, " windows, ", pool.GetThreadCount(), " threads, ", ___FRAMES___, " frames in ", ms, " ms") ;
+	logger::info("              ", wrong_count, " frames with a window drawn other than once, ", wrong_pixels, " windows showing the wrong frame") ;
+	return wrong_count == 0 && wrong_pixels == 0 ? 0 : 1 ;
+}
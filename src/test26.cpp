@@ -0,0 +1,111 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// records 300 frames of a 1080p headless window through Window::SetRecorder: one full frame, then a
+// small rect moving every frame like a cursor or a spinner would, as fast as the loop can draw. Reports
+// what Capture cost the loop, what encoding cost the recorder's thread and how fast the file decodes,
+// then reads every frame back in order and out of order and compares it with what was presented.
+// Exits non zero on a mismatch.
+static constexpr uint32_t ___FRAMES___ = 300 ;
+
+// FNV-1a over the pixels as ARGB with alpha left out, so any format both sides store compares
+static uint64_t Hash(const uint8_t* pixels, uint32_t stride, uint32_t width, uint32_t height, ColorFormat format, std::vector<uint32_t>& row) {
+	uint64_t h = 1469598103934665603ull ;
+	row.resize(width) ;
+	for (uint32_t y = 0 ; y < height ; ++y) {
+		pixel::ConvertRow(pixels + static_cast<size_t>(y) * stride, format, reinterpret_cast<uint8_t*>(row.data()), ColorFormat::ARGB, width) ;
+		for (uint32_t argb : row) {
+			h = (h ^ (argb & 0x00FFFFFFu)) * 1099511628211ull ;
+		}
+	}
+	return h ;
+}
+
+int main(int argc, char** argv) {
+	zketch_init() ;
+	const std::string path = argc > 1 ? argv[1] : "zketch-capture.zkc" ;
+
+	auto backend = std::make_unique<HeadlessBackend>("zketch capture", 1920, 1080) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+	window.Show() ;
+
+	FrameRecorder recorder ;
+	if (!recorder.Open(path)) {
+		logger::error("capture : can't open ", path) ;
+		return 1 ;
+	}
+	window.SetRecorder(&recorder) ;
+
+	Renderer renderer ;
+	std::vector<uint64_t> presented ;
+	std::vector<uint32_t> row ;
+	for (uint32_t f = 0 ; f < ___FRAMES___ ; ++f) {
+		if (!renderer.Begin(window)) {
+			logger::error("capture : Renderer::Begin failed") ;
+			return 1 ;
+		}
+		if (f == 0) {
+			renderer.Clear(rgba(24, 24, 32, 1)) ;
+		}
+		const int32_t x = static_cast<int32_t>(f * 6 % 1800) ;
+		renderer.FillRect({x, 500, 64, 64}, rgba(static_cast<uint8_t>(f), 160, 90, 1)) ;
+		renderer.End() ;
+
+		window.Present() ;
+
+		const Canvas frame = headless->GetLastFrame() ;
+		presented.push_back(Hash(frame.GetRow(0), frame.GetStride(), frame.GetWidth(), frame.GetHeight(), frame.GetFormat(), row)) ;
+	}
+
+	window.SetRecorder(nullptr) ;
+	const RecorderStats stats = recorder.GetStats() ;
+	recorder.Close() ;
+
+	CaptureReader reader ;
+	if (!reader.Open(path)) {
+		logger::error("capture : ", path, " doesn't read back") ;
+		return 1 ;
+	}
+
+	const auto t0 = std::chrono::steady_clock::now() ;
+	for (size_t i = 0 ; i < reader.GetFrameCount() ; ++i) {
+		reader.Seek(i) ;
+	}
+	const double decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+
+	// a dropped frame is folded into the next one, so the recording is the presented frames with a
+	// few left out: in order, every decoded frame has to be one presented after the one before it
+	std::vector<uint64_t> decoded ;
+	size_t mismatched = 0 ;
+	size_t next = 0 ;
+	const size_t count = reader.GetFrameCount() ;
+	for (size_t i = 0 ; i < count ; ++i) {
+		const ImageView view = reader.Seek(i) ? reader.GetFrame() : ImageView {} ;
+		decoded.push_back(view.IsValid() ? Hash(view.pixels_, view.stride_, view.width_, view.height_, view.format_, row) : 0) ;
+		while (next < presented.size() && presented[next] != decoded.back()) {
+			++next ;
+		}
+		mismatched += next < presented.size() ? 0 : 1 ;
+		next = next < presented.size() ? next + 1 : next ;
+	}
+
+	// then every frame again, in an order that jumps back and forth across key frames
+	for (size_t k = 0 ; k < count ; ++k) {
+		const size_t i = k * 7919 % count ;
+		const ImageView view = reader.Seek(i) ? reader.GetFrame() : ImageView {} ;
+		mismatched += view.IsValid() && Hash(view.pixels_, view.stride_, view.width_, view.height_, view.format_, row) == decoded[i] ? 0 : 1 ;
+	}
+
+	logger::info("capture   : ", stats.frames_, " frames, ", stats.key_frames_, " key, ", stats.dropped_, " dropped, ", stats.file_bytes_, " bytes on disk") ;
+	logger::info("caller    : ", std::chrono::duration<double, std::milli>(stats.GetAverageCaptureTime()).count(), " ms per Capture") ;
+	logger::info("encoder   : ", stats.frames_ ? std::chrono::duration<double, std::milli>(stats.encode_time_).count() / stats.frames_ : 0.0, " ms per frame") ;
+	logger::info("decode    : ", count ? decode_ms / count : 0.0, " ms per frame") ;
+	logger::info("check     : ", mismatched, " mismatches over ", count, " frames in order and ", count, " seeks out of order") ;
+
+	// a path given on the command line keeps the file, for zkdump
+	if (argc < 2) {
+		std::remove(path.c_str()) ;
+	}
+	return count == stats.frames_ && mismatched == 0 ? 0 : 1 ;
+}
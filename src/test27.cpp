@@ -0,0 +1,316 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// encodes a 4K and a 1080p frame of UI-like content, flat panels with a gradient and a noisy photo
+// like area, to memory as QOI, PNG and PPM, from ARGB and XRGB canvases. Reports the best of a few
+// runs per format, then decodes every output and compares it with the canvas. Exits non zero when
+// one doesn't read back as the pixels it was made from. The readers are the formats' specs written
+// out, nothing of codec's. Then checks codec::Crc32 against a bit at a time CRC on every length up
+// to 300 at 16 offsets and times it on 16 MiB.
+static constexpr uint32_t ___RUNS___ = 5 ;
+
+static void Fill(Canvas& canvas) {
+	const uint32_t w = canvas.GetWidth() ;
+	const uint32_t h = canvas.GetHeight() ;
+	uint32_t seed = 0x1234567u ;
+	const CanvasRows rows = canvas.GetRows() ;
+	for (uint32_t y = 0 ; y < h ; ++y) {
+		uint32_t* row = reinterpret_cast<uint32_t*>(rows[y]) ;
+		for (uint32_t x = 0 ; x < w ; ++x) {
+			uint32_t p = 0xFF202028u ;
+			if (y < h / 20) {
+				p = 0xFF3050A0u ;
+			} else if (x < w / 6) {
+				p = (y / 40) % 2 ? 0xFF2A2A34u : 0xFF30303Cu ;
+			} else if (y < h / 2) {
+				p = 0xFF000000u | ((x * 255 / w) << 16) | ((y * 255 / h) << 8) | 0x80 ;
+			} else if (x > w / 2 && y > h * 2 / 3) {
+				seed = seed * 1664525u + 1013904223u ;
+				p = 0xFF000000u | (seed >> 8) ;
+			}
+			row[x] = p ;
+		}
+	}
+}
+
+struct Decoded {
+	uint32_t width_ = 0 ;
+	uint32_t height_ = 0 ;
+	uint32_t channels_ = 0 ;
+	std::vector<uint32_t> argb_ ;
+} ;
+
+static uint32_t ReadU32BE(const uint8_t* p) {
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3] ;
+}
+
+// the QOI spec's decoder written out, none of codec's QoiState: ops in the order the spec lists
+// them, the index and the previous pixel kept the way it describes them
+static bool DecodeQoi(const std::vector<uint8_t>& data, Decoded& out) {
+	static constexpr uint8_t ___END___[8] = {0, 0, 0, 0, 0, 0, 0, 1} ;
+	if (data.size() < 22 || memcmp(data.data(), "qoif", 4) != 0 || memcmp(data.data() + data.size() - 8, ___END___, 8) != 0) {
+		return false ;
+	}
+	out.width_ = ReadU32BE(data.data() + 4) ;
+	out.height_ = ReadU32BE(data.data() + 8) ;
+	out.channels_ = data[12] ;
+	if ((out.channels_ != 3 && out.channels_ != 4) || data[13] > 1) {
+		return false ;
+	}
+	out.argb_.resize(static_cast<size_t>(out.width_) * out.height_) ;
+
+	uint8_t index[64][4] {} ;
+	uint8_t r = 0, g = 0, b = 0, a = 255 ;
+	size_t at = 14 ;
+	const size_t end = data.size() - 8 ;
+	for (size_t i = 0 ; i < out.argb_.size() ; ) {
+		if (at >= end) {
+			return false ;
+		}
+		const uint8_t op = data[at++] ;
+		uint32_t run = 1 ;
+		if (op == 0xFE || op == 0xFF) {
+			if (at + (op == 0xFF ? 4 : 3) > end) {
+				return false ;
+			}
+			r = data[at++] ;
+			g = data[at++] ;
+			b = data[at++] ;
+			if (op == 0xFF) {
+				a = data[at++] ;
+			}
+		} else if ((op >> 6) == 0) {
+			r = index[op][0] ;
+			g = index[op][1] ;
+			b = index[op][2] ;
+			a = index[op][3] ;
+		} else if ((op >> 6) == 1) {
+			r = static_cast<uint8_t>(r + ((op >> 4) & 3) - 2) ;
+			g = static_cast<uint8_t>(g + ((op >> 2) & 3) - 2) ;
+			b = static_cast<uint8_t>(b + (op & 3) - 2) ;
+		} else if ((op >> 6) == 2) {
+			if (at >= end) {
+				return false ;
+			}
+			const int32_t dg = (op & 0x3F) - 32 ;
+			const uint8_t next = data[at++] ;
+			r = static_cast<uint8_t>(r + dg + (next >> 4) - 8) ;
+			g = static_cast<uint8_t>(g + dg) ;
+			b = static_cast<uint8_t>(b + dg + (next & 0xF) - 8) ;
+		} else {
+			run = (op & 0x3F) + 1u ;
+		}
+
+		if (i + run > out.argb_.size()) {
+			return false ;
+		}
+		const uint32_t px = (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b ;
+		for (uint32_t k = 0 ; k < run ; ++k) {
+			out.argb_[i++] = px ;
+		}
+		uint8_t* slot = index[(r * 3 + g * 5 + b * 7 + a * 11) % 64] ;
+		slot[0] = r ;
+		slot[1] = g ;
+		slot[2] = b ;
+		slot[3] = a ;
+	}
+	// every byte up to the end marker belongs to a pixel
+	return at == end ;
+}
+
+// bit at a time, what the PNG and zlib specs print, to check codec's folded and sliced ones against
+static uint32_t Crc32(const uint8_t* data, size_t size) {
+	uint32_t crc = 0xFFFFFFFFu ;
+	while (size--) {
+		crc ^= *data++ ;
+		for (int32_t k = 0 ; k < 8 ; ++k) {
+			crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1 ;
+		}
+	}
+	return ~crc ;
+}
+
+static uint32_t Adler32(const uint8_t* data, size_t size) {
+	uint32_t s1 = 1 ;
+	uint32_t s2 = 0 ;
+	while (size--) {
+		s1 = (s1 + *data++) % 65521 ;
+		s2 = (s2 + s1) % 65521 ;
+	}
+	return (s2 << 16) | s1 ;
+}
+
+// walks the chunks checking every CRC, then reads the stored deflate blocks back and checks the Adler
+static bool DecodePng(const std::vector<uint8_t>& data, Decoded& out) {
+	const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'} ;
+	if (data.size() < 8 || memcmp(data.data(), signature, 8) != 0) {
+		return false ;
+	}
+
+	std::vector<uint8_t> zlib ;
+	bool ended = false ;
+	for (size_t at = 8 ; at + 12 <= data.size() && !ended ; ) {
+		const uint32_t size = ReadU32BE(data.data() + at) ;
+		const uint8_t* type = data.data() + at + 4 ;
+		if (at + 12 + size > data.size() || Crc32(type, size + 4) != ReadU32BE(type + 4 + size)) {
+			return false ;
+		}
+
+		if (memcmp(type, "IHDR", 4) == 0) {
+			out.width_ = ReadU32BE(type + 4) ;
+			out.height_ = ReadU32BE(type + 8) ;
+			out.channels_ = type[13] == 6 ? 4 : type[13] == 2 ? 3 : 1 ;
+		} else if (memcmp(type, "IDAT", 4) == 0) {
+			zlib.insert(zlib.end(), type + 4, type + 4 + size) ;
+		} else if (memcmp(type, "IEND", 4) == 0) {
+			ended = true ;
+		}
+		at += 12 + size ;
+	}
+
+	const size_t line = 1 + static_cast<size_t>(out.width_) * out.channels_ ;
+	std::vector<uint8_t> raw ;
+	raw.reserve(line * out.height_) ;
+	size_t at = 2 ;
+	bool last = false ;
+	while (!last && at + 5 <= zlib.size()) {
+		last = zlib[at] & 1 ;
+		const uint32_t len = zlib[at + 1] | (static_cast<uint32_t>(zlib[at + 2]) << 8) ;
+		const uint32_t nlen = zlib[at + 3] | (static_cast<uint32_t>(zlib[at + 4]) << 8) ;
+		if ((zlib[at] & 6) != 0 || (len ^ nlen) != 0xFFFF || at + 5 + len > zlib.size()) {
+			return false ;
+		}
+		raw.insert(raw.end(), zlib.begin() + static_cast<ptrdiff_t>(at + 5), zlib.begin() + static_cast<ptrdiff_t>(at + 5 + len)) ;
+		at += 5 + len ;
+	}
+
+	if (!ended || !last || at + 4 != zlib.size() || raw.size() != line * out.height_ || Adler32(raw.data(), raw.size()) != ReadU32BE(zlib.data() + at)) {
+		return false ;
+	}
+
+	out.argb_.resize(static_cast<size_t>(out.width_) * out.height_) ;
+	for (uint32_t y = 0 ; y < out.height_ ; ++y) {
+		const uint8_t* p = raw.data() + y * line ;
+		if (*p++ != 0) {
+			return false ;
+		}
+		for (uint32_t x = 0 ; x < out.width_ ; ++x, p += out.channels_) {
+			const uint32_t a = out.channels_ == 4 ? p[3] : 0xFF ;
+			out.argb_[static_cast<size_t>(y) * out.width_ + x] = (a << 24) | (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2] ;
+		}
+	}
+	return true ;
+}
+
+static bool DecodePpm(const std::vector<uint8_t>& data, Decoded& out) {
+	const std::string text(data.begin(), data.begin() + static_cast<ptrdiff_t>(std::min<size_t>(data.size(), 64))) ;
+	uint32_t max = 0 ;
+	int32_t header = 0 ;
+	if (std::sscanf(text.c_str(), "P6\n%u %u\n%u\n%n", &out.width_, &out.height_, &max, &header) != 3 || header == 0 || max != 255) {
+		return false ;
+	}
+	out.channels_ = 3 ;
+	if (data.size() != static_cast<size_t>(header) + static_cast<size_t>(out.width_) * out.height_ * 3) {
+		return false ;
+	}
+
+	out.argb_.resize(static_cast<size_t>(out.width_) * out.height_) ;
+	const uint8_t* p = data.data() + header ;
+	for (uint32_t& argb : out.argb_) {
+		argb = 0xFF000000u | (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2] ;
+		p += 3 ;
+	}
+	return true ;
+}
+
+// alpha only counts where the file kept it
+static bool Matches(const Canvas& canvas, const Decoded& decoded) {
+	if (decoded.width_ != canvas.GetWidth() || decoded.height_ != canvas.GetHeight()) {
+		return false ;
+	}
+
+	const uint32_t mask = decoded.channels_ == 4 ? 0xFFFFFFFFu : 0x00FFFFFFu ;
+	// the canvases are 32 bit, XRGB's alpha byte reads as opaque
+	const uint32_t opaque = canvas.GetFormat() == ColorFormat::XRGB ? 0xFF000000u : 0 ;
+	for (uint32_t y = 0 ; y < canvas.GetHeight() ; ++y) {
+		const uint32_t* row = reinterpret_cast<const uint32_t*>(canvas.GetRow(y)) ;
+		const uint32_t* got = decoded.argb_.data() + static_cast<size_t>(y) * decoded.width_ ;
+		for (uint32_t x = 0 ; x < canvas.GetWidth() ; ++x) {
+			if (((row[x] | opaque) ^ got[x]) & mask) {
+				return false ;
+			}
+		}
+	}
+	return true ;
+}
+
+int main() {
+	zketch_init() ;
+
+	const Size sizes[] = {{3840, 2160}, {1920, 1080}} ;
+	const ColorFormat formats[] = {ColorFormat::ARGB, ColorFormat::XRGB} ;
+	const ImageFormat images[] = {ImageFormat::QOI, ImageFormat::PNG, ImageFormat::PPM} ;
+	const char* names[] = {"qoi", "png", "ppm"} ;
+
+	uint32_t failed = 0 ;
+	for (const Size& size : sizes) {
+		for (ColorFormat format : formats) {
+			Canvas canvas ;
+			if (!canvas.Create(size, format)) {
+				logger::error("encoder : out of memory at ", size.x, "x", size.y) ;
+				return 1 ;
+			}
+			Fill(canvas) ;
+
+			for (size_t i = 0 ; i < std::size(images) ; ++i) {
+				MemoryWriter out ;
+				double best_ms = 1e9 ;
+				bool ok = true ;
+				for (uint32_t run = 0 ; run < ___RUNS___ ; ++run) {
+					out.Clear() ;
+					const auto t0 = std::chrono::steady_clock::now() ;
+					ok = canvas.Encode(out, images[i]) && ok ;
+					best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()) ;
+				}
+
+				Decoded decoded ;
+				const std::vector<uint8_t>& bytes = out.GetBuffer() ;
+				const bool read = images[i] == ImageFormat::QOI ? DecodeQoi(bytes, decoded) : images[i] == ImageFormat::PNG ? DecodePng(bytes, decoded) : DecodePpm(bytes, decoded) ;
+				const bool matched = ok && read && Matches(canvas, decoded) ;
+				failed += matched ? 0 : 1 ;
+
+				const double mbytes = static_cast<double>(size.x) * size.y * 4 / 1e6 ;
+				logger::info("encoder ", size.x, "x", size.y, format == ColorFormat::ARGB ? " argb " : " xrgb ", names[i], " : ", best_ms, " ms, ", mbytes / best_ms * 1e3, " MB/s in, ", bytes.size() / 1024, " KiB out, ", matched ? "reads back" : "MISMATCH") ;
+			}
+		}
+	}
+	// lengths either side of the 64 byte fold and its 16 byte steps, at every alignment
+	std::vector<uint8_t> bytes(16 << 20) ;
+	uint32_t seed = 0x2545F491u ;
+	for (uint8_t& b : bytes) {
+		seed = seed * 1664525u + 1013904223u ;
+		b = static_cast<uint8_t>(seed >> 24) ;
+	}
+	uint32_t crc_failed = 0 ;
+	for (size_t offset = 0 ; offset < 16 ; ++offset) {
+		for (size_t size = 0 ; size <= 300 ; ++size) {
+			crc_failed += codec::Crc32(0, bytes.data() + offset, size) == Crc32(bytes.data() + offset, size) ? 0 : 1 ;
+		}
+	}
+	// and a running CRC carried across calls the way PNG chunks are written
+	uint32_t running = codec::Crc32(0, bytes.data(), 1000) ;
+	running = codec::Crc32(running, bytes.data() + 1000, 4096 - 1000) ;
+	crc_failed += running == Crc32(bytes.data(), 4096) ? 0 : 1 ;
+
+	double crc_ms = 1e9 ;
+	uint32_t crc = 0 ;
+	for (uint32_t run = 0 ; run < ___RUNS___ ; ++run) {
+		const auto t0 = std::chrono::steady_clock::now() ;
+		crc = codec::Crc32(0, bytes.data(), bytes.size()) ;
+		crc_ms = std::min(crc_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()) ;
+	}
+	crc_failed += crc == Crc32(bytes.data(), bytes.size()) ? 0 : 1 ;
+	logger::info("crc32 : ", static_cast<double>(bytes.size()) / crc_ms / 1e6, " GB/s, ", crc_failed, " lengths off the reference") ;
+
+	return failed == 0 && crc_failed == 0 ? 0 : 1 ;
+}
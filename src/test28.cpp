@@ -0,0 +1,83 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// what a loop costs when there is nothing to draw. An idle FrameScheduler waits 2 s with a task
+// posted from another thread at 0.5 s and a PostDelayed timer due at 1 s, then the same loop capped
+// at 60 fps and one spinning uncapped, 1 s each. Reports frames and the loop thread's cpu for each.
+// Exits non zero when a task didn't run, the idle loop ran frames it had no reason to or the capped
+// one went past its cap or spun its waits away. Linux only.
+static double ThreadCpuMs() {
+	timespec ts {} ;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) ;
+	return static_cast<double>(ts.tv_sec) * 1e3 + static_cast<double>(ts.tv_nsec) / 1e6 ;
+}
+
+struct Run {
+	uint64_t frames_ ;
+	double cpu_ms_ ;
+	double wall_ms_ ;
+} ;
+
+static Run Loop(FrameScheduler& scheduler, std::chrono::milliseconds length) {
+	scheduler.ResetStats() ;
+	const double cpu0 = ThreadCpuMs() ;
+	const auto t0 = std::chrono::steady_clock::now() ;
+	const auto end = t0 + length ;
+
+	// the idle loop has a timer due at the end, so it wakes to notice it is over
+	bool done = false ;
+	if (scheduler.IsIdleMode()) {
+		scheduler.PostDelayed(length, [&done] { done = true ; }) ;
+	}
+
+	while (!done && std::chrono::steady_clock::now() < end) {
+		scheduler.BeginFrame() ;
+		Event e ;
+		while (PollEvent(e)) {}
+		scheduler.EndFrame() ;
+	}
+
+	return {scheduler.GetStats().frames_, ThreadCpuMs() - cpu0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()} ;
+}
+
+int main() {
+	zketch_init() ;
+
+	FrameScheduler scheduler ;
+	scheduler.SetIdleMode(true) ;
+
+	// the first frame is owed to the start, the loop draws once before it has nothing to do
+	scheduler.BeginFrame() ;
+	scheduler.EndFrame() ;
+
+	bool posted = false ;
+	bool delayed = false ;
+	scheduler.PostDelayed(std::chrono::seconds(1), [&delayed] { delayed = true ; }) ;
+	std::thread poster([&scheduler, &posted] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(500)) ;
+		scheduler.Post([&posted] { posted = true ; }) ;
+	}) ;
+
+	const Run idle = Loop(scheduler, std::chrono::seconds(2)) ;
+	poster.join() ;
+
+	scheduler.SetIdleMode(false) ;
+	scheduler.SetTargetFps(60.0) ;
+	const Run capped = Loop(scheduler, std::chrono::seconds(1)) ;
+
+	scheduler.SetTargetFps(0.0) ;
+	const Run spinning = Loop(scheduler, std::chrono::seconds(1)) ;
+
+	logger::info("idle     : ", idle.frames_, " frames in ", idle.wall_ms_, " ms, ", idle.cpu_ms_, " ms of cpu (post ", posted ? "ran" : "lost", ", timer ", delayed ? "ran" : "lost", ")") ;
+	logger::info("60 fps   : ", capped.frames_, " frames in ", capped.wall_ms_, " ms, ", capped.cpu_ms_, " ms of cpu") ;
+	logger::info("spinning : ", spinning.frames_, " frames in ", spinning.wall_ms_, " ms, ", spinning.cpu_ms_, " ms of cpu") ;
+
+	// idle: the post, the timer and the end, a spurious wake or two at most
+	const bool idle_ok = posted && delayed && idle.frames_ <= 5 ;
+	// the first frame runs right away and the last may start after the second is up, it waits for
+	// its slot
+	const bool capped_ok = static_cast<double>(capped.frames_) <= capped.wall_ms_ * 60.0 / 1000.0 + 2.0 ;
+	// the pacing sleep is one absolute clock_nanosleep, a frame that does nothing costs microseconds
+	const bool slept = capped.cpu_ms_ <= static_cast<double>(capped.frames_) * 0.25 ;
+	return idle_ok && capped_ok && slept ? 0 : 1 ;
+}
@@ -0,0 +1,98 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// async present switched off with a frame still in the mailbox: the present thread is held inside
+// the backend's Present with frame 1 while frame 2 is submitted, then the window goes back to
+// presenting itself. Frame 2 has to reach the output, and a frame drawn afterwards on top of it has
+// to start from frame 2's pixels. Exits non zero when a frame is lost or drawn on stale content.
+class HeldBackend : public HeadlessBackend {
+private :
+	std::mutex mutex_ ;
+	std::condition_variable cv_ ;
+	bool hold_ = true ;
+	uint32_t entered_ = 0 ;
+
+public :
+	HeldBackend(const char* title, int32_t width, int32_t height) noexcept : HeadlessBackend(title, width, height) {}
+
+	void Present(const Canvas& frame, const DamageList& damage) noexcept override {
+		{
+			std::unique_lock<std::mutex> lock(mutex_) ;
+			++entered_ ;
+			cv_.notify_all() ;
+			cv_.wait(lock, [this] { return !hold_ ; }) ;
+		}
+		HeadlessBackend::Present(frame, damage) ;
+	}
+
+	void WaitEntered(uint32_t count) noexcept {
+		std::unique_lock<std::mutex> lock(mutex_) ;
+		cv_.wait(lock, [this, count] { return entered_ >= count ; }) ;
+	}
+
+	void Release() noexcept {
+		{
+			std::lock_guard<std::mutex> lock(mutex_) ;
+			hold_ = false ;
+		}
+		cv_.notify_all() ;
+	}
+} ;
+
+static uint32_t PixelAt(const Canvas& frame, int32_t x, int32_t y) {
+	uint32_t argb = 0 ;
+	pixel::ConvertRow(frame.GetRow(static_cast<uint32_t>(y)) + x * BytesPerPixel(frame.GetFormat()), frame.GetFormat(), reinterpret_cast<uint8_t*>(&argb), ColorFormat::ARGB, 1) ;
+	return argb | 0xFF000000u ;
+}
+
+static bool Draw(Window& window, const Rect& rect, const Color& color) {
+	Renderer renderer ;
+	if (!renderer.Begin(window)) {
+		return false ;
+	}
+	renderer.FillRect(rect, color) ;
+	renderer.End() ;
+	return true ;
+}
+
+int main() {
+	zketch_init() ;
+
+	auto backend = std::make_unique<HeldBackend>("zketch async toggle", 160, 120) ;
+	HeldBackend* held = backend.get() ;
+	Window window(std::move(backend)) ;
+	window.Show() ;
+
+	if (!window.SetAsyncPresent(true)) {
+		logger::error("async toggle : SetAsyncPresent failed") ;
+		return 1 ;
+	}
+
+	// frame 1 red, the thread takes it and stays in Present. Frame 2 green waits in the mailbox.
+	bool drawn = Draw(window, {0, 0, 160, 120}, rgba(200, 40, 40, 1)) ;
+	held->WaitEntered(1) ;
+	drawn = Draw(window, {0, 0, 160, 120}, rgba(40, 200, 40, 1)) && drawn ;
+
+	// Stop asks the thread to end before frame 1's present returns, so it never takes frame 2
+	std::thread release([held] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100)) ;
+		held->Release() ;
+	}) ;
+	window.SetAsyncPresent(false) ;
+	release.join() ;
+
+	const uint64_t presents = held->GetPresentCount() ;
+	const uint32_t shown = PixelAt(held->GetLastFrame(), 80, 60) ;
+
+	// frame 3 only touches a corner, the rest comes from frame 2
+	drawn = Draw(window, {0, 0, 20, 20}, rgba(40, 40, 200, 1)) && drawn ;
+	window.Present() ;
+	const Canvas last = held->GetLastFrame() ;
+	const uint32_t corner = PixelAt(last, 5, 5) ;
+	const uint32_t rest = PixelAt(last, 80, 60) ;
+
+	logger::info("async toggle : ", presents, " presents when it stopped, center ", reinterpret_cast<void*>(static_cast<uintptr_t>(shown)), ", then corner ", reinterpret_cast<void*>(static_cast<uintptr_t>(corner)), " center ", reinterpret_cast<void*>(static_cast<uintptr_t>(rest))) ;
+
+	const bool ok = drawn && presents == 2 && shown == 0xFF28C828u && corner == 0xFF2828C8u && rest == 0xFF28C828u ;
+	return ok ? 0 : 1 ;
+}
@@ -0,0 +1,83 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// what a headless window pushes to its output per frame, presenting itself and then from the present
+// thread: a full frame, a frame that draws nothing and a frame that fills one 30x40 rect. Exits non
+// zero when the clean frame reaches the output or the partial one pushes pixels outside its rect and
+// the pixel of anti aliasing around it.
+
+// FillRect damages a pixel around what it fills for anti aliasing, the output gets ___DAMAGED___
+static constexpr Rect ___PARTIAL___ = {10, 20, 30, 40} ;
+static constexpr Rect ___DAMAGED___ = {9, 19, 32, 42} ;
+
+struct Step {
+	uint64_t presents_ ;
+	uint64_t pixels_ ;
+	uint64_t output_area_ ;	// of the damage the backend got with the last present
+	bool inside_ ;			// every rect it got lies in ___DAMAGED___
+} ;
+
+static bool Draw(Window& window, const Rect* rect) {
+	Renderer renderer ;
+	if (!renderer.Begin(window)) {
+		return false ;
+	}
+	if (rect) {
+		renderer.FillRect(*rect, rgba(200, 40, 40, 1)) ;
+	}
+	renderer.End() ;
+	return true ;
+}
+
+// draws one frame and presents it, waits for the present thread when there is one
+static Step Frame(Window& window, HeadlessBackend& headless, const Rect* rect, bool expect_present) {
+	const uint64_t before = headless.GetPresentCount() ;
+	window.ResetPresentStats() ;
+	Draw(window, rect) ;
+	window.Present() ;
+
+	const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(2) ;
+	while (expect_present && headless.GetPresentCount() == before && std::chrono::steady_clock::now() < give_up) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1)) ;
+	}
+	// a present that shouldn't happen gets the time to show up anyway
+	if (!expect_present) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20)) ;
+	}
+
+	const PresentStats stats = window.GetPresentStats() ;
+	const DamageList damage = headless.GetLastDamage() ;
+	bool inside = true ;
+	for (const Rect& r : damage) {
+		inside = inside && r.x >= ___DAMAGED___.x && r.y >= ___DAMAGED___.y && r.x + r.w <= ___DAMAGED___.x + ___DAMAGED___.w && r.y + r.h <= ___DAMAGED___.y + ___DAMAGED___.h ;
+	}
+	return {headless.GetPresentCount() - before, stats.pixels_, damage.GetArea(), inside} ;
+}
+
+static bool Run(const char* name, bool async) {
+	auto backend = std::make_unique<HeadlessBackend>("zketch damage", 320, 240) ;
+	HeadlessBackend* headless = backend.get() ;
+	Window window(std::move(backend)) ;
+	window.Show() ;
+	window.SetAsyncPresent(async) ;
+
+	const Rect all = {0, 0, 320, 240} ;
+	const Step full = Frame(window, *headless, &all, true) ;
+	const Step clean = Frame(window, *headless, nullptr, false) ;
+	const Step partial = Frame(window, *headless, &___PARTIAL___, true) ;
+	window.SetAsyncPresent(false) ;
+
+	logger::info(name, " : full ", full.presents_, " present ", full.pixels_, " px, clean ", clean.presents_, " present ", clean.pixels_, " px, partial ", partial.presents_, " present ", partial.pixels_, " px (", partial.output_area_, " px in the rects the output got)") ;
+
+	const uint64_t area = static_cast<uint64_t>(___DAMAGED___.w) * ___DAMAGED___.h ;
+	return full.presents_ == 1 && full.pixels_ == 320 * 240
+		&& clean.presents_ == 0 && clean.pixels_ == 0
+		&& partial.presents_ == 1 && partial.pixels_ == area && partial.output_area_ == area && partial.inside_ ;
+}
+
+int main() {
+	zketch_init() ;
+	const bool sync = Run("sync present ", false) ;
+	const bool async = Run("async present", true) ;
+	return sync && async ? 0 : 1 ;
+}
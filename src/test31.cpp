@@ -0,0 +1,172 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// the copy X11Backend::Present does into the server's image, without a server: a 41x23 XRGB frame
+// copied into images of every layout an X server may ask for (32 bit XRGB, BGR and MSB first, 24
+// and 16 bit, 10 bit channels), through rects that stick out of the frame and of an image smaller
+// than it. Each image is read back with a reference that builds pixels bit by bit. Exits non zero
+// when a pixel is off, a byte outside the copied rect was touched, or a layout X11Backend can't
+// draw is taken as supported.
+static constexpr uint32_t ___WIDTH___ = 41 ;
+static constexpr uint32_t ___HEIGHT___ = 23 ;
+static constexpr uint8_t ___UNTOUCHED___ = 0xCD ;
+
+// an 8 bit channel as bits wide: its top bits when narrower, its bit pattern repeated when wider
+static uint32_t Reference(uint32_t v, uint32_t bits) {
+	uint32_t out = 0 ;
+	for (uint32_t j = 0 ; j < bits ; ++j) {
+		out = (out << 1) | ((v >> (7 - j % 8)) & 1) ;
+	}
+	return out ;
+}
+
+static uint32_t Shift(uint32_t mask) {
+	uint32_t shift = 0 ;
+	while (!((mask >> shift) & 1)) {
+		++shift ;
+	}
+	return shift ;
+}
+
+static uint32_t Bits(uint32_t mask) {
+	uint32_t bits = 0 ;
+	for (mask >>= Shift(mask) ; mask & 1 ; mask >>= 1) {
+		++bits ;
+	}
+	return bits ;
+}
+
+struct Layout {
+	const char* name_ ;
+	X11PixelFormat format_ ;
+} ;
+
+static bool Check(const Canvas& frame, const Layout& layout, const Rect& rect, uint32_t width, uint32_t height, const Rect& expected, uint64_t& pixels) {
+	const X11PixelFormat& f = layout.format_ ;
+	const size_t stride = static_cast<size_t>(width) * f.bytes_ + 7 ;	// padded like bytes_per_line may be
+	std::vector<uint8_t> image(stride * height, ___UNTOUCHED___) ;
+
+	const Rect copied = X11CopyRect(frame, rect, image.data(), stride, width, height, f) ;
+	if (copied.x != expected.x || copied.y != expected.y || copied.w != expected.w || copied.h != expected.h) {
+		logger::error("x11 convert : ", layout.name_, " copied ", copied.x, ",", copied.y, " ", copied.w, "x", copied.h, " instead of ", expected.x, ",", expected.y, " ", expected.w, "x", expected.h) ;
+		return false ;
+	}
+
+	for (uint32_t y = 0 ; y < height ; ++y) {
+		for (size_t at = 0 ; at < stride ; ++at) {
+			const uint8_t* p = image.data() + y * stride + at ;
+			const uint32_t x = static_cast<uint32_t>(at / f.bytes_) ;
+			const bool inside = at < static_cast<size_t>(width) * f.bytes_ && static_cast<int32_t>(x) >= copied.x && static_cast<int32_t>(x) < copied.x + static_cast<int32_t>(copied.w) && static_cast<int32_t>(y) >= copied.y && static_cast<int32_t>(y) < copied.y + static_cast<int32_t>(copied.h) ;
+			if (!inside) {
+				if (*p != ___UNTOUCHED___) {
+					logger::error("x11 convert : ", layout.name_, " wrote byte ", at, " of row ", y, " outside the rect") ;
+					return false ;
+				}
+				continue ;
+			}
+			if (at % f.bytes_ != 0) {
+				continue ;
+			}
+
+			uint32_t value = 0 ;
+			for (uint32_t i = 0 ; i < f.bytes_ ; ++i) {
+				value |= static_cast<uint32_t>(p[i]) << (8 * (f.msb_first_ ? f.bytes_ - 1 - i : i)) ;
+			}
+
+			const uint32_t xrgb = reinterpret_cast<const uint32_t*>(frame.GetRow(y))[x] ;
+			const uint32_t want = (Reference((xrgb >> 16) & 0xFF, Bits(f.red_mask_)) << Shift(f.red_mask_))
+				| (Reference((xrgb >> 8) & 0xFF, Bits(f.green_mask_)) << Shift(f.green_mask_))
+				| (Reference(xrgb & 0xFF, Bits(f.blue_mask_)) << Shift(f.blue_mask_)) ;
+			// the bits no channel owns are padding, the 32 bit XRGB copy leaves the frame's there
+			const uint32_t owned = f.red_mask_ | f.green_mask_ | f.blue_mask_ ;
+			if ((value & owned) != want) {
+				logger::error("x11 convert : ", layout.name_, " pixel ", x, ",", y, " is ", reinterpret_cast<void*>(static_cast<uintptr_t>(value)), " instead of ", reinterpret_cast<void*>(static_cast<uintptr_t>(want))) ;
+				return false ;
+			}
+			++pixels ;
+		}
+	}
+	return true ;
+}
+
+int main() {
+	zketch_init() ;
+
+	Canvas frame ;
+	if (!frame.Create({___WIDTH___, ___HEIGHT___}, ColorFormat::XRGB)) {
+		logger::error("x11 convert : out of memory") ;
+		return 1 ;
+	}
+	uint32_t seed = 0x9E3779B9u ;
+	const CanvasRows rows = frame.GetRows() ;
+	for (uint32_t y = 0 ; y < ___HEIGHT___ ; ++y) {
+		uint32_t* row = reinterpret_cast<uint32_t*>(rows[y]) ;
+		for (uint32_t x = 0 ; x < ___WIDTH___ ; ++x) {
+			seed = seed * 1664525u + 1013904223u ;
+			row[x] = 0xFF000000u | (seed >> 8) ;
+		}
+	}
+	// the ends of every channel's range
+	reinterpret_cast<uint32_t*>(rows[0])[0] = 0xFFFFFFFFu ;
+	reinterpret_cast<uint32_t*>(rows[0])[1] = 0xFF000000u ;
+
+	const Layout layouts[] = {
+		{"32 bit xrgb", {4, false, 0xFF0000u, 0xFF00u, 0xFFu}},
+		{"32 bit msb first", {4, true, 0xFF0000u, 0xFF00u, 0xFFu}},
+		{"32 bit bgr", {4, false, 0xFFu, 0xFF00u, 0xFF0000u}},
+		{"30 bit", {4, false, 0x3FF00000u, 0xFFC00u, 0x3FFu}},
+		{"24 bit", {3, false, 0xFF0000u, 0xFF00u, 0xFFu}},
+		{"24 bit msb first", {3, true, 0xFF0000u, 0xFF00u, 0xFFu}},
+		{"16 bit 565", {2, false, 0xF800u, 0x7E0u, 0x1Fu}},
+		{"16 bit 565 msb first", {2, true, 0xF800u, 0x7E0u, 0x1Fu}},
+		{"15 bit 555", {2, false, 0x7C00u, 0x3E0u, 0x1Fu}},
+	} ;
+
+	const Layout rejected[] = {
+		{"8 bit", {1, false, 0xE0u, 0x1Cu, 0x3u}},
+		{"no pixel size", {0, false, 0xFF0000u, 0xFF00u, 0xFFu}},
+		{"overlapping masks", {4, false, 0xFF0000u, 0xFFFF00u, 0xFFu}},
+		{"holes in a mask", {4, false, 0xF0F000u, 0xFFu, 0xF00u}},
+		{"empty mask", {4, false, 0xFF0000u, 0, 0xFFu}},
+		{"mask past the pixel", {2, false, 0xFF0000u, 0xFF00u, 0xFFu}},
+	} ;
+
+	// damage as Present gets it: whole, sticking out left and right, past the bottom, outside, and the
+	// whole frame into an image smaller than it (a resize the window hasn't caught up with)
+	struct Case {
+		Rect rect_ ;
+		uint32_t width_ ;
+		uint32_t height_ ;
+		Rect expected_ ;
+	} ;
+	const Case cases[] = {
+		{{0, 0, ___WIDTH___, ___HEIGHT___}, ___WIDTH___, ___HEIGHT___, {0, 0, ___WIDTH___, ___HEIGHT___}},
+		{{-5, 3, ___WIDTH___ + 10, 7}, ___WIDTH___, ___HEIGHT___, {0, 3, ___WIDTH___, 7}},
+		{{17, 20, 3, 9}, ___WIDTH___, ___HEIGHT___, {17, 20, 3, 3}},
+		{{50, 2, 4, 4}, ___WIDTH___, ___HEIGHT___, {0, 0, 0, 0}},
+		{{0, 0, ___WIDTH___, ___HEIGHT___}, 37, 19, {0, 0, 37, 19}},
+	} ;
+
+	uint32_t failed = 0 ;
+	uint64_t pixels = 0 ;
+	for (const Layout& layout : layouts) {
+		if (!layout.format_.IsSupported()) {
+			logger::error("x11 convert : ", layout.name_, " taken as unsupported") ;
+			++failed ;
+			continue ;
+		}
+		for (const Case& c : cases) {
+			failed += Check(frame, layout, c.rect_, c.width_, c.height_, c.expected_, pixels) ? 0 : 1 ;
+		}
+	}
+
+	for (const Layout& layout : rejected) {
+		if (layout.format_.IsSupported()) {
+			logger::error("x11 convert : ", layout.name_, " taken as supported") ;
+			++failed ;
+		}
+	}
+
+	logger::info("x11 convert : ", std::size(layouts), " layouts, ", pixels, " pixels as the reference has them, ", std::size(rejected), " layouts refused, ", failed, " failures") ;
+	return failed == 0 ? 0 : 1 ;
+}
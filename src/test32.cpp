@@ -0,0 +1,256 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// the SSE2 conversion and blend kernels of pixel.hpp against the per pixel functions they replace,
+// on every width from 0 to 67 at offsets 0 to 3, so each vector loop ends in every possible tail and
+// starts unaligned. Sources mix random pixels with alpha 0 and 255 runs. Then times, best of 5, each
+// kernel and its scalar loop over a 1080p frame (BlendOver only vectorizes runs of opaque destination
+// and the frame's are random, it runs even), and filling a 4K canvas through GetRow per row and
+// through GetRows once. Exits non zero when a kernel disagrees with its scalar function on a pixel.
+static constexpr size_t ___MAX_WIDTH___ = 67 ;
+static constexpr size_t ___BENCH_PIXELS___ = 1920 * 1080 ;
+static constexpr uint32_t ___RUNS___ = 5 ;
+
+
+template <typename Fn>
+static double Best(Fn&& fn) {
+	double best = 1e9 ;
+	for (uint32_t run = 0 ; run < ___RUNS___ ; ++run) {
+		const auto t0 = std::chrono::steady_clock::now() ;
+		fn() ;
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count()) ;
+	}
+	return best ;
+}
+
+// random pixels, a stretch of them fully transparent and one fully opaque so the kernels' shortcuts run
+static std::vector<uint32_t> Pixels(size_t count, uint32_t seed) {
+	std::vector<uint32_t> out(count) ;
+	for (size_t i = 0 ; i < count ; ++i) {
+		seed = seed * 1664525u + 1013904223u ;
+		out[i] = seed ;
+		if ((i / 8) % 5 == 1) {
+			out[i] &= 0x00FFFFFFu ;
+		} else if ((i / 8) % 5 == 3) {
+			out[i] |= 0xFF000000u ;
+		}
+	}
+	return out ;
+}
+
+struct Kernel {
+	const char* name_ ;
+	// runs the kernel and its scalar function on count pixels from offset, false on the first mismatch
+	bool (*check_)(const std::vector<uint32_t>& src, const std::vector<uint32_t>& dst, size_t offset, size_t count) ;
+	void (*simd_)(const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) ;
+	void (*scalar_)(const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) ;
+} ;
+
+static const uint32_t ___TINT___ = 0xC0336699u ;
+
+static const Kernel g_kernels[] = {
+	{"argb to xrgb",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>&, size_t offset, size_t count) {
+			std::vector<uint32_t> out(count + 1, 0xDEADBEEFu) ;
+			pixel::ArgbToXrgb(src.data() + offset, out.data(), count) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				if (out[i] != (src[offset + i] | 0xFF000000u)) {
+					return false ;
+				}
+			}
+			return out[count] == 0xDEADBEEFu ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::ArgbToXrgb(src.data(), dst.data(), count) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			for (size_t i = 0 ; i < count ; ++i) {
+				dst[i] = src[i] | 0xFF000000u ;
+			}
+		}},
+	{"argb to rgb565",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>&, size_t offset, size_t count) {
+			std::vector<uint16_t> out(count + 1, 0xBEEF) ;
+			pixel::ArgbToRgb565(src.data() + offset, out.data(), count) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				if (out[i] != pixel::Pack565(src[offset + i])) {
+					return false ;
+				}
+			}
+			return out[count] == 0xBEEF ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::ArgbToRgb565(src.data(), reinterpret_cast<uint16_t*>(dst.data()), count) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			uint16_t* out = reinterpret_cast<uint16_t*>(dst.data()) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				out[i] = pixel::Pack565(src[i]) ;
+			}
+		}},
+	{"rgb565 to argb",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>&, size_t offset, size_t count) {
+			const uint16_t* in = reinterpret_cast<const uint16_t*>(src.data()) + offset ;
+			std::vector<uint32_t> out(count + 1, 0xDEADBEEFu) ;
+			pixel::Rgb565ToArgb(in, out.data(), count) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				if (out[i] != pixel::Expand565(in[i])) {
+					return false ;
+				}
+			}
+			return out[count] == 0xDEADBEEFu ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::Rgb565ToArgb(reinterpret_cast<const uint16_t*>(src.data()), dst.data(), count) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			const uint16_t* in = reinterpret_cast<const uint16_t*>(src.data()) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				dst[i] = pixel::Expand565(in[i]) ;
+			}
+		}},
+	{"argb to a8",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>&, size_t offset, size_t count) {
+			std::vector<uint8_t> out(count + 1, 0xA5) ;
+			pixel::ArgbToA8(src.data() + offset, out.data(), count) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				if (out[i] != (src[offset + i] >> 24)) {
+					return false ;
+				}
+			}
+			return out[count] == 0xA5 ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::ArgbToA8(src.data(), reinterpret_cast<uint8_t*>(dst.data()), count) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			uint8_t* out = reinterpret_cast<uint8_t*>(dst.data()) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				out[i] = static_cast<uint8_t>(src[i] >> 24) ;
+			}
+		}},
+	{"a8 to argb",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>&, size_t offset, size_t count) {
+			const uint8_t* in = reinterpret_cast<const uint8_t*>(src.data()) + offset ;
+			std::vector<uint32_t> out(count + 1, 0xDEADBEEFu) ;
+			pixel::A8ToArgb(in, out.data(), count, ___TINT___) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				if (out[i] != pixel::Tint(in[i], ___TINT___)) {
+					return false ;
+				}
+			}
+			return out[count] == 0xDEADBEEFu ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::A8ToArgb(reinterpret_cast<const uint8_t*>(src.data()), dst.data(), count, ___TINT___) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			const uint8_t* in = reinterpret_cast<const uint8_t*>(src.data()) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				dst[i] = pixel::Tint(in[i], ___TINT___) ;
+			}
+		}},
+	{"blend over opaque",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>& dst, size_t offset, size_t count) {
+			std::vector<uint32_t> out(dst.begin() + static_cast<ptrdiff_t>(offset), dst.begin() + static_cast<ptrdiff_t>(offset + count + 1)) ;
+			for (uint32_t& p : out) {
+				p |= 0xFF000000u ;
+			}
+			const uint32_t after = out[count] ;
+			std::vector<uint32_t> expected(out) ;
+			pixel::BlendOverOpaque(src.data() + offset, out.data(), count) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				const uint32_t s = src[offset + i] ;
+				const uint32_t want = (s >> 24) == 0 ? expected[i] : (s >> 24) == 255 ? s : pixel::OverOpaque(s, expected[i]) ;
+				if (out[i] != want) {
+					return false ;
+				}
+			}
+			return out[count] == after ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::BlendOverOpaque(src.data(), dst.data(), count) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			for (size_t i = 0 ; i < count ; ++i) {
+				const uint32_t sa = src[i] >> 24 ;
+				if (sa != 0) {
+					dst[i] = sa == 255 ? src[i] : pixel::OverOpaque(src[i], dst[i]) ;
+				}
+			}
+		}},
+	{"blend over",
+		[](const std::vector<uint32_t>& src, const std::vector<uint32_t>& dst, size_t offset, size_t count) {
+			std::vector<uint32_t> out(dst.begin() + static_cast<ptrdiff_t>(offset), dst.begin() + static_cast<ptrdiff_t>(offset + count + 1)) ;
+			const uint32_t after = out[count] ;
+			std::vector<uint32_t> expected(out) ;
+			pixel::BlendOver(src.data() + offset, out.data(), count) ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				if (out[i] != pixel::Over(src[offset + i], expected[i])) {
+					return false ;
+				}
+			}
+			return out[count] == after ;
+		},
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) { pixel::BlendOver(src.data(), dst.data(), count) ; },
+		[](const std::vector<uint32_t>& src, std::vector<uint32_t>& dst, size_t count) {
+			for (size_t i = 0 ; i < count ; ++i) {
+				dst[i] = pixel::Over(src[i], dst[i]) ;
+			}
+		}},
+} ;
+
+int main() {
+	zketch_init() ;
+
+	#ifdef ZKETCH_SSE2
+		logger::info("pixel kernels : SSE2") ;
+	#else
+		logger::info("pixel kernels : no SIMD, the kernels are their scalar loops") ;
+	#endif
+
+	const std::vector<uint32_t> src = Pixels(___MAX_WIDTH___ + 8, 0x2545F491u) ;
+	// half of the destination opaque, so BlendOver takes both of its paths
+	std::vector<uint32_t> dst = Pixels(___MAX_WIDTH___ + 8, 0x9E3779B9u) ;
+	for (size_t i = 0 ; i < dst.size() ; i += 2) {
+		dst[i] |= 0xFF000000u ;
+	}
+
+	uint32_t failed = 0 ;
+	for (const Kernel& kernel : g_kernels) {
+		uint32_t mismatches = 0 ;
+		for (size_t offset = 0 ; offset < 4 ; ++offset) {
+			for (size_t width = 0 ; width <= ___MAX_WIDTH___ ; ++width) {
+				mismatches += kernel.check_(src, dst, offset, width) ? 0 : 1 ;
+			}
+		}
+		if (mismatches) {
+			logger::error("pixel kernels : ", kernel.name_, " differs from its scalar function at ", mismatches, " widths") ;
+		}
+		failed += mismatches ;
+	}
+
+	const std::vector<uint32_t> bench_src = Pixels(___BENCH_PIXELS___, 0x12345u) ;
+	const std::vector<uint32_t> bench_dst = Pixels(___BENCH_PIXELS___, 0x6789Au) ;
+	std::vector<uint32_t> out(___BENCH_PIXELS___) ;
+	for (const Kernel& kernel : g_kernels) {
+		const double simd = Best([&] {
+			out = bench_dst ;
+			kernel.simd_(bench_src, out, ___BENCH_PIXELS___) ;
+		}) ;
+		const double scalar = Best([&] {
+			out = bench_dst ;
+			kernel.scalar_(bench_src, out, ___BENCH_PIXELS___) ;
+		}) ;
+		logger::info("  ", kernel.name_, " : ", simd, " ms, scalar ", scalar, " ms, ", scalar / simd, "x (1080p, copy of the destination included)") ;
+	}
+
+	Canvas canvas ;
+	if (!canvas.Create({3840, 2160}, ColorFormat::XRGB)) {
+		logger::error("pixel kernels : out of memory") ;
+		return 1 ;
+	}
+	const double per_row = Best([&] {
+		for (uint32_t y = 0 ; y < canvas.GetHeight() ; ++y) {
+			std::memset(canvas.GetRow(y), static_cast<int>(y), static_cast<size_t>(canvas.GetWidth()) * 4) ;
+		}
+	}) ;
+	const uint64_t version = canvas.GetVersion() ;
+	const double once = Best([&] {
+		const CanvasRows rows = canvas.GetRows() ;
+		for (uint32_t y = 0 ; y < canvas.GetHeight() ; ++y) {
+			std::memset(rows[y], static_cast<int>(y), static_cast<size_t>(canvas.GetWidth()) * 4) ;
+		}
+	}) ;
+	logger::info("  4K fill : ", per_row, " ms through GetRow, ", once, " ms through GetRows, ", canvas.GetVersion() - version, " versions for ", ___RUNS___, " fills") ;
+
+	return failed == 0 && canvas.GetVersion() - version == ___RUNS___ ? 0 : 1 ;
+}
@@ -0,0 +1,95 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// a form of default styled buttons: 40 at 120x32, 20 at 200x40 and 4 labeled "OK" at 120x32, all
+// idle. Each group has to hold one bitmap, referenced by every button in it and by the cache, and
+// the form has to save the bytes of all the others. Then one button is written to and one is
+// hovered: both fork their own pixels under a new version while the rest of their group keeps the
+// old ones. Exits non zero when a count, a version or the bytes saved are off.
+struct Group {
+	const char* name_ ;
+	RectF bound_ ;
+	std::wstring label_ ;
+	uint32_t count_ ;
+	std::vector<std::unique_ptr<Button>> buttons_ ;
+} ;
+
+static const Canvas& CanvasOf(const Button& button) {
+	return *button.GetCanvas() ;
+}
+
+int main() {
+	zketch_init() ;
+	SurfaceCache::Clear() ;
+
+	Font font ;
+	Group groups[] = {
+		{"120x32", {0, 0, 120, 32}, L"", 40, {}},
+		{"200x40", {0, 0, 200, 40}, L"", 20, {}},
+		{"120x32 \"OK\"", {0, 0, 120, 32}, L"OK", 4, {}},
+	} ;
+	for (Group& group : groups) {
+		for (uint32_t i = 0 ; i < group.count_ ; ++i) {
+			group.buttons_.push_back(std::make_unique<Button>(group.bound_, font, group.label_)) ;
+			group.buttons_.back()->InvokeUpdate() ;
+		}
+	}
+
+	uint32_t failed = 0 ;
+	size_t total = 0 ;
+	std::vector<const uint8_t*> distinct ;
+	size_t held = 0 ;
+	for (const Group& group : groups) {
+		const Canvas& first = CanvasOf(*group.buttons_[0]) ;
+		bool same = true ;
+		for (const auto& button : group.buttons_) {
+			same = same && CanvasOf(*button).GetPixels() == first.GetPixels() && CanvasOf(*button).GetVersion() == first.GetVersion() ;
+			total += CanvasOf(*button).GetByteSize() ;
+		}
+		if (std::find(distinct.begin(), distinct.end(), first.GetPixels()) == distinct.end()) {
+			distinct.push_back(first.GetPixels()) ;
+			held += first.GetByteSize() ;
+		}
+
+		// the buttons and the cache's entry under the button's key, a label free one also sits under
+		// the skin key the labeled buttons start from
+		const long expected = static_cast<long>(group.count_) + (group.label_.empty() ? 2 : 1) ;
+		logger::info("surface sharing : ", group.name_, " ", group.count_, " buttons, ", same ? "one bitmap" : "SEVERAL BITMAPS", ", ", first.GetShareCount(), " references") ;
+		failed += same && first.GetShareCount() == expected ? 0 : 1 ;
+	}
+
+	// every button but the first of each group rides on another's pixels
+	size_t saved_expected = 0 ;
+	for (const Group& group : groups) {
+		saved_expected += (group.count_ - 1) * CanvasOf(*group.buttons_[0]).GetByteSize() ;
+	}
+	logger::info("surface sharing : ", total / 1024, " KiB drawn, ", held / 1024, " KiB held, ", (total - held) / 1024, " KiB saved, cache ", SurfaceCache::GetCount(), " entries ", SurfaceCache::GetBytes() / 1024, " KiB") ;
+	failed += distinct.size() == std::size(groups) && total - held == saved_expected ? 0 : 1 ;
+
+	// a write forks the button's pixels and gives them a version of their own
+	Group& plain = groups[0] ;
+	const Canvas& neighbour = CanvasOf(*plain.buttons_[1]) ;
+	const uint8_t* shared_pixels = neighbour.GetPixels() ;
+	const uint64_t shared_version = neighbour.GetVersion() ;
+	const long shared_count = neighbour.GetShareCount() ;
+	const uint32_t shared_first = *reinterpret_cast<const uint32_t*>(shared_pixels) ;
+
+	Canvas* written = plain.buttons_[0]->GetCanvas() ;
+	const CanvasRows rows = written->GetRows() ;
+	*reinterpret_cast<uint32_t*>(rows[0]) = ~shared_first ;
+
+	const bool forked = written->GetPixels() != shared_pixels && written->GetVersion() != shared_version && written->GetShareCount() == 1 ;
+	const bool kept = neighbour.GetPixels() == shared_pixels && neighbour.GetVersion() == shared_version && neighbour.GetShareCount() == shared_count - 1 && *reinterpret_cast<const uint32_t*>(shared_pixels) == shared_first ;
+	logger::info("surface sharing : write ", forked ? "forked" : "DIDN'T FORK", " (version ", shared_version, " -> ", written->GetVersion(), "), the rest ", kept ? "kept theirs" : "CHANGED") ;
+	failed += forked && kept ? 0 : 1 ;
+
+	// hovering is another state, another key, drawn on its own
+	Button& hovered = *plain.buttons_[2] ;
+	hovered.OnHover({10, 10}) ;
+	hovered.InvokeUpdate() ;
+	const bool apart = CanvasOf(hovered).GetPixels() != shared_pixels && CanvasOf(hovered).GetVersion() != shared_version && neighbour.GetShareCount() == shared_count - 2 ;
+	logger::info("surface sharing : hover ", apart ? "drew its own surface" : "STAYED SHARED") ;
+	failed += apart ? 0 : 1 ;
+
+	return failed == 0 ? 0 : 1 ;
+}
@@ -0,0 +1,129 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// 24 panels of 256x256 with a 50 ms idle time: 8 hidden past it, 8 hidden just before the sweep and
+// 8 left shown, plus one hidden panel sharing its pixels with a shown one. Releasing, the sweep has
+// to free exactly the 8 old ones, a shown panel draws itself again. Compressing, the same 8 are
+// packed, the bytes reclaimed are what packing saved and a shown panel comes back with its pixels
+// without drawing. Exits non zero when a panel is evicted early, kept late, or a counter is off.
+static constexpr uint32_t ___SIDE___ = 256 ;
+static constexpr uint32_t ___GROUP___ = 8 ;
+static constexpr auto ___IDLE___ = std::chrono::milliseconds(50) ;
+
+class Panel : public Widget<Panel> {
+	friend class Widget<Panel> ;
+
+private :
+	uint32_t seed_ ;
+	uint32_t draws_ = 0 ;
+
+	// flat bands with a few noisy rows, about what a form panel packs like
+	void UpdateImpl() noexcept {
+		const CanvasRows rows = canvas_->GetRows() ;
+		if (!rows) {
+			return ;
+		}
+		uint32_t seed = seed_ ;
+		for (uint32_t y = 0 ; y < rows.height_ ; ++y) {
+			uint32_t* row = reinterpret_cast<uint32_t*>(rows[y]) ;
+			for (uint32_t x = 0 ; x < canvas_->GetWidth() ; ++x) {
+				seed = seed * 1664525u + 1013904223u ;
+				row[x] = y % 32 == 0 ? 0xFF000000u | (seed >> 8) : 0xFF202028u + (y / 32) * 0x000A0A0Au ;
+			}
+		}
+		++draws_ ;
+	}
+
+public :
+	Panel(uint32_t seed) noexcept : seed_(seed) {
+		bound_ = {0, 0, static_cast<float>(___SIDE___), static_cast<float>(___SIDE___)} ;
+		canvas_ = std::make_unique<Canvas>() ;
+		canvas_->Create(bound_.GetSize()) ;
+	}
+
+	void ShareWith(const Panel& other) noexcept { *canvas_ = *other.canvas_ ; }
+	const Canvas& GetStorage() const noexcept { return *canvas_ ; }
+	uint32_t GetDraws() const noexcept { return draws_ ; }
+} ;
+
+static uint64_t Fingerprint(const Canvas& canvas) {
+	return canvas.IsValid() ? codec::Hash64(canvas.GetPixels(), canvas.GetByteSize()) : 0 ;
+}
+
+static bool Run(const char* name, ReclaimMode mode) {
+	Residency::SetPolicy(mode, ___IDLE___) ;
+	const ResidencyStats before = Residency::GetStats() ;
+
+	std::vector<std::unique_ptr<Panel>> panels ;
+	for (uint32_t i = 0 ; i < ___GROUP___ * 3 + 1 ; ++i) {
+		panels.push_back(std::make_unique<Panel>(i + 1)) ;
+		panels.back()->InvokeUpdate() ;
+	}
+	// the last panel rides on the first shown one's pixels
+	Panel& sharing = *panels.back() ;
+	sharing.ShareWith(*panels[___GROUP___ * 2]) ;
+
+	const uint64_t first_pixels = Fingerprint(panels[0]->GetStorage()) ;
+	for (uint32_t i = 0 ; i < ___GROUP___ ; ++i) {
+		panels[i]->SetVisible(false) ;
+	}
+	sharing.SetVisible(false) ;
+	std::this_thread::sleep_for(___IDLE___ * 2) ;
+	for (uint32_t i = ___GROUP___ ; i < ___GROUP___ * 2 ; ++i) {
+		panels[i]->SetVisible(false) ;
+	}
+
+	const size_t swept = Residency::Collect() ;
+	const ResidencyStats after = Residency::GetStats() ;
+
+	uint32_t evicted = 0 ;
+	uint32_t early = 0 ;
+	size_t packed = 0 ;
+	for (uint32_t i = 0 ; i < ___GROUP___ * 3 ; ++i) {
+		const bool gone = !panels[i]->GetStorage().IsValid() ;
+		if (i < ___GROUP___) {
+			evicted += gone ? 1 : 0 ;
+			packed += panels[i]->GetStorage().GetCompressedSize() ;
+		} else {
+			early += gone ? 1 : 0 ;
+		}
+	}
+	// the sharing panel let go of its reference, which frees nothing
+	const bool shared_ok = !sharing.GetStorage().IsValid() && panels[___GROUP___ * 2]->GetStorage().GetShareCount() == 1 ;
+
+	const size_t bytes = static_cast<size_t>(___SIDE___) * ___SIDE___ * 4 ;
+	const size_t expected = mode == ReclaimMode::Compress ? bytes * ___GROUP___ - packed : bytes * ___GROUP___ ;
+	const uint64_t packed_count = after.compressed_ - before.compressed_ ;
+	const uint64_t released_count = after.released_ - before.released_ ;
+
+	// showing one again, compressed pixels come back as they were, released ones are drawn again
+	const size_t first_reclaimed = bytes - panels[0]->GetStorage().GetCompressedSize() ;
+	const uint32_t draws = panels[0]->GetDraws() ;
+	panels[0]->SetVisible(true) ;
+	panels[0]->InvokeUpdate() ;
+	const ResidencyStats shown = Residency::GetStats() ;
+	const bool back = Fingerprint(panels[0]->GetStorage()) == first_pixels ;
+	const uint32_t redrawn = panels[0]->GetDraws() - draws ;
+
+	logger::info(name, " : ", evicted, " of ", ___GROUP___, " old panels and ", early, " recent ones evicted, ", swept / 1024, " KiB reclaimed (", after.reclaimed_bytes_ / 1024, " KiB in the stats), ", packed / 1024, " KiB packed, shown again ", redrawn ? "by drawing" : "from memory") ;
+
+	bool ok = evicted == ___GROUP___ && early == 0 && shared_ok && swept == expected && after.reclaimed_bytes_ - before.reclaimed_bytes_ == expected && back
+		&& shown.reclaimed_bytes_ == after.reclaimed_bytes_ - first_reclaimed ;
+	if (mode == ReclaimMode::Compress) {
+		ok = ok && packed_count == ___GROUP___ && released_count == 1 && packed < bytes * ___GROUP___ && redrawn == 0 && shown.restored_ - after.restored_ == 1 ;
+	} else {
+		ok = ok && packed_count == 0 && released_count == ___GROUP___ + 1 && redrawn == 1 && shown.rerasterized_ - after.rerasterized_ == 1 ;
+	}
+
+	panels.clear() ;
+	const ResidencyStats cleared = Residency::GetStats() ;
+	return ok && cleared.reclaimed_bytes_ == before.reclaimed_bytes_ && cleared.compressed_bytes_ == before.compressed_bytes_ ;
+}
+
+int main() {
+	zketch_init() ;
+	const bool released = Run("release ", ReclaimMode::Release) ;
+	const bool compressed = Run("compress", ReclaimMode::Compress) ;
+	Residency::SetPolicy(ReclaimMode::Keep) ;
+	return released && compressed ? 0 : 1 ;
+}
@@ -0,0 +1,121 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// a 30000x30000 tiled canvas with six rects drawn far apart, five inside a tile each and one across a
+// tile corner: 9 tiles allocated, 2.25 MiB where a dense canvas would take 3.4 GiB. Reads back the
+// corner and an untouched region, then sets a redraw callback and a 4 tile budget: the 5 least
+// recently used tiles are evicted, reading one regenerates it within the budget and a tile holding
+// drawing the callback can't reproduce outlives a budget of nothing. Exits non zero when a tile
+// count, the footprint, an eviction or a pixel read back is off.
+static constexpr int32_t ___T___ = static_cast<int32_t>(TiledCanvas::___TILE_SIZE___) ;
+static constexpr uint32_t ___SIDE___ = 30000 ;
+static constexpr size_t ___TILE_BYTES___ = static_cast<size_t>(___T___) * ___T___ * 4 ;
+static constexpr uint32_t ___INK___ = 0xFFC82828u ;
+static constexpr uint32_t ___PAPER___ = 0xFFFFFFFFu ;
+
+static const Rect g_marks[] = {
+	{39 * ___T___ + 20, 78 * ___T___ + 20, 200, 200},
+	{5 * ___T___ + 20, 100 * ___T___ + 20, 120, 60},
+	{110 * ___T___ + 30, 3 * ___T___ + 30, 100, 100},
+	{90 * ___T___ + 40, 90 * ___T___ + 40, 50, 150},
+	{60 * ___T___ + 10, 20 * ___T___ + 10, 200, 200},
+	{100 * ___T___ - 60, 50 * ___T___ - 60, 120, 120},	// across the corner of 4 tiles
+} ;
+
+static void Draw(Renderer& renderer) {
+	for (const Rect& mark : g_marks) {
+		renderer.FillRect(mark, rgba(200, 40, 40, 1)) ;
+	}
+}
+
+// reads region through DrawCanvas and compares it with ink inside marks and paper outside, a
+// pixel band along each mark's edge is left out for anti aliasing
+static bool ReadsBack(TiledCanvas& doc, const Rect& region, const Rect* marks, size_t count) {
+	Canvas out ;
+	Renderer renderer ;
+	if (!out.Create({region.w, region.h}, ColorFormat::ARGB) || !renderer.Begin(out)) {
+		return false ;
+	}
+	renderer.DrawCanvas(&doc, region, {0, 0}) ;
+	renderer.End() ;
+
+	for (int32_t y = 0 ; y < static_cast<int32_t>(region.h) ; ++y) {
+		const uint32_t* row = reinterpret_cast<const uint32_t*>(out.GetRow(static_cast<uint32_t>(y))) ;
+		for (int32_t x = 0 ; x < static_cast<int32_t>(region.w) ; ++x) {
+			const int32_t px = region.x + x ;
+			const int32_t py = region.y + y ;
+			bool inside = false ;
+			bool edge = false ;
+			for (size_t i = 0 ; i < count ; ++i) {
+				const Rect& m = marks[i] ;
+				const bool in = px >= m.x && py >= m.y && px < m.x + static_cast<int32_t>(m.w) && py < m.y + static_cast<int32_t>(m.h) ;
+				const bool near = px >= m.x - 1 && py >= m.y - 1 && px <= m.x + static_cast<int32_t>(m.w) && py <= m.y + static_cast<int32_t>(m.h) ;
+				const bool core = px >= m.x + 1 && py >= m.y + 1 && px < m.x + static_cast<int32_t>(m.w) - 1 && py < m.y + static_cast<int32_t>(m.h) - 1 ;
+				inside = inside || in ;
+				edge = edge || (near && !core) ;
+			}
+			if (!edge && row[x] != (inside ? ___INK___ : ___PAPER___)) {
+				logger::error("tiled canvas : pixel ", px, ",", py, " is ", reinterpret_cast<void*>(static_cast<uintptr_t>(row[x]))) ;
+				return false ;
+			}
+		}
+	}
+	return true ;
+}
+
+int main() {
+	zketch_init() ;
+
+	TiledCanvas doc ;
+	if (!doc.Create({___SIDE___, ___SIDE___}, ColorFormat::ARGB) || !doc.SetBackground(rgba(255, 255, 255, 1))) {
+		logger::error("tiled canvas : Create failed") ;
+		return 1 ;
+	}
+
+	Renderer renderer ;
+	if (!renderer.Begin(doc)) {
+		logger::error("tiled canvas : Begin failed") ;
+		return 1 ;
+	}
+	Draw(renderer) ;
+	renderer.End() ;
+
+	const size_t drawn = doc.GetTileCount() ;
+	const size_t footprint = doc.GetByteSize() ;
+	const double dense = static_cast<double>(___SIDE___) * ___SIDE___ * 4 ;
+	logger::info("tiled canvas : ", drawn, " tiles, ", footprint / 1024, " KiB, ", dense / footprint, "x less than a dense canvas") ;
+	uint32_t failed = drawn == 9 && footprint == 9 * ___TILE_BYTES___ ? 0 : 1 ;
+
+	// the corner read last, its tiles are the most recently used ones
+	const Rect untouched = {2 * ___T___ - 50, 2 * ___T___ - 50, 100, 100} ;
+	const Rect corner = {100 * ___T___ - 100, 50 * ___T___ - 100, 200, 200} ;
+	failed += ReadsBack(doc, untouched, nullptr, 0) ? 0 : 1 ;
+	failed += ReadsBack(doc, corner, &g_marks[5], 1) ? 0 : 1 ;
+	failed += doc.GetTileCount() == 9 ? 0 : 1 ;
+
+	doc.SetRedraw([](Renderer& r, const Rect&) { Draw(r) ; }) ;
+	doc.MarkClean() ;
+	doc.SetBudget(4 * ___TILE_BYTES___) ;
+	const bool kept = doc.GetTile(99, 49) && doc.GetTile(100, 49) && doc.GetTile(99, 50) && doc.GetTile(100, 50) ;
+	logger::info("tiled canvas : 4 tile budget, ", doc.GetTileCount(), " tiles left, ", doc.GetEvictedCount(), " evicted, the corner's ", kept ? "kept" : "EVICTED") ;
+	failed += doc.GetTileCount() == 4 && doc.GetByteSize() == 4 * ___TILE_BYTES___ && doc.GetEvictedCount() == 5 && kept ? 0 : 1 ;
+
+	// an evicted tile comes back through the callback, one more goes to make room
+	const Rect first = {39 * ___T___, 78 * ___T___, ___T___, ___T___} ;
+	const bool regenerated = ReadsBack(doc, first, &g_marks[0], 1) ;
+	logger::info("tiled canvas : evicted tile read ", regenerated ? "back" : "WRONG", ", ", doc.GetRegeneratedCount(), " regenerated, ", doc.GetTileCount(), " tiles, ", doc.GetEvictedCount(), " evicted") ;
+	failed += regenerated && doc.GetRegeneratedCount() == 1 && doc.GetByteSize() <= doc.GetBudget() && doc.GetEvictedCount() == 6 && doc.GetTile(39, 78) ? 0 : 1 ;
+
+	// drawing without a MarkClean() is dirty, only clean tiles go to meet a budget
+	const Rect scribble = {10 * ___T___ + 50, 10 * ___T___ + 50, 30, 30} ;
+	if (renderer.Begin(doc)) {
+		renderer.FillRect(scribble, rgba(200, 40, 40, 1)) ;
+		renderer.End() ;
+	}
+	doc.SetBudget(1) ;
+	const bool dirty_kept = doc.GetTileCount() == 1 && doc.GetTile(10, 10) && ReadsBack(doc, {10 * ___T___, 10 * ___T___, ___T___, ___T___}, &scribble, 1) ;
+	logger::info("tiled canvas : 1 byte budget, ", doc.GetTileCount(), " tile left, the dirty one ", dirty_kept ? "kept" : "LOST") ;
+	failed += dirty_kept ? 0 : 1 ;
+
+	return failed == 0 ? 0 : 1 ;
+}
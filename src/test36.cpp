@@ -0,0 +1,136 @@
+#include "zketch.hpp"
+using namespace zketch ;
+
+// a 97x61 wrapped canvas scrolling over a map of 7x5 cells, by steps that carry the origin across
+// both edges of the storage in both directions, up to a whole width. After each step only the
+// exposed strips are drawn, then regions of it are drawn through DrawCanvas: the whole view, one
+// around the seam in both axes, one hanging off the source and one off the target. Each has to come
+// out byte for byte as the same view drawn in full on a plain canvas. Exits non zero when one
+// doesn't.
+static constexpr uint32_t ___W___ = 97 ;
+static constexpr uint32_t ___H___ = 61 ;
+static constexpr int32_t ___CELL_W___ = 7 ;
+static constexpr int32_t ___CELL_H___ = 5 ;
+
+static Color CellColor(int32_t cx, int32_t cy) {
+	uint32_t h = static_cast<uint32_t>(cx) * 0x9E3779B1u ^ static_cast<uint32_t>(cy) * 0x85EBCA77u ;
+	h ^= h >> 15 ;
+	h *= 0x2C1B3C6Du ;
+	h ^= h >> 12 ;
+	return rgba(static_cast<int32_t>(h & 0xFF), static_cast<int32_t>((h >> 8) & 0xFF), static_cast<int32_t>((h >> 16) & 0xFF), 1) ;
+}
+
+// the map cells under rect (logical) with the view's top left at view
+static void DrawMap(Renderer& renderer, const Rect& rect, const Point& view) {
+	if (rect.w == 0 || rect.h == 0) {
+		return ;
+	}
+	const int32_t x0 = view.x + rect.x ;
+	const int32_t y0 = view.y + rect.y ;
+	const int32_t x1 = x0 + static_cast<int32_t>(rect.w) ;
+	const int32_t y1 = y0 + static_cast<int32_t>(rect.h) ;
+	for (int32_t cy = y0 / ___CELL_H___ ; cy * ___CELL_H___ < y1 ; ++cy) {
+		for (int32_t cx = x0 / ___CELL_W___ ; cx * ___CELL_W___ < x1 ; ++cx) {
+			const int32_t l = std::max(cx * ___CELL_W___, x0) ;
+			const int32_t t = std::max(cy * ___CELL_H___, y0) ;
+			const int32_t r = std::min((cx + 1) * ___CELL_W___, x1) ;
+			const int32_t b = std::min((cy + 1) * ___CELL_H___, y1) ;
+			renderer.ClearRect({l - view.x, t - view.y, static_cast<uint32_t>(r - l), static_cast<uint32_t>(b - t)}, CellColor(cx, cy)) ;
+		}
+	}
+}
+
+// draws region of src at pos on a cleared 120x80 canvas
+static bool Blit(const Canvas& src, const Rect& region, const Point& pos, Canvas& out) {
+	Renderer renderer ;
+	if (!out.Create({120, 80}, ColorFormat::ARGB) || !renderer.Begin(out)) {
+		return false ;
+	}
+	renderer.Clear(rgba(0, 0, 0, 0)) ;
+	renderer.DrawCanvas(&src, region, pos) ;
+	renderer.End() ;
+	return true ;
+}
+
+static bool Same(const Canvas& a, const Canvas& b) {
+	for (uint32_t y = 0 ; y < a.GetHeight() ; ++y) {
+		if (memcmp(a.GetRow(y), b.GetRow(y), static_cast<size_t>(a.GetWidth()) * 4) != 0) {
+			return false ;
+		}
+	}
+	return true ;
+}
+
+int main() {
+	zketch_init() ;
+
+	Canvas strip ;
+	Renderer renderer ;
+	if (!strip.Create({___W___, ___H___}, ColorFormat::ARGB) || !renderer.Begin(strip)) {
+		logger::error("wrap scroll : Create failed") ;
+		return 1 ;
+	}
+	strip.SetWrap(true) ;
+	Point view {1000, 1000} ;
+	DrawMap(renderer, {0, 0, ___W___, ___H___}, view) ;
+	renderer.End() ;
+
+	const Point steps[] = {
+		{40, 0}, {40, 0}, {40, 0},			// right past the storage's right edge and around
+		{-130, 0}, {-97, 0},				// back past the left edge, a whole width at once
+		{0, 25}, {0, 25}, {0, 25},			// down across the bottom edge
+		{0, -70}, {0, -61},					// up past the top edge, a whole height
+		{33, 17}, {-55, -40}, {96, 60}, {-1, -1}, {13, -29},
+	} ;
+
+	uint32_t failed = 0 ;
+	uint32_t seams = 0 ;
+	for (const Point& step : steps) {
+		const std::array<Rect, 2> exposed = strip.Scroll(step.x, step.y) ;
+		view.x += step.x ;
+		view.y += step.y ;
+		if (!renderer.Begin(strip)) {
+			++failed ;
+			continue ;
+		}
+		DrawMap(renderer, exposed[0], view) ;
+		DrawMap(renderer, exposed[1], view) ;
+		renderer.End() ;
+
+		Canvas reference ;
+		if (!reference.Create({___W___, ___H___}, ColorFormat::ARGB) || !renderer.Begin(reference)) {
+			++failed ;
+			continue ;
+		}
+		DrawMap(renderer, {0, 0, ___W___, ___H___}, view) ;
+		renderer.End() ;
+
+		// the seam is where logical coordinates wrap back to the start of the storage
+		const Point origin = strip.GetOrigin() ;
+		const int32_t sx = static_cast<int32_t>(___W___) - origin.x ;
+		const int32_t sy = static_cast<int32_t>(___H___) - origin.y ;
+		seams += origin.x != 0 && origin.y != 0 ? 1 : 0 ;
+
+		struct Blitted {
+			Rect region_ ;
+			Point pos_ ;
+		} ;
+		const Blitted blits[] = {
+			{{0, 0, ___W___, ___H___}, {5, 3}},
+			{{sx - 9, sy - 6, 18, 12}, {50, 40}},
+			{{sx - 30, sy - 20, 200, 200}, {0, 0}},
+			{{0, 0, ___W___, ___H___}, {-sx, 80 - sy}},
+		} ;
+		for (const Blitted& blit : blits) {
+			Canvas got ;
+			Canvas want ;
+			if (!Blit(strip, blit.region_, blit.pos_, got) || !Blit(reference, blit.region_, blit.pos_, want) || !Same(got, want)) {
+				logger::error("wrap scroll : view ", view.x, ",", view.y, " origin ", origin.x, ",", origin.y, " region ", blit.region_.x, ",", blit.region_.y, " ", blit.region_.w, "x", blit.region_.h, " differs from the unwrapped canvas") ;
+				++failed ;
+			}
+		}
+	}
+
+	logger::info("wrap scroll : ", std::size(steps), " scrolls, ", seams, " with a seam in both axes, ", failed, " blits off the unwrapped reference") ;
+	return failed == 0 && seams >= 5 ? 0 : 1 ;
+}
@@ -0,0 +1,99 @@
+// dumps capture files written by FrameRecorder, needs no window system:
+//
+//	g++ -std=c++20 -O2 -Iinclude src/zkdump.cpp -o zkdump
+//
+//	zkdump rec.zkc							frame index with timestamps
+//	zkdump rec.zkc -f 120 out.png			frame 120
+//	zkdump rec.zkc -t 2500 out.png			frame shown at 2500 ms
+//	zkdump rec.zkc -a frames/				every frame as frames/000000.ppm, ...
+//	zkdump rec.zkc -p						decodes every frame, reports decode speed
+#include "capture.hpp"
+#include <cstdio>
+using namespace zketch ;
+
+static bool Save(const ImageView& frame, const std::string& path) {
+	ImageFormat format = ImageFormat::PPM ;
+	if (path.ends_with(".png")) {
+		format = ImageFormat::PNG ;
+	} else if (path.ends_with(".qoi")) {
+		format = ImageFormat::QOI ;
+	}
+
+	FileWriter out(path) ;
+	return out.IsOpen() && EncodeImage(frame, out, format) ;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s capture [-f frame out | -t ms out | -a dir | -p]\n", argv[0]) ;
+		return 1 ;
+	}
+
+	CaptureReader reader ;
+	if (!reader.Open(argv[1])) {
+		std::fprintf(stderr, "%s: not a capture file\n", argv[1]) ;
+		return 1 ;
+	}
+
+	const auto& index = reader.GetIndex() ;
+	const std::string mode = argc > 2 ? argv[2] : "" ;
+
+	if (mode.empty()) {
+		size_t keys = 0 ;
+		for (size_t i = 0 ; i < index.size() ; ++i) {
+			std::printf("%6zu  %10.3f ms  %s  offset %10llu  %8llu bytes\n", i, index[i].timestamp_ / 1e6, index[i].IsKeyFrame() ? "key  " : "delta", static_cast<unsigned long long>(index[i].offset_), static_cast<unsigned long long>(reader.GetFrameBytes(i))) ;
+			keys += index[i].IsKeyFrame() ? 1 : 0 ;
+		}
+
+		const double duration = index.empty() ? 0.0 : index.back().timestamp_ / 1e9 ;
+		std::printf("%zu frames, %zu key frames (interval %u), %.3f s\n", index.size(), keys, reader.GetKeyFrameInterval(), duration) ;
+		return 0 ;
+	}
+
+	if ((mode == "-f" || mode == "-t") && argc > 4) {
+		const size_t frame = mode == "-f" ? std::strtoull(argv[3], nullptr, 10) : reader.FindFrame(static_cast<uint64_t>(std::strtod(argv[3], nullptr) * 1e6)) ;
+		if (!reader.Seek(frame) || !Save(reader.GetFrame(), argv[4])) {
+			std::fprintf(stderr, "failed to dump frame %zu\n", frame) ;
+			return 1 ;
+		}
+
+		std::printf("frame %zu at %.3f ms -> %s\n", frame, index[frame].timestamp_ / 1e6, argv[4]) ;
+		return 0 ;
+	}
+
+	if (mode == "-a" && argc > 3) {
+		std::string dir = argv[3] ;
+		if (!dir.empty() && dir.back() != '/') {
+			dir.push_back('/') ;
+		}
+
+		for (size_t i = 0 ; i < index.size() ; ++i) {
+			char name[32] ;
+			std::snprintf(name, sizeof(name), "%06zu.ppm", i) ;
+			if (!reader.Seek(i) || !Save(reader.GetFrame(), dir + name)) {
+				std::fprintf(stderr, "failed to dump frame %zu\n", i) ;
+				return 1 ;
+			}
+		}
+
+		std::printf("%zu frames -> %s\n", index.size(), dir.c_str()) ;
+		return 0 ;
+	}
+
+	if (mode == "-p") {
+		const auto t0 = std::chrono::steady_clock::now() ;
+		for (size_t i = 0 ; i < index.size() ; ++i) {
+			if (!reader.Seek(i)) {
+				std::fprintf(stderr, "failed to decode frame %zu\n", i) ;
+				return 1 ;
+			}
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() ;
+		std::printf("%zu frames decoded in %.2f ms, %.3f ms per frame\n", index.size(), ms, index.empty() ? 0.0 : ms / index.size()) ;
+		return 0 ;
+	}
+
+	std::fprintf(stderr, "usage: %s capture [-f frame out | -t ms out | -a dir | -p]\n", argv[0]) ;
+	return 1 ;
+}